@@ -25,6 +25,7 @@
 #include <nuttx/config.h>
 
 #include <stdio.h>
+#include <errno.h>
 
 #include <nuttx/syslog/syslog.h>
 #include <nuttx/compiler.h>
@@ -63,6 +64,8 @@
 /* SYSLOG channel methods */
 
 static int itm_putc(FAR struct syslog_channel_s *channel, int ch);
+static ssize_t itm_write(FAR struct syslog_channel_s *channel,
+                         FAR const char *buffer, size_t buflen);
 static int itm_flush(FAR struct syslog_channel_s *channel);
 
 /****************************************************************************
@@ -76,6 +79,7 @@ static const struct syslog_channel_ops_s g_itm_channel_ops =
   .sc_putc  = itm_putc,
   .sc_force = itm_putc,
   .sc_flush = itm_flush,
+  .sc_write = itm_write,
 };
 
 /* This structure describes the ITM SYSLOG channel */
@@ -119,6 +123,57 @@ static int itm_putc(FAR struct syslog_channel_s *channel, int ch)
   return ch;
 }
 
+/****************************************************************************
+ * Name: itm_write
+ *
+ * Description:
+ *   Write a buffer to the ITM stimulus port, four characters per 32-bit
+ *   write.  The trace decoder receives them in order, least significant
+ *   byte first.
+ *
+ ****************************************************************************/
+
+static ssize_t itm_write(FAR struct syslog_channel_s *channel,
+                         FAR const char *buffer, size_t buflen)
+{
+  FAR const uint8_t *src = (FAR const uint8_t *)buffer;
+  size_t nwritten = 0;
+  uint32_t word;
+
+  UNUSED(channel);
+
+  /* ITM enabled */
+
+  if ((getreg32(ITM_TCR) & ITM_TCR_ITMENA_MASK) == 0)
+    {
+      return -EIO;
+    }
+
+  /* ITM Port "CONFIG_ARMV7M_ITMSYSLOG_PORT" enabled */
+
+  if ((getreg32(ITM_TER) & (1 << CONFIG_ARMV7M_ITMSYSLOG_PORT)) == 0)
+    {
+      return buflen;
+    }
+
+  for (; nwritten + 4 <= buflen; nwritten += 4, src += 4)
+    {
+      word = (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+             ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+
+      while (getreg32(ITM_PORT(CONFIG_ARMV7M_ITMSYSLOG_PORT)) == 0);
+      putreg32(word, ITM_PORT(CONFIG_ARMV7M_ITMSYSLOG_PORT));
+    }
+
+  for (; nwritten < buflen; nwritten++, src++)
+    {
+      while (getreg32(ITM_PORT(CONFIG_ARMV7M_ITMSYSLOG_PORT)) == 0);
+      putreg8(*src, ITM_PORT(CONFIG_ARMV7M_ITMSYSLOG_PORT));
+    }
+
+  return buflen;
+}
+
 /****************************************************************************
  * Name: itm_flush
  *
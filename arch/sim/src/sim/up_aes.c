@@ -0,0 +1,269 @@
+/****************************************************************************
+ * arch/sim/src/sim/up_aes.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <nuttx/crypto/aes.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define AESNI_TARGET  __attribute__((target("sse2,aes")))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Use the compiler's generic vector types so that no host intrinsics
+ * header is needed.
+ */
+
+typedef long long v2di_t __attribute__((vector_size(16)));
+typedef int v4si_t __attribute__((vector_size(16)));
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint8_t g_rcon[11] =
+{
+  0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline v2di_t AESNI_TARGET loadu(FAR const void *src)
+{
+  v2di_t v;
+
+  __builtin_memcpy(&v, src, sizeof(v));
+  return v;
+}
+
+static inline void AESNI_TARGET storeu(FAR void *dest, v2di_t v)
+{
+  __builtin_memcpy(dest, &v, sizeof(v));
+}
+
+/* SubWord() of a little-endian key word:  AESKEYGENASSIST applies the
+ * S-box to the second word of its source and returns it in the first.
+ */
+
+static uint32_t AESNI_TARGET sub_word(uint32_t w)
+{
+  v4si_t v;
+
+  v[0] = w;
+  v[1] = w;
+  v[2] = w;
+  v[3] = w;
+
+  v = (v4si_t)__builtin_ia32_aeskeygenassist128((v2di_t)v, 0);
+  return (uint32_t)v[0];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aes_setupkey
+ *
+ * Description:
+ *   Expand the key as in FIPS-197, keeping the round keys in the byte
+ *   order of the AES-NI instructions.  The decryption keys are those of
+ *   the equivalent inverse cipher that AESDEC expects.
+ *
+ ****************************************************************************/
+
+int AESNI_TARGET aes_setupkey(FAR struct aes_state_s *state,
+                              FAR const uint8_t *key, int len)
+{
+  FAR uint32_t *ek = state->ek;
+  FAR v2di_t *dk = (FAR v2di_t *)state->dk;
+  uint32_t t;
+  int nwords;
+  int nk;
+  int nr;
+  int i;
+
+  if (len != AES128_KEY_SIZE && len != AES192_KEY_SIZE &&
+      len != AES256_KEY_SIZE)
+    {
+      return -EINVAL;
+    }
+
+  nk     = len / 4;
+  nr     = nk + 6;
+  nwords = 4 * (nr + 1);
+
+  __builtin_memcpy(ek, key, len);
+
+  for (i = nk; i < nwords; i++)
+    {
+      t = ek[i - 1];
+      if (i % nk == 0)
+        {
+          t = sub_word((t >> 8) | (t << 24)) ^ g_rcon[i / nk];
+        }
+      else if (nk > 6 && i % nk == 4)
+        {
+          t = sub_word(t);
+        }
+
+      ek[i] = ek[i - nk] ^ t;
+    }
+
+  storeu(&dk[0], loadu(&ek[4 * nr]));
+  for (i = 1; i < nr; i++)
+    {
+      storeu(&dk[i],
+             __builtin_ia32_aesimc128(loadu(&ek[4 * (nr - i)])));
+    }
+
+  storeu(&dk[nr], loadu(&ek[0]));
+
+  state->nrounds = nr;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: aes_encipher
+ *
+ * Description:
+ *   Encipher blocks in place, four at a time so that the AESENC latency
+ *   of one block is hidden behind the others.
+ *
+ ****************************************************************************/
+
+void AESNI_TARGET aes_encipher(FAR struct aes_state_s *state,
+                               FAR uint8_t *blocks, int nblk)
+{
+  FAR const uint32_t *rk = state->ek;
+  int nr = state->nrounds;
+  v2di_t k;
+  v2di_t x0;
+  v2di_t x1;
+  v2di_t x2;
+  v2di_t x3;
+  int r;
+
+  for (; nblk >= 4; nblk -= 4, blocks += 64)
+    {
+      k  = loadu(rk);
+      x0 = loadu(blocks)      ^ k;
+      x1 = loadu(blocks + 16) ^ k;
+      x2 = loadu(blocks + 32) ^ k;
+      x3 = loadu(blocks + 48) ^ k;
+
+      for (r = 1; r < nr; r++)
+        {
+          k  = loadu(rk + 4 * r);
+          x0 = __builtin_ia32_aesenc128(x0, k);
+          x1 = __builtin_ia32_aesenc128(x1, k);
+          x2 = __builtin_ia32_aesenc128(x2, k);
+          x3 = __builtin_ia32_aesenc128(x3, k);
+        }
+
+      k = loadu(rk + 4 * nr);
+      storeu(blocks,      __builtin_ia32_aesenclast128(x0, k));
+      storeu(blocks + 16, __builtin_ia32_aesenclast128(x1, k));
+      storeu(blocks + 32, __builtin_ia32_aesenclast128(x2, k));
+      storeu(blocks + 48, __builtin_ia32_aesenclast128(x3, k));
+    }
+
+  for (; nblk > 0; nblk--, blocks += 16)
+    {
+      x0 = loadu(blocks) ^ loadu(rk);
+      for (r = 1; r < nr; r++)
+        {
+          x0 = __builtin_ia32_aesenc128(x0, loadu(rk + 4 * r));
+        }
+
+      storeu(blocks, __builtin_ia32_aesenclast128(x0, loadu(rk + 4 * nr)));
+    }
+}
+
+/****************************************************************************
+ * Name: aes_decipher
+ *
+ * Description:
+ *   Decipher blocks in place, four at a time.
+ *
+ ****************************************************************************/
+
+void AESNI_TARGET aes_decipher(FAR struct aes_state_s *state,
+                               FAR uint8_t *blocks, int nblk)
+{
+  FAR const uint32_t *rk = state->dk;
+  int nr = state->nrounds;
+  v2di_t k;
+  v2di_t x0;
+  v2di_t x1;
+  v2di_t x2;
+  v2di_t x3;
+  int r;
+
+  for (; nblk >= 4; nblk -= 4, blocks += 64)
+    {
+      k  = loadu(rk);
+      x0 = loadu(blocks)      ^ k;
+      x1 = loadu(blocks + 16) ^ k;
+      x2 = loadu(blocks + 32) ^ k;
+      x3 = loadu(blocks + 48) ^ k;
+
+      for (r = 1; r < nr; r++)
+        {
+          k  = loadu(rk + 4 * r);
+          x0 = __builtin_ia32_aesdec128(x0, k);
+          x1 = __builtin_ia32_aesdec128(x1, k);
+          x2 = __builtin_ia32_aesdec128(x2, k);
+          x3 = __builtin_ia32_aesdec128(x3, k);
+        }
+
+      k = loadu(rk + 4 * nr);
+      storeu(blocks,      __builtin_ia32_aesdeclast128(x0, k));
+      storeu(blocks + 16, __builtin_ia32_aesdeclast128(x1, k));
+      storeu(blocks + 32, __builtin_ia32_aesdeclast128(x2, k));
+      storeu(blocks + 48, __builtin_ia32_aesdeclast128(x3, k));
+    }
+
+  for (; nblk > 0; nblk--, blocks += 16)
+    {
+      x0 = loadu(blocks) ^ loadu(rk);
+      for (r = 1; r < nr; r++)
+        {
+          x0 = __builtin_ia32_aesdec128(x0, loadu(rk + 4 * r));
+        }
+
+      storeu(blocks, __builtin_ia32_aesdeclast128(x0, loadu(rk + 4 * nr)));
+    }
+}
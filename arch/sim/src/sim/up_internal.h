@@ -96,6 +96,7 @@ struct spi_dev_s;
 struct qspi_dev_s;
 struct ioexpander_dev_s;
 struct i2c_master_s;
+struct sdio_dev_s;
 
 /****************************************************************************
  * Public Data
@@ -208,6 +209,8 @@ int  simuart_open(const char *pathname);
 void simuart_close(int fd);
 int  simuart_putc(int fd, int ch);
 int  simuart_getc(int fd);
+int  simuart_write(int fd, const char *buf, size_t len);
+int  simuart_read(int fd, char *buf, size_t len);
 bool simuart_checkc(int fd);
 int  simuart_setcflag(int fd, unsigned int cflag);
 int  simuart_getcflag(int fd, unsigned int *cflag);
@@ -345,6 +348,12 @@ struct audio_lowerhalf_s *sim_audio_initialize(bool playback);
 void sim_audio_loop(void);
 #endif
 
+/* up_sdio.c ****************************************************************/
+
+#ifdef CONFIG_SIM_SDIO
+struct sdio_dev_s *sim_sdio_initialize(void);
+#endif
+
 /* up_i2cbus*.c *************************************************************/
 
 #ifdef CONFIG_SIM_I2CBUS
@@ -0,0 +1,682 @@
+/****************************************************************************
+ * arch/sim/src/sim/up_sdio.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/signal.h>
+#include <nuttx/sdio.h>
+#include <nuttx/fs/hostfs.h>
+
+#include "up_internal.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The simulated card is a block addressed (high capacity) SD card with 512
+ * byte blocks.
+ */
+
+#define SIM_SDIO_BLOCKSHIFT     9
+#define SIM_SDIO_BLOCKSIZE      (1 << SIM_SDIO_BLOCKSHIFT)
+#define SIM_SDIO_NBLOCKS        ((uint32_t)CONFIG_SIM_SDIO_SIZE << 11)
+#define SIM_SDIO_RCA            0x1234
+
+/* Card states as reported in the R1 status */
+
+#define SIM_STATE_IDLE          0
+#define SIM_STATE_READY         1
+#define SIM_STATE_IDENT         2
+#define SIM_STATE_STBY          3
+#define SIM_STATE_TRAN          4
+
+/* R1 status and OCR bits */
+
+#define SIM_R1_STATE(s)         ((uint32_t)(s) << 9)
+#define SIM_R1_READYFORDATA     ((uint32_t)1 << 8)
+#define SIM_R1_APPCMD           ((uint32_t)1 << 5)
+
+#define SIM_OCR_VOLTAGES        ((uint32_t)0x00ff8000) /* 2.7-3.6V */
+#define SIM_OCR_CCS             ((uint32_t)1 << 30)    /* High capacity */
+#define SIM_OCR_READY           ((uint32_t)1 << 31)    /* Power up done */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure holds the state of the simulated card and controller */
+
+struct sim_sdio_s
+{
+  struct sdio_dev_s dev;         /* SDIO device (must be first) */
+
+  int       fd;                  /* Host file with the card contents */
+  uint8_t   state;               /* Card state (see SIM_STATE_*) */
+  bool      appcmd;              /* true: Last command was CMD55 */
+  int       cmdresult;           /* Result of the last command */
+  uint32_t  response[4];         /* Response of the last command */
+
+  /* Data transfer started by the last data command */
+
+  uint8_t   xfercmd;             /* Command index, zero if none */
+  uint32_t  xferblock;           /* First block of the transfer */
+  FAR uint8_t *buffer;           /* Buffer set up by recv/sendsetup */
+  size_t    nbytes;              /* Size of the buffer */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* Mutual exclusion */
+
+#ifdef CONFIG_SDIO_MUXBUS
+static int  sim_sdio_lock(FAR struct sdio_dev_s *dev, bool lock);
+#endif
+
+/* Initialization/setup */
+
+static void sim_sdio_reset(FAR struct sdio_dev_s *dev);
+static sdio_capset_t sim_sdio_capabilities(FAR struct sdio_dev_s *dev);
+static sdio_statset_t sim_sdio_status(FAR struct sdio_dev_s *dev);
+static void sim_sdio_widebus(FAR struct sdio_dev_s *dev, bool enable);
+static void sim_sdio_clock(FAR struct sdio_dev_s *dev,
+              enum sdio_clock_e rate);
+static int  sim_sdio_attach(FAR struct sdio_dev_s *dev);
+
+/* Command/Status/Data Transfer */
+
+static int  sim_sdio_sendcmd(FAR struct sdio_dev_s *dev, uint32_t cmd,
+              uint32_t arg);
+#ifdef CONFIG_SDIO_BLOCKSETUP
+static void sim_sdio_blocksetup(FAR struct sdio_dev_s *dev,
+              unsigned int blocklen, unsigned int nblocks);
+#endif
+static int  sim_sdio_recvsetup(FAR struct sdio_dev_s *dev,
+              FAR uint8_t *buffer, size_t nbytes);
+static int  sim_sdio_sendsetup(FAR struct sdio_dev_s *dev,
+              FAR const uint8_t *buffer, size_t nbytes);
+static int  sim_sdio_cancel(FAR struct sdio_dev_s *dev);
+static int  sim_sdio_waitresponse(FAR struct sdio_dev_s *dev,
+              uint32_t cmd);
+static int  sim_sdio_recvshort(FAR struct sdio_dev_s *dev, uint32_t cmd,
+              FAR uint32_t *rshort);
+static int  sim_sdio_recvlong(FAR struct sdio_dev_s *dev, uint32_t cmd,
+              uint32_t rlong[4]);
+
+/* Event/Callback support */
+
+static void sim_sdio_waitenable(FAR struct sdio_dev_s *dev,
+              sdio_eventset_t eventset, uint32_t timeout);
+static sdio_eventset_t sim_sdio_eventwait(FAR struct sdio_dev_s *dev);
+static void sim_sdio_callbackenable(FAR struct sdio_dev_s *dev,
+              sdio_eventset_t eventset);
+#if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_HPWORK)
+static int  sim_sdio_registercallback(FAR struct sdio_dev_s *dev,
+              worker_t callback, FAR void *arg);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct sim_sdio_s g_sim_sdio =
+{
+  .dev =
+  {
+#ifdef CONFIG_SDIO_MUXBUS
+    .lock             = sim_sdio_lock,
+#endif
+    .reset            = sim_sdio_reset,
+    .capabilities     = sim_sdio_capabilities,
+    .status           = sim_sdio_status,
+    .widebus          = sim_sdio_widebus,
+    .clock            = sim_sdio_clock,
+    .attach           = sim_sdio_attach,
+    .sendcmd          = sim_sdio_sendcmd,
+#ifdef CONFIG_SDIO_BLOCKSETUP
+    .blocksetup       = sim_sdio_blocksetup,
+#endif
+    .recvsetup        = sim_sdio_recvsetup,
+    .sendsetup        = sim_sdio_sendsetup,
+    .cancel           = sim_sdio_cancel,
+    .waitresponse     = sim_sdio_waitresponse,
+    .recv_r1          = sim_sdio_recvshort,
+    .recv_r2          = sim_sdio_recvlong,
+    .recv_r3          = sim_sdio_recvshort,
+    .recv_r4          = sim_sdio_recvshort,
+    .recv_r5          = sim_sdio_recvshort,
+    .recv_r6          = sim_sdio_recvshort,
+    .recv_r7          = sim_sdio_recvshort,
+    .waitenable       = sim_sdio_waitenable,
+    .eventwait        = sim_sdio_eventwait,
+    .callbackenable   = sim_sdio_callbackenable,
+#if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_HPWORK)
+    .registercallback = sim_sdio_registercallback,
+#endif
+#ifdef CONFIG_SDIO_DMA
+#ifdef CONFIG_ARCH_HAVE_SDIO_PREFLIGHT
+    .dmapreflight     = NULL,
+#endif
+    .dmarecvsetup     = sim_sdio_recvsetup,
+    .dmasendsetup     = sim_sdio_sendsetup,
+#endif
+  },
+  .fd                 = -1,
+};
+
+/* SD Configuration Register as transferred by ACMD51: SCR version 1.0,
+ * SD version 2.00, 1-bit and 4-bit bus widths.
+ */
+
+static const uint8_t g_sim_sdio_scr[8] =
+{
+  0x02, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_sdio_lock
+ *
+ * Description:
+ *   The simulated bus is not shared with other devices.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SDIO_MUXBUS
+static int sim_sdio_lock(FAR struct sdio_dev_s *dev, bool lock)
+{
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: sim_sdio_reset
+ *
+ * Description:
+ *   Reset the simulated card to the idle state.
+ *
+ ****************************************************************************/
+
+static void sim_sdio_reset(FAR struct sdio_dev_s *dev)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  priv->state   = SIM_STATE_IDLE;
+  priv->appcmd  = false;
+  priv->xfercmd = 0;
+  priv->buffer  = NULL;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_capabilities
+ ****************************************************************************/
+
+static sdio_capset_t sim_sdio_capabilities(FAR struct sdio_dev_s *dev)
+{
+  return SDIO_CAPS_4BIT;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_status
+ *
+ * Description:
+ *   The card is present as long as its host file is open.
+ *
+ ****************************************************************************/
+
+static sdio_statset_t sim_sdio_status(FAR struct sdio_dev_s *dev)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  return priv->fd >= 0 ? SDIO_STATUS_PRESENT : 0;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_widebus
+ ****************************************************************************/
+
+static void sim_sdio_widebus(FAR struct sdio_dev_s *dev, bool enable)
+{
+}
+
+/****************************************************************************
+ * Name: sim_sdio_clock
+ ****************************************************************************/
+
+static void sim_sdio_clock(FAR struct sdio_dev_s *dev,
+                           enum sdio_clock_e rate)
+{
+}
+
+/****************************************************************************
+ * Name: sim_sdio_attach
+ ****************************************************************************/
+
+static int sim_sdio_attach(FAR struct sdio_dev_s *dev)
+{
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_sendcmd
+ *
+ * Description:
+ *   Execute a command on the simulated card and prepare its response.
+ *   Data commands only record the transfer, the data is moved when
+ *   sim_sdio_eventwait() is called.  Commands that are not supported
+ *   (including all MMC-only commands) time out.
+ *
+ ****************************************************************************/
+
+static int sim_sdio_sendcmd(FAR struct sdio_dev_s *dev, uint32_t cmd,
+                            uint32_t arg)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+  uint32_t r1;
+  bool appcmd;
+
+  /* The R1 status reports the state when the command was received */
+
+  r1              = SIM_R1_STATE(priv->state) | SIM_R1_READYFORDATA;
+  appcmd          = priv->appcmd;
+  priv->appcmd    = false;
+  priv->cmdresult = OK;
+  memset(priv->response, 0, sizeof(priv->response));
+
+  if (appcmd)
+    {
+      r1 |= SIM_R1_APPCMD;
+
+      switch (cmd & MMCSD_CMDIDX_MASK)
+        {
+          case SD_ACMDIDX41: /* SD_SEND_OP_COND */
+            priv->response[0] = SIM_OCR_READY | SIM_OCR_CCS |
+                                SIM_OCR_VOLTAGES;
+            priv->state       = SIM_STATE_READY;
+            break;
+
+          case SD_ACMDIDX51: /* SEND_SCR */
+            priv->xfercmd     = SD_ACMDIDX51;
+            priv->response[0] = r1;
+            break;
+
+          case SD_ACMDIDX6:  /* SET_BUS_WIDTH */
+          case SD_ACMDIDX23: /* SET_WR_BLK_ERASE_COUNT */
+          case SD_ACMDIDX42: /* SET_CLR_CARD_DETECT */
+            priv->response[0] = r1;
+            break;
+
+          default:
+            priv->cmdresult = -ETIMEDOUT;
+            break;
+        }
+
+      return OK;
+    }
+
+  switch (cmd & MMCSD_CMDIDX_MASK)
+    {
+      case MMCSD_CMDIDX0:  /* GO_IDLE_STATE */
+        sim_sdio_reset(dev);
+        break;
+
+      case MMCSD_CMDIDX2:  /* ALL_SEND_CID */
+
+        /* MID, OID "NX", PNM "SIMSD", PRV 1.0, PSN 1 */
+
+        priv->response[0] = 0x004e5853;
+        priv->response[1] = 0x494d5344;
+        priv->response[2] = 0x10000000;
+        priv->response[3] = 0x01000000;
+        priv->state       = SIM_STATE_IDENT;
+        break;
+
+      case SD_CMDIDX3:     /* SEND_RELATIVE_ADDR */
+        priv->response[0] = ((uint32_t)SIM_SDIO_RCA << 16) |
+                            (r1 & 0x1fff);
+        priv->state       = SIM_STATE_STBY;
+        break;
+
+      case MMCSD_CMDIDX7:  /* SELECT/DESELECT_CARD */
+        priv->response[0] = r1;
+        priv->state       = (arg >> 16) == SIM_SDIO_RCA ?
+                            SIM_STATE_TRAN : SIM_STATE_STBY;
+        break;
+
+      case MMCSD_CMDIDX8:  /* SEND_IF_COND */
+        priv->response[0] = arg & 0xfff;
+        break;
+
+      case MMCSD_CMDIDX9:  /* SEND_CSD */
+        {
+          /* CSD version 2.0, C_SIZE in units of 512KiB */
+
+          uint32_t csize = (SIM_SDIO_NBLOCKS >> 10) - 1;
+
+          priv->response[0] = 0x400e0032;
+          priv->response[1] = 0x5b590000 | ((csize >> 16) & 0x3f);
+          priv->response[2] = ((csize & 0xffff) << 16) | 0x7f80;
+          priv->response[3] = 0x0a400001;
+        }
+        break;
+
+      case MMCSD_CMDIDX12: /* STOP_TRANSMISSION */
+      case MMCSD_CMDIDX13: /* SEND_STATUS */
+      case MMCSD_CMDIDX16: /* SET_BLOCKLEN */
+        priv->response[0] = r1;
+        break;
+
+      case MMCSD_CMDIDX17: /* READ_SINGLE_BLOCK */
+      case MMCSD_CMDIDX18: /* READ_MULTIPLE_BLOCK */
+      case MMCSD_CMDIDX24: /* WRITE_BLOCK */
+      case MMCSD_CMDIDX25: /* WRITE_MULTIPLE_BLOCK */
+        priv->xfercmd     = cmd & MMCSD_CMDIDX_MASK;
+        priv->xferblock   = arg;
+        priv->response[0] = r1;
+        break;
+
+      case SD_CMDIDX55:    /* APP_CMD */
+        priv->response[0] = r1 | SIM_R1_APPCMD;
+        priv->appcmd      = true;
+        break;
+
+      default:
+        priv->cmdresult   = -ETIMEDOUT;
+        break;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_blocksetup
+ ****************************************************************************/
+
+#ifdef CONFIG_SDIO_BLOCKSETUP
+static void sim_sdio_blocksetup(FAR struct sdio_dev_s *dev,
+                                unsigned int blocklen, unsigned int nblocks)
+{
+}
+#endif
+
+/****************************************************************************
+ * Name: sim_sdio_recvsetup
+ ****************************************************************************/
+
+static int sim_sdio_recvsetup(FAR struct sdio_dev_s *dev,
+                              FAR uint8_t *buffer, size_t nbytes)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  priv->buffer = buffer;
+  priv->nbytes = nbytes;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_sendsetup
+ ****************************************************************************/
+
+static int sim_sdio_sendsetup(FAR struct sdio_dev_s *dev,
+                              FAR const uint8_t *buffer, size_t nbytes)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  priv->buffer = (FAR uint8_t *)buffer;
+  priv->nbytes = nbytes;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_cancel
+ ****************************************************************************/
+
+static int sim_sdio_cancel(FAR struct sdio_dev_s *dev)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  priv->xfercmd = 0;
+  priv->buffer  = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_waitresponse
+ ****************************************************************************/
+
+static int sim_sdio_waitresponse(FAR struct sdio_dev_s *dev, uint32_t cmd)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  return priv->cmdresult;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_recvshort
+ ****************************************************************************/
+
+static int sim_sdio_recvshort(FAR struct sdio_dev_s *dev, uint32_t cmd,
+                              FAR uint32_t *rshort)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  if (priv->cmdresult == OK && rshort != NULL)
+    {
+      *rshort = priv->response[0];
+    }
+
+  return priv->cmdresult;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_recvlong
+ ****************************************************************************/
+
+static int sim_sdio_recvlong(FAR struct sdio_dev_s *dev, uint32_t cmd,
+                             uint32_t rlong[4])
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+
+  if (priv->cmdresult == OK && rlong != NULL)
+    {
+      memcpy(rlong, priv->response, sizeof(priv->response));
+    }
+
+  return priv->cmdresult;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_waitenable
+ ****************************************************************************/
+
+static void sim_sdio_waitenable(FAR struct sdio_dev_s *dev,
+                                sdio_eventset_t eventset, uint32_t timeout)
+{
+}
+
+/****************************************************************************
+ * Name: sim_sdio_eventwait
+ *
+ * Description:
+ *   Move the data of the pending transfer between the buffer and the host
+ *   file.  The configured access and transfer times are spent sleeping, so
+ *   that other threads can queue requests while the "bus" is busy.
+ *
+ ****************************************************************************/
+
+static sdio_eventset_t sim_sdio_eventwait(FAR struct sdio_dev_s *dev)
+{
+  FAR struct sim_sdio_s *priv = (FAR struct sim_sdio_s *)dev;
+  sdio_eventset_t events = SDIOWAIT_TRANSFERDONE;
+  uint32_t nblocks;
+  ssize_t nxfer;
+  off_t pos;
+  useconds_t delay;
+
+  if (priv->xfercmd == 0 || priv->buffer == NULL)
+    {
+      return SDIOWAIT_ERROR;
+    }
+
+  if (priv->xfercmd == SD_ACMDIDX51)
+    {
+      memcpy(priv->buffer, g_sim_sdio_scr,
+             priv->nbytes < 8 ? priv->nbytes : 8);
+      priv->xfercmd = 0;
+      priv->buffer  = NULL;
+      return events;
+    }
+
+  nblocks = priv->nbytes >> SIM_SDIO_BLOCKSHIFT;
+  if (nblocks == 0 || priv->xferblock >= SIM_SDIO_NBLOCKS ||
+      nblocks > SIM_SDIO_NBLOCKS - priv->xferblock)
+    {
+      events = SDIOWAIT_ERROR;
+      goto out;
+    }
+
+  delay = CONFIG_SIM_SDIO_CMDDELAY + nblocks * CONFIG_SIM_SDIO_BLOCKDELAY;
+  if (delay > 0)
+    {
+      nxsig_usleep(delay);
+    }
+
+  pos = (off_t)priv->xferblock << SIM_SDIO_BLOCKSHIFT;
+  if (host_lseek(priv->fd, pos, SEEK_SET) != pos)
+    {
+      events = SDIOWAIT_ERROR;
+      goto out;
+    }
+
+  if (priv->xfercmd == MMCSD_CMDIDX17 || priv->xfercmd == MMCSD_CMDIDX18)
+    {
+      nxfer = host_read(priv->fd, priv->buffer, priv->nbytes);
+    }
+  else
+    {
+      nxfer = host_write(priv->fd, priv->buffer, priv->nbytes);
+    }
+
+  if (nxfer != priv->nbytes)
+    {
+      ferr("ERROR: Host file transfer failed: %zd\n", nxfer);
+      events = SDIOWAIT_ERROR;
+    }
+
+out:
+  priv->xfercmd = 0;
+  priv->buffer  = NULL;
+  return events;
+}
+
+/****************************************************************************
+ * Name: sim_sdio_callbackenable
+ ****************************************************************************/
+
+static void sim_sdio_callbackenable(FAR struct sdio_dev_s *dev,
+                                    sdio_eventset_t eventset)
+{
+}
+
+/****************************************************************************
+ * Name: sim_sdio_registercallback
+ *
+ * Description:
+ *   The simulated card is never removed, so media change callbacks are
+ *   never made.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_HPWORK)
+static int sim_sdio_registercallback(FAR struct sdio_dev_s *dev,
+                                     worker_t callback, FAR void *arg)
+{
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_sdio_initialize
+ *
+ * Description:
+ *   Open (and if needed create or extend) the host file that holds the
+ *   contents of the simulated SD card and return the SDIO interface that
+ *   drives the card.  The result is intended to be passed to
+ *   mmcsd_slotinitialize().
+ *
+ ****************************************************************************/
+
+FAR struct sdio_dev_s *sim_sdio_initialize(void)
+{
+  FAR struct sim_sdio_s *priv = &g_sim_sdio;
+  off_t size = (off_t)SIM_SDIO_NBLOCKS << SIM_SDIO_BLOCKSHIFT;
+  off_t end;
+  int ret;
+
+  if (priv->fd < 0)
+    {
+      priv->fd = host_open(CONFIG_SIM_SDIO_PATH, O_RDWR | O_CREAT, 0644);
+      if (priv->fd < 0)
+        {
+          ferr("ERROR: Failed to open %s: %d\n",
+               CONFIG_SIM_SDIO_PATH, priv->fd);
+          return NULL;
+        }
+
+      end = host_lseek(priv->fd, 0, SEEK_END);
+      if (end >= 0 && end < size)
+        {
+          ret = host_ftruncate(priv->fd, size);
+          if (ret < 0)
+            {
+              ferr("ERROR: Failed to size %s: %d\n",
+                   CONFIG_SIM_SDIO_PATH, ret);
+              host_close(priv->fd);
+              priv->fd = -1;
+              return NULL;
+            }
+        }
+    }
+
+  sim_sdio_reset(&priv->dev);
+  return &priv->dev;
+}
@@ -152,6 +152,30 @@ int simuart_getc(int fd)
   return ret < 0 ? ret : ch;
 }
 
+/****************************************************************************
+ * Name: simuart_write
+ ****************************************************************************/
+
+int simuart_write(int fd, const char *buf, size_t len)
+{
+  int ret;
+
+  ret = write(fd, buf, len);
+  return ret < 0 ? -errno : ret;
+}
+
+/****************************************************************************
+ * Name: simuart_read
+ ****************************************************************************/
+
+int simuart_read(int fd, char *buf, size_t len)
+{
+  int ret;
+
+  ret = read(fd, buf, len);
+  return ret < 0 ? -errno : ret;
+}
+
 /****************************************************************************
  * Name: simuart_getcflag
  ****************************************************************************/
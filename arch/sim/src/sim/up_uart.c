@@ -72,6 +72,10 @@ static void tty_send(FAR struct uart_dev_s *dev, int ch);
 static void tty_txint(FAR struct uart_dev_s *dev, bool enable);
 static bool tty_txready(FAR struct uart_dev_s *dev);
 static bool tty_txempty(FAR struct uart_dev_s *dev);
+static ssize_t tty_sendbuf(FAR struct uart_dev_s *dev,
+                           FAR const char *buffer, size_t len);
+static ssize_t tty_recvbuf(FAR struct uart_dev_s *dev,
+                           FAR char *buffer, size_t len);
 
 /****************************************************************************
  * Private Data
@@ -92,6 +96,8 @@ static const struct uart_ops_s g_tty_ops =
   .txint          = tty_txint,
   .txready        = tty_txready,
   .txempty        = tty_txempty,
+  .sendbuf        = tty_sendbuf,
+  .recvbuf        = tty_recvbuf,
 };
 #endif
 
@@ -488,6 +494,85 @@ static bool tty_txempty(struct uart_dev_s *dev)
 {
   return true;
 }
+
+/****************************************************************************
+ * Name: tty_sendbuf
+ *
+ * Description:
+ *   Send a run of bytes with one host write() rather than one per byte.
+ *
+ ****************************************************************************/
+
+static ssize_t tty_sendbuf(FAR struct uart_dev_s *dev,
+                           FAR const char *buffer, size_t len)
+{
+  FAR struct tty_priv_s *priv = dev->priv;
+  size_t nsent = 0;
+  size_t n;
+  int ret = 0;
+
+  if (!dev->isconsole)
+    {
+      return simuart_write(priv->fd, buffer, len);
+    }
+
+  /* The console expands \n to \r\n */
+
+  while (nsent < len)
+    {
+      for (n = 0; nsent + n < len && buffer[nsent + n] != '\n'; n++);
+
+      if (n == 0)
+        {
+          ret = simuart_write(1, "\r\n", 2);
+          if (ret != 2)
+            {
+              break;
+            }
+
+          nsent++;
+        }
+      else
+        {
+          ret = simuart_write(1, &buffer[nsent], n);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          nsent += ret;
+          if ((size_t)ret < n)
+            {
+              break;
+            }
+        }
+    }
+
+  return nsent > 0 ? nsent : ret;
+}
+
+/****************************************************************************
+ * Name: tty_recvbuf
+ *
+ * Description:
+ *   Move whatever the host has received, up to len bytes, with one
+ *   host read().
+ *
+ ****************************************************************************/
+
+static ssize_t tty_recvbuf(FAR struct uart_dev_s *dev,
+                           FAR char *buffer, size_t len)
+{
+  FAR struct tty_priv_s *priv = dev->priv;
+  int fd = dev->isconsole ? 0 : priv->fd;
+
+  if (!simuart_checkc(fd))
+    {
+      return 0;
+    }
+
+  return simuart_read(fd, buffer, len);
+}
 #endif
 
 /****************************************************************************
@@ -31,6 +31,7 @@
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/syslog/syslog.h>
 #include <nuttx/binfmt/binfmt.h>
 
 #include "binfmt.h"
@@ -150,6 +151,14 @@ int unload_module(FAR struct binary_s *binp)
         }
 #endif
 
+#ifdef CONFIG_SYSLOG_DEFERRED
+      /* Format any deferred syslog records that may still reference format
+       * strings in the program text.
+       */
+
+      syslog_flush();
+#endif
+
       /* Unmap mapped address spaces */
 
       if (binp->mapped)
@@ -31,6 +31,7 @@
 #include <nuttx/board.h>
 #include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mmcsd.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/nxffs.h>
@@ -98,6 +99,9 @@ int sim_bringup(void)
 #ifdef CONFIG_SIM_I2CBUS
   FAR struct i2c_master_s *i2cbus;
 #endif
+#ifdef CONFIG_SIM_SDIO
+  FAR struct sdio_dev_s *sdio;
+#endif
 #ifdef CONFIG_MPU60X0_I2C
   FAR struct mpu_config_s *mpu_config;
 #endif
@@ -369,6 +373,24 @@ int sim_bringup(void)
     }
 #endif
 
+#ifdef CONFIG_SIM_SDIO
+  /* Register the simulated SD card as /dev/mmcsd0 */
+
+  sdio = sim_sdio_initialize();
+  if (sdio == NULL)
+    {
+      syslog(LOG_ERR, "ERROR: sim_sdio_initialize failed.\n");
+    }
+  else
+    {
+      ret = mmcsd_slotinitialize(0, sdio);
+      if (ret < 0)
+        {
+          syslog(LOG_ERR, "ERROR: mmcsd_slotinitialize failed: %d\n", ret);
+        }
+    }
+#endif
+
 #ifdef CONFIG_SIM_I2CBUS
   /* Initialize the i2c master bus device */
 
@@ -31,8 +31,11 @@
 #include <errno.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
 #include <nuttx/drivers/drivers.h>
 
+#include <nuttx/crypto/aes.h>
 #include <nuttx/crypto/crypto.h>
 #include <nuttx/crypto/cryptodev.h>
 
@@ -46,12 +49,45 @@
              mode, encrypt)
 #endif
 
+#if defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES)
+#  define HAVE_CRYPTODEV_AES 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One session:  The cipher and its key, already expanded for the software
+ * library so that it is not expanded again for every operation.
+ */
+
+struct cryptodev_session_s
+{
+  uint32_t cipher;                 /* CRYPTO_AES_* */
+  uint32_t keylen;
+  uint8_t key[AES256_KEY_SIZE];    /* For the hardware aes_cypher() */
+#ifdef CONFIG_CRYPTO_SW_AES
+  struct aes_gcm_s ctx;            /* Expanded key (and GHASH table) */
+#endif
+};
+
+/* The state of one open /dev/crypto */
+
+struct cryptodev_file_s
+{
+  sem_t lock;
+  FAR struct cryptodev_session_s *
+    sessions[CONFIG_CRYPTO_CRYPTODEV_NSESSIONS];
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
 /* Character driver methods */
 
+static int cryptodev_open(FAR struct file *filep);
+static int cryptodev_close(FAR struct file *filep);
 static ssize_t cryptodev_read(FAR struct file *filep,
                               FAR char *buffer,
                               size_t len);
@@ -68,8 +104,8 @@ static int cryptodev_ioctl(FAR struct file *filep,
 
 static const struct file_operations g_cryptodevops =
 {
-  NULL,               /* open   */
-  NULL,               /* close  */
+  cryptodev_open,     /* open   */
+  cryptodev_close,    /* close  */
   cryptodev_read,     /* read   */
   cryptodev_write,    /* write  */
   NULL,               /* seek   */
@@ -84,6 +120,297 @@ static const struct file_operations g_cryptodevops =
  * Private Functions
  ****************************************************************************/
 
+static void cryptodev_freesession(FAR struct cryptodev_session_s *ses)
+{
+  explicit_bzero(ses, sizeof(struct cryptodev_session_s));
+  kmm_free(ses);
+}
+
+static FAR struct cryptodev_session_s *
+cryptodev_getsession(FAR struct cryptodev_file_s *priv, uint32_t id)
+{
+  if (id == 0 || id > CONFIG_CRYPTO_CRYPTODEV_NSESSIONS)
+    {
+      return NULL;
+    }
+
+  return priv->sessions[id - 1];
+}
+
+/****************************************************************************
+ * Name: cryptodev_newsession
+ *
+ * Description:
+ *   Handle CIOCGSESSION:  Check the cipher and the key, set up the key and
+ *   return the number of the new session in sop->ses.
+ *
+ ****************************************************************************/
+
+static int cryptodev_newsession(FAR struct cryptodev_file_s *priv,
+                                FAR struct session_op *sop)
+{
+  FAR struct cryptodev_session_s *ses;
+  int ret = OK;
+  int i;
+
+  switch (sop->cipher)
+    {
+#ifdef HAVE_CRYPTODEV_AES
+      case CRYPTO_AES_ECB:
+      case CRYPTO_AES_CBC:
+      case CRYPTO_AES_CTR:
+        break;
+#endif
+
+#ifdef CONFIG_CRYPTO_SW_AES
+      case CRYPTO_AES_GCM:
+        break;
+#endif
+
+      default:
+        return -EINVAL;
+    }
+
+  if (sop->keylen != AES128_KEY_SIZE && sop->keylen != AES192_KEY_SIZE &&
+      sop->keylen != AES256_KEY_SIZE)
+    {
+      return -EINVAL;
+    }
+
+  for (i = 0; i < CONFIG_CRYPTO_CRYPTODEV_NSESSIONS; i++)
+    {
+      if (priv->sessions[i] == NULL)
+        {
+          break;
+        }
+    }
+
+  if (i >= CONFIG_CRYPTO_CRYPTODEV_NSESSIONS)
+    {
+      return -ENOSPC;
+    }
+
+  ses = kmm_zalloc(sizeof(struct cryptodev_session_s));
+  if (ses == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ses->cipher = sop->cipher;
+  ses->keylen = sop->keylen;
+  memcpy(ses->key, sop->key, sop->keylen);
+
+#ifdef CONFIG_CRYPTO_SW_AES
+  if (ses->cipher == CRYPTO_AES_GCM)
+    {
+      ret = aes_gcm_setupkey(&ses->ctx, ses->key, ses->keylen);
+    }
+  else
+    {
+      ret = aes_setupkey(&ses->ctx.aes, ses->key, ses->keylen);
+    }
+#endif
+
+  if (ret < 0)
+    {
+      cryptodev_freesession(ses);
+      return ret;
+    }
+
+  priv->sessions[i] = ses;
+  sop->ses          = i + 1;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: cryptodev_crypt
+ *
+ * Description:
+ *   Handle CIOCCRYPT for the unauthenticated modes.  AES hardware is used
+ *   when there is one, the software library otherwise.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_CRYPTODEV_AES
+static int cryptodev_crypt(FAR struct cryptodev_session_s *ses,
+                           FAR struct crypt_op *op)
+{
+  int encrypt;
+#ifndef CONFIG_CRYPTO_AES
+  uint8_t iv[AES_BLOCK_SIZE];
+  int ret;
+#endif
+
+  switch (op->op)
+    {
+    case COP_ENCRYPT:
+      encrypt = 1;
+      break;
+
+    case COP_DECRYPT:
+      encrypt = 0;
+      break;
+
+    default:
+      return -EINVAL;
+    }
+
+#ifdef CONFIG_CRYPTO_AES
+  switch (ses->cipher)
+    {
+    case CRYPTO_AES_ECB:
+      return AES_CYPHER(AES_MODE_ECB);
+
+    case CRYPTO_AES_CBC:
+      return AES_CYPHER(AES_MODE_CBC);
+
+    case CRYPTO_AES_CTR:
+      return AES_CYPHER(AES_MODE_CTR);
+
+    default:
+      return -EINVAL;
+    }
+#else
+  if (ses->cipher != CRYPTO_AES_CTR && (op->len % AES_BLOCK_SIZE) != 0)
+    {
+      return -EINVAL;
+    }
+
+  if (ses->cipher != CRYPTO_AES_ECB)
+    {
+      if (op->iv == NULL)
+        {
+          return -EINVAL;
+        }
+
+      memcpy(iv, op->iv, AES_BLOCK_SIZE);
+    }
+
+  switch (ses->cipher)
+    {
+    case CRYPTO_AES_ECB:
+      memmove(op->dst, op->src, op->len);
+      if (encrypt)
+        {
+          aes_encipher(&ses->ctx.aes, (FAR uint8_t *)op->dst,
+                       op->len / AES_BLOCK_SIZE);
+        }
+      else
+        {
+          aes_decipher(&ses->ctx.aes, (FAR uint8_t *)op->dst,
+                       op->len / AES_BLOCK_SIZE);
+        }
+
+      ret = OK;
+      break;
+
+    case CRYPTO_AES_CBC:
+      if (encrypt)
+        {
+          ret = aes_cbc_encrypt(&ses->ctx.aes, iv, (FAR uint8_t *)op->dst,
+                                (FAR const uint8_t *)op->src, op->len);
+        }
+      else
+        {
+          ret = aes_cbc_decrypt(&ses->ctx.aes, iv, (FAR uint8_t *)op->dst,
+                                (FAR const uint8_t *)op->src, op->len);
+        }
+      break;
+
+    case CRYPTO_AES_CTR:
+      aes_ctr_crypt(&ses->ctx.aes, iv, (FAR uint8_t *)op->dst,
+                    (FAR const uint8_t *)op->src, op->len);
+      ret = OK;
+      break;
+
+    default:
+      ret = -EINVAL;
+      break;
+    }
+
+  return ret;
+#endif
+}
+#endif /* HAVE_CRYPTODEV_AES */
+
+/****************************************************************************
+ * Name: cryptodev_authcrypt
+ *
+ * Description:
+ *   Handle CIOCAUTHCRYPT.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CRYPTO_SW_AES
+static int cryptodev_authcrypt(FAR struct cryptodev_session_s *ses,
+                               FAR struct crypt_auth_op *op)
+{
+  size_t taglen;
+
+  if (ses->cipher != CRYPTO_AES_GCM)
+    {
+      return -EINVAL;
+    }
+
+  taglen = op->tag_len != 0 ? op->tag_len : AES_GCM_TAG_SIZE;
+
+  switch (op->op)
+    {
+    case COP_ENCRYPT:
+      return aes_gcm_encrypt(&ses->ctx,
+                             (FAR const uint8_t *)op->iv, op->iv_len,
+                             (FAR const uint8_t *)op->auth_src,
+                             op->auth_len, (FAR uint8_t *)op->dst,
+                             (FAR const uint8_t *)op->src, op->len,
+                             (FAR uint8_t *)op->tag, taglen);
+
+    case COP_DECRYPT:
+      return aes_gcm_decrypt(&ses->ctx,
+                             (FAR const uint8_t *)op->iv, op->iv_len,
+                             (FAR const uint8_t *)op->auth_src,
+                             op->auth_len, (FAR uint8_t *)op->dst,
+                             (FAR const uint8_t *)op->src, op->len,
+                             (FAR const uint8_t *)op->tag, taglen);
+
+    default:
+      return -EINVAL;
+    }
+}
+#endif /* CONFIG_CRYPTO_SW_AES */
+
+static int cryptodev_open(FAR struct file *filep)
+{
+  FAR struct cryptodev_file_s *priv;
+
+  priv = kmm_zalloc(sizeof(struct cryptodev_file_s));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nxsem_init(&priv->lock, 0, 1);
+  filep->f_priv = priv;
+  return OK;
+}
+
+static int cryptodev_close(FAR struct file *filep)
+{
+  FAR struct cryptodev_file_s *priv = filep->f_priv;
+  int i;
+
+  for (i = 0; i < CONFIG_CRYPTO_CRYPTODEV_NSESSIONS; i++)
+    {
+      if (priv->sessions[i] != NULL)
+        {
+          cryptodev_freesession(priv->sessions[i]);
+        }
+    }
+
+  nxsem_destroy(&priv->lock);
+  kmm_free(priv);
+  return OK;
+}
+
 static ssize_t cryptodev_read(FAR struct file *filep,
                               FAR char *buffer,
                               size_t len)
@@ -102,61 +429,69 @@ static int cryptodev_ioctl(FAR struct file *filep,
                            int cmd,
                            unsigned long arg)
 {
+  FAR struct cryptodev_file_s *priv = filep->f_priv;
+  FAR struct cryptodev_session_s *ses;
+  int ret;
+
+  ret = nxsem_wait_uninterruptible(&priv->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
   switch (cmd)
   {
   case CIOCGSESSION:
     {
-      FAR struct session_op *ses = (FAR struct session_op *)arg;
-      ses->ses = (uint32_t)ses;
-      return OK;
+      ret = cryptodev_newsession(priv, (FAR struct session_op *)arg);
+      break;
     }
 
   case CIOCFSESSION:
     {
-      return OK;
-    }
-
-#ifdef CONFIG_CRYPTO_AES
-  case CIOCCRYPT:
-    {
-      FAR struct crypt_op *op    = (FAR struct crypt_op *)arg;
-      FAR struct session_op *ses = (FAR struct session_op *)op->ses;
-      int encrypt;
+      uint32_t id = *(FAR uint32_t *)arg;
 
-      switch (op->op)
+      ses = cryptodev_getsession(priv, id);
+      if (ses == NULL)
         {
-        case COP_ENCRYPT:
-          encrypt = 1;
-          break;
-
-        case COP_DECRYPT:
-          encrypt = 0;
+          ret = -EINVAL;
           break;
-
-        default:
-          return -EINVAL;
         }
 
-      switch (ses->cipher)
-        {
-        case CRYPTO_AES_ECB:
-          return AES_CYPHER(AES_MODE_ECB);
+      priv->sessions[id - 1] = NULL;
+      cryptodev_freesession(ses);
+      break;
+    }
+
+#ifdef HAVE_CRYPTODEV_AES
+  case CIOCCRYPT:
+    {
+      FAR struct crypt_op *op = (FAR struct crypt_op *)arg;
 
-        case CRYPTO_AES_CBC:
-          return AES_CYPHER(AES_MODE_CBC);
+      ses = cryptodev_getsession(priv, op->ses);
+      ret = ses != NULL ? cryptodev_crypt(ses, op) : -EINVAL;
+      break;
+    }
+#endif
 
-        case CRYPTO_AES_CTR:
-          return AES_CYPHER(AES_MODE_CTR);
+#ifdef CONFIG_CRYPTO_SW_AES
+  case CIOCAUTHCRYPT:
+    {
+      FAR struct crypt_auth_op *op = (FAR struct crypt_auth_op *)arg;
 
-        default:
-           return -EINVAL;
-        }
+      ses = cryptodev_getsession(priv, op->ses);
+      ret = ses != NULL ? cryptodev_authcrypt(ses, op) : -EINVAL;
+      break;
     }
 #endif
 
   default:
-    return -ENOTTY;
+    ret = -ENOTTY;
+    break;
   }
+
+  nxsem_post(&priv->lock);
+  return ret;
 }
 
 /****************************************************************************
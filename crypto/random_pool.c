@@ -49,6 +49,7 @@
 #include <errno.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/irq.h>
 #include <nuttx/random.h>
 #include <nuttx/board.h>
 
@@ -65,6 +66,36 @@
 #define ROTL_32(x,n) ( ((x) << (n)) | ((x) >> (32-(n))) )
 #define ROTR_32(x,n) ( ((x) >> (n)) | ((x) << (32-(n))) )
 
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+/* ChaCha20 output generator:  each refill produces RNG_CHACHA_BLOCKS
+ * blocks of keystream, the first RNG_CHACHA_KEYSIZE bytes of which become
+ * the next key.  The generator takes a new key from the BLAKE2Xs generator
+ * after RNG_CHACHA_REKEY bytes of output.
+ */
+
+#  define RNG_CHACHA_KEYSIZE   32
+#  define RNG_CHACHA_BLOCKSIZE 64
+#  define RNG_CHACHA_BLOCKS    8
+#  define RNG_CHACHA_BUFSIZE   (RNG_CHACHA_BLOCKS * RNG_CHACHA_BLOCKSIZE)
+#  define RNG_CHACHA_REKEY     (1024 * 1024)
+
+#  ifdef CONFIG_SMP
+#    define RNG_NCPUS          CONFIG_SMP_NCPUS
+#  else
+#    define RNG_NCPUS          1
+#  endif
+
+#  define CHACHA_QROUND(x,a,b,c,d) \
+  do \
+    { \
+      x[a] += x[b]; x[d] = ROTL_32(x[d] ^ x[a], 16); \
+      x[c] += x[d]; x[b] = ROTL_32(x[b] ^ x[c], 12); \
+      x[a] += x[b]; x[d] = ROTL_32(x[d] ^ x[a], 8); \
+      x[c] += x[d]; x[b] = ROTL_32(x[b] ^ x[c], 7); \
+    } \
+  while (0)
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -90,9 +121,27 @@ struct rng_s
   volatile uint8_t rd_prev_time;
   volatile uint16_t rd_prev_irq;
   bool output_initialized;
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+  volatile uint32_t rd_seq;  /* Incremented on each reseed, never zero */
+#endif
   struct blake2xs_rng_s blake2xs;
 };
 
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+/* Per-CPU ChaCha20 generator.  It is only used with local interrupts
+ * disabled, so it needs no lock.
+ */
+
+struct rng_chacha_s
+{
+  uint32_t seq;                         /* g_rng.rd_seq when keyed */
+  uint32_t nout;                        /* Bytes output since keyed */
+  uint32_t key[RNG_CHACHA_KEYSIZE / 4]; /* Key of the next refill */
+  uint16_t avail;                       /* Bytes left at the end of buf */
+  uint8_t buf[RNG_CHACHA_BUFSIZE];      /* Unused keystream */
+};
+#endif
+
 enum
 {
   POOL_SIZE = ENTROPY_POOL_SIZE,
@@ -108,6 +157,10 @@ enum
 
 static struct rng_s g_rng;
 
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+static struct rng_chacha_s g_rng_chacha[RNG_NCPUS];
+#endif
+
 #ifdef CONFIG_BOARD_ENTROPY_POOL
 /* Entropy pool structure can be provided by board source. Use for this is,
  * for example, allocate entropy pool from special area of RAM which content
@@ -321,6 +374,15 @@ static void rng_reseed(void)
   g_rng.blake2xs.param.node_depth = 0;
 
   g_rng.output_initialized = true;
+
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+  /* Make the ChaCha20 generators take new keys */
+
+  if (++g_rng.rd_seq == 0)
+    {
+      g_rng.rd_seq = 1;
+    }
+#endif
 }
 
 static void rng_buf_internal(FAR uint8_t *bytes, size_t nbytes)
@@ -374,6 +436,135 @@ static void rng_buf_internal(FAR uint8_t *bytes, size_t nbytes)
     }
 }
 
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+/****************************************************************************
+ * Name: rng_chacha_blocks
+ *
+ * Description:
+ *   Produce nblocks blocks of ChaCha20 (RFC 8439) keystream for key, with
+ *   an all-zero nonce and the block counter starting at zero.  Every key
+ *   is used for one call only.
+ *
+ ****************************************************************************/
+
+static void rng_chacha_blocks(FAR const uint32_t *key, FAR uint8_t *out,
+                              int nblocks)
+{
+  uint32_t input[16];
+  uint32_t x[16];
+  int i;
+
+  input[0]  = 0x61707865;
+  input[1]  = 0x3320646e;
+  input[2]  = 0x79622d32;
+  input[3]  = 0x6b206574;
+  memcpy(&input[4], key, RNG_CHACHA_KEYSIZE);
+  input[12] = 0;
+  input[13] = 0;
+  input[14] = 0;
+  input[15] = 0;
+
+  for (; nblocks > 0; nblocks--, input[12]++)
+    {
+      memcpy(x, input, sizeof(x));
+
+      for (i = 0; i < 10; i++)
+        {
+          CHACHA_QROUND(x, 0, 4,  8, 12);
+          CHACHA_QROUND(x, 1, 5,  9, 13);
+          CHACHA_QROUND(x, 2, 6, 10, 14);
+          CHACHA_QROUND(x, 3, 7, 11, 15);
+          CHACHA_QROUND(x, 0, 5, 10, 15);
+          CHACHA_QROUND(x, 1, 6, 11, 12);
+          CHACHA_QROUND(x, 2, 7,  8, 13);
+          CHACHA_QROUND(x, 3, 4,  9, 14);
+        }
+
+      for (i = 0; i < 16; i++)
+        {
+          x[i] += input[i];
+
+          *out++ = (uint8_t)x[i];
+          *out++ = (uint8_t)(x[i] >> 8);
+          *out++ = (uint8_t)(x[i] >> 16);
+          *out++ = (uint8_t)(x[i] >> 24);
+        }
+    }
+
+  explicit_bzero(input, sizeof(input));
+  explicit_bzero(x, sizeof(x));
+}
+
+/****************************************************************************
+ * Name: rng_chacha_refill
+ *
+ * Description:
+ *   Refill the keystream buffer, replacing the key with the start of the
+ *   new keystream and erasing it from the buffer ("fast key erasure"):
+ *   nothing left in memory can reproduce output that was already given.
+ *
+ ****************************************************************************/
+
+static void rng_chacha_refill(FAR struct rng_chacha_s *chacha)
+{
+  rng_chacha_blocks(chacha->key, chacha->buf, RNG_CHACHA_BLOCKS);
+
+  memcpy(chacha->key, chacha->buf, RNG_CHACHA_KEYSIZE);
+  explicit_bzero(chacha->buf, RNG_CHACHA_KEYSIZE);
+  chacha->avail = RNG_CHACHA_BUFSIZE - RNG_CHACHA_KEYSIZE;
+}
+
+/****************************************************************************
+ * Name: rng_chacha_rekey
+ *
+ * Description:
+ *   Take a new key for the ChaCha20 generator of the current CPU from the
+ *   BLAKE2Xs generator, which reseeds from the entropy pool as needed.
+ *
+ ****************************************************************************/
+
+static void rng_chacha_rekey(void)
+{
+  FAR struct rng_chacha_s *chacha;
+  uint32_t key[RNG_CHACHA_KEYSIZE / 4];
+  irqstate_t flags;
+  uint32_t seq;
+  int ret;
+  int i;
+
+  do
+    {
+      ret = nxsem_wait_uninterruptible(&g_rng.rd_sem);
+      DEBUGASSERT(ret == OK || ret == -ECANCELED);
+    }
+  while (ret < 0);
+
+  rng_buf_internal((FAR uint8_t *)key, sizeof(key));
+  seq = g_rng.rd_seq;
+  nxsem_post(&g_rng.rd_sem);
+
+  /* The thread may have moved to another CPU meanwhile, which does no
+   * harm:  mix the key into whichever generator it is on now.
+   */
+
+  flags  = up_irq_save();
+  chacha = &g_rng_chacha[up_cpu_index()];
+
+  for (i = 0; i < RNG_CHACHA_KEYSIZE / 4; i++)
+    {
+      chacha->key[i] ^= key[i];
+    }
+
+  explicit_bzero(chacha->buf, sizeof(chacha->buf));
+  chacha->avail = 0;
+  chacha->nout  = 0;
+  chacha->seq   = seq;
+
+  up_irq_restore(flags);
+  explicit_bzero(key, sizeof(key));
+}
+#endif
+
 static void rng_init(void)
 {
   cryptinfo("Initializing RNG\n");
@@ -561,6 +752,55 @@ void up_randompool_initialize(void)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_CRYPTO_RANDOM_POOL_CHACHA20
+void arc4random_buf(FAR void *bytes, size_t nbytes)
+{
+  FAR struct rng_chacha_s *chacha;
+  FAR uint8_t *dest = bytes;
+  irqstate_t flags;
+  size_t ncopy;
+
+  while (nbytes > 0)
+    {
+      /* Use the generator of this CPU.  With local interrupts disabled,
+       * nothing else can use it or move this thread elsewhere.  At most
+       * one refill is done each time round, which bounds the time that
+       * interrupts stay disabled.
+       */
+
+      flags  = up_irq_save();
+      chacha = &g_rng_chacha[up_cpu_index()];
+
+      if (chacha->seq == 0 || chacha->seq != g_rng.rd_seq ||
+          chacha->nout >= RNG_CHACHA_REKEY ||
+          g_rng.rd_newentr >= MAX_SEED_NEW_ENTROPY_WORDS)
+        {
+          up_irq_restore(flags);
+          rng_chacha_rekey();
+          continue;
+        }
+
+      if (chacha->avail == 0)
+        {
+          rng_chacha_refill(chacha);
+        }
+
+      /* Hand out the keystream from the end of the buffer and erase it */
+
+      ncopy = MIN(nbytes, chacha->avail);
+      chacha->avail -= ncopy;
+      chacha->nout  += ncopy;
+
+      memcpy(dest, &chacha->buf[chacha->avail], ncopy);
+      explicit_bzero(&chacha->buf[chacha->avail], ncopy);
+
+      up_irq_restore(flags);
+
+      dest   += ncopy;
+      nbytes -= ncopy;
+    }
+}
+#else
 void arc4random_buf(FAR void *bytes, size_t nbytes)
 {
   int ret;
@@ -581,3 +821,4 @@ void arc4random_buf(FAR void *bytes, size_t nbytes)
   rng_buf_internal(bytes, nbytes);
   nxsem_post(&g_rng.rd_sem);
 }
+#endif
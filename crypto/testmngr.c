@@ -33,6 +33,7 @@
 
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/crypto/aes.h>
 #include <nuttx/crypto/crypto.h>
 
 #ifdef CONFIG_CRYPTO_ALGTEST
@@ -47,12 +48,49 @@
 #  define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #endif
 
-#if defined(CONFIG_CRYPTO_AES)
-
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#if defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES)
+
+#define AES_CYPHER_TEST_ENCRYPT(fn, mode, mode_str, count, template) \
+  for (i = 0; i < count; i++) { \
+    if (fn(template + i, mode, CYPHER_ENCRYPT)) { \
+      crypterr("ERROR: Failed " mode_str " encrypt test #%i\n", i); \
+      return -1; \
+    } \
+  }
+
+#define AES_CYPHER_TEST_DECRYPT(fn, mode, mode_str, count, template) \
+  for (i = 0; i < count; i++) { \
+    if (fn(template + i, mode, CYPHER_DECRYPT)) { \
+      crypterr("ERROR: Failed " mode_str " decrypt test #%i\n", i); \
+      return -1; \
+    } \
+  }
+
+#define AES_CYPHER_TEST(fn, mode, mode_str, enc_count, dec_count, enc_template, dec_template) \
+  AES_CYPHER_TEST_ENCRYPT(fn, mode, mode_str, enc_count, enc_template)\
+  AES_CYPHER_TEST_DECRYPT(fn, mode, mode_str, dec_count, dec_template)
+
+#define AES_CYPHER_TEST_ALL(fn) \
+  AES_CYPHER_TEST(fn, AES_MODE_ECB, "ECB", ARRAY_SIZE(aes_enc_tv_template), \
+                  ARRAY_SIZE(aes_dec_tv_template), aes_enc_tv_template, \
+                  aes_dec_tv_template) \
+  AES_CYPHER_TEST(fn, AES_MODE_CBC, "CBC", \
+                  ARRAY_SIZE(aes_cbc_enc_tv_template), \
+                  ARRAY_SIZE(aes_cbc_dec_tv_template), \
+                  aes_cbc_enc_tv_template, aes_cbc_dec_tv_template) \
+  AES_CYPHER_TEST(fn, AES_MODE_CTR, "CTR", \
+                  ARRAY_SIZE(aes_ctr_enc_tv_template), \
+                  ARRAY_SIZE(aes_ctr_dec_tv_template), \
+                  aes_ctr_enc_tv_template, aes_ctr_dec_tv_template)
+
+#endif
+
+#if defined(CONFIG_CRYPTO_AES)
+
 static int do_test_aes(FAR struct cipher_testvec *test,
                        int mode,
                        int encrypt)
@@ -70,44 +108,173 @@ static int do_test_aes(FAR struct cipher_testvec *test,
   return res;
 }
 
-#define AES_CYPHER_TEST_ENCRYPT(mode, mode_str, count, template) \
-  for (i = 0; i < count; i++) { \
-    if (do_test_aes(template + i, mode, CYPHER_ENCRYPT)) { \
-      crypterr("ERROR: Failed " mode_str " encrypt test #%i\n", i); \
-      return -1; \
-    } \
-  }
+static int test_aes(void)
+{
+  int i;
 
-#define AES_CYPHER_TEST_DECRYPT(mode, mode_str, count, template) \
-  for (i = 0; i < count; i++) { \
-    if (do_test_aes(template + i, mode, CYPHER_DECRYPT)) { \
-      crypterr("ERROR: Failed " mode_str " decrypt test #%i\n", i); \
-      return -1; \
-    } \
-  }
+  AES_CYPHER_TEST_ALL(do_test_aes)
 
-#define AES_CYPHER_TEST(mode, mode_str, enc_count, dec_count, enc_template, dec_template) \
-  AES_CYPHER_TEST_ENCRYPT(mode, mode_str, enc_count, enc_template)\
-  AES_CYPHER_TEST_DECRYPT(mode, mode_str, dec_count, dec_template)
+  return OK;
+}
+#endif
 
-static int test_aes(void)
+#if defined(CONFIG_CRYPTO_SW_AES)
+
+/* The same vectors through the software library, where CBC and CTR
+ * decryption are done in place
+ */
+
+static int do_test_swaes(FAR struct cipher_testvec *test,
+                         int mode,
+                         int encrypt)
+{
+  struct aes_state_s state;
+  uint8_t iv[AES_BLOCK_SIZE];
+  FAR uint8_t *out;
+  int res;
+
+  out = kmm_zalloc(test->rlen);
+  if (out == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  res = aes_setupkey(&state, (FAR const uint8_t *)test->key, test->klen);
+  if (res < 0)
+    {
+      goto out;
+    }
+
+  memcpy(out, test->input, test->ilen);
+  if (mode != AES_MODE_ECB)
+    {
+      memcpy(iv, test->iv, AES_BLOCK_SIZE);
+    }
+
+  switch (mode)
+    {
+    case AES_MODE_ECB:
+      if (encrypt)
+        {
+          aes_encipher(&state, out, test->ilen / AES_BLOCK_SIZE);
+        }
+      else
+        {
+          aes_decipher(&state, out, test->ilen / AES_BLOCK_SIZE);
+        }
+      break;
+
+    case AES_MODE_CBC:
+      if (encrypt)
+        {
+          res = aes_cbc_encrypt(&state, iv, out, out, test->ilen);
+        }
+      else
+        {
+          res = aes_cbc_decrypt(&state, iv, out, out, test->ilen);
+        }
+      break;
+
+    case AES_MODE_CTR:
+      aes_ctr_crypt(&state, iv, out, out, test->ilen);
+      break;
+
+    default:
+      res = -EINVAL;
+      break;
+    }
+
+  if (res == OK)
+    {
+      res = memcmp(out, test->result, test->rlen);
+    }
+
+out:
+  kmm_free(out);
+  return res;
+}
+
+/* Encrypt, check cipher text and tag, decrypt, then check that a corrupted
+ * tag is refused
+ */
+
+static int do_test_gcm(FAR struct aead_testvec *test)
+{
+  FAR struct aes_gcm_s *gcm;
+  uint8_t tag[AES_GCM_TAG_SIZE];
+  FAR uint8_t *out;
+  int res;
+
+  gcm = kmm_malloc(sizeof(struct aes_gcm_s));
+  out = kmm_zalloc(test->ilen + 1);
+  if (gcm == NULL || out == NULL)
+    {
+      res = -ENOMEM;
+      goto out;
+    }
+
+  res = aes_gcm_setupkey(gcm, (FAR const uint8_t *)test->key, test->klen);
+  if (res < 0)
+    {
+      goto out;
+    }
+
+  res = aes_gcm_encrypt(gcm, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen,
+                        out, (FAR const uint8_t *)test->input, test->ilen,
+                        tag, AES_GCM_TAG_SIZE);
+  if (res < 0 || memcmp(out, test->result, test->ilen) != 0 ||
+      memcmp(tag, test->tag, AES_GCM_TAG_SIZE) != 0)
+    {
+      res = -EIO;
+      goto out;
+    }
+
+  res = aes_gcm_decrypt(gcm, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen,
+                        out, out, test->ilen, tag, AES_GCM_TAG_SIZE);
+  if (res < 0 || memcmp(out, test->input, test->ilen) != 0)
+    {
+      res = -EIO;
+      goto out;
+    }
+
+  tag[0] ^= 1;
+  res = aes_gcm_decrypt(gcm, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen,
+                        out, (FAR const uint8_t *)test->result, test->ilen,
+                        tag, AES_GCM_TAG_SIZE);
+  res = res == -EBADMSG ? OK : -EIO;
+
+out:
+  kmm_free(out);
+  kmm_free(gcm);
+  return res;
+}
+
+static int test_swaes(void)
 {
   int i;
 
-  AES_CYPHER_TEST(AES_MODE_ECB, "ECB", ARRAY_SIZE(aes_enc_tv_template),
-                  ARRAY_SIZE(aes_dec_tv_template), aes_enc_tv_template,
-                  aes_dec_tv_template)
-  AES_CYPHER_TEST(AES_MODE_CBC, "CBC", ARRAY_SIZE(aes_cbc_enc_tv_template),
-                  ARRAY_SIZE(aes_cbc_dec_tv_template),
-                  aes_cbc_enc_tv_template, aes_cbc_dec_tv_template)
-  AES_CYPHER_TEST(AES_MODE_CTR, "CTR", ARRAY_SIZE(aes_ctr_enc_tv_template),
-                  ARRAY_SIZE(aes_ctr_dec_tv_template),
-                  aes_ctr_enc_tv_template, aes_ctr_dec_tv_template)
+  AES_CYPHER_TEST_ALL(do_test_swaes)
+
+  for (i = 0; i < ARRAY_SIZE(aes_gcm_tv_template); i++)
+    {
+      if (do_test_gcm(aes_gcm_tv_template + i))
+        {
+          crypterr("ERROR: Failed GCM test #%i\n", i);
+          return -1;
+        }
+    }
 
   return OK;
 }
 #endif
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 int crypto_test(void)
 {
 #if defined(CONFIG_CRYPTO_AES)
@@ -117,6 +284,13 @@ int crypto_test(void)
     }
 #endif
 
+#if defined(CONFIG_CRYPTO_SW_AES)
+  if (test_swaes())
+    {
+      return -1;
+    }
+#endif
+
   return OK;
 }
 
@@ -0,0 +1,408 @@
+/****************************************************************************
+ * drivers/dev_lzf.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* A character device that stores the data written to it LZF compressed in
+ * a file, and returns the decompressed content of that file when read.
+ * The file is a sequence of LZF blocks (see include/lzf.h) and is appended
+ * to by each writer, one block of CONFIG_LIBC_LZF_STREAM_BLKSIZE octets at
+ * a time.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <lzf.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/drivers/drivers.h>
+
+#ifdef CONFIG_DEV_LZF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The I/O buffer holds one complete compressed block.  Each call to
+ * lzf_stream_compress() returns at most one block, so that every block is
+ * appended to the file by a write of its own and the blocks of several
+ * writers are not mixed.
+ */
+
+#define DEVLZF_BUFSIZE (LZF_MAX_HDR_SIZE + LZF_STREAM_BLKSIZE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The state of one open instance of the device */
+
+struct devlzf_file_s
+{
+  struct file df_file;                  /* The compressed file */
+  mutex_t df_lock;                      /* Serializes I/O on the stream */
+  FAR lzf_hslot_t *df_htab;             /* Hash table (writers only) */
+  struct lzf_stream_s df_strm;          /* Compression state */
+  uint8_t df_buffer[DEVLZF_BUFSIZE];    /* File I/O buffer */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     devlzf_open(FAR struct file *filep);
+static int     devlzf_close(FAR struct file *filep);
+static ssize_t devlzf_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t devlzf_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
+static int     devlzf_ioctl(FAR struct file *filep, int cmd,
+                 unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations devlzf_fops =
+{
+  devlzf_open,   /* open */
+  devlzf_close,  /* close */
+  devlzf_read,   /* read */
+  devlzf_write,  /* write */
+  NULL,          /* seek */
+  devlzf_ioctl,  /* ioctl */
+  NULL           /* poll */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , NULL         /* unlink */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: devlzf_deflate
+ *
+ * Description:
+ *   Compress the data at next_in and append the complete blocks to the
+ *   file, one block per write.  If flush is true, the partial block is
+ *   appended as well.
+ *
+ ****************************************************************************/
+
+static int devlzf_deflate(FAR struct devlzf_file_s *priv, bool flush)
+{
+  FAR struct lzf_stream_s *strm = &priv->df_strm;
+  ssize_t nwritten;
+  size_t nbytes;
+  size_t pos;
+
+  do
+    {
+      strm->next_out  = priv->df_buffer;
+      strm->avail_out = DEVLZF_BUFSIZE;
+      lzf_stream_compress(strm, flush);
+
+      nbytes = DEVLZF_BUFSIZE - strm->avail_out;
+      for (pos = 0; pos < nbytes; pos += nwritten)
+        {
+          nwritten = file_write(&priv->df_file, &priv->df_buffer[pos],
+                                nbytes - pos);
+          if (nwritten <= 0)
+            {
+              return nwritten < 0 ? (int)nwritten : -EIO;
+            }
+        }
+    }
+  while (nbytes > 0);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: devlzf_open
+ ****************************************************************************/
+
+static int devlzf_open(FAR struct file *filep)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR struct devlzf_file_s *priv;
+  int oflags;
+  int ret;
+
+  /* The file is either decompressed or appended to, not both */
+
+  if ((filep->f_oflags & O_ACCMODE) == O_RDWR)
+    {
+      return -EACCES;
+    }
+
+  priv = (FAR struct devlzf_file_s *)kmm_zalloc(sizeof(*priv));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if ((filep->f_oflags & O_WROK) != 0)
+    {
+      priv->df_htab = (FAR lzf_hslot_t *)kmm_malloc(sizeof(lzf_state_t));
+      if (priv->df_htab == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout_with_priv;
+        }
+
+      oflags = O_WRONLY | O_CREAT | O_APPEND | (filep->f_oflags & O_TRUNC);
+    }
+  else
+    {
+      oflags = O_RDONLY;
+    }
+
+  ret = file_open(&priv->df_file, (FAR const char *)inode->i_private,
+                  oflags, 0666);
+  if (ret < 0)
+    {
+      goto errout_with_htab;
+    }
+
+  nxmutex_init(&priv->df_lock);
+  lzf_stream_init(&priv->df_strm, priv->df_htab);
+  filep->f_priv = priv;
+  return OK;
+
+errout_with_htab:
+  if (priv->df_htab != NULL)
+    {
+      kmm_free(priv->df_htab);
+    }
+
+errout_with_priv:
+  kmm_free(priv);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: devlzf_close
+ ****************************************************************************/
+
+static int devlzf_close(FAR struct file *filep)
+{
+  FAR struct devlzf_file_s *priv = filep->f_priv;
+  int ret = OK;
+  int ret2;
+
+  /* Append the partial block of a writer */
+
+  if (priv->df_htab != NULL)
+    {
+      priv->df_strm.avail_in = 0;
+      ret = devlzf_deflate(priv, true);
+      kmm_free(priv->df_htab);
+    }
+
+  ret2 = file_close(&priv->df_file);
+  if (ret >= 0)
+    {
+      ret = ret2;
+    }
+
+  nxmutex_destroy(&priv->df_lock);
+  kmm_free(priv);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: devlzf_read
+ ****************************************************************************/
+
+static ssize_t devlzf_read(FAR struct file *filep, FAR char *buffer,
+                           size_t len)
+{
+  FAR struct devlzf_file_s *priv = filep->f_priv;
+  FAR struct lzf_stream_s *strm = &priv->df_strm;
+  ssize_t nread;
+  ssize_t ret;
+
+  ret = nxmutex_lock(&priv->df_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Input that was read from the file but not yet decompressed is kept in
+   * df_buffer, referenced by next_in.  More is read when all of it has
+   * been consumed.
+   */
+
+  strm->next_out  = (FAR uint8_t *)buffer;
+  strm->avail_out = len;
+
+  for (; ; )
+    {
+      if (lzf_stream_decompress(strm) < 0)
+        {
+          ret = -get_errno();
+          break;
+        }
+
+      if (strm->avail_out == 0)
+        {
+          break;
+        }
+
+      nread = file_read(&priv->df_file, priv->df_buffer, DEVLZF_BUFSIZE);
+      if (nread <= 0)
+        {
+          /* At the end of the file, a partial block is kept until a
+           * writer has appended the rest of it.
+           */
+
+          ret = nread;
+          break;
+        }
+
+      strm->next_in  = priv->df_buffer;
+      strm->avail_in = nread;
+    }
+
+  if (strm->avail_out < len)
+    {
+      ret = len - strm->avail_out;
+    }
+
+  nxmutex_unlock(&priv->df_lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: devlzf_write
+ ****************************************************************************/
+
+static ssize_t devlzf_write(FAR struct file *filep, FAR const char *buffer,
+                            size_t len)
+{
+  FAR struct devlzf_file_s *priv = filep->f_priv;
+  int ret;
+
+  ret = nxmutex_lock(&priv->df_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  priv->df_strm.next_in  = (FAR const uint8_t *)buffer;
+  priv->df_strm.avail_in = len;
+
+  ret = devlzf_deflate(priv, false);
+  nxmutex_unlock(&priv->df_lock);
+  return ret < 0 ? ret : (ssize_t)len;
+}
+
+/****************************************************************************
+ * Name: devlzf_ioctl
+ ****************************************************************************/
+
+static int devlzf_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
+{
+  FAR struct devlzf_file_s *priv = filep->f_priv;
+  int ret;
+
+  switch (cmd)
+    {
+      /* Append the partial block to the file and synchronize the file */
+
+      case FIOC_FLUSH:
+        if (priv->df_htab == NULL)
+          {
+            return -EBADF;
+          }
+
+        ret = nxmutex_lock(&priv->df_lock);
+        if (ret < 0)
+          {
+            return ret;
+          }
+
+        priv->df_strm.avail_in = 0;
+        ret = devlzf_deflate(priv, true);
+        if (ret >= 0)
+          {
+            ret = file_fsync(&priv->df_file);
+          }
+
+        nxmutex_unlock(&priv->df_lock);
+        break;
+
+      default:
+        ret = -ENOTTY;
+        break;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: devlzf_register
+ *
+ * Description:
+ *   Register a character device at 'devpath' that compresses the data
+ *   written to it into the file at 'path', and returns the decompressed
+ *   content of that file when read.
+ *
+ ****************************************************************************/
+
+int devlzf_register(FAR const char *devpath, FAR const char *path)
+{
+  FAR char *filepath;
+  int ret;
+
+  filepath = (FAR char *)kmm_malloc(strlen(path) + 1);
+  if (filepath == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  strcpy(filepath, path);
+  ret = register_driver(devpath, &devlzf_fops, 0666, filepath);
+  if (ret < 0)
+    {
+      kmm_free(filepath);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_DEV_LZF */
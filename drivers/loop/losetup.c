@@ -199,6 +199,8 @@ static ssize_t loop_read(FAR struct inode *inode, FAR unsigned char *buffer,
 {
   FAR struct loop_struct_s *dev;
   ssize_t nbytesread;
+  size_t nbytes;
+  size_t ntotal;
   off_t offset;
   off_t ret;
 
@@ -221,23 +223,47 @@ static ssize_t loop_read(FAR struct inode *inode, FAR unsigned char *buffer,
       return -EIO;
     }
 
-  /* Then read the requested number of sectors from that position */
+  /* Then read the requested number of sectors from that position.  The
+   * file may return less data than requested, so continue until all of the
+   * sectors have been read with as few file accesses as possible.
+   */
+
+  nbytes = nsectors * dev->sectsize;
+  ntotal = 0;
 
-  do
+  while (ntotal < nbytes)
     {
-      nbytesread = file_read(&dev->devfile, buffer,
-                             nsectors * dev->sectsize);
-      if (nbytesread < 0 && nbytesread != -EINTR)
+      nbytesread = file_read(&dev->devfile, buffer + ntotal,
+                             nbytes - ntotal);
+      if (nbytesread < 0)
         {
+          if (nbytesread == -EINTR)
+            {
+              continue;
+            }
+
           ferr("ERROR: Read failed: %zd\n", nbytesread);
-          return (int)nbytesread;
+
+          /* Report the sectors that were transferred before the error */
+
+          if (ntotal < dev->sectsize)
+            {
+              return nbytesread;
+            }
+
+          break;
         }
+      else if (nbytesread == 0)
+        {
+          break;
+        }
+
+      ntotal += nbytesread;
     }
-  while (nbytesread < 0);
 
   /* Return the number of sectors read */
 
-  return nbytesread / dev->sectsize;
+  return ntotal / dev->sectsize;
 }
 
 /****************************************************************************
@@ -253,12 +279,20 @@ static ssize_t loop_write(FAR struct inode *inode,
 {
   FAR struct loop_struct_s *dev;
   ssize_t nbyteswritten;
+  size_t nbytes;
+  size_t ntotal;
   off_t offset;
   off_t ret;
 
   DEBUGASSERT(inode && inode->i_private);
   dev = (FAR struct loop_struct_s *)inode->i_private;
 
+  if (start_sector + nsectors > dev->nsectors)
+    {
+      ferr("ERROR: Write past end of file\n");
+      return -EIO;
+    }
+
   /* Calculate the offset to write the sectors and seek to the position */
 
   offset = start_sector * dev->sectsize + dev->offset;
@@ -266,25 +300,49 @@ static ssize_t loop_write(FAR struct inode *inode,
   if (ret < 0)
     {
       ferr("ERROR: Seek failed for offset=%d: %d\n", (int)offset, (int)ret);
+      return -EIO;
     }
 
-  /* Then write the requested number of sectors to that position */
+  /* Then write the requested number of sectors to that position, again
+   * continuing if the file accepts less data than requested.
+   */
+
+  nbytes = nsectors * dev->sectsize;
+  ntotal = 0;
 
-  do
+  while (ntotal < nbytes)
     {
-      nbyteswritten = file_write(&dev->devfile, buffer,
-                                 nsectors * dev->sectsize);
-      if (nbyteswritten < 0 && nbyteswritten != -EINTR)
+      nbyteswritten = file_write(&dev->devfile, buffer + ntotal,
+                                 nbytes - ntotal);
+      if (nbyteswritten < 0)
         {
+          if (nbyteswritten == -EINTR)
+            {
+              continue;
+            }
+
           ferr("ERROR: file_write failed: %zd\n", nbyteswritten);
-          return nbyteswritten;
+
+          /* Report the sectors that were transferred before the error */
+
+          if (ntotal < dev->sectsize)
+            {
+              return nbyteswritten;
+            }
+
+          break;
         }
+      else if (nbyteswritten == 0)
+        {
+          break;
+        }
+
+      ntotal += nbyteswritten;
     }
-  while (nbyteswritten < 0);
 
   /* Return the number of sectors written */
 
-  return nbyteswritten / dev->sectsize;
+  return ntotal / dev->sectsize;
 }
 
 /****************************************************************************
@@ -32,6 +32,7 @@
 #include <sys/ioctl.h>
 
 #include <inttypes.h>
+#include <queue.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -88,10 +89,39 @@
 
 #define IS_EMPTY(priv) (priv->type == MMCSD_CARDTYPE_UNKNOWN)
 
+/* Size of the bounce buffer of merged requests */
+
+#define MMCSD_MERGE_BUFSIZE     (CONFIG_MMCSD_MERGE_BLOCKS * 512)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+/* A read or write request of one caller.  Requests live on the stack of the
+ * caller and are linked into the request queue of the slot until they are
+ * completed.
+ */
+
+struct mmcsd_request_s
+{
+  /* Supports a singly linked list */
+
+  FAR struct mmcsd_request_s *flink;
+  FAR uint8_t *buffer;             /* Data of the request */
+  off_t    startblock;             /* First block of the request */
+  size_t   nblocks;                /* Number of blocks */
+  ssize_t  result;                 /* Blocks transferred or negated errno */
+  sem_t    done;                   /* Completion or queue hand-over */
+  bool     write;                  /* true: Write request */
+  bool     complete;               /* true: Request has been completed */
+  bool     dispatch;               /* true: Caller must run the queue */
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+  struct timespec start;           /* Time the request was queued */
+#endif
+};
+#endif
+
 /* This structure is contains the unique state of the MMC/SD block driver */
 
 struct mmcsd_state_s
@@ -136,6 +166,18 @@ struct mmcsd_state_s
 
 #if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
   struct rwbuffer_s rwbuffer;
+#endif
+
+  /* Request queue support */
+
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+  sem_t    qsem;                   /* Protects the request queue */
+  sq_queue_t reqq;                 /* Requests waiting for the card */
+  bool     dispatching;            /* true: A caller runs the queue */
+  FAR uint8_t *mergebuf;           /* Bounce buffer of merged requests */
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+  struct mmcsd_reqstats_s stats;   /* Request statistics */
+#endif
 #endif
 };
 
@@ -208,6 +250,25 @@ static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
                  off_t startblock, size_t nblocks);
 #endif
 
+/* Request queue ************************************************************/
+
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+static ssize_t mmcsd_transfer(FAR struct mmcsd_state_s *priv, bool write,
+                 FAR uint8_t *buffer, off_t startblock, size_t nblocks);
+static FAR struct mmcsd_request_s *
+               mmcsd_collect(FAR struct mmcsd_state_s *priv,
+                 FAR off_t *startblock, FAR size_t *nblocks);
+static unsigned int mmcsd_runbatch(FAR struct mmcsd_state_s *priv,
+                 FAR struct mmcsd_request_s *batch, off_t startblock,
+                 size_t nblocks);
+static void    mmcsd_complete(FAR struct mmcsd_state_s *priv,
+                 FAR struct mmcsd_request_s *batch, unsigned int nxfers);
+static void    mmcsd_dispatch(FAR struct mmcsd_state_s *priv,
+                 FAR struct mmcsd_request_s *self);
+static ssize_t mmcsd_submit(FAR struct mmcsd_state_s *priv, bool write,
+                 FAR uint8_t *buffer, off_t startblock, size_t nblocks);
+#endif
+
 /* Block driver methods *****************************************************/
 
 static int     mmcsd_open(FAR struct inode *inode);
@@ -2152,6 +2213,447 @@ static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
 }
 #endif
 
+/****************************************************************************
+ * Request Queue
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mmcsd_transfer
+ *
+ * Description:
+ *   Transfer contiguous blocks with the single- or multiple-block transfer
+ *   method.  The multiple-block write pre-erases the blocks with ACMD23 on
+ *   SD cards.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+static ssize_t mmcsd_transfer(FAR struct mmcsd_state_s *priv, bool write,
+                              FAR uint8_t *buffer, off_t startblock,
+                              size_t nblocks)
+{
+  if (write)
+    {
+      if (nblocks == 1)
+        {
+          return mmcsd_writesingle(priv, buffer, startblock);
+        }
+
+      return mmcsd_writemultiple(priv, buffer, startblock, nblocks);
+    }
+
+  if (nblocks == 1)
+    {
+      return mmcsd_readsingle(priv, buffer, startblock);
+    }
+
+  return mmcsd_readmultiple(priv, buffer, startblock, nblocks);
+}
+
+/****************************************************************************
+ * Name: mmcsd_collect
+ *
+ * Description:
+ *   Remove the oldest request from the request queue together with all
+ *   queued requests of the same direction that extend it to a contiguous
+ *   range of blocks, up to the size of the merge buffer.  The returned
+ *   list is sorted by block number.
+ *
+ * Assumptions:
+ *   The caller holds qsem and the request queue is not empty.
+ *
+ ****************************************************************************/
+
+static FAR struct mmcsd_request_s *
+mmcsd_collect(FAR struct mmcsd_state_s *priv, FAR off_t *startblock,
+              FAR size_t *nblocks)
+{
+  FAR struct mmcsd_request_s *first;
+  FAR struct mmcsd_request_s *last;
+  FAR struct mmcsd_request_s *prev;
+  FAR struct mmcsd_request_s *req;
+  size_t maxblocks = 0;
+  off_t start;
+  size_t count;
+
+  first = (FAR struct mmcsd_request_s *)sq_remfirst(&priv->reqq);
+  DEBUGASSERT(first != NULL);
+
+  first->flink = NULL;
+  last         = first;
+  start        = first->startblock;
+  count        = first->nblocks;
+
+  /* Merged requests are gathered in the merge buffer, so nothing can be
+   * merged without one.
+   */
+
+  if (priv->mergebuf != NULL && priv->blockshift >= 9)
+    {
+      maxblocks = MMCSD_MERGE_BUFSIZE >> priv->blockshift;
+    }
+
+  prev = NULL;
+  req  = (FAR struct mmcsd_request_s *)sq_peek(&priv->reqq);
+
+  while (req != NULL)
+    {
+      if (req->write == first->write && count + req->nblocks <= maxblocks &&
+          (req->startblock == start + count ||
+           req->startblock + req->nblocks == start))
+        {
+          /* Remove the request from the queue */
+
+          if (prev == NULL)
+            {
+              sq_remfirst(&priv->reqq);
+            }
+          else
+            {
+              sq_remafter((FAR sq_entry_t *)prev, &priv->reqq);
+            }
+
+          /* And add it at the end or at the beginning of the range */
+
+          if (req->startblock == start + count)
+            {
+              req->flink  = NULL;
+              last->flink = req;
+              last        = req;
+            }
+          else
+            {
+              req->flink  = first;
+              first       = req;
+              start       = req->startblock;
+            }
+
+          count += req->nblocks;
+
+          /* The range has grown, so requests that were skipped before may
+           * be adjacent now.  Rescan the queue.
+           */
+
+          prev = NULL;
+          req  = (FAR struct mmcsd_request_s *)sq_peek(&priv->reqq);
+        }
+      else
+        {
+          prev = req;
+          req  = req->flink;
+        }
+    }
+
+  *startblock = start;
+  *nblocks    = count;
+  return first;
+}
+
+/****************************************************************************
+ * Name: mmcsd_runbatch
+ *
+ * Description:
+ *   Perform the transfer of a list of requests returned by mmcsd_collect()
+ *   and set the result of each request.
+ *
+ * Returned Value:
+ *   The number of transfers performed on the bus.
+ *
+ * Assumptions:
+ *   The caller holds the slot lock.
+ *
+ ****************************************************************************/
+
+static unsigned int mmcsd_runbatch(FAR struct mmcsd_state_s *priv,
+                                   FAR struct mmcsd_request_s *batch,
+                                   off_t startblock, size_t nblocks)
+{
+  FAR struct mmcsd_request_s *req;
+  bool write = batch->write;
+  unsigned int nxfers = 0;
+  size_t offset;
+  ssize_t ret;
+
+  if (batch->flink == NULL)
+    {
+      /* A single request is transferred from the buffer of the caller */
+
+      batch->result = mmcsd_transfer(priv, write, batch->buffer,
+                                     startblock, nblocks);
+      return 1;
+    }
+
+  if (priv->mergebuf == NULL ||
+      (nblocks << priv->blockshift) > MMCSD_MERGE_BUFSIZE)
+    {
+      /* The card has changed since the requests were merged.  Transfer
+       * each request on its own.
+       */
+
+      for (req = batch; req != NULL; req = req->flink)
+        {
+          req->result = mmcsd_transfer(priv, write, req->buffer,
+                                       req->startblock, req->nblocks);
+          nxfers++;
+        }
+
+      return nxfers;
+    }
+
+  /* Gather the data of the write requests in the merge buffer */
+
+  if (write)
+    {
+      for (req = batch; req != NULL; req = req->flink)
+        {
+          offset = (size_t)(req->startblock - startblock) <<
+                   priv->blockshift;
+          memcpy(priv->mergebuf + offset, req->buffer,
+                 req->nblocks << priv->blockshift);
+        }
+    }
+
+  ret = mmcsd_transfer(priv, write, priv->mergebuf, startblock, nblocks);
+
+  /* Scatter the data read to the requests and set the results */
+
+  for (req = batch; req != NULL; req = req->flink)
+    {
+      if (ret < 0)
+        {
+          req->result = ret;
+          continue;
+        }
+
+      if (!write)
+        {
+          offset = (size_t)(req->startblock - startblock) <<
+                   priv->blockshift;
+          memcpy(req->buffer, priv->mergebuf + offset,
+                 req->nblocks << priv->blockshift);
+        }
+
+      req->result = req->nblocks;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: mmcsd_complete
+ *
+ * Description:
+ *   Account for and wake up the callers of a list of finished requests,
+ *   which took 'nxfers' transfers on the bus.  A request must not be
+ *   accessed after it has been completed, it is released by its caller.
+ *
+ * Assumptions:
+ *   The caller holds qsem.
+ *
+ ****************************************************************************/
+
+static void mmcsd_complete(FAR struct mmcsd_state_s *priv,
+                           FAR struct mmcsd_request_s *batch,
+                           unsigned int nxfers)
+{
+  FAR struct mmcsd_request_s *next;
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+  FAR struct mmcsd_dirstats_s *stats;
+  struct timespec now;
+  uint32_t latency;
+  int bucket;
+
+  clock_systime_timespec(&now);
+
+  stats = batch->write ? &priv->stats.write : &priv->stats.read;
+  stats->nxfers += nxfers;
+#else
+  UNUSED(nxfers);
+#endif
+
+  for (; batch != NULL; batch = next)
+    {
+      next = batch->flink;
+
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+      stats   = batch->write ? &priv->stats.write : &priv->stats.read;
+      latency = (uint32_t)(now.tv_sec - batch->start.tv_sec) * 1000000 +
+                (now.tv_nsec - batch->start.tv_nsec) / 1000;
+
+      bucket  = 0;
+
+      while (bucket < MMCSD_NLATBUCKETS - 1 && (latency >> bucket) != 0)
+        {
+          bucket++;
+        }
+
+      stats->nreqs++;
+      stats->hist[bucket]++;
+      if (latency > stats->maxlatency)
+        {
+          stats->maxlatency = latency;
+        }
+
+      if (batch->result < 0)
+        {
+          stats->nerrors++;
+        }
+      else
+        {
+          stats->nblocks += batch->result;
+        }
+#endif
+
+      batch->complete = true;
+      nxsem_post(&batch->done);
+    }
+}
+
+/****************************************************************************
+ * Name: mmcsd_dispatch
+ *
+ * Description:
+ *   Run the request queue until the request of the calling thread has been
+ *   completed, then hand the queue over to the caller of the oldest queued
+ *   request.
+ *
+ ****************************************************************************/
+
+static void mmcsd_dispatch(FAR struct mmcsd_state_s *priv,
+                           FAR struct mmcsd_request_s *self)
+{
+  FAR struct mmcsd_request_s *batch;
+  FAR struct mmcsd_request_s *next;
+  unsigned int nxfers;
+  off_t startblock;
+  size_t nblocks;
+  int ret;
+
+  nxsem_wait_uninterruptible(&priv->qsem);
+  while (!self->complete)
+    {
+      /* Our own request is still queued, so there is something to do */
+
+      batch = mmcsd_collect(priv, &startblock, &nblocks);
+      nxsem_post(&priv->qsem);
+
+      nxfers = 0;
+      ret    = mmcsd_takesem(priv);
+      if (ret < 0)
+        {
+          for (next = batch; next != NULL; next = next->flink)
+            {
+              next->result = ret;
+            }
+        }
+      else
+        {
+          nxfers = mmcsd_runbatch(priv, batch, startblock, nblocks);
+          mmcsd_givesem(priv);
+        }
+
+      nxsem_wait_uninterruptible(&priv->qsem);
+      mmcsd_complete(priv, batch, nxfers);
+    }
+
+  /* Hand the queue over to the oldest waiting caller, if any */
+
+  next = (FAR struct mmcsd_request_s *)sq_peek(&priv->reqq);
+  if (next != NULL)
+    {
+      next->dispatch = true;
+      nxsem_post(&next->done);
+    }
+  else
+    {
+      priv->dispatching = false;
+    }
+
+  nxsem_post(&priv->qsem);
+}
+
+/****************************************************************************
+ * Name: mmcsd_submit
+ *
+ * Description:
+ *   Queue a read or write request and wait for its completion.  The caller
+ *   runs the queue itself if no other caller does.
+ *
+ ****************************************************************************/
+
+static ssize_t mmcsd_submit(FAR struct mmcsd_state_s *priv, bool write,
+                            FAR uint8_t *buffer, off_t startblock,
+                            size_t nblocks)
+{
+  struct mmcsd_request_s req;
+  bool dispatch;
+  int ret;
+
+  req.buffer     = buffer;
+  req.startblock = startblock;
+  req.nblocks    = nblocks;
+  req.result     = -EIO;
+  req.write      = write;
+  req.complete   = false;
+  req.dispatch   = false;
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+  clock_systime_timespec(&req.start);
+#endif
+
+  /* The done semaphore is used for signaling and, hence, should not have
+   * priority inheritance enabled.
+   */
+
+  nxsem_init(&req.done, 0, 0);
+  nxsem_set_protocol(&req.done, SEM_PRIO_NONE);
+
+  ret = nxsem_wait_uninterruptible(&priv->qsem);
+  if (ret < 0)
+    {
+      nxsem_destroy(&req.done);
+      return ret;
+    }
+
+  sq_addlast((FAR sq_entry_t *)&req, &priv->reqq);
+  dispatch = !priv->dispatching;
+  if (dispatch)
+    {
+      /* The card is idle, run the queue ourselves */
+
+      priv->dispatching = true;
+      req.dispatch      = true;
+    }
+
+  nxsem_post(&priv->qsem);
+
+  /* Wait until the request has been completed or the queue has been
+   * handed over to us.  Both are signaled by posting 'done' after the flag
+   * is set, so the flags are only looked at after that post has been
+   * consumed:  the request lives on our stack and must not go away while
+   * another thread may still post to it.
+   */
+
+  while (!dispatch)
+    {
+      nxsem_wait_uninterruptible(&req.done);
+      if (req.complete)
+        {
+          nxsem_destroy(&req.done);
+          return req.result;
+        }
+
+      dispatch = req.dispatch;
+    }
+
+  /* Run the queue until our own request has been completed */
+
+  mmcsd_dispatch(priv, &req);
+
+  nxsem_destroy(&req.done);
+  return req.result;
+}
+#endif
+
 /****************************************************************************
  * Name: mmcsd_open
  *
@@ -2237,6 +2739,17 @@ static ssize_t mmcsd_read(FAR struct inode *inode, unsigned char *buffer,
   finfo("startsector: %" PRIuOFF " nsectors: %u sectorsize: %d\n",
         startsector, nsectors, priv->blocksize);
 
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+  if (nsectors > 0)
+    {
+      /* Queue the request, it may be merged with the requests of other
+       * callers.
+       */
+
+      return mmcsd_submit(priv, false, buffer, startsector, nsectors);
+    }
+#endif
+
   if (nsectors > 0)
     {
       ret = mmcsd_takesem(priv);
@@ -2318,6 +2831,18 @@ static ssize_t mmcsd_write(FAR struct inode *inode,
   finfo("sector: %lu nsectors: %u sectorsize: %u\n",
         (unsigned long)startsector, nsectors, priv->blocksize);
 
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+  if (nsectors > 0)
+    {
+      /* Queue the request, it may be merged with the requests of other
+       * callers.
+       */
+
+      return mmcsd_submit(priv, true, (FAR uint8_t *)buffer, startsector,
+                          nsectors);
+    }
+#endif
+
   if (nsectors > 0)
     {
       ret = mmcsd_takesem(priv);
@@ -2491,6 +3016,31 @@ static int mmcsd_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       }
       break;
 
+#ifdef CONFIG_MMCSD_REQUEST_STATS
+    case BIOC_REQSTATS: /* Return and reset the request statistics */
+      {
+        FAR struct mmcsd_reqstats_s *stats =
+          (FAR struct mmcsd_reqstats_s *)((uintptr_t)arg);
+
+        finfo("BIOC_REQSTATS\n");
+
+        if (stats == NULL)
+          {
+            ret = -EINVAL;
+            break;
+          }
+
+        ret = nxsem_wait_uninterruptible(&priv->qsem);
+        if (ret >= 0)
+          {
+            memcpy(stats, &priv->stats, sizeof(struct mmcsd_reqstats_s));
+            memset(&priv->stats, 0, sizeof(struct mmcsd_reqstats_s));
+            nxsem_post(&priv->qsem);
+          }
+      }
+      break;
+#endif
+
     default:
       ret = -ENOTTY;
       break;
@@ -3672,6 +4222,9 @@ static void mmcsd_hwuninitialize(FAR struct mmcsd_state_s *priv)
     {
       mmcsd_removed(priv);
       SDIO_RESET(priv->dev);
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+      kmm_free(priv->mergebuf);
+#endif
       kmm_free(priv);
     }
 }
@@ -3721,6 +4274,10 @@ int mmcsd_slotinitialize(int minor, FAR struct sdio_dev_s *dev)
 
       memset(priv, 0, sizeof(struct mmcsd_state_s));
       nxsem_init(&priv->sem, 0, 1);
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+      nxsem_init(&priv->qsem, 0, 1);
+      sq_init(&priv->reqq);
+#endif
 
       /* Bind the MMCSD driver to the MMCSD state structure */
 
@@ -3771,6 +4328,18 @@ int mmcsd_slotinitialize(int minor, FAR struct sdio_dev_s *dev)
         }
 #endif
 
+#ifdef CONFIG_MMCSD_REQUEST_QUEUE
+      /* Allocate the bounce buffer of merged requests.  Requests are still
+       * queued, but not merged, without it.
+       */
+
+      priv->mergebuf = (FAR uint8_t *)kmm_malloc(MMCSD_MERGE_BUFSIZE);
+      if (priv->mergebuf == NULL)
+        {
+          fwarn("WARNING: No merge buffer, requests will not be merged\n");
+        }
+
+#endif
       /* Create a MMCSD device name */
 
       snprintf(devname, 16, "/dev/mmcsd%d", minor);
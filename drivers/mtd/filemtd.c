@@ -71,6 +71,10 @@
 #  error "CONFIG_FILEMTD_ERASESIZE must be an even multiple of CONFIG_FILEMTD_BLOCKSIZE"
 #endif
 
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -88,12 +92,23 @@ struct file_dev_s
   size_t           offset;     /* Offset from start of file */
   size_t           erasesize;  /* Offset from start of file */
   size_t           blocksize;  /* Offset from start of file */
+  FAR uint8_t     *buffer;     /* Read-modify-write buffer of one block */
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  FAR uint8_t     *erasemap;   /* One bit per erase block known erased */
+  bool             tail;       /* True: device ends at the end of the file */
+#endif
 };
 
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
+static ssize_t filemtd_fileread(FAR struct file_dev_s *priv,
+                 FAR uint8_t *buffer, size_t offset, size_t nbytes);
+static ssize_t filemtd_filewrite(FAR struct file_dev_s *priv,
+                 FAR const uint8_t *buffer, size_t offset, size_t nbytes);
+static int     filemtd_fileerase(FAR struct file_dev_s *priv,
+                 off_t startblock, size_t nblocks);
 static ssize_t filemtd_read(FAR struct file_dev_s *priv,
                  FAR unsigned char *buffer, size_t offsetbytes,
                  unsigned int nbytes);
@@ -122,86 +137,278 @@ static int     filemtd_ioctl(FAR struct mtd_dev_s *dev, int cmd,
  ****************************************************************************/
 
 /****************************************************************************
- * Name: filemtd_write
+ * Name: filemtd_iserased, filemtd_seterased, and filemtd_clrerased
+ *
+ * Description:
+ *   Test, set, and clear the bit of the erased block map that tells that
+ *   an erase block is known to be in the erased state.
+ *
  ****************************************************************************/
 
-static ssize_t filemtd_write(FAR struct file_dev_s *priv, size_t offset,
-                             FAR const void *src, size_t len)
+static inline bool filemtd_iserased(FAR struct file_dev_s *priv,
+                                    size_t block)
 {
-  FAR const uint8_t *pin  = (FAR const uint8_t *)src;
-  FAR uint8_t       *pout;
-  char               buf[128];
-  int                buflen = 0;
-  uint8_t            oldvalue;
-  uint8_t            srcvalue;
-  uint8_t            newvalue;
-  size_t             seekpos;
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  return (priv->erasemap[block >> 3] & (1 << (block & 7))) != 0;
+#else
+  return false;
+#endif
+}
 
-  /* Set the starting location in the file */
+static inline void filemtd_seterased(FAR struct file_dev_s *priv,
+                                     size_t block)
+{
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  priv->erasemap[block >> 3] |= 1 << (block & 7);
+#endif
+}
+
+static inline void filemtd_clrerased(FAR struct file_dev_s *priv,
+                                     size_t block)
+{
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  priv->erasemap[block >> 3] &= ~(1 << (block & 7));
+#endif
+}
 
-  seekpos = priv->offset + offset;
+/****************************************************************************
+ * Name: filemtd_fileread
+ *
+ * Description:
+ *   Read a range of the device from the backing file.
+ *
+ ****************************************************************************/
 
-  while (len-- > 0)
+static ssize_t filemtd_fileread(FAR struct file_dev_s *priv,
+                                FAR uint8_t *buffer, size_t offset,
+                                size_t nbytes)
+{
+  size_t remaining = nbytes;
+  ssize_t nread;
+  off_t ret;
+
+  ret = file_seek(&priv->mtdfile, priv->offset + offset, SEEK_SET);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while (remaining > 0)
     {
-      if (buflen == 0)
+      nread = file_read(&priv->mtdfile, buffer, remaining);
+      if (nread < 0)
         {
-          /* Read more data from the file */
+          if (nread == -EINTR)
+            {
+              continue;
+            }
 
-          file_seek(&priv->mtdfile, seekpos, SEEK_SET);
-          buflen = file_read(&priv->mtdfile, buf, sizeof(buf));
-          pout   = (FAR uint8_t *) buf;
+          return nread;
         }
+      else if (nread == 0)
+        {
+          break;
+        }
+
+      buffer    += nread;
+      remaining -= nread;
+    }
 
-      /* Get the source and destination values */
+  return nbytes - remaining;
+}
 
-      oldvalue = *pout;
-      srcvalue = *pin++;
+/****************************************************************************
+ * Name: filemtd_filewrite
+ *
+ * Description:
+ *   Write a range of the device to the backing file.
+ *
+ ****************************************************************************/
 
-      /* Get the new destination value, accounting for bits that cannot be
-       * changes because they are not in the erased state.
-       */
+static ssize_t filemtd_filewrite(FAR struct file_dev_s *priv,
+                                 FAR const uint8_t *buffer, size_t offset,
+                                 size_t nbytes)
+{
+  size_t remaining = nbytes;
+  ssize_t nwritten;
+  off_t ret;
 
-#if CONFIG_FILEMTD_ERASESTATE == 0xff
-      newvalue = oldvalue & srcvalue; /* We can only clear bits */
-#else /* CONFIG_FILEMTD_ERASESTATE == 0x00 */
-      newvalue = oldvalue | srcvalue; /* We can only set bits */
-#endif
+  ret = file_seek(&priv->mtdfile, priv->offset + offset, SEEK_SET);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
-      /* Report any attempt to change the value of bits that are not in the
-       * erased state.
-       */
+  while (remaining > 0)
+    {
+      nwritten = file_write(&priv->mtdfile, buffer, remaining);
+      if (nwritten < 0)
+        {
+          if (nwritten == -EINTR)
+            {
+              continue;
+            }
 
-#ifdef CONFIG_DEBUG_FEATURES
-      if (newvalue != srcvalue)
+          return nwritten;
+        }
+      else if (nwritten == 0)
         {
-          ferr("ERROR: Bad write: source=%02x dest=%02x result=%02x\n",
-              srcvalue, oldvalue, newvalue);
+          return -ENOSPC;
         }
-#endif
 
-      /* Write the modified value to simulated FLASH */
+      buffer    += nwritten;
+      remaining -= nwritten;
+    }
 
-      *pout++ = newvalue;
-      buflen--;
+  return nbytes;
+}
 
-      /* If our buffer is full, then seek back to beginning of
-       * the file and write the buffer contents
-       */
+/****************************************************************************
+ * Name: filemtd_fileerase
+ *
+ * Description:
+ *   Put a range of erase blocks of the backing file in the erased state.
+ *
+ ****************************************************************************/
 
-      if (buflen == 0)
+static int filemtd_fileerase(FAR struct file_dev_s *priv, off_t startblock,
+                             size_t nblocks)
+{
+  size_t offset = startblock * priv->erasesize;
+  size_t nbytes = nblocks * priv->erasesize;
+  size_t chunk;
+  ssize_t ret;
+
+#if defined(CONFIG_FILEMTD_ERASEMAP) && CONFIG_FILEMTD_ERASESTATE == 0x00
+  /* Erasing the end of a device that ends at the end of the file: drop the
+   * data and extend the file again.  The file system fills the extension
+   * with zeroes, possibly without allocating any storage for it.
+   */
+
+  if (priv->tail && startblock + nblocks == priv->nblocks)
+    {
+      ret = file_truncate(&priv->mtdfile, priv->offset + offset);
+      if (ret >= 0)
         {
-          file_seek(&priv->mtdfile, seekpos, SEEK_SET);
-          file_write(&priv->mtdfile, buf, sizeof(buf));
-          seekpos += sizeof(buf);
+          ret = file_truncate(&priv->mtdfile, priv->offset +
+                              priv->nblocks * priv->erasesize);
+          if (ret >= 0)
+            {
+              return OK;
+            }
         }
     }
+#endif
+
+  /* Otherwise write the erased state over the range */
+
+  memset(priv->buffer, CONFIG_FILEMTD_ERASESTATE, priv->blocksize);
+  while (nbytes > 0)
+    {
+      chunk = MIN(nbytes, priv->blocksize);
+      ret   = filemtd_filewrite(priv, priv->buffer, offset, chunk);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      offset += chunk;
+      nbytes -= chunk;
+    }
+
+  return OK;
+}
 
-  /* Write remaining bytes */
+/****************************************************************************
+ * Name: filemtd_write
+ ****************************************************************************/
 
-  if (buflen != 0)
+static ssize_t filemtd_write(FAR struct file_dev_s *priv, size_t offset,
+                             FAR const void *src, size_t len)
+{
+  FAR const uint8_t *pin = (FAR const uint8_t *)src;
+  size_t             nbytes = len;
+  size_t             chunk;
+  size_t             block;
+  size_t             i;
+  ssize_t            ret;
+
+  while (nbytes > 0)
     {
-      file_seek(&priv->mtdfile, seekpos, SEEK_SET);
-      file_write(&priv->mtdfile, buf, sizeof(buf));
+      block = offset / priv->erasesize;
+      chunk = priv->erasesize - offset % priv->erasesize;
+
+      if (filemtd_iserased(priv, block))
+        {
+          /* Programming erased bits just gives the source data, so the
+           * data of this and the following erased blocks can be written
+           * as it is.
+           */
+
+          filemtd_clrerased(priv, block);
+          while (chunk < nbytes && filemtd_iserased(priv, block + 1))
+            {
+              filemtd_clrerased(priv, ++block);
+              chunk += priv->erasesize;
+            }
+
+          chunk = MIN(chunk, nbytes);
+          ret   = filemtd_filewrite(priv, pin, offset, chunk);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+      else
+        {
+          /* Read the current data of the file */
+
+          chunk = MIN(chunk, MIN(nbytes, priv->blocksize));
+          ret   = filemtd_fileread(priv, priv->buffer, offset, chunk);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          /* Get the new value, accounting for bits that cannot be changed
+           * because they are not in the erased state.
+           */
+
+          for (i = 0; i < chunk; i++)
+            {
+#if CONFIG_FILEMTD_ERASESTATE == 0xff
+              uint8_t newvalue = priv->buffer[i] & pin[i]; /* Clear bits */
+#else /* CONFIG_FILEMTD_ERASESTATE == 0x00 */
+              uint8_t newvalue = priv->buffer[i] | pin[i]; /* Set bits */
+#endif
+
+              /* Report any attempt to change the value of bits that are not
+               * in the erased state.
+               */
+
+#ifdef CONFIG_DEBUG_FEATURES
+              if (newvalue != pin[i])
+                {
+                  ferr("ERROR: Bad write: source=%02x dest=%02x "
+                       "result=%02x\n", pin[i], priv->buffer[i], newvalue);
+                }
+#endif
+
+              priv->buffer[i] = newvalue;
+            }
+
+          /* Write the modified values to simulated FLASH */
+
+          ret = filemtd_filewrite(priv, priv->buffer, offset, chunk);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      pin    += chunk;
+      offset += chunk;
+      nbytes -= chunk;
     }
 
   return len;
@@ -215,11 +422,81 @@ static ssize_t filemtd_read(FAR struct file_dev_s *priv,
                             FAR unsigned char *buffer, size_t offsetbytes,
                             unsigned int nbytes)
 {
-  /* Set the starting location in the file */
+  size_t remaining = nbytes;
+  size_t chunk;
+  size_t block;
+  ssize_t ret;
+
+  while (remaining > 0)
+    {
+      block = offsetbytes / priv->erasesize;
+      chunk = priv->erasesize - offsetbytes % priv->erasesize;
+
+      if (filemtd_iserased(priv, block))
+        {
+          /* Erased blocks are read without accessing the file */
+
+          chunk = MIN(chunk, remaining);
+          memset(buffer, CONFIG_FILEMTD_ERASESTATE, chunk);
+        }
+      else
+        {
+          /* Read this and the following blocks that are not known to be
+           * erased with one file access.
+           */
+
+          while (chunk < remaining && !filemtd_iserased(priv, block + 1))
+            {
+              chunk += priv->erasesize;
+              block++;
+            }
+
+          chunk = MIN(chunk, remaining);
+          ret   = filemtd_fileread(priv, buffer, offsetbytes, chunk);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+#ifdef CONFIG_FILEMTD_ERASEMAP
+          /* Remember the whole erase blocks that were read back erased */
+
+          for (block = (offsetbytes + priv->erasesize - 1) /
+                       priv->erasesize;
+               (block + 1) * priv->erasesize <= offsetbytes + ret;
+               block++)
+            {
+              FAR const uint8_t *ptr = buffer + block * priv->erasesize -
+                                       offsetbytes;
+              size_t i;
+
+              for (i = 0; i < priv->erasesize; i++)
+                {
+                  if (ptr[i] != CONFIG_FILEMTD_ERASESTATE)
+                    {
+                      break;
+                    }
+                }
+
+              if (i == priv->erasesize)
+                {
+                  filemtd_seterased(priv, block);
+                }
+            }
+#endif
+
+          if (ret < chunk)
+            {
+              return nbytes - remaining + ret;
+            }
+        }
 
-  file_seek(&priv->mtdfile, priv->offset + offsetbytes, SEEK_SET);
+      buffer      += chunk;
+      offsetbytes += chunk;
+      remaining   -= chunk;
+    }
 
-  return file_read(&priv->mtdfile, buffer, nbytes);
+  return nbytes;
 }
 
 /****************************************************************************
@@ -230,9 +507,9 @@ static int filemtd_erase(FAR struct mtd_dev_s *dev, off_t startblock,
                          size_t nblocks)
 {
   FAR struct file_dev_s *priv = (FAR struct file_dev_s *)dev;
-  size_t    nbytes;
-  size_t    offset;
-  char      buffer[128];
+  off_t endblock;
+  off_t block;
+  int ret;
 
   DEBUGASSERT(dev);
 
@@ -248,28 +525,39 @@ static int filemtd_erase(FAR struct mtd_dev_s *dev, off_t startblock,
       nblocks = priv->nblocks - startblock;
     }
 
-  /* Convert the erase block to a logical block and the number of blocks
-   * in logical block numbers
-   */
+  /* Erase each run of blocks that are not already known to be erased */
 
-  startblock *= FILEMTD_BLKPER;
-  nblocks    *= FILEMTD_BLKPER;
+  endblock = startblock + nblocks;
+  for (block = startblock; block < endblock; )
+    {
+      off_t first = block;
 
-  /* Get the offset corresponding to the first block and the size
-   * corresponding to the number of blocks.
-   */
+      while (block < endblock && !filemtd_iserased(priv, block))
+        {
+          block++;
+        }
 
-  offset = startblock * priv->blocksize;
-  nbytes = nblocks * priv->blocksize;
+      if (block > first)
+        {
+          ret = filemtd_fileerase(priv, first, block - first);
+          if (ret < 0)
+            {
+              return ret;
+            }
 
-  /* Then erase the data in the file */
+          while (first < block)
+            {
+              filemtd_seterased(priv, first);
+              first++;
+            }
+        }
 
-  file_seek(&priv->mtdfile, priv->offset + offset, SEEK_SET);
-  memset(buffer, CONFIG_FILEMTD_ERASESTATE, sizeof(buffer));
-  while (nbytes)
-    {
-      file_write(&priv->mtdfile, buffer, sizeof(buffer));
-      nbytes -= sizeof(buffer);
+      /* Skip the blocks that are already erased */
+
+      while (block < endblock && filemtd_iserased(priv, block))
+        {
+          block++;
+        }
     }
 
   return OK;
@@ -286,6 +574,7 @@ static ssize_t filemtd_bread(FAR struct mtd_dev_s *dev, off_t startblock,
   off_t offset;
   off_t maxblock;
   size_t nbytes;
+  ssize_t ret;
 
   DEBUGASSERT(dev && buf);
 
@@ -311,8 +600,8 @@ static ssize_t filemtd_bread(FAR struct mtd_dev_s *dev, off_t startblock,
 
   /* Then read the data from the file */
 
-  filemtd_read(priv, buf, offset, nbytes);
-  return nblocks;
+  ret = filemtd_read(priv, buf, offset, nbytes);
+  return ret < 0 ? ret : ret / priv->blocksize;
 }
 
 /****************************************************************************
@@ -326,6 +615,7 @@ static ssize_t filemtd_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
   off_t offset;
   off_t maxblock;
   size_t nbytes;
+  ssize_t ret;
 
   DEBUGASSERT(dev && buf);
 
@@ -351,8 +641,8 @@ static ssize_t filemtd_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
 
   /* Then write the data to the file */
 
-  filemtd_write(priv, offset, buf, nbytes);
-  return nblocks;
+  ret = filemtd_write(priv, offset, buf, nbytes);
+  return ret < 0 ? ret : nblocks;
 }
 
 /****************************************************************************
@@ -373,8 +663,7 @@ static ssize_t filemtd_byteread(FAR struct mtd_dev_s *dev, off_t offset,
       return 0;
     }
 
-  filemtd_read(priv, buf, offset, nbytes);
-  return nbytes;
+  return filemtd_read(priv, buf, offset, nbytes);
 }
 
 /****************************************************************************
@@ -400,8 +689,7 @@ static ssize_t file_bytewrite(FAR struct mtd_dev_s *dev, off_t offset,
 
   /* Then write the data to the file */
 
-  filemtd_write(priv, offset, buf, nbytes);
-  return nbytes;
+  return filemtd_write(priv, offset, buf, nbytes);
 }
 #endif
 
@@ -456,8 +744,7 @@ static int filemtd_ioctl(FAR struct mtd_dev_s *dev, int cmd,
         {
           /* Erase the entire device */
 
-          filemtd_erase(dev, 0, priv->nblocks);
-          ret = OK;
+          ret = filemtd_erase(dev, 0, priv->nblocks);
         }
         break;
 
@@ -561,6 +848,32 @@ FAR struct mtd_dev_s *blockmtd_initialize(FAR const char *path,
       return NULL;
     }
 
+  /* Allocate the read-modify-write buffer */
+
+  priv->buffer = (FAR uint8_t *)kmm_malloc(priv->blocksize);
+  if (priv->buffer == NULL)
+    {
+      ferr("ERROR: Failed to allocate the FILE MTD buffer\n");
+      goto errout_with_file;
+    }
+
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  /* Nothing is known to be erased yet */
+
+  priv->erasemap = (FAR uint8_t *)kmm_zalloc((nblocks + 7) >> 3);
+  if (priv->erasemap == NULL)
+    {
+      ferr("ERROR: Failed to allocate the FILE MTD erase map\n");
+      kmm_free(priv->buffer);
+      goto errout_with_file;
+    }
+
+  /* Check if the device extends to the end of the file */
+
+  priv->tail = file_seek(&priv->mtdfile, 0, SEEK_END) ==
+               offset + nblocks * priv->erasesize;
+#endif
+
   /* Perform initialization as necessary. (unsupported methods were
    * nullified by kmm_zalloc).
    */
@@ -578,6 +891,11 @@ FAR struct mtd_dev_s *blockmtd_initialize(FAR const char *path,
   priv->nblocks    = nblocks;
 
   return &priv->mtd;
+
+errout_with_file:
+  file_close(&priv->mtdfile);
+  kmm_free(priv);
+  return NULL;
 }
 
 /****************************************************************************
@@ -608,6 +926,10 @@ void blockmtd_teardown(FAR struct mtd_dev_s *dev)
 
   /* Free the memory */
 
+#ifdef CONFIG_FILEMTD_ERASEMAP
+  kmm_free(priv->erasemap);
+#endif
+  kmm_free(priv->buffer);
   kmm_free(priv);
 }
 
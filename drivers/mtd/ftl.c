@@ -38,88 +38,1209 @@
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/drivers/rwbuffer.h>
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+#  include <crc32.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Check if read/write buffer support is needed */
+
+#if defined(CONFIG_FTL_READAHEAD) || defined(CONFIG_FTL_WRITEBUFFER)
+#  define FTL_HAVE_RWBUFFER 1
+#endif
+
+/* The maximum length of the device name paths is the maximum length of a
+ * name plus 5 for the the length of "/dev/" and a NUL terminator.
+ */
+
+#define DEV_NAME_MAX    (NAME_MAX + 5)
+
+/* Log-structured translation layer.  Each erase block is a segment of
+ * 'ndata' data sectors followed by 'nsum' summary sectors.  Sectors are
+ * only written into the one open segment, and the summary, which records
+ * the logical sector held by each data sector, is written when the segment
+ * is committed.  Committed summaries are the checkpoints from which the
+ * sector map is rebuilt at initialization time:  anything written after
+ * the last commit is lost on power failure, but the previously committed
+ * contents are kept intact until a later commit supersedes them.
+ */
+
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+#  ifndef CONFIG_FTL_LOG_NRESERVE
+#    define CONFIG_FTL_LOG_NRESERVE 4
+#  endif
+
+#  ifndef CONFIG_FTL_LOG_WEARDIFF
+#    define CONFIG_FTL_LOG_WEARDIFF 64
+#  endif
+
+#  ifndef CONFIG_FTL_LOG_SYNCDELAY
+#    define CONFIG_FTL_LOG_SYNCDELAY 0
+#  endif
+
+#  if !defined(CONFIG_SCHED_WORKQUEUE) && CONFIG_FTL_LOG_SYNCDELAY != 0
+#    error "Worker thread support is required (CONFIG_SCHED_WORKQUEUE)"
+#  endif
+
+/* Writes collect garbage until this many segments are free or can be
+ * reclaimed at the next commit.  The idle worker aims for all of the
+ * reserved segments but the open one.
+ */
+
+#  define FTL_LOG_GCMIN     2
+#  define FTL_LOG_GCIDLE    (CONFIG_FTL_LOG_NRESERVE - 1)
+
+#  if CONFIG_FTL_LOG_NRESERVE <= FTL_LOG_GCMIN
+#    error "CONFIG_FTL_LOG_NRESERVE is too small"
+#  endif
+
+#  define FTL_LOG_MAGIC     0x474f4c46 /* "FLOG" */
+#  define FTL_LOG_UNMAPPED  UINT32_MAX
+#  define FTL_LOG_SUMHDR    offsetof(struct ftl_sum_s, lsn)
+
+/* Segment states */
+
+#  define FTL_SEG_FREE      0 /* Erased */
+#  define FTL_SEG_DIRTY     1 /* Must be erased before use */
+#  define FTL_SEG_OPEN      2 /* Being written */
+#  define FTL_SEG_USED      3 /* Committed */
+#  define FTL_SEG_BAD       4 /* Could not be erased */
+#  define FTL_SEG_NOSUM     5 /* Closed, but the summary write failed */
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+/* In-memory state of one segment */
+
+struct ftl_seg_s
+{
+  uint32_t ec;                    /* Erase count */
+  uint16_t live;                  /* Number of live data sectors */
+  uint8_t  state;                 /* See FTL_SEG_* definitions */
+};
+
+/* On-flash segment summary */
+
+struct ftl_sum_s
+{
+  uint32_t magic;                 /* FTL_LOG_MAGIC */
+  uint32_t seq;                   /* Commit sequence number */
+  uint32_t ec;                    /* Erase count of the segment */
+  uint32_t crc;                   /* CRC32 of the fields above and lsn[] */
+  uint32_t lsn[1];                /* Logical sector of each data sector */
+};
+
+/* Used to replay the summaries in commit order */
+
+struct ftl_order_s
+{
+  uint32_t seq;
+  int      seg;
+};
+#endif
+
+struct ftl_struct_s
+{
+  FAR struct mtd_dev_s *mtd;      /* Contained MTD interface */
+  struct mtd_geometry_s geo;      /* Device geometry */
+#ifdef FTL_HAVE_RWBUFFER
+  struct rwbuffer_s     rwb;      /* Read-ahead/write buffer support */
+#endif
+  uint16_t              blkper;   /* R/W blocks per erase block */
+  uint16_t              refs;     /* Number of references */
+  bool                  unlinked; /* The driver has been unlinked */
+  FAR uint8_t          *eblock;   /* One, in-memory erase block */
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  mutex_t               lock;     /* Protects the translation state */
+  FAR struct ftl_seg_s *segs;     /* State of each segment */
+  FAR uint32_t         *map;      /* Logical to physical sector map */
+  FAR struct ftl_sum_s *sum;      /* Summary of the open segment */
+  FAR struct ftl_sum_s *gcsum;    /* Summary of the GC victim */
+  FAR uint8_t          *page;     /* Sector being relocated */
+  uint32_t              nsectors; /* Number of logical sectors */
+  uint32_t              seq;      /* Next commit sequence number */
+  uint16_t              nsum;     /* Summary sectors per segment */
+  uint16_t              ndata;    /* Data sectors per segment */
+  uint16_t              wpage;    /* Next sector of the open segment */
+  uint16_t              vpage;    /* Next sector of the victim to examine */
+  int                   nsegs;    /* Number of segments */
+  int                   open;     /* Open segment or -1 */
+  int                   victim;   /* GC victim segment or -1 */
+  int                   nfree;    /* Number of free or dirty segments */
+  int                   npending; /* Committed segments without live data */
+  int                   nnosum;   /* Segments in the FTL_SEG_NOSUM state */
+#  if CONFIG_FTL_LOG_SYNCDELAY != 0
+  struct work_s         work;     /* Delayed commit */
+  sem_t                 wkexit;   /* Posted by workers seeing 'closing' */
+  uint8_t               wkpend;   /* Worker runs not yet holding 'lock' */
+  bool                  closing;  /* ftl_log_uninitialize() is waiting */
+#  endif
+#endif
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     ftl_open(FAR struct inode *inode);
+static int     ftl_close(FAR struct inode *inode);
+static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
+                 off_t startblock, size_t nblocks);
+static ssize_t ftl_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                 blkcnt_t start_sector, unsigned int nsectors);
+static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
+                 off_t startblock, size_t nblocks);
+static ssize_t ftl_write(FAR struct inode *inode,
+                 FAR const unsigned char *buffer, blkcnt_t start_sector,
+                 unsigned int nsectors);
+static int     ftl_geometry(FAR struct inode *inode,
+                 FAR struct geometry *geometry);
+static int     ftl_ioctl(FAR struct inode *inode, int cmd,
+                 unsigned long arg);
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     ftl_unlink(FAR struct inode *inode);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  ftl_open,     /* open     */
+  ftl_close,    /* close    */
+  ftl_read,     /* read     */
+  ftl_write,    /* write    */
+  ftl_geometry, /* geometry */
+  ftl_ioctl     /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , ftl_unlink  /* unlink   */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ftl_log_crc
+ *
+ * Description: Checksum a segment summary
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+static uint32_t ftl_log_crc(FAR struct ftl_struct_s *dev,
+                            FAR const struct ftl_sum_s *sum)
+{
+  uint32_t crc;
+
+  crc = crc32((FAR const uint8_t *)sum, offsetof(struct ftl_sum_s, crc));
+  return crc32part((FAR const uint8_t *)sum->lsn,
+                   dev->ndata * sizeof(uint32_t), crc);
+}
+
+/****************************************************************************
+ * Name: ftl_log_kill
+ *
+ * Description: A data sector has been superseded by a newer copy
+ *
+ ****************************************************************************/
+
+static void ftl_log_kill(FAR struct ftl_struct_s *dev, uint32_t psn)
+{
+  FAR struct ftl_seg_s *seg = &dev->segs[psn / dev->blkper];
+
+  DEBUGASSERT(seg->live > 0);
+  if (--seg->live == 0)
+    {
+      if (seg->state == FTL_SEG_USED)
+        {
+          dev->npending++;
+        }
+      else if (seg->state == FTL_SEG_NOSUM)
+        {
+          /* Nothing refers to it and it is ignored at initialization */
+
+          seg->state = FTL_SEG_DIRTY;
+          dev->nnosum--;
+          dev->nfree++;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_log_reclaim
+ *
+ * Description:
+ *   Called after a commit:  every newer copy of the data in a committed
+ *   segment without live sectors is now committed as well, so that segment
+ *   may be erased and reused.  That is not so while a segment whose
+ *   summary could not be written still holds live data:  the segments it
+ *   superseded hold the only copies that survive a reset.
+ *
+ ****************************************************************************/
+
+static void ftl_log_reclaim(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_seg_s *seg;
+  int i;
+
+  if (dev->nnosum > 0)
+    {
+      return;
+    }
+
+  for (i = 0; dev->npending > 0 && i < dev->nsegs; i++)
+    {
+      seg = &dev->segs[i];
+      if (seg->state == FTL_SEG_USED && seg->live == 0)
+        {
+          seg->state = FTL_SEG_DIRTY;
+          dev->npending--;
+          dev->nfree++;
+
+          if (i == dev->victim)
+            {
+              dev->victim = -1;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_log_wearlevel
+ *
+ * Description:
+ *   Static wear leveling:  if the least erased segment holding data has
+ *   fallen too far behind the most erased one, select it as the next GC
+ *   victim so that its cold data moves and the segment rejoins the pool.
+ *   This is only done while there is space to spare.
+ *
+ ****************************************************************************/
+
+static void ftl_log_wearlevel(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_seg_s *seg;
+  uint32_t maxec = 0;
+  ssize_t nxfrd;
+  int cold = -1;
+  int i;
+
+  if (dev->victim >= 0 || dev->nfree < FTL_LOG_GCMIN)
+    {
+      return;
+    }
+
+  for (i = 0; i < dev->nsegs; i++)
+    {
+      seg = &dev->segs[i];
+      if (seg->state != FTL_SEG_BAD && seg->ec > maxec)
+        {
+          maxec = seg->ec;
+        }
+
+      if (seg->state == FTL_SEG_USED && seg->live > 0 &&
+          (cold < 0 || seg->ec < dev->segs[cold].ec))
+        {
+          cold = i;
+        }
+    }
+
+  if (cold < 0 || maxec - dev->segs[cold].ec <= CONFIG_FTL_LOG_WEARDIFF)
+    {
+      return;
+    }
+
+  nxfrd = MTD_BREAD(dev->mtd, (off_t)cold * dev->blkper + dev->ndata,
+                    dev->nsum, (FAR uint8_t *)dev->gcsum);
+  if (nxfrd == dev->nsum)
+    {
+      finfo("Wear leveling segment %d, erase count %" PRIu32 "\n",
+            cold, dev->segs[cold].ec);
+
+      dev->victim = cold;
+      dev->vpage  = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_log_commit
+ *
+ * Description: Write the summary of the open segment and close it
+ *
+ ****************************************************************************/
+
+static int ftl_log_commit(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_sum_s *sum = dev->sum;
+  FAR struct ftl_seg_s *seg;
+  off_t sumblock;
+  ssize_t nxfrd;
+
+  DEBUGASSERT(dev->open >= 0);
+
+  seg        = &dev->segs[dev->open];
+  sumblock   = (off_t)dev->open * dev->blkper + dev->ndata;
+  sum->magic = FTL_LOG_MAGIC;
+  sum->seq   = dev->seq++;
+  sum->ec    = seg->ec;
+  sum->crc   = ftl_log_crc(dev, sum);
+
+  nxfrd = MTD_BWRITE(dev->mtd, sumblock, dev->nsum,
+                     (FAR const uint8_t *)sum);
+
+  dev->open = -1;
+
+  /* Without the summary the data will be lost at the next reset, so keep
+   * the older copies that it superseded until ftl_log_rescue() has
+   * written the data again and committed it.
+   */
+
+  if (nxfrd != dev->nsum)
+    {
+      ferr("ERROR: Write summary %" PRIdOFF " failed: %zd\n",
+           sumblock, nxfrd);
+
+      if (seg->live == 0)
+        {
+          seg->state = FTL_SEG_DIRTY;
+          dev->nfree++;
+        }
+      else
+        {
+          seg->state = FTL_SEG_NOSUM;
+          dev->nnosum++;
+        }
+
+      return -EIO;
+    }
+
+  seg->state = FTL_SEG_USED;
+  if (seg->live == 0)
+    {
+      dev->npending++;
+    }
+
+  ftl_log_reclaim(dev);
+  ftl_log_wearlevel(dev);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_open
+ *
+ * Description: Open the least erased free segment for writing
+ *
+ ****************************************************************************/
+
+static int ftl_log_open(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_seg_s *seg;
+  int best;
+  int ret;
+  int i;
+
+  for (; ; )
+    {
+      best = -1;
+      for (i = 0; i < dev->nsegs; i++)
+        {
+          seg = &dev->segs[i];
+          if ((seg->state == FTL_SEG_FREE || seg->state == FTL_SEG_DIRTY) &&
+              (best < 0 || seg->ec < dev->segs[best].ec))
+            {
+              best = i;
+            }
+        }
+
+      if (best < 0)
+        {
+          ferr("ERROR: No free segment\n");
+          return -ENOSPC;
+        }
+
+      seg = &dev->segs[best];
+      if (seg->state == FTL_SEG_DIRTY)
+        {
+          ret = MTD_ERASE(dev->mtd, best, 1);
+          if (ret < 0)
+            {
+              ferr("ERROR: Erase block=%d failed: %d\n", best, ret);
+              seg->state = FTL_SEG_BAD;
+              dev->nfree--;
+              continue;
+            }
+
+          seg->ec++;
+        }
+
+      seg->state = FTL_SEG_OPEN;
+      dev->nfree--;
+      dev->open  = best;
+      dev->wpage = 0;
+
+      memset(dev->sum, 0xff, dev->nsum * dev->geo.blocksize);
+      return OK;
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_log_prepare
+ *
+ * Description: Make sure that the open segment has room for a sector
+ *
+ ****************************************************************************/
+
+static int ftl_log_prepare(FAR struct ftl_struct_s *dev)
+{
+  int ret;
+
+  if (dev->open >= 0)
+    {
+      if (dev->wpage < dev->ndata)
+        {
+          return OK;
+        }
+
+      ret = ftl_log_commit(dev);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return ftl_log_open(dev);
+}
+
+/****************************************************************************
+ * Name: ftl_log_append
+ *
+ * Description:
+ *   Write consecutive logical sectors to the open segment, which must have
+ *   room for all of them, and remap them there.
+ *
+ ****************************************************************************/
+
+static int ftl_log_append(FAR struct ftl_struct_s *dev, uint32_t lsn,
+                          FAR const uint8_t *buffer, size_t nsectors)
+{
+  uint32_t psn;
+  ssize_t nxfrd;
+  size_t page;
+  size_t i;
+
+  DEBUGASSERT(dev->open >= 0 && dev->wpage + nsectors <= dev->ndata);
+
+  page  = dev->wpage;
+  psn   = (uint32_t)dev->open * dev->blkper + page;
+  nxfrd = MTD_BWRITE(dev->mtd, psn, nsectors, buffer);
+
+  /* The sectors are used up even if the write failed */
+
+  dev->wpage += nsectors;
+  if (nxfrd != nsectors)
+    {
+      ferr("ERROR: Write %zu sectors at %" PRIu32 " failed: %zd\n",
+           nsectors, psn, nxfrd);
+      return -EIO;
+    }
+
+  for (i = 0; i < nsectors; i++)
+    {
+      if (dev->map[lsn + i] != FTL_LOG_UNMAPPED)
+        {
+          ftl_log_kill(dev, dev->map[lsn + i]);
+        }
+
+      dev->map[lsn + i]       = psn + i;
+      dev->sum->lsn[page + i] = lsn + i;
+    }
+
+  dev->segs[dev->open].live += nsectors;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_rescue
+ *
+ * Description:
+ *   Write the live sectors of the segments whose summary could not be
+ *   written to the open segment again.  Once they have all been moved,
+ *   the next commit makes them durable.  There is no summary to tell which
+ *   logical sectors such a segment holds, so the sector map is searched.
+ *
+ ****************************************************************************/
+
+static int ftl_log_rescue(FAR struct ftl_struct_s *dev)
+{
+  uint32_t lsn;
+  uint32_t psn;
+  ssize_t nxfrd;
+  int ret;
+
+  /* A failed commit in here may leave live sectors behind the search */
+
+  while (dev->nnosum > 0)
+    {
+      for (lsn = 0; lsn < dev->nsectors && dev->nnosum > 0; lsn++)
+        {
+          psn = dev->map[lsn];
+          if (psn == FTL_LOG_UNMAPPED ||
+              dev->segs[psn / dev->blkper].state != FTL_SEG_NOSUM)
+            {
+              continue;
+            }
+
+          ret = ftl_log_prepare(dev);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          nxfrd = MTD_BREAD(dev->mtd, psn, 1, dev->page);
+          if (nxfrd != 1)
+            {
+              ferr("ERROR: Read sector %" PRIu32 " failed: %zd\n",
+                   psn, nxfrd);
+              return -EIO;
+            }
+
+          ret = ftl_log_append(dev, lsn, dev->page, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_victim
+ *
+ * Description:
+ *   Select the committed segment with the fewest live sectors for garbage
+ *   collection and read in its summary.
+ *
+ ****************************************************************************/
+
+static int ftl_log_victim(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_seg_s *seg;
+  ssize_t nxfrd;
+  int best = -1;
+  int i;
+
+  for (i = 0; i < dev->nsegs; i++)
+    {
+      seg = &dev->segs[i];
+      if (seg->state == FTL_SEG_USED && seg->live > 0 &&
+          (best < 0 || seg->live < dev->segs[best].live ||
+           (seg->live == dev->segs[best].live &&
+            seg->ec < dev->segs[best].ec)))
+        {
+          best = i;
+        }
+    }
+
+  /* Nothing to gain if every segment is full of live data */
+
+  if (best < 0 || dev->segs[best].live >= dev->ndata)
+    {
+      return -ENOSPC;
+    }
+
+  nxfrd = MTD_BREAD(dev->mtd, (off_t)best * dev->blkper + dev->ndata,
+                    dev->nsum, (FAR uint8_t *)dev->gcsum);
+  if (nxfrd != dev->nsum)
+    {
+      ferr("ERROR: Read summary of segment %d failed: %zd\n", best, nxfrd);
+      return -EIO;
+    }
+
+  dev->victim = best;
+  dev->vpage  = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_log_collect
+ *
+ * Description:
+ *   Garbage collection:  move the live sectors out of victim segments
+ *   until 'target' segments are free or reclaimable.  A victim that is
+ *   already being collected is continued for up to 'budget' sectors even
+ *   if there is enough space.
+ *
+ * Returned Value:
+ *   The number of sectors moved or a negated errno value.  -ENOSPC means
+ *   that no segment is worth collecting.
+ *
+ ****************************************************************************/
+
+static int ftl_log_collect(FAR struct ftl_struct_s *dev, int target,
+                           int budget)
+{
+  uint32_t lsn;
+  uint32_t psn;
+  ssize_t nxfrd;
+  int moved = 0;
+  int ret;
+
+  ret = ftl_log_rescue(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while (dev->nfree + dev->npending < target ||
+         (dev->victim >= 0 && moved < budget))
+    {
+      if (dev->victim < 0)
+        {
+          ret = ftl_log_victim(dev);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      if (dev->vpage >= dev->ndata || dev->segs[dev->victim].live == 0)
+        {
+          dev->victim = -1;
+          continue;
+        }
+
+      /* Skip sectors that have been rewritten since */
+
+      lsn = dev->gcsum->lsn[dev->vpage];
+      psn = (uint32_t)dev->victim * dev->blkper + dev->vpage++;
+      if (lsn >= dev->nsectors || dev->map[lsn] != psn)
+        {
+          continue;
+        }
+
+      ret = ftl_log_prepare(dev);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      nxfrd = MTD_BREAD(dev->mtd, psn, 1, dev->page);
+      if (nxfrd != 1)
+        {
+          ferr("ERROR: Read sector %" PRIu32 " failed: %zd\n", psn, nxfrd);
+          return -EIO;
+        }
+
+      ret = ftl_log_append(dev, lsn, dev->page, 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      moved++;
+    }
+
+  return moved;
+}
+
+/****************************************************************************
+ * Name: ftl_log_cancel
+ *
+ * Description:
+ *   Cancel the delayed commit if it is still queued.  Called with the lock
+ *   held.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+static void ftl_log_cancel(FAR struct ftl_struct_s *dev)
+{
+  if (work_cancel(LPWORK, &dev->work) == OK)
+    {
+      dev->wkpend--;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_log_timeout
+ *
+ * Description:
+ *   Runs on the low priority work queue once writes have stopped for a
+ *   while:  collect garbage ahead of the next burst of writes, then commit
+ *   the open segment.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+static void ftl_log_timeout(FAR void *arg)
+{
+  FAR struct ftl_struct_s *dev = (FAR struct ftl_struct_s *)arg;
+
+  nxmutex_lock(&dev->lock);
+
+  /* Let ftl_log_uninitialize() know that this run is over */
+
+  dev->wkpend--;
+  if (dev->closing)
+    {
+      nxmutex_unlock(&dev->lock);
+      nxsem_post(&dev->wkexit);
+      return;
+    }
+
+  ftl_log_collect(dev, FTL_LOG_GCIDLE, dev->ndata);
+  if (dev->open >= 0 && dev->wpage > 0)
+    {
+      ftl_log_commit(dev);
+    }
+
+  nxmutex_unlock(&dev->lock);
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_log_read
+ *
+ * Description: Read logical sectors through the sector map
+ *
+ ****************************************************************************/
+
+static ssize_t ftl_log_read(FAR struct ftl_struct_s *dev,
+                            FAR uint8_t *buffer, off_t startblock,
+                            size_t nblocks)
+{
+  size_t remaining = nblocks;
+  uint32_t psn;
+  ssize_t nxfrd;
+  size_t n;
+  int ret = OK;
+
+  if (startblock < 0 || startblock + nblocks > dev->nsectors)
+    {
+      return -EINVAL;
+    }
+
+  nxmutex_lock(&dev->lock);
+
+  while (remaining > 0)
+    {
+      psn = dev->map[startblock];
+      if (psn == FTL_LOG_UNMAPPED)
+        {
+          /* Never written sectors read back as erased FLASH */
+
+          memset(buffer, 0xff, dev->geo.blocksize);
+          n = 1;
+        }
+      else
+        {
+          /* Read physically contiguous sectors together */
+
+          n = 1;
+          while (n < remaining && dev->map[startblock + n] == psn + n)
+            {
+              n++;
+            }
+
+          nxfrd = MTD_BREAD(dev->mtd, psn, n, buffer);
+          if (nxfrd != n)
+            {
+              ferr("ERROR: Read %zu sectors at %" PRIu32 " failed: %zd\n",
+                   n, psn, nxfrd);
+              ret = -EIO;
+              break;
+            }
+        }
+
+      startblock += n;
+      remaining  -= n;
+      buffer     += n * dev->geo.blocksize;
+    }
+
+  nxmutex_unlock(&dev->lock);
+  return ret < 0 ? ret : nblocks;
+}
+
+/****************************************************************************
+ * Name: ftl_log_write
+ *
+ * Description:
+ *   Append logical sectors to the log, collecting garbage first if free
+ *   segments are running out.
+ *
+ ****************************************************************************/
+
+static ssize_t ftl_log_write(FAR struct ftl_struct_s *dev,
+                             FAR const uint8_t *buffer, off_t startblock,
+                             size_t nblocks)
+{
+  size_t remaining = nblocks;
+  size_t n;
+  int ret = OK;
+
+  if (startblock < 0 || startblock + nblocks > dev->nsectors)
+    {
+      return -EINVAL;
+    }
+
+  nxmutex_lock(&dev->lock);
+
+  while (remaining > 0)
+    {
+      ret = ftl_log_collect(dev, FTL_LOG_GCMIN, dev->ndata);
+      if (ret < 0 && ret != -ENOSPC)
+        {
+          break;
+        }
+
+      ret = ftl_log_prepare(dev);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      n = dev->ndata - dev->wpage;
+      if (n > remaining)
+        {
+          n = remaining;
+        }
+
+      ret = ftl_log_append(dev, startblock, buffer, n);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      startblock += n;
+      remaining  -= n;
+      buffer     += n * dev->geo.blocksize;
+    }
+
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+  ftl_log_cancel(dev);
+  work_queue(LPWORK, &dev->work, ftl_log_timeout, dev,
+             MSEC2TICK(CONFIG_FTL_LOG_SYNCDELAY));
+  dev->wkpend++;
+#endif
+
+  nxmutex_unlock(&dev->lock);
+  return ret < 0 ? ret : nblocks;
+}
+
 /****************************************************************************
- * Pre-processor Definitions
+ * Name: ftl_log_sync
+ *
+ * Description: Commit everything written so far
+ *
  ****************************************************************************/
 
-/* Check if read/write buffer support is needed */
+static int ftl_log_sync(FAR struct ftl_struct_s *dev)
+{
+  int ret = OK;
 
-#if defined(CONFIG_FTL_READAHEAD) || defined(CONFIG_FTL_WRITEBUFFER)
-#  define FTL_HAVE_RWBUFFER 1
+  nxmutex_lock(&dev->lock);
+
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+  ftl_log_cancel(dev);
 #endif
 
-/* The maximum length of the device name paths is the maximum length of a
- * name plus 5 for the the length of "/dev/" and a NUL terminator.
- */
+  ret = ftl_log_rescue(dev);
+  if (ret >= 0 && dev->open >= 0 && dev->wpage > 0)
+    {
+      ret = ftl_log_commit(dev);
+    }
 
-#define DEV_NAME_MAX    (NAME_MAX + 5)
+  nxmutex_unlock(&dev->lock);
+  return ret;
+}
 
 /****************************************************************************
- * Private Types
+ * Name: ftl_log_format
+ *
+ * Description: The whole device has been erased underneath the log
+ *
  ****************************************************************************/
 
-struct ftl_struct_s
+static void ftl_log_format(FAR struct ftl_struct_s *dev)
 {
-  FAR struct mtd_dev_s *mtd;      /* Contained MTD interface */
-  struct mtd_geometry_s geo;      /* Device geometry */
-#ifdef FTL_HAVE_RWBUFFER
-  struct rwbuffer_s     rwb;      /* Read-ahead/write buffer support */
-#endif
-  uint16_t              blkper;   /* R/W blocks per erase block */
-  uint16_t              refs;     /* Number of references */
-  bool                  unlinked; /* The driver has been unlinked */
-  FAR uint8_t          *eblock;   /* One, in-memory erase block */
-};
+  FAR struct ftl_seg_s *seg;
+  int i;
+
+  nxmutex_lock(&dev->lock);
+
+  dev->nfree = 0;
+  for (i = 0; i < dev->nsegs; i++)
+    {
+      seg = &dev->segs[i];
+      if (seg->state != FTL_SEG_BAD)
+        {
+          seg->state = FTL_SEG_FREE;
+          seg->live  = 0;
+          seg->ec++;
+          dev->nfree++;
+        }
+    }
+
+  memset(dev->map, 0xff, dev->nsectors * sizeof(uint32_t));
+  dev->open     = -1;
+  dev->victim   = -1;
+  dev->npending = 0;
+  dev->nnosum   = 0;
+
+  nxmutex_unlock(&dev->lock);
+}
 
 /****************************************************************************
- * Private Function Prototypes
+ * Name: ftl_log_compare
+ *
+ * Description: qsort() comparison of commit sequence numbers
+ *
  ****************************************************************************/
 
-static int     ftl_open(FAR struct inode *inode);
-static int     ftl_close(FAR struct inode *inode);
-static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
-                 off_t startblock, size_t nblocks);
-static ssize_t ftl_read(FAR struct inode *inode, FAR unsigned char *buffer,
-                 blkcnt_t start_sector, unsigned int nsectors);
-static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
-                 off_t startblock, size_t nblocks);
-static ssize_t ftl_write(FAR struct inode *inode,
-                 FAR const unsigned char *buffer, blkcnt_t start_sector,
-                 unsigned int nsectors);
-static int     ftl_geometry(FAR struct inode *inode,
-                 FAR struct geometry *geometry);
-static int     ftl_ioctl(FAR struct inode *inode, int cmd,
-                 unsigned long arg);
-#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-static int     ftl_unlink(FAR struct inode *inode);
-#endif
+static int ftl_log_compare(FAR const void *a, FAR const void *b)
+{
+  FAR const struct ftl_order_s *oa = (FAR const struct ftl_order_s *)a;
+  FAR const struct ftl_order_s *ob = (FAR const struct ftl_order_s *)b;
+
+  if (oa->seq != ob->seq)
+    {
+      return oa->seq < ob->seq ? -1 : 1;
+    }
+
+  return 0;
+}
 
 /****************************************************************************
- * Private Data
+ * Name: ftl_log_uninitialize
+ *
+ * Description: Free the translation state
+ *
  ****************************************************************************/
 
-static const struct block_operations g_bops =
+static void ftl_log_uninitialize(FAR struct ftl_struct_s *dev)
 {
-  ftl_open,     /* open     */
-  ftl_close,    /* close    */
-  ftl_read,     /* read     */
-  ftl_write,    /* write    */
-  ftl_geometry, /* geometry */
-  ftl_ioctl     /* ioctl    */
-#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-  , ftl_unlink  /* unlink   */
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+  int nwait;
+
+  /* work_cancel() does not wait for a worker that has already been taken
+   * off the queue.  Such a worker still has to take the lock, so tell it
+   * to return at once and wait until it has.
+   */
+
+  nxmutex_lock(&dev->lock);
+  ftl_log_cancel(dev);
+  dev->closing = true;
+  nwait        = dev->wkpend;
+  nxmutex_unlock(&dev->lock);
+
+  while (nwait-- > 0)
+    {
+      nxsem_wait_uninterruptible(&dev->wkexit);
+    }
+
+  nxsem_destroy(&dev->wkexit);
 #endif
-};
+
+  nxmutex_destroy(&dev->lock);
+  kmm_free(dev->segs);
+  kmm_free(dev->map);
+  kmm_free(dev->sum);
+  kmm_free(dev->gcsum);
+  kmm_free(dev->page);
+  dev->map = NULL;
+}
 
 /****************************************************************************
- * Private Functions
+ * Name: ftl_log_initialize
+ *
+ * Description:
+ *   Lay out the segments and rebuild the sector map by replaying the
+ *   committed summaries in the order that they were written.
+ *
+ * Returned Value:
+ *   Zero on success.  -EINVAL means that the geometry cannot hold the log.
+ *
  ****************************************************************************/
 
+static int ftl_log_initialize(FAR struct ftl_struct_s *dev)
+{
+  FAR struct ftl_order_s *order;
+  FAR struct ftl_sum_s *sum;
+  FAR struct ftl_seg_s *seg;
+  uint64_t ectotal = 0;
+  uint32_t psn;
+  uint32_t lsn;
+  ssize_t nxfrd;
+  int nused = 0;
+  int ret = -ENOMEM;
+  int i;
+  int j;
+
+  /* Find the smallest summary that describes the rest of the segment */
+
+  for (dev->nsum = 1; dev->nsum < dev->blkper; dev->nsum++)
+    {
+      if (FTL_LOG_SUMHDR + (dev->blkper - dev->nsum) * sizeof(uint32_t) <=
+          dev->nsum * dev->geo.blocksize)
+        {
+          break;
+        }
+    }
+
+  dev->ndata = dev->blkper - dev->nsum;
+  dev->nsegs = dev->geo.neraseblocks;
+  if (dev->ndata == 0 || dev->nsegs <= CONFIG_FTL_LOG_NRESERVE)
+    {
+      return -EINVAL;
+    }
+
+  dev->nsectors = (dev->nsegs - CONFIG_FTL_LOG_NRESERVE) * dev->ndata;
+
+  dev->segs  = kmm_zalloc(dev->nsegs * sizeof(struct ftl_seg_s));
+  dev->map   = kmm_malloc(dev->nsectors * sizeof(uint32_t));
+  dev->sum   = kmm_malloc(dev->nsum * dev->geo.blocksize);
+  dev->gcsum = kmm_malloc(dev->nsum * dev->geo.blocksize);
+  dev->page  = kmm_malloc(dev->geo.blocksize);
+  order      = kmm_malloc(dev->nsegs * sizeof(struct ftl_order_s));
+
+  if (dev->segs == NULL || dev->map == NULL || dev->sum == NULL ||
+      dev->gcsum == NULL || dev->page == NULL || order == NULL)
+    {
+      goto errout;
+    }
+
+  /* Find the committed segments */
+
+  sum = dev->gcsum;
+  for (i = 0; i < dev->nsegs; i++)
+    {
+      seg   = &dev->segs[i];
+      nxfrd = MTD_BREAD(dev->mtd, (off_t)i * dev->blkper + dev->ndata,
+                        dev->nsum, (FAR uint8_t *)sum);
+      if (nxfrd == dev->nsum && sum->magic == FTL_LOG_MAGIC &&
+          sum->crc == ftl_log_crc(dev, sum))
+        {
+          seg->state        = FTL_SEG_USED;
+          seg->ec           = sum->ec;
+          ectotal          += sum->ec;
+          order[nused].seq  = sum->seq;
+          order[nused].seg  = i;
+          nused++;
+        }
+      else
+        {
+          seg->state = FTL_SEG_DIRTY;
+        }
+    }
+
+  /* Replay them in commit order so that the newest copy of each sector
+   * wins.
+   */
+
+  qsort(order, nused, sizeof(struct ftl_order_s), ftl_log_compare);
+  memset(dev->map, 0xff, dev->nsectors * sizeof(uint32_t));
+
+  for (i = 0; i < nused; i++)
+    {
+      psn   = (uint32_t)order[i].seg * dev->blkper;
+      nxfrd = MTD_BREAD(dev->mtd, psn + dev->ndata, dev->nsum,
+                        (FAR uint8_t *)sum);
+      if (nxfrd != dev->nsum)
+        {
+          ferr("ERROR: Read summary of segment %d failed: %zd\n",
+               order[i].seg, nxfrd);
+          ret = -EIO;
+          goto errout;
+        }
+
+      for (j = 0; j < dev->ndata; j++)
+        {
+          lsn = sum->lsn[j];
+          if (lsn < dev->nsectors)
+            {
+              dev->map[lsn] = psn + j;
+            }
+        }
+    }
+
+  dev->seq = nused > 0 ? order[nused - 1].seq + 1 : 1;
+
+  for (lsn = 0; lsn < dev->nsectors; lsn++)
+    {
+      if (dev->map[lsn] != FTL_LOG_UNMAPPED)
+        {
+          dev->segs[dev->map[lsn] / dev->blkper].live++;
+        }
+    }
+
+  /* Segments without live data are free.  The erase count of the ones
+   * that were never committed is not known, so assume the average.
+   */
+
+  for (i = 0; i < dev->nsegs; i++)
+    {
+      seg = &dev->segs[i];
+      if (seg->state == FTL_SEG_DIRTY)
+        {
+          seg->ec = nused > 0 ? ectotal / nused : 0;
+        }
+      else if (seg->live == 0)
+        {
+          seg->state = FTL_SEG_DIRTY;
+        }
+
+      if (seg->state == FTL_SEG_DIRTY)
+        {
+          dev->nfree++;
+        }
+    }
+
+  finfo("%d segments, %d committed, %" PRIu32 " sectors, %d free\n",
+        dev->nsegs, nused, dev->nsectors, dev->nfree);
+
+  dev->open   = -1;
+  dev->victim = -1;
+
+  nxmutex_init(&dev->lock);
+#if CONFIG_FTL_LOG_SYNCDELAY != 0
+  nxsem_init(&dev->wkexit, 0, 0);
+  nxsem_set_protocol(&dev->wkexit, SEM_PRIO_NONE);
+#endif
+
+  kmm_free(order);
+  return OK;
+
+errout:
+  kmm_free(order);
+  kmm_free(dev->segs);
+  kmm_free(dev->map);
+  kmm_free(dev->sum);
+  kmm_free(dev->gcsum);
+  kmm_free(dev->page);
+  dev->map = NULL;
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: ftl_open
  *
@@ -156,11 +1277,25 @@ static int ftl_close(FAR struct inode *inode)
   rwb_flush(&dev->rwb);
 #endif
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  if (dev->map != NULL)
+    {
+      ftl_log_sync(dev);
+    }
+#endif
+
   if (--dev->refs == 0 && dev->unlinked)
     {
 #ifdef FTL_HAVE_RWBUFFER
       rwb_uninitialize(&dev->rwb);
 #endif
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          ftl_log_uninitialize(dev);
+        }
+#endif
+
       if (dev->eblock)
         {
           kmm_free(dev->eblock);
@@ -185,6 +1320,13 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
   struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
   ssize_t nread;
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  if (dev->map != NULL)
+    {
+      return ftl_log_read(dev, buffer, startblock, nblocks);
+    }
+#endif
+
   /* Read the full erase block into the buffer */
 
   nread   = MTD_BREAD(dev->mtd, startblock, nblocks, buffer);
@@ -254,6 +1396,13 @@ static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
   int    nbytes;
   int    ret;
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  if (dev->map != NULL)
+    {
+      return ftl_log_write(dev, buffer, startblock, nblocks);
+    }
+#endif
+
   /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
    * per erase block is a power of 2, and (2) the erase begins with that same
    * alignment.
@@ -478,6 +1627,13 @@ static int ftl_geometry(FAR struct inode *inode,
       geometry->geo_nsectors      = dev->geo.neraseblocks * dev->blkper;
       geometry->geo_sectorsize    = dev->geo.blocksize;
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          geometry->geo_nsectors  = dev->nsectors;
+        }
+#endif
+
       finfo("available: true mediachanged: false writeenabled: %s\n",
             geometry->geo_writeenabled ? "true" : "false");
       finfo("nsectors: %" PRIuOFF " sectorsize: %u\n",
@@ -511,7 +1667,36 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #ifdef CONFIG_FTL_WRITEBUFFER
       rwb_flush(&dev->rwb);
 #endif
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          ftl_log_sync(dev);
+        }
+#endif
+    }
+
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  /* The log exposes fewer sectors than the MTD holds, and they are
+   * rewritten without erasing them first.  Describe those instead of the
+   * raw flash.
+   */
+
+  if (cmd == MTDIOC_GEOMETRY && dev->map != NULL)
+    {
+      FAR struct mtd_geometry_s *geo =
+        (FAR struct mtd_geometry_s *)((uintptr_t)arg);
+
+      if (geo == NULL)
+        {
+          return -EINVAL;
+        }
+
+      geo->blocksize    = dev->geo.blocksize;
+      geo->erasesize    = dev->geo.blocksize;
+      geo->neraseblocks = dev->nsectors;
+      return OK;
     }
+#endif
 
   /* No other block driver ioctl commands are not recognized by this
    * driver.  Other possible MTD driver ioctl commands are passed through
@@ -524,6 +1709,15 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       ferr("ERROR: MTD ioctl(%04x) failed: %d\n", cmd, ret);
     }
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+  /* Forget the log if the whole device has been erased */
+
+  if (ret >= 0 && cmd == MTDIOC_BULKERASE && dev->map != NULL)
+    {
+      ftl_log_format(dev);
+    }
+#endif
+
   return ret;
 }
 
@@ -548,6 +1742,13 @@ static int ftl_unlink(FAR struct inode *inode)
 #ifdef FTL_HAVE_RWBUFFER
       rwb_uninitialize(&dev->rwb);
 #endif
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          ftl_log_uninitialize(dev);
+        }
+#endif
+
       if (dev->eblock)
         {
           kmm_free(dev->eblock);
@@ -618,11 +1819,37 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
       dev->blkper = dev->geo.erasesize / dev->geo.blocksize;
       DEBUGASSERT(dev->blkper * dev->geo.blocksize == dev->geo.erasesize);
 
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      /* Set up the log-structured translation layer.  Fall back to read-
+       * erase-rewrite if the device is too small or if an erase block
+       * is a single sector, when there is nothing to remap anyway.
+       */
+
+      ret = ftl_log_initialize(dev);
+      if (ret == -EINVAL)
+        {
+          fwarn("WARNING: Not using the log for %s\n", path);
+        }
+      else if (ret < 0)
+        {
+          ferr("ERROR: ftl_log_initialize failed: %d\n", ret);
+          kmm_free(dev);
+          return ret;
+        }
+#endif
+
       /* Configure read-ahead/write buffering */
 
 #ifdef FTL_HAVE_RWBUFFER
       dev->rwb.blocksize     = dev->geo.blocksize;
       dev->rwb.nblocks       = dev->geo.neraseblocks * dev->blkper;
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          dev->rwb.nblocks     = dev->nsectors;
+        }
+#endif
+
       dev->rwb.dev           = (FAR void *)dev;
       dev->rwb.wrflush       = ftl_flush;
       dev->rwb.rhreload      = ftl_reload;
@@ -630,6 +1857,21 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
 #if defined(CONFIG_FTL_WRITEBUFFER)
       dev->rwb.wrmaxblocks   = dev->blkper;
       dev->rwb.wralignblocks = dev->blkper;
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+      if (dev->map != NULL)
+        {
+          /* The log appends sectors wherever they land, so there is
+           * nothing to gain from padding a flush to an erase block.  Do
+           * not buffer more than the log can append to one segment.
+           */
+
+          dev->rwb.wralignblocks = 1;
+          if (dev->rwb.wrmaxblocks > dev->ndata)
+            {
+              dev->rwb.wrmaxblocks = dev->ndata;
+            }
+        }
+#endif
 #endif
 
 #ifdef CONFIG_FTL_READAHEAD
@@ -640,6 +1882,13 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
       if (ret < 0)
         {
           ferr("ERROR: rwb_initialize failed: %d\n", ret);
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+          if (dev->map != NULL)
+            {
+              ftl_log_uninitialize(dev);
+            }
+#endif
+
           kmm_free(dev);
           return ret;
         }
@@ -654,6 +1903,13 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
 #ifdef FTL_HAVE_RWBUFFER
           rwb_uninitialize(&dev->rwb);
 #endif
+#ifdef CONFIG_FTL_LOGSTRUCTURED
+          if (dev->map != NULL)
+            {
+              ftl_log_uninitialize(dev);
+            }
+#endif
+
           kmm_free(dev);
         }
     }
@@ -311,6 +311,16 @@ static int mtd_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
         }
         break;
 
+#ifdef CONFIG_DRVR_WRITEBUFFER
+      case BIOC_FLUSH:
+        {
+          /* Write all buffered data to the contained MTD */
+
+          ret = rwb_flush(&priv->rwb);
+        }
+        break;
+#endif
+
       case MTDIOC_BULKERASE:
         {
           /* Erase the entire device */
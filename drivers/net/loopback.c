@@ -509,6 +509,12 @@ int localhost_initialize(void)
   priv->lo_dev.d_buf     = g_iobuffer;   /* Attach the IO buffer */
   priv->lo_dev.d_private = priv;         /* Used to recover private state from dev */
 
+#ifdef CONFIG_NETDEV_CHKSUM_OFFLOAD
+  /* Looped back packets never leave memory, so checksums buy nothing */
+
+  priv->lo_dev.d_features = NETDEV_FEATURE_CSUM_ALL;
+#endif
+
   /* Register the loopabck device with the OS so that socket IOCTLs can b
    * performed.
    */
@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -389,22 +390,29 @@ int pipecommon_close(FAR struct file *filep)
 }
 
 /****************************************************************************
- * Name: pipecommon_read
+ * Name: pipecommon_readv
  ****************************************************************************/
 
-ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
+ssize_t pipecommon_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                         int iovcnt)
 {
   FAR struct inode      *inode  = filep->f_inode;
   FAR struct pipe_dev_s *dev    = inode->i_private;
-#ifdef CONFIG_DEV_PIPEDUMP
-  FAR uint8_t           *start  = (FAR uint8_t *)buffer;
-#endif
+  FAR char              *buffer;
   ssize_t                nread  = 0;
+  size_t                 len;
+  size_t                 n;
   int                    sval;
   int                    ret;
+  int                    i;
 
   DEBUGASSERT(dev);
 
+  for (len = 0, i = 0; i < iovcnt; i++)
+    {
+      len += iov[i].iov_len;
+    }
+
   if (len == 0)
     {
       return 0;
@@ -460,19 +468,23 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
     }
 
   /* Then return whatever is available in the pipe (which is at least one
-   * byte).
+   * byte), scattering it across the iovecs.
    */
 
-  nread = 0;
-  while ((size_t)nread < len && dev->d_wrndx != dev->d_rdndx)
+  for (i = 0; i < iovcnt && dev->d_wrndx != dev->d_rdndx; i++)
     {
-      *buffer++ = dev->d_buffer[dev->d_rdndx];
-      if (++dev->d_rdndx >= dev->d_bufsize)
+      buffer = iov[i].iov_base;
+      for (n = 0; n < iov[i].iov_len && dev->d_wrndx != dev->d_rdndx; n++)
         {
-          dev->d_rdndx = 0;
+          *buffer++ = dev->d_buffer[dev->d_rdndx];
+          if (++dev->d_rdndx >= dev->d_bufsize)
+            {
+              dev->d_rdndx = 0;
+            }
         }
 
-      nread++;
+      pipe_dumpbuffer("From PIPE:", (FAR uint8_t *)iov[i].iov_base, n);
+      nread += n;
     }
 
   /* Notify all poll/select waiters that they can write to the FIFO */
@@ -489,27 +501,49 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
     }
 
   nxsem_post(&dev->d_bfsem);
-  pipe_dumpbuffer("From PIPE:", start, nread);
   return nread;
 }
 
 /****************************************************************************
- * Name: pipecommon_write
+ * Name: pipecommon_read
  ****************************************************************************/
 
-ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
-                         size_t len)
+ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
+{
+  struct iovec iov;
+
+  iov.iov_base = buffer;
+  iov.iov_len  = len;
+  return pipecommon_readv(filep, &iov, 1);
+}
+
+/****************************************************************************
+ * Name: pipecommon_writev
+ ****************************************************************************/
+
+ssize_t pipecommon_writev(FAR struct file *filep,
+                          FAR const struct iovec *iov, int iovcnt)
 {
   FAR struct inode      *inode    = filep->f_inode;
   FAR struct pipe_dev_s *dev      = inode->i_private;
+  FAR const char        *buffer;
   ssize_t                nwritten = 0;
   ssize_t                last;
+  size_t                 remaining;
+  size_t                 len;
   int                    nxtwrndx;
   int                    sval;
   int                    ret;
+  int                    i;
 
   DEBUGASSERT(dev);
-  pipe_dumpbuffer("To PIPE:", (FAR uint8_t *)buffer, len);
+
+  for (len = 0, i = 0; i < iovcnt; i++)
+    {
+      pipe_dumpbuffer("To PIPE:", (FAR uint8_t *)iov[i].iov_base,
+                      iov[i].iov_len);
+      len += iov[i].iov_len;
+    }
 
   /* Handle zero-length writes */
 
@@ -556,6 +590,17 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
       return ret;
     }
 
+  /* Skip leading empty iovecs */
+
+  i = 0;
+  while (iov[i].iov_len == 0)
+    {
+      i++;
+    }
+
+  buffer    = iov[i].iov_base;
+  remaining = iov[i].iov_len;
+
   /* Loop until all of the bytes have been written */
 
   last = 0;
@@ -603,6 +648,20 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
               nxsem_post(&dev->d_bfsem);
               return len;
             }
+
+          /* Move on to the next non-empty iovec when this one is done */
+
+          if (--remaining == 0)
+            {
+              do
+                {
+                  i++;
+                }
+              while (iov[i].iov_len == 0);
+
+              buffer    = iov[i].iov_base;
+              remaining = iov[i].iov_len;
+            }
         }
       else
         {
@@ -666,6 +725,20 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
     }
 }
 
+/****************************************************************************
+ * Name: pipecommon_write
+ ****************************************************************************/
+
+ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
+                         size_t len)
+{
+  struct iovec iov;
+
+  iov.iov_base = (FAR void *)buffer;
+  iov.iov_len  = len;
+  return pipecommon_writev(filep, &iov, 1);
+}
+
 /****************************************************************************
  * Name: pipecommon_poll
  ****************************************************************************/
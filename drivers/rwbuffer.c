@@ -56,12 +56,55 @@
 #  error "Worker thread support is required (CONFIG_SCHED_WORKQUEUE)"
 #endif
 
+#ifndef CONFIG_DRVR_WRITEBUFFER
+#  undef CONFIG_DRVR_WRITEBACK
+#endif
+
+#ifndef MIN
+#  define MIN(a,b)        ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#  define MAX(a,b)        ((a) > (b) ? (a) : (b))
+#endif
+
+/* Write-back cache page states */
+
+#define RWB_PAGE_DIRTY    (1 << 0) /* Holds data not yet written */
+#define RWB_PAGE_BUSY     (1 << 1) /* Being written to the media */
+
+/* Size of the valid block bitmap of one page */
+
+#define RWB_VALIDSIZE(r)  (((r)->wralignblocks + 7) >> 3)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBACK
+/* One page of the write-back cache.  The data of page n is at
+ * wrbuffer[n * wralignblocks * blocksize] and its valid block bitmap at
+ * wrvalid[n * RWB_VALIDSIZE(rwb)].  The page contents may only be changed
+ * while holding wrsem and while the page is not busy.
+ */
+
+struct rwb_page_s
+{
+  off_t    block;                  /* First block of the page, -1 if free */
+  uint32_t age;                    /* Last access, for LRU replacement */
+  uint8_t  flags;                  /* See RWB_PAGE_* definitions */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
 static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
                          size_t nblocks, FAR uint8_t *rdbuffer);
+#ifdef CONFIG_DRVR_WRITEBACK
+static void rwb_wbflushall(FAR struct rwbuffer_s *rwb, bool wait);
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -71,7 +114,7 @@ static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
  * Name: rwb_semtake
  ****************************************************************************/
 
-#if defined(CONFIG_DRVR_WRITEBUFFER) && CONFIG_DRVR_WRDELAY != 0
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_REMOVABLE)
 static int rwb_semtake(FAR sem_t *sem)
 {
   return nxsem_wait_uninterruptible(sem);
@@ -82,7 +125,7 @@ static int rwb_semtake(FAR sem_t *sem)
  * Name: rwb_forcetake
  ****************************************************************************/
 
-#if defined(CONFIG_DRVR_WRITEBUFFER) && CONFIG_DRVR_WRDELAY != 0
+#ifdef CONFIG_DRVR_WRITEBUFFER
 static int rwb_forcetake(FAR sem_t *sem)
 {
   int result;
@@ -159,7 +202,7 @@ static inline void rwb_resetwrbuffer(FAR struct rwbuffer_s *rwb)
  *
  ****************************************************************************/
 
-#ifdef CONFIG_DRVR_WRITEBUFFER
+#if defined(CONFIG_DRVR_WRITEBUFFER) && !defined(CONFIG_DRVR_WRITEBACK)
 static void rwb_wrflush(FAR struct rwbuffer_s *rwb)
 {
   int ret;
@@ -217,7 +260,11 @@ static void rwb_wrtimeout(FAR void *arg)
    */
 
   rwb_forcetake(&rwb->wrsem);
+#ifdef CONFIG_DRVR_WRITEBACK
+  rwb_wbflushall(rwb, false);
+#else
   rwb_wrflush(rwb);
+#endif
   rwb_semgive(&rwb->wrsem);
 }
 #endif
@@ -257,7 +304,7 @@ static inline void rwb_wrcanceltimeout(FAR struct rwbuffer_s *rwb)
  * Name: rwb_writebuffer
  ****************************************************************************/
 
-#ifdef CONFIG_DRVR_WRITEBUFFER
+#if defined(CONFIG_DRVR_WRITEBUFFER) && !defined(CONFIG_DRVR_WRITEBACK)
 static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
                                off_t startblock, uint32_t nblocks,
                                FAR const uint8_t *wrbuffer)
@@ -527,7 +574,8 @@ static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock)
  *
  ****************************************************************************/
 
-#if defined(CONFIG_DRVR_WRITEBUFFER) && defined(CONFIG_DRVR_INVALIDATE)
+#if defined(CONFIG_DRVR_WRITEBUFFER) && defined(CONFIG_DRVR_INVALIDATE) && \
+    !defined(CONFIG_DRVR_WRITEBACK)
 int rwb_invalidate_writebuffer(FAR struct rwbuffer_s *rwb,
                                off_t startblock, size_t blockcount)
 {
@@ -669,6 +717,9 @@ int rwb_invalidate_writebuffer(FAR struct rwbuffer_s *rwb,
  * Description:
  *   Invalidate a region of the read-ahead buffer
  *
+ * Assumptions:
+ *   The caller holds the rhsem semaphore.
+ *
  ****************************************************************************/
 
 #if defined(CONFIG_DRVR_READAHEAD)  && defined(CONFIG_DRVR_INVALIDATE)
@@ -685,12 +736,6 @@ int rwb_invalidate_readahead(FAR struct rwbuffer_s *rwb,
       finfo("startblock=%" PRIdOFF " blockcount=%zu\n",
             startblock, blockcount);
 
-      ret = rwb_semtake(&rwb->rhsem);
-      if (ret < 0)
-        {
-          return ret;
-        }
-
       /* Now there are five cases:
        *
        * 1. We invalidate nothing
@@ -774,13 +819,729 @@ int rwb_invalidate_readahead(FAR struct rwbuffer_s *rwb,
           rwb->rhblockstart = invend;
           rwb->rhnblocks    = nkeep;
         }
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: rwb_wbdata
+ *
+ * Description:
+ *   Return the address of the data of a write-back cache page.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBACK
+static inline FAR uint8_t *rwb_wbdata(FAR struct rwbuffer_s *rwb,
+                                      FAR struct rwb_page_s *page)
+{
+  return rwb->wrbuffer + (size_t)(page - rwb->wrpages) *
+                         rwb->wralignblocks * rwb->blocksize;
+}
+
+/****************************************************************************
+ * Name: rwb_wbvalid
+ *
+ * Description:
+ *   Return the valid block bitmap of a write-back cache page.
+ *
+ ****************************************************************************/
+
+static inline FAR uint8_t *rwb_wbvalid(FAR struct rwbuffer_s *rwb,
+                                       FAR struct rwb_page_s *page)
+{
+  return rwb->wrvalid + (size_t)(page - rwb->wrpages) * RWB_VALIDSIZE(rwb);
+}
+
+/****************************************************************************
+ * Name: rwb_wbsetvalid
+ *
+ * Description:
+ *   Mark 'nblocks' blocks of a page, starting at block 'offset' within the
+ *   page, valid (or invalid).  Returns true if any block of the page is
+ *   still valid.
+ *
+ ****************************************************************************/
+
+static bool rwb_wbsetvalid(FAR struct rwbuffer_s *rwb,
+                           FAR struct rwb_page_s *page, size_t offset,
+                           size_t nblocks, bool valid)
+{
+  FAR uint8_t *bitmap = rwb_wbvalid(rwb, page);
+  size_t i;
+
+  for (i = offset; i < offset + nblocks; i++)
+    {
+      if (valid)
+        {
+          bitmap[i >> 3] |= 1 << (i & 7);
+        }
+      else
+        {
+          bitmap[i >> 3] &= ~(1 << (i & 7));
+        }
+    }
+
+  for (i = 0; i < RWB_VALIDSIZE(rwb); i++)
+    {
+      if (bitmap[i] != 0)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: rwb_wbfind
+ *
+ * Description:
+ *   Return the page caching the page-aligned block 'block' or NULL.
+ *
+ ****************************************************************************/
+
+static FAR struct rwb_page_s *rwb_wbfind(FAR struct rwbuffer_s *rwb,
+                                         off_t block)
+{
+  int i;
+
+  for (i = 0; i < rwb->wrnpages; i++)
+    {
+      if (rwb->wrpages[i].block == block)
+        {
+          return &rwb->wrpages[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: rwb_wblookup
+ *
+ * Description:
+ *   Return the cached copy of 'block' or NULL if the block is not cached.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *rwb_wblookup(FAR struct rwbuffer_s *rwb, off_t block)
+{
+  FAR struct rwb_page_s *page;
+  size_t offset;
+
+  offset = block % rwb->wralignblocks;
+  page   = rwb_wbfind(rwb, block - offset);
+  if (page != NULL &&
+      (rwb_wbvalid(rwb, page)[offset >> 3] & (1 << (offset & 7))) != 0)
+    {
+      return rwb_wbdata(rwb, page) + offset * rwb->blocksize;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: rwb_wbwait
+ *
+ * Description:
+ *   Wait until a page write completes.  wrsem is released while waiting.
+ *
+ ****************************************************************************/
+
+static void rwb_wbwait(FAR struct rwbuffer_s *rwb)
+{
+  rwb->wrwaiters++;
+  rwb_semgive(&rwb->wrsem);
+  nxsem_wait_uninterruptible(&rwb->wrwaitsem);
+  rwb_forcetake(&rwb->wrsem);
+}
+
+/****************************************************************************
+ * Name: rwb_wbrhdrop
+ *
+ * Description:
+ *   Drop blocks that were just written to the media from the read-ahead
+ *   buffer:  it may have been reloaded with the old media contents while
+ *   the blocks were only in the write-back cache.
+ *
+ ****************************************************************************/
+
+static void rwb_wbrhdrop(FAR struct rwbuffer_s *rwb, off_t startblock,
+                         size_t nblocks)
+{
+#ifdef CONFIG_DRVR_READAHEAD
+  if (rwb->rhmaxblocks > 0 &&
+      nxsem_wait_uninterruptible(&rwb->rhsem) >= 0)
+    {
+#ifdef CONFIG_DRVR_INVALIDATE
+      rwb_invalidate_readahead(rwb, startblock, nblocks);
+#else
+      if (rwb_overlap(rwb->rhblockstart, rwb->rhnblocks, startblock,
+                      nblocks))
+        {
+          rwb_resetrhbuffer(rwb);
+        }
+#endif
 
       rwb_semgive(&rwb->rhsem);
     }
+#endif
+}
+
+/****************************************************************************
+ * Name: rwb_wbflushrun
+ *
+ * Description:
+ *   Write the dirty page 'page' to the media, together with the dirty pages
+ *   that follow it both on the media and in the cache memory, with a single
+ *   wrflush call.  Blocks of the pages that were never written are read
+ *   from the media first.  wrsem is released during the transfer; the
+ *   pages are marked busy meanwhile.  If the write fails, the pages stay
+ *   dirty and the error is reported by the next rwb_flush().
+ *
+ * Returned Value:
+ *   OK on success, otherwise a negated errno value.
+ *
+ * Assumptions:
+ *   The caller holds the wrsem semaphore.
+ *
+ ****************************************************************************/
+
+static int rwb_wbflushrun(FAR struct rwbuffer_s *rwb,
+                              FAR struct rwb_page_s *page)
+{
+  FAR struct rwb_page_s *end = rwb->wrpages + rwb->wrnpages;
+  FAR struct rwb_page_s *last = page;
+  FAR struct rwb_page_s *p;
+  off_t startblock = page->block;
+  size_t nblocks;
+  size_t npages;
+  ssize_t ret = OK;
+  size_t i;
+  size_t n;
+
+  DEBUGASSERT((page->flags & (RWB_PAGE_DIRTY | RWB_PAGE_BUSY)) ==
+              RWB_PAGE_DIRTY);
+
+  while (last + 1 < end &&
+         (last[1].flags & (RWB_PAGE_DIRTY | RWB_PAGE_BUSY)) ==
+         RWB_PAGE_DIRTY &&
+         last[1].block == last->block + rwb->wralignblocks)
+    {
+      last++;
+    }
+
+  npages  = last - page + 1;
+  nblocks = npages * rwb->wralignblocks;
+
+  for (p = page; p <= last; p++)
+    {
+      p->flags = RWB_PAGE_BUSY;
+    }
+
+  rwb->wrndirty -= npages;
+  rwb->wrnbusy  += npages;
+  rwb_semgive(&rwb->wrsem);
+
+  /* The wrflush callbacks do not expect to be called concurrently */
+
+  rwb_forcetake(&rwb->wrflushsem);
+
+  finfo("Flushing: blockstart=0x%08lx nblocks=%zu\n",
+        (long)startblock, nblocks);
+
+  /* Fill in the blocks that were never written.  Nobody else touches the
+   * contents of busy pages or their bitmaps.
+   */
+
+  for (p = page; p <= last && ret >= 0; p++)
+    {
+      FAR uint8_t *bitmap = rwb_wbvalid(rwb, p);
+
+      for (i = 0; i < rwb->wralignblocks && ret >= 0; i += n)
+        {
+          for (n = 0; i + n < rwb->wralignblocks &&
+                      (bitmap[(i + n) >> 3] & (1 << ((i + n) & 7))) == 0;
+               n++)
+            {
+            }
+
+          if (n == 0)
+            {
+              n = 1;
+            }
+          else
+            {
+              ret = rwb_read_(rwb, p->block + i, n,
+                              rwb_wbdata(rwb, p) + i * rwb->blocksize);
+            }
+        }
+    }
+
+  if (ret >= 0)
+    {
+      ret = rwb->wrflush(rwb->dev, rwb_wbdata(rwb, page), startblock,
+                         nblocks);
+      rwb_wbrhdrop(rwb, startblock, nblocks);
+    }
+
+  rwb_semgive(&rwb->wrflushsem);
+  rwb_forcetake(&rwb->wrsem);
+
+  rwb->wrnbusy -= npages;
+  if (ret == (ssize_t)nblocks)
+    {
+      for (p = page; p <= last; p++)
+        {
+          p->flags = 0;
+          memset(rwb_wbvalid(rwb, p), 0xff, RWB_VALIDSIZE(rwb));
+        }
+
+      ret = OK;
+    }
+  else
+    {
+      /* Keep the data so that a later flush can write it again */
+
+      ferr("ERROR: Error flushing write buffer: %zd\n", ret);
+      for (p = page; p <= last; p++)
+        {
+          p->flags = RWB_PAGE_DIRTY;
+        }
+
+      rwb->wrndirty += npages;
+      ret = ret < 0 ? ret : -EIO;
+      if (rwb->wrerror == OK)
+        {
+          rwb->wrerror = ret;
+        }
+    }
+
+  /* Wake up everybody waiting for a page write */
+
+  while (rwb->wrwaiters > 0)
+    {
+      rwb->wrwaiters--;
+      rwb_semgive(&rwb->wrwaitsem);
+    }
 
   return ret;
 }
+
+/****************************************************************************
+ * Name: rwb_wbflushall
+ *
+ * Description:
+ *   Write all dirty pages to the media in ascending block order.  If 'wait'
+ *   is true, also wait for page writes started by other threads, so that
+ *   all data written before is on the media on return.  Every page is
+ *   tried once, so pages that fail to write do not stall the pass.
+ *
+ * Assumptions:
+ *   The caller holds the wrsem semaphore.
+ *
+ ****************************************************************************/
+
+static void rwb_wbflushall(FAR struct rwbuffer_s *rwb, bool wait)
+{
+  FAR struct rwb_page_s *first;
+  off_t next = 0;
+  int i;
+
+  for (; ; )
+    {
+      first = NULL;
+      for (i = 0; i < rwb->wrnpages; i++)
+        {
+          if ((rwb->wrpages[i].flags & (RWB_PAGE_DIRTY | RWB_PAGE_BUSY)) ==
+              RWB_PAGE_DIRTY && rwb->wrpages[i].block >= next &&
+              (first == NULL || rwb->wrpages[i].block < first->block))
+            {
+              first = &rwb->wrpages[i];
+            }
+        }
+
+      if (first != NULL)
+        {
+          next = first->block + rwb->wralignblocks;
+          rwb_wbflushrun(rwb, first);
+        }
+      else if (wait && rwb->wrnbusy > 0)
+        {
+          rwb_wbwait(rwb);
+        }
+      else
+        {
+          break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: rwb_wballoc
+ *
+ * Description:
+ *   Assign a page to the page-aligned block 'block'.  A clean page is
+ *   reused if there is one, preferably the page following the page of the
+ *   preceding blocks so that sequential data can be written back with one
+ *   call.  Otherwise the least recently used dirty pages are written back
+ *   or a page write is waited for, which releases wrsem; NULL is returned
+ *   in that case and the caller must look up the block again.
+ *
+ * Returned Value:
+ *   The page, or NULL as described above.  If the dirty pages could not
+ *   be written back, NULL is returned and *errcode is set to the negated
+ *   errno value.
+ *
+ * Assumptions:
+ *   The caller holds the wrsem semaphore.
+ *
+ ****************************************************************************/
+
+static FAR struct rwb_page_s *rwb_wballoc(FAR struct rwbuffer_s *rwb,
+                                          off_t block, FAR int *errcode)
+{
+  FAR struct rwb_page_s *victim = NULL;
+  FAR struct rwb_page_s *dirty = NULL;
+  FAR struct rwb_page_s *page;
+  int i;
+
+  page = block > 0 ? rwb_wbfind(rwb, block - rwb->wralignblocks) : NULL;
+  if (page != NULL && page + 1 < rwb->wrpages + rwb->wrnpages &&
+      page[1].flags == 0)
+    {
+      victim = page + 1;
+    }
+  else
+    {
+      for (i = 0; i < rwb->wrnpages; i++)
+        {
+          page = &rwb->wrpages[i];
+          if ((page->flags & RWB_PAGE_BUSY) != 0)
+            {
+              continue;
+            }
+
+          if ((page->flags & RWB_PAGE_DIRTY) == 0)
+            {
+              if (victim == NULL || page->age < victim->age)
+                {
+                  victim = page;
+                }
+            }
+          else if (dirty == NULL || page->age < dirty->age)
+            {
+              dirty = page;
+            }
+        }
+    }
+
+  if (victim != NULL)
+    {
+      victim->block = block;
+      memset(rwb_wbvalid(rwb, victim), 0, RWB_VALIDSIZE(rwb));
+      return victim;
+    }
+
+  if (dirty != NULL)
+    {
+      *errcode = rwb_wbflushrun(rwb, dirty);
+    }
+  else
+    {
+      rwb_wbwait(rwb);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: rwb_wbstartflush
+ *
+ * Description:
+ *   Schedule the background write-back:  right away if more than half of
+ *   the pages are dirty, otherwise after the write flush delay.
+ *
+ ****************************************************************************/
+
+static void rwb_wbstartflush(FAR struct rwbuffer_s *rwb)
+{
+#if CONFIG_DRVR_WRDELAY != 0
+  if (rwb->wrnpages > 1 && rwb->wrndirty > rwb->wrnpages / 2)
+    {
+      work_queue(LPWORK, &rwb->work, rwb_wrtimeout, (FAR void *)rwb, 0);
+    }
+  else if (rwb->wrndirty > 0)
+    {
+      rwb_wrstarttimeout(rwb);
+    }
 #endif
+}
+
+/****************************************************************************
+ * Name: rwb_wbwrite
+ *
+ * Description:
+ *   Write blocks into the write-back cache.  Writes larger than the whole
+ *   cache go directly to the media; the cached copies of the blocks are
+ *   updated.
+ *
+ * Assumptions:
+ *   The caller holds the wrsem semaphore.
+ *
+ ****************************************************************************/
+
+static ssize_t rwb_wbwrite(FAR struct rwbuffer_s *rwb, off_t startblock,
+                           size_t nblocks, FAR const uint8_t *wrbuffer)
+{
+  FAR struct rwb_page_s *page;
+  size_t nwritten = nblocks;
+  size_t offset;
+  size_t ncopy;
+  ssize_t ret;
+  off_t first;
+  off_t last;
+  bool busy;
+  int errcode;
+  int i;
+
+  rwb_wrcanceltimeout(rwb);
+
+  if (nblocks > rwb->wrmaxblocks)
+    {
+      /* Make sure that no older copy of the blocks is being written */
+
+      do
+        {
+          busy = false;
+          for (i = 0; i < rwb->wrnpages && !busy; i++)
+            {
+              busy = (rwb->wrpages[i].flags & RWB_PAGE_BUSY) != 0 &&
+                     rwb_overlap(rwb->wrpages[i].block, rwb->wralignblocks,
+                                 startblock, nblocks);
+            }
+
+          if (busy)
+            {
+              rwb_wbwait(rwb);
+            }
+        }
+      while (busy);
+
+      rwb_forcetake(&rwb->wrflushsem);
+      ret = rwb->wrflush(rwb->dev, wrbuffer, startblock, nblocks);
+      rwb_semgive(&rwb->wrflushsem);
+      if (ret < 0)
+        {
+          rwb_wbstartflush(rwb);
+          return ret;
+        }
+
+      for (i = 0; i < rwb->wrnpages; i++)
+        {
+          page = &rwb->wrpages[i];
+          if (page->block >= 0 &&
+              rwb_overlap(page->block, rwb->wralignblocks, startblock,
+                          nblocks))
+            {
+              first = MAX(page->block, startblock);
+              last  = MIN(page->block + rwb->wralignblocks,
+                          startblock + (off_t)nblocks);
+
+              memcpy(rwb_wbdata(rwb, page) +
+                     (first - page->block) * rwb->blocksize,
+                     wrbuffer + (first - startblock) * rwb->blocksize,
+                     (last - first) * rwb->blocksize);
+              rwb_wbsetvalid(rwb, page, first - page->block, last - first,
+                             true);
+            }
+        }
+
+      nblocks = 0;
+    }
+
+  while (nblocks > 0)
+    {
+      offset = startblock % rwb->wralignblocks;
+      ncopy  = rwb->wralignblocks - offset;
+      if (ncopy > nblocks)
+        {
+          ncopy = nblocks;
+        }
+
+      page = rwb_wbfind(rwb, startblock - offset);
+      if (page != NULL && (page->flags & RWB_PAGE_BUSY) != 0)
+        {
+          rwb_wbwait(rwb);
+          continue;
+        }
+
+      if (page == NULL)
+        {
+          errcode = OK;
+          page    = rwb_wballoc(rwb, startblock - offset, &errcode);
+          if (errcode < 0)
+            {
+              /* No room left in the cache for the remaining blocks */
+
+              nwritten -= nblocks;
+              rwb_wbstartflush(rwb);
+              return nwritten > 0 ? (ssize_t)nwritten : errcode;
+            }
+
+          if (page == NULL)
+            {
+              continue;
+            }
+        }
+
+      memcpy(rwb_wbdata(rwb, page) + offset * rwb->blocksize, wrbuffer,
+             ncopy * rwb->blocksize);
+      rwb_wbsetvalid(rwb, page, offset, ncopy, true);
+
+      if ((page->flags & RWB_PAGE_DIRTY) == 0)
+        {
+          page->flags |= RWB_PAGE_DIRTY;
+          rwb->wrndirty++;
+        }
+
+      page->age   = ++rwb->wrclock;
+      startblock += ncopy;
+      wrbuffer   += ncopy * rwb->blocksize;
+      nblocks    -= ncopy;
+    }
+
+  rwb_wbstartflush(rwb);
+  return nwritten;
+}
+
+/****************************************************************************
+ * Name: rwb_wbread
+ *
+ * Description:
+ *   Read blocks, taking those held in the write-back cache from there and
+ *   the others from the media (through the read-ahead buffer).  wrsem is
+ *   not held while the media is accessed.
+ *
+ ****************************************************************************/
+
+static ssize_t rwb_wbread(FAR struct rwbuffer_s *rwb, off_t startblock,
+                          size_t nblocks, FAR uint8_t *rdbuffer)
+{
+  FAR const uint8_t *src;
+  size_t remaining = nblocks;
+  ssize_t ret;
+  size_t n;
+
+  while (remaining > 0)
+    {
+      ret = nxsem_wait(&rwb->wrsem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      while (remaining > 0 &&
+             (src = rwb_wblookup(rwb, startblock)) != NULL)
+        {
+          memcpy(rdbuffer, src, rwb->blocksize);
+          startblock++;
+          rdbuffer += rwb->blocksize;
+          remaining--;
+        }
+
+      for (n = 0; n < remaining && rwb_wblookup(rwb, startblock + n) == NULL;
+           n++)
+        {
+        }
+
+      rwb_semgive(&rwb->wrsem);
+
+      if (n > 0)
+        {
+          ret = rwb_read_(rwb, startblock, n, rdbuffer);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          startblock += n;
+          rdbuffer   += n * rwb->blocksize;
+          remaining  -= n;
+        }
+    }
+
+  return nblocks;
+}
+
+/****************************************************************************
+ * Name: rwb_wbinvalidate
+ *
+ * Description:
+ *   Drop a region from the write-back cache.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_DRVR_INVALIDATE) || defined(CONFIG_DRVR_REMOVABLE)
+static int rwb_wbinvalidate(FAR struct rwbuffer_s *rwb, off_t startblock,
+                            size_t blockcount)
+{
+  FAR struct rwb_page_s *page;
+  off_t first;
+  off_t last;
+  int ret;
+  int i;
+
+  ret = rwb_semtake(&rwb->wrsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < rwb->wrnpages; i++)
+    {
+      page = &rwb->wrpages[i];
+      if (page->block < 0 ||
+          !rwb_overlap(page->block, rwb->wralignblocks, startblock,
+                       blockcount))
+        {
+          continue;
+        }
+
+      if ((page->flags & RWB_PAGE_BUSY) != 0)
+        {
+          /* Wait for the write and start over */
+
+          rwb_wbwait(rwb);
+          i = -1;
+          continue;
+        }
+
+      first = MAX(page->block, startblock);
+      last  = MIN(page->block + rwb->wralignblocks,
+                  startblock + (off_t)blockcount);
+
+      if (!rwb_wbsetvalid(rwb, page, first - page->block, last - first,
+                          false))
+        {
+          if ((page->flags & RWB_PAGE_DIRTY) != 0)
+            {
+              rwb->wrndirty--;
+            }
+
+          page->block = -1;
+          page->flags = 0;
+        }
+    }
+
+  rwb_semgive(&rwb->wrsem);
+  return OK;
+}
+#endif
+#endif /* CONFIG_DRVR_WRITEBACK */
 
 /****************************************************************************
  * Public Functions
@@ -793,6 +1554,9 @@ int rwb_invalidate_readahead(FAR struct rwbuffer_s *rwb,
 int rwb_initialize(FAR struct rwbuffer_s *rwb)
 {
   uint32_t allocsize;
+#ifdef CONFIG_DRVR_WRITEBACK
+  int i;
+#endif
 
   /* Sanity checking */
 
@@ -806,6 +1570,10 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
 #ifdef CONFIG_DRVR_WRITEBUFFER
   DEBUGASSERT(rwb->wrflush != NULL);
   rwb->wrbuffer = NULL;
+#ifdef CONFIG_DRVR_WRITEBACK
+  rwb->wrpages  = NULL;
+  rwb->wrvalid  = NULL;
+#endif
 #endif
 #ifdef CONFIG_DRVR_READAHEAD
   DEBUGASSERT(rwb->rhreload != NULL);
@@ -844,6 +1612,36 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
         }
 
       finfo("Write buffer size: %d bytes\n", allocsize);
+
+#ifdef CONFIG_DRVR_WRITEBACK
+      /* Divide the write buffer into pages of wralignblocks blocks */
+
+      rwb->wrnpages  = rwb->wrmaxblocks / rwb->wralignblocks;
+      rwb->wrndirty  = 0;
+      rwb->wrnbusy   = 0;
+      rwb->wrwaiters = 0;
+      rwb->wrclock   = 0;
+      rwb->wrerror   = OK;
+
+      nxsem_init(&rwb->wrwaitsem, 0, 0);
+      nxsem_set_protocol(&rwb->wrwaitsem, SEM_PRIO_NONE);
+      nxsem_init(&rwb->wrflushsem, 0, 1);
+
+      rwb->wrpages = (FAR struct rwb_page_s *)
+        kmm_zalloc(rwb->wrnpages * sizeof(struct rwb_page_s));
+      rwb->wrvalid = (FAR uint8_t *)
+        kmm_zalloc(rwb->wrnpages * RWB_VALIDSIZE(rwb));
+      if (rwb->wrpages == NULL || rwb->wrvalid == NULL)
+        {
+          ferr("Write-back cache allocation failed\n");
+          return -ENOMEM;
+        }
+
+      for (i = 0; i < rwb->wrnpages; i++)
+        {
+          rwb->wrpages[i].block = -1;
+        }
+#endif
     }
 #endif /* CONFIG_DRVR_WRITEBUFFER */
 
@@ -888,7 +1686,29 @@ void rwb_uninitialize(FAR struct rwbuffer_s *rwb)
   if (rwb->wrmaxblocks > 0)
     {
       rwb_wrcanceltimeout(rwb);
+#ifdef CONFIG_DRVR_WRITEBACK
+      if (rwb->wrpages != NULL && rwb->wrvalid != NULL &&
+          rwb->wrbuffer != NULL)
+        {
+          rwb_forcetake(&rwb->wrsem);
+          rwb_wbflushall(rwb, true);
+          rwb_semgive(&rwb->wrsem);
+        }
+
+      nxsem_destroy(&rwb->wrwaitsem);
+      nxsem_destroy(&rwb->wrflushsem);
+      if (rwb->wrpages)
+        {
+          kmm_free(rwb->wrpages);
+        }
+
+      if (rwb->wrvalid)
+        {
+          kmm_free(rwb->wrvalid);
+        }
+#else
       rwb_wrflush(rwb);
+#endif
       nxsem_destroy(&rwb->wrsem);
       if (rwb->wrbuffer)
         {
@@ -1010,7 +1830,12 @@ ssize_t rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock,
   finfo("startblock=%ld nblocks=%ld rdbuffer=%p\n",
         (long)startblock, (long)nblocks, rdbuffer);
 
-#ifdef CONFIG_DRVR_WRITEBUFFER
+#ifdef CONFIG_DRVR_WRITEBACK
+  if (rwb->wrmaxblocks > 0)
+    {
+      return rwb_wbread(rwb, startblock, nblocks, rdbuffer);
+    }
+#elif defined(CONFIG_DRVR_WRITEBUFFER)
   /* If the new read data overlaps any part of the write buffer, we
    * directly copy write buffer to read buffer. This boost performance.
    */
@@ -1133,7 +1958,11 @@ ssize_t rwb_write(FAR struct rwbuffer_s *rwb, off_t startblock,
           return ret;
         }
 
+#ifdef CONFIG_DRVR_WRITEBACK
+      ret = rwb_wbwrite(rwb, startblock, nblocks, wrbuffer);
+#else
       ret = rwb_writebuffer(rwb, startblock, nblocks, wrbuffer);
+#endif
       rwb_semgive(&rwb->wrsem);
 
       /* On success, return the number of blocks that we were requested to
@@ -1194,7 +2023,18 @@ ssize_t rwb_readbytes(FAR struct rwbuffer_s *dev, off_t offset,
 #ifdef CONFIG_DRVR_REMOVABLE
 int rwb_mediaremoved(FAR struct rwbuffer_s *rwb)
 {
-#ifdef CONFIG_DRVR_WRITEBUFFER
+  int ret;
+
+#ifdef CONFIG_DRVR_WRITEBACK
+  if (rwb->wrmaxblocks > 0)
+    {
+      ret = rwb_wbinvalidate(rwb, 0, rwb->nblocks);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+#elif defined(CONFIG_DRVR_WRITEBUFFER)
   if (rwb->wrmaxblocks > 0)
     {
       ret = rwb_semtake(&rwb->wrsem);
@@ -1240,7 +2080,15 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
 {
   int ret;
 
-#ifdef CONFIG_DRVR_WRITEBUFFER
+#ifdef CONFIG_DRVR_WRITEBACK
+  ret = rwb->wrmaxblocks > 0 ?
+        rwb_wbinvalidate(rwb, startblock, blockcount) : OK;
+  if (ret < 0)
+    {
+      ferr("ERROR: rwb_wbinvalidate failed: %d\n", ret);
+      return ret;
+    }
+#elif defined(CONFIG_DRVR_WRITEBUFFER)
   ret = rwb_invalidate_writebuffer(rwb, startblock, blockcount);
   if (ret < 0)
     {
@@ -1250,11 +2098,21 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
 #endif
 
 #ifdef CONFIG_DRVR_READAHEAD
-  ret = rwb_invalidate_readahead(rwb, startblock, blockcount);
-  if (ret < 0)
+  if (rwb->rhmaxblocks > 0)
     {
-      ferr("ERROR: rwb_invalidate_readahead failed: %d\n", ret);
-      return ret;
+      ret = nxsem_wait_uninterruptible(&rwb->rhsem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = rwb_invalidate_readahead(rwb, startblock, blockcount);
+      rwb_semgive(&rwb->rhsem);
+      if (ret < 0)
+        {
+          ferr("ERROR: rwb_invalidate_readahead failed: %d\n", ret);
+          return ret;
+        }
     }
 #endif
 
@@ -1266,7 +2124,9 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
  * Name: rwb_flush
  *
  * Description:
- *   Flush the write buffer
+ *   Flush the write buffer.  With CONFIG_DRVR_WRITEBACK, this also waits
+ *   for the background writes in progress and returns the first error any
+ *   background write reported since the last flush.
  *
  ****************************************************************************/
 
@@ -1275,9 +2135,26 @@ int rwb_flush(FAR struct rwbuffer_s *rwb)
 {
   int ret;
 
+#ifdef CONFIG_DRVR_WRITEBACK
+  if (rwb->wrmaxblocks == 0)
+    {
+      return OK;
+    }
+#endif
+
   ret = rwb_forcetake(&rwb->wrsem);
   rwb_wrcanceltimeout(rwb);
+#ifdef CONFIG_DRVR_WRITEBACK
+  rwb_wbflushall(rwb, true);
+  if (ret == OK)
+    {
+      ret = rwb->wrerror;
+    }
+
+  rwb->wrerror = OK;
+#else
   rwb_wrflush(rwb);
+#endif
   rwb_semgive(&rwb->wrsem);
 
   return ret;
@@ -147,6 +147,72 @@ static int uart_takesem(FAR sem_t *sem, bool errout)
 
 #define uart_givesem(sem) (void)nxsem_post(sem)
 
+/****************************************************************************
+ * Name: uart_nbuffered
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+static inline unsigned int uart_nbuffered(FAR struct uart_buffer_s *buf)
+{
+  int16_t head = buf->head;
+  int16_t tail = buf->tail;
+
+  return head >= tail ? head - tail : buf->size - tail + head;
+}
+
+/****************************************************************************
+ * Name: uart_readmin
+ *
+ * Description:
+ *   The number of bytes that a non-canonical read() must return before it
+ *   may complete without a timeout:  c_cc[VMIN] bounded by the request
+ *   size, or one if only c_cc[VTIME] is set (zero if neither is).
+ *
+ ****************************************************************************/
+
+static inline size_t uart_readmin(FAR uart_dev_t *dev, size_t buflen)
+{
+  if (dev->tc_vmin == 0)
+    {
+      return dev->tc_vtime > 0 ? 1 : 0;
+    }
+
+  return dev->tc_vmin < buflen ? dev->tc_vmin : buflen;
+}
+
+/****************************************************************************
+ * Name: uart_recvwake
+ *
+ * Description:
+ *   The number of buffered bytes at which a reader that still needs
+ *   'needed' bytes is woken up.  This is bounded by what the Rx buffer can
+ *   hold before reception stops (at a full buffer or, with flow control
+ *   watermarks, at the upper watermark), otherwise a VMIN larger than the
+ *   buffer would never be reached.  The reader then takes what is buffered
+ *   and waits again for the rest.
+ *
+ ****************************************************************************/
+
+static inline uint16_t uart_recvwake(FAR uart_dev_t *dev, size_t needed)
+{
+  size_t limit;
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  limit = (CONFIG_SERIAL_IFLOWCONTROL_UPPER_WATERMARK * dev->recv.size) /
+          100;
+#else
+  limit = dev->recv.size - 1;
+#endif
+
+  if (limit < 1)
+    {
+      limit = 1;
+    }
+
+  return needed < limit ? needed : limit;
+}
+#endif
+
 /****************************************************************************
  * Name: uart_pollnotify
  ****************************************************************************/
@@ -706,6 +772,10 @@ static ssize_t uart_read(FAR struct file *filep,
   irqstate_t flags;
   ssize_t recvd = 0;
   int16_t tail;
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+  bool timedout = false;
+  int16_t head;
+#endif
   char ch;
   int ret;
 
@@ -835,11 +905,16 @@ static ssize_t uart_read(FAR struct file *filep,
           break;
         }
 #else
-      /* No... the circular buffer is empty.  Have we returned anything
-       * to the caller?
+      /* No... the circular buffer is empty.  Have we returned enough
+       * to the caller?  That is anything at all unless VMIN asks for
+       * more; and whatever we have if the VTIME timer has expired.
        */
 
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+      else if ((size_t)recvd >= uart_readmin(dev, buflen) || timedout)
+#else
       else if (recvd > 0)
+#endif
         {
           /* Yes.. break out of the loop and return the number of bytes
            * received up to the wait condition.
@@ -865,9 +940,15 @@ static ssize_t uart_read(FAR struct file *filep,
 
       else if ((filep->f_oflags & O_NONBLOCK) != 0)
         {
-          /* Break out of the loop returning -EAGAIN */
+          /* Break out of the loop returning -EAGAIN if nothing (short of
+           * VMIN) was received.
+           */
+
+          if (recvd < 1)
+            {
+              recvd = -EAGAIN;
+            }
 
-          recvd = -EAGAIN;
           break;
         }
 #endif
@@ -942,7 +1023,35 @@ static ssize_t uart_read(FAR struct file *filep,
                    */
 
                   dev->recvwaiting = true;
-                  ret = uart_takesem(&dev->recvsem, true);
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+                  /* Ask not to be woken before VMIN is satisfied.  The
+                   * VTIME timer runs while waiting for the first byte if
+                   * VMIN is zero, otherwise between bytes.  It restarts
+                   * whenever something arrived during the last period,
+                   * so a read completes at most 2 * VTIME after the last
+                   * byte.
+                   */
+
+                  dev->recvwake = uart_recvwake(dev,
+                                      uart_readmin(dev, buflen) - recvd);
+                  if (dev->tc_vtime > 0 && (dev->tc_vmin == 0 || recvd > 0))
+                    {
+                      head = rxbuf->head;
+                      ret  = nxsem_tickwait(&dev->recvsem,
+                                            clock_systime_ticks(),
+                                            DSEC2TICK(dev->tc_vtime));
+                      if (ret == -ETIMEDOUT)
+                        {
+                          dev->recvwaiting = false;
+                          timedout = rxbuf->head == head;
+                          ret = OK;
+                        }
+                    }
+                  else
+#endif
+                    {
+                      ret = uart_takesem(&dev->recvsem, true);
+                    }
                 }
 
               leave_critical_section(flags);
@@ -1422,6 +1531,10 @@ static int uart_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               termiosp->c_iflag = dev->tc_iflag;
               termiosp->c_oflag = dev->tc_oflag;
               termiosp->c_lflag = dev->tc_lflag;
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+              termiosp->c_cc[VMIN]  = dev->tc_vmin;
+              termiosp->c_cc[VTIME] = dev->tc_vtime;
+#endif
             }
             break;
 
@@ -1440,6 +1553,10 @@ static int uart_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               dev->tc_iflag = termiosp->c_iflag;
               dev->tc_oflag = termiosp->c_oflag;
               dev->tc_lflag = termiosp->c_lflag;
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+              dev->tc_vmin  = termiosp->c_cc[VMIN];
+              dev->tc_vtime = termiosp->c_cc[VTIME];
+#endif
             }
             break;
         }
@@ -1610,6 +1727,15 @@ int uart_register(FAR const char *path, FAR uart_dev_t *dev)
   dev->pid = (pid_t)-1;
 #  endif
 
+#  ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+  /* Return from read() as soon as anything has been received, as before
+   * VMIN and VTIME were supported.
+   */
+
+  dev->tc_vmin  = 1;
+  dev->tc_vtime = 0;
+#  endif
+
   /* If this UART is a serial console */
 
   if (dev->isconsole)
@@ -1664,7 +1790,13 @@ void uart_datareceived(FAR uart_dev_t *dev)
 
   /* Is there a thread waiting for read data?  */
 
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+  /* Don't wake a reader that is waiting for more than has arrived */
+
+  if (dev->recvwaiting && uart_nbuffered(&dev->recv) >= dev->recvwake)
+#else
   if (dev->recvwaiting)
+#endif
     {
       /* Yes... wake it up */
 
@@ -36,6 +36,184 @@
 #include <nuttx/signal.h>
 #include <nuttx/serial/serial.h>
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: uart_xmitbulk
+ *
+ * Description:
+ *   Hand the TX ring buffer to the lower half's sendbuf() method one
+ *   contiguous run at a time.  Returns the number of bytes removed from
+ *   the buffer.
+ *
+ ****************************************************************************/
+
+static uint16_t uart_xmitbulk(FAR uart_dev_t *dev)
+{
+  FAR struct uart_buffer_s *txbuf = &dev->xmit;
+  uint16_t nbytes = 0;
+  ssize_t nsent;
+  size_t run;
+  int16_t tail;
+
+  while (txbuf->head != txbuf->tail)
+    {
+      tail = txbuf->tail;
+      run  = txbuf->head > tail ? txbuf->head - tail : txbuf->size - tail;
+
+      nsent = uart_sendbuf(dev, &txbuf->buffer[tail], run);
+      if (nsent <= 0)
+        {
+          break;
+        }
+
+      nbytes += nsent;
+      tail   += nsent;
+      if (tail >= txbuf->size)
+        {
+          tail = 0;
+        }
+
+      txbuf->tail = tail;
+
+      /* A short count means that the TX FIFO is full */
+
+      if ((size_t)nsent < run)
+        {
+          break;
+        }
+    }
+
+  return nbytes;
+}
+
+/****************************************************************************
+ * Name: uart_rxspecial
+ *
+ * Description:
+ *   Return true if received characters must be inspected one at a time
+ *   for the SIGINT, SIGTSTP or panic characters.
+ *
+ ****************************************************************************/
+
+static inline bool uart_rxspecial(FAR uart_dev_t *dev)
+{
+#if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGTSTP)
+  if (dev->pid >= 0 && (dev->tc_lflag & ISIG) != 0)
+    {
+      return true;
+    }
+#endif
+
+#ifdef CONFIG_TTY_FORCE_PANIC
+  if ((dev->tc_lflag & ISIG) != 0)
+    {
+      return true;
+    }
+#endif
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: uart_recvbulk
+ *
+ * Description:
+ *   Let the lower half's recvbuf() method fill the RX ring buffer one
+ *   contiguous run at a time.  The fill stops short of a full buffer (or
+ *   of the upper watermark) so that uart_recvchars() still handles flow
+ *   control and overrun in one place.  Returns the number of bytes added.
+ *
+ ****************************************************************************/
+
+static uint16_t uart_recvbulk(FAR uart_dev_t *dev)
+{
+  FAR struct uart_buffer_s *rxbuf = &dev->recv;
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  unsigned int watermark;
+  unsigned int nbuffered;
+#endif
+  uint16_t nbytes = 0;
+  ssize_t nrecvd;
+  size_t space;
+  int16_t head;
+  int16_t tail;
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  watermark = (CONFIG_SERIAL_IFLOWCONTROL_UPPER_WATERMARK * rxbuf->size) /
+              100;
+#endif
+
+  for (; ; )
+    {
+      /* Contiguous free space after the head, keeping one slot empty */
+
+      head = rxbuf->head;
+      tail = rxbuf->tail;
+
+      if (head >= tail)
+        {
+          space = rxbuf->size - head - (tail == 0 ? 1 : 0);
+        }
+      else
+        {
+          space = tail - head - 1;
+        }
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+      if (head >= tail)
+        {
+          nbuffered = head - tail;
+        }
+      else
+        {
+          nbuffered = rxbuf->size - tail + head;
+        }
+
+      if (nbuffered >= watermark)
+        {
+          break;
+        }
+
+      if (space > watermark - nbuffered)
+        {
+          space = watermark - nbuffered;
+        }
+#endif
+
+      if (space == 0)
+        {
+          break;
+        }
+
+      nrecvd = uart_recvbuf(dev, &rxbuf->buffer[head], space);
+      if (nrecvd <= 0)
+        {
+          break;
+        }
+
+      nbytes += nrecvd;
+      head   += nrecvd;
+      if (head >= rxbuf->size)
+        {
+          head = 0;
+        }
+
+      rxbuf->head = head;
+
+      /* A short count means that the RX FIFO is empty */
+
+      if ((size_t)nrecvd < space)
+        {
+          break;
+        }
+    }
+
+  return nbytes;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -60,6 +238,13 @@ void uart_xmitchars(FAR uart_dev_t *dev)
   irqstate_t flags = enter_critical_section();
 #endif
 
+  /* Let the lower half take whole runs of the buffer, if it can */
+
+  if (dev->ops->sendbuf != NULL)
+    {
+      nbytes = uart_xmitbulk(dev);
+    }
+
   /* Send while we still have data in the TX buffer & room in the fifo */
 
   while (dev->xmit.head != dev->xmit.tail && uart_txready(dev))
@@ -123,12 +308,23 @@ void uart_recvchars(FAR uart_dev_t *dev)
   unsigned int watermark;
 #endif
   unsigned int status;
-  int nexthead = rxbuf->head + 1;
+  int nexthead;
 #if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGTSTP)
   int signo = 0;
 #endif
   uint16_t nbytes = 0;
 
+  /* Let the lower half move whole runs into the buffer, if it can and no
+   * special characters need to be looked for.  Anything left over (and
+   * flow control or overrun) is handled one character at a time below.
+   */
+
+  if (dev->ops->recvbuf != NULL && !uart_rxspecial(dev))
+    {
+      nbytes = uart_recvbulk(dev);
+    }
+
+  nexthead = rxbuf->head + 1;
   if (nexthead >= rxbuf->size)
     {
       nexthead = 0;
@@ -88,7 +88,11 @@ static int     ramlog_readnotify(FAR struct ramlog_dev_s *priv);
 #endif
 static void    ramlog_pollnotify(FAR struct ramlog_dev_s *priv,
                                  pollevent_t eventset);
-static int     ramlog_addchar(FAR struct ramlog_dev_s *priv, char ch);
+static void    ramlog_addnotify(FAR struct ramlog_dev_s *priv);
+static size_t  ramlog_copyin(FAR struct ramlog_dev_s *priv,
+                             FAR const char *buffer, size_t len);
+static size_t  ramlog_addrun(FAR struct ramlog_dev_s *priv,
+                             FAR const char *buffer, size_t len);
 
 /* Character driver methods */
 
@@ -263,88 +267,183 @@ static void ramlog_initbuf(void)
 #endif
 
 /****************************************************************************
- * Name: ramlog_addchar
+ * Name: ramlog_addnotify
+ *
+ * Description:
+ *   Wake up the readers and poll waiters after data was added.
+ *
  ****************************************************************************/
 
-static int ramlog_addchar(FAR struct ramlog_dev_s *priv, char ch)
+static void ramlog_addnotify(FAR struct ramlog_dev_s *priv)
 {
-  irqstate_t flags;
-  size_t nexthead;
-
-#ifdef CONFIG_RAMLOG_SYSLOG
-  if (priv == &g_sysdev)
-    {
-      ramlog_initbuf();
-    }
-#endif
+  int readers_waken = 0;
 
-  /* Disable interrupts (in case we are NOT called from interrupt handler) */
+#ifndef CONFIG_RAMLOG_NONBLOCKING
+  /* Are there threads waiting for read data? */
 
-  flags = enter_critical_section();
+  readers_waken = ramlog_readnotify(priv);
+#endif
 
-#ifdef CONFIG_RAMLOG_CRLF
-  /* Ignore carriage returns */
+  /* If there are multiple readers, some of them might block despite
+   * POLLIN because first reader might read all data. Favor readers
+   * and notify poll waiters only if no reader was awakened, even if
+   * the latter may starve.
+   *
+   * This also implies we do not have to make these two notify
+   * operations a critical section.
+   */
 
-  if (ch == '\r')
+  if (readers_waken == 0)
     {
-      leave_critical_section(flags);
-      return OK;
+      /* Notify all poll/select waiters that they can read from the FIFO */
+
+      ramlog_pollnotify(priv, POLLIN);
     }
+}
 
-  /* Pre-pend a carriage before a linefeed */
+/****************************************************************************
+ * Name: ramlog_copyin
+ *
+ * Description:
+ *   Copy a run of bytes into the circular buffer with at most two
+ *   memcpy() calls.  One byte is always left free so that a full buffer
+ *   can be told from an empty one.  With CONFIG_RAMLOG_OVERWRITE the
+ *   oldest data is dropped to make room; otherwise whatever does not fit
+ *   is dropped.  Must be called in a critical section.
+ *
+ * Returned Value:
+ *   The number of bytes of the buffer that were saved, or that replaced
+ *   older data.
+ *
+ ****************************************************************************/
 
-  if (ch == '\n')
+static size_t ramlog_copyin(FAR struct ramlog_dev_s *priv,
+                            FAR const char *buffer, size_t len)
+{
+  size_t bufsize = priv->rl_bufsize;
+  size_t head    = priv->rl_head;
+  size_t tail    = priv->rl_tail;
+  size_t nsaved  = len;
+  size_t space;
+  size_t chunk;
+
+  space = (tail + bufsize - head - 1) % bufsize;
+  if (len > space)
     {
-      ch = '\r';
-    }
-
-again:
-#endif
+#ifdef CONFIG_RAMLOG_OVERWRITE
+      /* Only the end of the run can be kept if it is larger than the
+       * whole buffer; the head moves on as if the rest had been written.
+       * The buffer ends up full, with the tail just after the head.
+       */
 
-  /* Calculate the write index AFTER the next byte is written */
+      if (len > bufsize - 1)
+        {
+          head    = (head + len - (bufsize - 1)) % bufsize;
+          buffer += len - (bufsize - 1);
+          len     = bufsize - 1;
+        }
 
-  nexthead = priv->rl_head + 1;
-  if (nexthead >= priv->rl_bufsize)
-    {
-      nexthead = 0;
+      tail = (head + len + 1) % bufsize;
+#else
+      len    = space;
+      nsaved = space;
+#endif
     }
 
-  /* Would the next write overflow the circular buffer? */
-
-  if (nexthead == priv->rl_tail)
+  while (len > 0)
     {
-#ifdef CONFIG_RAMLOG_OVERWRITE
-      /* Yes... Overwrite with the latest log in the circular buffer */
+      chunk = bufsize - head;
+      if (chunk > len)
+        {
+          chunk = len;
+        }
+
+      memcpy(&priv->rl_buffer[head], buffer, chunk);
 
-      priv->rl_buffer[priv->rl_tail] = '\0';
-      priv->rl_tail += 1;
-      if (priv->rl_tail >= priv->rl_bufsize)
+      head += chunk;
+      if (head >= bufsize)
         {
-          priv->rl_tail = 0;
+          head = 0;
         }
-#else
-      /* Yes... Return an indication that nothing was saved in the buffer. */
 
-      leave_critical_section(flags);
-      return -EBUSY;
-#endif
+      buffer += chunk;
+      len    -= chunk;
     }
 
-  /* No... copy the byte and re-enable interrupts */
+  /* Free space is kept zeroed (see ramlog_initbuf).  After overwriting,
+   * the only free byte is the one at the head.
+   */
+
+  if (nsaved > space)
+    {
+      priv->rl_buffer[head] = '\0';
+    }
 
-  priv->rl_buffer[priv->rl_head] = ch;
-  priv->rl_head = nexthead;
+  priv->rl_head = head;
+  priv->rl_tail = tail;
+  return nsaved;
+}
 
+/****************************************************************************
+ * Name: ramlog_addrun
+ *
+ * Description:
+ *   Add a run of characters to the circular buffer, expanding line ends
+ *   if so configured.  Must be called in a critical section.
+ *
+ * Returned Value:
+ *   The number of bytes saved, counting the expanded line ends.
+ *
+ ****************************************************************************/
+
+static size_t ramlog_addrun(FAR struct ramlog_dev_s *priv,
+                            FAR const char *buffer, size_t len)
+{
 #ifdef CONFIG_RAMLOG_CRLF
-  if (ch == '\r')
+  FAR const char *end = buffer + len;
+  FAR const char *ptr;
+  size_t nsaved = 0;
+  size_t nrun;
+  size_t ret;
+
+  /* Copy everything between line ends as one run.  Carriage returns are
+   * ignored and a carriage return is prepended to each linefeed.
+   */
+
+  while (buffer < end)
     {
-      ch = '\n';
-      goto again;
+      for (ptr = buffer; ptr < end && *ptr != '\r' && *ptr != '\n'; ptr++)
+        {
+        }
+
+      nrun = ptr - buffer;
+      if (nrun > 0)
+        {
+          ret     = ramlog_copyin(priv, buffer, nrun);
+          nsaved += ret;
+          if (ret < nrun)
+            {
+              break;
+            }
+        }
+
+      if (ptr < end && *ptr == '\n')
+        {
+          ret     = ramlog_copyin(priv, "\r\n", 2);
+          nsaved += ret;
+          if (ret < 2)
+            {
+              break;
+            }
+        }
+
+      buffer = ptr < end ? ptr + 1 : end;
     }
-#endif
 
-  leave_critical_section(flags);
-  return OK;
+  return nsaved;
+#else
+  return ramlog_copyin(priv, buffer, len);
+#endif
 }
 
 /****************************************************************************
@@ -354,9 +453,8 @@ again:
 static ssize_t ramlog_addbuf(FAR struct ramlog_dev_s *priv,
                              FAR const char *buffer, size_t len)
 {
-  int readers_waken;
-  ssize_t nwritten;
-  char ch;
+  irqstate_t flags;
+  size_t nsaved;
   int ret;
 
   ret = nxsem_wait(&priv->rl_exclsem);
@@ -365,54 +463,27 @@ static ssize_t ramlog_addbuf(FAR struct ramlog_dev_s *priv,
       return ret;
     }
 
-  for (nwritten = 0; (size_t)nwritten < len; nwritten++)
+#ifdef CONFIG_RAMLOG_SYSLOG
+  if (priv == &g_sysdev)
     {
-      /* Get the next character to output */
-
-      ch = buffer[nwritten];
-
-      /* Then output the character */
-
-      ret = ramlog_addchar(priv, ch);
-      if (ret < 0)
-        {
-          /* The buffer is full and nothing was saved.  The remaining
-           * data to be written is dropped on the floor.
-           */
-
-          break;
-        }
+      ramlog_initbuf();
     }
-
-  /* Was anything written? */
-
-  if (nwritten > 0)
-    {
-      readers_waken = 0;
-
-#ifndef CONFIG_RAMLOG_NONBLOCKING
-      /* Are there threads waiting for read data? */
-
-      readers_waken = ramlog_readnotify(priv);
 #endif
 
-      /* If there are multiple readers, some of them might block despite
-       * POLLIN because first reader might read all data. Favor readers
-       * and notify poll waiters only if no reader was awakened, even if
-       * the latter may starve.
-       *
-       * This also implies we do not have to make these two notify
-       * operations a critical section.
-       */
+  /* Disable interrupts (in case we are NOT called from interrupt handler)
+   * and copy the whole buffer in runs.  If the buffer is full, the
+   * remaining data to be written is dropped on the floor.
+   */
 
-      if (readers_waken == 0)
-        {
-          /* Notify all poll/select waiters that they can read from the
-           * FIFO.
-           */
+  flags  = enter_critical_section();
+  nsaved = ramlog_addrun(priv, buffer, len);
+  leave_critical_section(flags);
 
-          ramlog_pollnotify(priv, POLLIN);
-        }
+  /* Wake up the readers once for the whole buffer */
+
+  if (nsaved > 0)
+    {
+      ramlog_addnotify(priv);
     }
 
   /* We always have to return the number of bytes requested and NOT the
@@ -433,8 +504,10 @@ static ssize_t ramlog_file_read(FAR struct file *filep, FAR char *buffer,
 {
   FAR struct inode *inode = filep->f_inode;
   FAR struct ramlog_dev_s *priv;
+  irqstate_t flags;
   ssize_t nread;
-  char ch;
+  size_t chunk;
+  size_t tail;
   int ret;
 
   /* Some sanity checking */
@@ -548,24 +621,36 @@ static ssize_t ramlog_file_read(FAR struct file *filep, FAR char *buffer,
         }
       else
         {
-          /* The circular buffer is not empty, get the next byte from the
-           * tail index.
+          /* The circular buffer is not empty, copy the contiguous data
+           * from the tail index, and zero it again.  A writer may move the
+           * tail when overwriting, so this is a critical section.
            */
 
-          ch = priv->rl_buffer[priv->rl_tail];
-          priv->rl_buffer[priv->rl_tail] = '\0';
+          flags = enter_critical_section();
 
-          /* Increment the tail index. */
+          tail  = priv->rl_tail;
+          chunk = priv->rl_head >= tail ? priv->rl_head - tail :
+                                          priv->rl_bufsize - tail;
+          if (chunk > len - nread)
+            {
+              chunk = len - nread;
+            }
+
+          memcpy(&buffer[nread], &priv->rl_buffer[tail], chunk);
+          memset(&priv->rl_buffer[tail], 0, chunk);
 
-          if (++priv->rl_tail >= priv->rl_bufsize)
+          /* Advance the tail index. */
+
+          tail += chunk;
+          if (tail >= priv->rl_bufsize)
             {
-              priv->rl_tail = 0;
+              tail = 0;
             }
 
-          /* Add the character to the user buffer. */
+          priv->rl_tail = tail;
+          leave_critical_section(flags);
 
-          buffer[nread] = ch;
-          nread++;
+          nread += chunk;
         }
     }
 
@@ -633,6 +718,76 @@ static int ramlog_file_ioctl(FAR struct file *filep, int cmd,
         *(FAR int *)((uintptr_t)arg) = (priv->rl_bufsize + priv->rl_head -
                                         priv->rl_tail) % priv->rl_bufsize;
         break;
+
+      /* Zero-copy collection:  Map the buffer, get the positions, copy
+       * out or send the data between tail and head, then consume it.
+       */
+
+      case FIOC_MMAP:
+        *(FAR void **)((uintptr_t)arg) = priv->rl_buffer;
+        break;
+
+      case RAMLOGIOC_GETPOS:
+        {
+          FAR struct ramlog_pos_s *pos =
+            (FAR struct ramlog_pos_s *)((uintptr_t)arg);
+          irqstate_t flags;
+
+          flags     = enter_critical_section();
+          pos->head = priv->rl_head;
+          pos->tail = priv->rl_tail;
+          pos->size = priv->rl_bufsize;
+          leave_critical_section(flags);
+        }
+        break;
+
+      case RAMLOGIOC_CONSUME:
+        {
+          irqstate_t flags;
+          size_t count;
+          size_t chunk;
+          size_t tail;
+
+          flags = enter_critical_section();
+          count = (priv->rl_bufsize + priv->rl_head - priv->rl_tail) %
+                  priv->rl_bufsize;
+          if (arg > count)
+            {
+              arg = count;
+            }
+
+          count = arg;
+          tail  = priv->rl_tail;
+
+          while (count > 0)
+            {
+              chunk = priv->rl_bufsize - tail;
+              if (chunk > count)
+                {
+                  chunk = count;
+                }
+
+              memset(&priv->rl_buffer[tail], 0, chunk);
+
+              tail += chunk;
+              if (tail >= priv->rl_bufsize)
+                {
+                  tail = 0;
+                }
+
+              count -= chunk;
+            }
+
+          priv->rl_tail = tail;
+          leave_critical_section(flags);
+
+          if (arg > 0)
+            {
+              ramlog_pollnotify(priv, POLLOUT);
+            }
+        }
+        break;
+
       default:
         ret = -ENOTTY;
         break;
@@ -841,41 +996,43 @@ void ramlog_syslog_register(void)
 int ramlog_putc(FAR struct syslog_channel_s *channel, int ch)
 {
   FAR struct ramlog_dev_s *priv = &g_sysdev;
-  int readers_waken = 0;
-  int ret;
+  irqstate_t flags;
+  size_t nsaved;
+  char c = ch;
 
   UNUSED(channel);
 
   /* Add the character to the RAMLOG */
 
-  ret = ramlog_addchar(priv, ch);
-  if (ret < 0)
-    {
-      /* The buffer is full and 'ch' was not saved. */
+  ramlog_initbuf();
 
-      return ret;
-    }
+  flags  = enter_critical_section();
+  nsaved = ramlog_addrun(priv, &c, 1);
+  leave_critical_section(flags);
 
-#ifndef CONFIG_RAMLOG_NONBLOCKING
-  /* Are there threads waiting for read data? */
+  if (nsaved == 0)
+    {
+#ifdef CONFIG_RAMLOG_CRLF
+      if (c == '\r')
+        {
+          /* Carriage returns are ignored */
 
-  readers_waken = ramlog_readnotify(priv);
+          return ch;
+        }
 #endif
 
-  /* If there are multiple readers, some of them might block despite
-   * POLLIN because first reader might read all data. Favor readers
-   * and notify poll waiters only if no reader was awakened, even if
-   * the latter may starve.
-   *
-   * This also implies we do not have to make these two notify
-   * operations a critical section.
+      /* The buffer is full and 'ch' was not saved. */
+
+      return -EBUSY;
+    }
+
+  /* Single characters mostly come from interrupt level output.  Wake up
+   * the readers once per line rather than once per character.
    */
 
-  if (readers_waken == 0)
+  if (c == '\n')
     {
-      /* Notify all poll/select waiters that they can read from the FIFO */
-
-      ramlog_pollnotify(priv, POLLIN);
+      ramlog_addnotify(priv);
     }
 
   /* Return the character added on success */
@@ -27,7 +27,10 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <time.h>
 
 /****************************************************************************
  * Public Data
@@ -278,6 +281,93 @@ ssize_t syslog_write(FAR const char *buffer, size_t buflen);
 
 int syslog_force(int ch);
 
+/****************************************************************************
+ * Name: syslog_gettime
+ *
+ * Description:
+ *   Get the time stamp for a new SYSLOG message, or zero if timestamps are
+ *   disabled or the timer hardware is not yet initialized.
+ *
+ * Input Parameters:
+ *   ts - The location to return the time stamp.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void syslog_gettime(FAR struct timespec *ts);
+
+/****************************************************************************
+ * Name: syslog_header and syslog_trailer
+ *
+ * Description:
+ *   Output the configured decorations that precede and follow the text of
+ *   a SYSLOG message.
+ *
+ * Input Parameters:
+ *   stream   - The stream to output to.
+ *   priority - The message priority.
+ *   ts       - The time stamp of the message.
+ *   cpu      - The CPU that logged the message.
+ *   pid      - The task that logged the message.
+ *
+ * Returned Value:
+ *   The number of characters output.
+ *
+ ****************************************************************************/
+
+struct lib_outstream_s; /* Forward reference */
+int syslog_header(FAR struct lib_outstream_s *stream, int priority,
+                  FAR const struct timespec *ts, int cpu, pid_t pid);
+int syslog_trailer(FAR struct lib_outstream_s *stream);
+
+/****************************************************************************
+ * Name: syslog_deferred_post
+ *
+ * Description:
+ *   Save the format string pointer and the raw arguments of a message in
+ *   the per-CPU binary log to be formatted later by the SYSLOG worker.
+ *
+ * Input Parameters:
+ *   priority - The message priority.
+ *   fmt      - The format string, which must remain valid until the record
+ *              is formatted.
+ *   ap       - The arguments.
+ *
+ * Returned Value:
+ *   Zero (OK) if the record was queued.  A negated errno value is returned
+ *   if the message must be formatted immediately instead:  -EAGAIN before
+ *   the OS is ready or for urgent messages, -ENOTSUP for a conversion
+ *   whose argument cannot be saved, and -E2BIG if the record does not fit
+ *   in CONFIG_SYSLOG_DEFERRED_RECSIZE.
+ *
+ * Assumptions:
+ *   May be called from interrupt handlers.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+int syslog_deferred_post(int priority, FAR const IPTR char *fmt,
+                         FAR va_list *ap);
+#endif
+
+/****************************************************************************
+ * Name: syslog_deferred_flush
+ *
+ * Description:
+ *   Format all pending records of the binary log in time stamp order and
+ *   send them to the SYSLOG channels.
+ *
+ * Returned Value:
+ *   The number of records formatted.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+int syslog_deferred_flush(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -0,0 +1,904 @@
+/****************************************************************************
+ * drivers/syslog/syslog_deferred.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Deferred (binary) logging:  Instead of formatting the message in the
+ * context of the caller, nx_vsyslog() saves the time stamp, the priority,
+ * the format string pointer and the raw arguments in a ring buffer that
+ * belongs to the current CPU.  A worker later formats the records of all
+ * CPUs in time stamp order.
+ *
+ * The format string is only scanned, not interpreted, when the record is
+ * made, to learn the size of each argument.  Strings are copied because
+ * they may not outlive the call.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/init.h>
+#include <nuttx/clock.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/streams.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/syslog/syslog.h>
+
+#include "syslog.h"
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if !defined(CONFIG_SCHED_WORKQUEUE)
+#  error Work queue support is required (CONFIG_SCHED_WORKQUEUE)
+#endif
+
+/* The low priority work queue is preferred.  If it is not enabled, LPWORK
+ * will be the same as HPWORK.
+ */
+
+#define SYSLOGWORK LPWORK
+
+/* The ring buffers are volatile, which orders the accesses on one CPU;
+ * the consumer can only run on another CPU with SMP, where spinlock
+ * support provides the memory barrier.
+ */
+
+#ifdef CONFIG_SMP
+#  define SYSLOG_NCPUS        CONFIG_SMP_NCPUS
+#  define syslog_cpu()        up_cpu_index()
+#  define SYSLOG_DMB()        SP_DMB()
+#else
+#  define SYSLOG_NCPUS        1
+#  define syslog_cpu()        0
+#  define SYSLOG_DMB()
+#endif
+
+/* Sizes in 32-bit words.  The ring size must be a power of two. */
+
+#define SYSLOG_RINGWORDS      (CONFIG_SYSLOG_DEFERRED_BUFSIZE / 4)
+#define SYSLOG_RINGMASK       (SYSLOG_RINGWORDS - 1)
+#define SYSLOG_RECWORDS       (CONFIG_SYSLOG_DEFERRED_RECSIZE / 4)
+#define SYSLOG_HDRWORDS       (sizeof(struct syslog_record_s) / 4)
+
+#if (SYSLOG_RINGWORDS & SYSLOG_RINGMASK) != 0
+#  error CONFIG_SYSLOG_DEFERRED_BUFSIZE must be a power of two
+#endif
+
+#if CONFIG_SYSLOG_DEFERRED_RECSIZE > CONFIG_SYSLOG_DEFERRED_BUFSIZE
+#  error CONFIG_SYSLOG_DEFERRED_RECSIZE exceeds the buffer size
+#endif
+
+/* Messages at this priority or more urgent are never deferred so that
+ * they reach the channels even if the system does not survive.
+ */
+
+#define SYSLOG_URGENT         LOG_CRIT
+
+/* The longest conversion specification that is accepted, with room for
+ * the expansion of '*' width and precision.
+ */
+
+#define SYSLOG_SPECLEN        16
+#define SYSLOG_SPECBUF        (SYSLOG_SPECLEN + 24)
+
+/* Argument classes, by the type that va_arg() must fetch */
+
+#define SYSLOG_ARG_NONE       0  /* "%%" */
+#define SYSLOG_ARG_INT        1  /* int, and anything promoted to int */
+#define SYSLOG_ARG_LONG       2  /* long */
+#define SYSLOG_ARG_LLONG      3  /* long long */
+#define SYSLOG_ARG_DOUBLE     4  /* double */
+#define SYSLOG_ARG_PTR        5  /* void * */
+#define SYSLOG_ARG_STR        6  /* char *, copied into the record */
+
+/* String length marking a NULL string pointer */
+
+#define SYSLOG_NULLSTR        0xffff
+
+/* Precision of a conversion without one, and of a '*' precision */
+
+#define SYSLOG_PREC_NONE      -1
+#define SYSLOG_PREC_STAR      -2
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The fixed part of a record.  The packed arguments follow, each rounded
+ * up to a multiple of 32 bits.
+ */
+
+struct syslog_record_s
+{
+  uint16_t len;                  /* Length of the record in words */
+  uint8_t priority;              /* Message priority */
+  uint8_t cpu;                   /* CPU that logged the message */
+  int32_t pid;                   /* Task that logged the message */
+  uint32_t sec;                  /* Time stamp */
+  uint32_t nsec;
+  FAR const IPTR char *fmt;      /* Format string */
+};
+
+union syslog_recbuf_u
+{
+  struct syslog_record_s hdr;
+  uint32_t words[SYSLOG_RECWORDS];
+  uint8_t bytes[SYSLOG_RECWORDS * 4];
+};
+
+/* A parsed conversion specification */
+
+struct syslog_spec_s
+{
+  uint8_t len;                   /* Length of the specification text */
+  uint8_t nstar;                 /* Number of '*' int arguments */
+  uint8_t type;                  /* SYSLOG_ARG_* class of the argument */
+  int prec;                      /* Precision or SYSLOG_PREC_* */
+};
+
+/* The ring buffer of one CPU.  It has a single producer, the CPU itself
+ * with interrupts disabled, and a single consumer, the flush logic.
+ */
+
+struct syslog_ring_s
+{
+  volatile uint32_t head;        /* Word index of the next record to add */
+  volatile uint32_t tail;        /* Word index of the oldest record */
+  volatile uint32_t dropped;     /* Records lost to a full buffer */
+  uint32_t reported;             /* Drops already reported by the consumer */
+  volatile uint32_t buffer[SYSLOG_RINGWORDS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct syslog_ring_s g_syslog_ring[SYSLOG_NCPUS];
+static struct work_s g_syslog_work;
+
+/* Only one thread renders records at a time.  g_syslog_flusher is the
+ * thread that does so, -1 if nobody or an interrupt handler does.
+ */
+
+static sem_t g_syslog_flushsem = SEM_INITIALIZER(1);
+static volatile pid_t g_syslog_flusher = -1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_scan_spec
+ *
+ * Description:
+ *   Parse the conversion specification at fmt, which points just after the
+ *   '%'.  Conversions whose argument cannot be saved (%n, long double, wide
+ *   strings and anything unknown) are refused.
+ *
+ ****************************************************************************/
+
+static int syslog_scan_spec(FAR const char *fmt,
+                            FAR struct syslog_spec_s *spec)
+{
+  FAR const char *p = fmt;
+  int nlong = 0;
+  bool half = false;
+
+  spec->nstar = 0;
+  spec->prec  = SYSLOG_PREC_NONE;
+
+  if (*p == '%')
+    {
+      spec->len  = 1;
+      spec->type = SYSLOG_ARG_NONE;
+      return OK;
+    }
+
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    {
+      p++;
+    }
+
+  if (*p == '*')
+    {
+      spec->nstar++;
+      p++;
+    }
+  else
+    {
+      while (*p >= '0' && *p <= '9')
+        {
+          p++;
+        }
+    }
+
+  if (*p == '.')
+    {
+      p++;
+      if (*p == '*')
+        {
+          spec->nstar++;
+          spec->prec = SYSLOG_PREC_STAR;
+          p++;
+        }
+      else
+        {
+          /* The precision bounds the octets read from a string argument.
+           * Anything larger than a record is as good as no bound.
+           */
+
+          spec->prec = 0;
+          while (*p >= '0' && *p <= '9')
+            {
+              if (spec->prec < CONFIG_SYSLOG_DEFERRED_RECSIZE)
+                {
+                  spec->prec = spec->prec * 10 + *p - '0';
+                }
+
+              p++;
+            }
+        }
+    }
+
+  /* Map the length modifier to the size of the argument */
+
+  switch (*p)
+    {
+      case 'h':
+        half = true;
+        while (*p == 'h')
+          {
+            p++;
+          }
+        break;
+
+      case 'l':
+        while (*p == 'l')
+          {
+            nlong++;
+            p++;
+          }
+        break;
+
+      case 'j':
+        nlong = sizeof(intmax_t) == sizeof(long) ? 1 : 2;
+        p++;
+        break;
+
+      case 'z':
+        nlong = sizeof(size_t) == sizeof(long) ? 1 : 0;
+        p++;
+        break;
+
+      case 't':
+        nlong = sizeof(ptrdiff_t) == sizeof(long) ? 1 : 0;
+        p++;
+        break;
+
+      default:
+        break;
+    }
+
+  switch (*p)
+    {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+        spec->type = nlong == 0 ? SYSLOG_ARG_INT :
+                     nlong == 1 ? SYSLOG_ARG_LONG : SYSLOG_ARG_LLONG;
+        break;
+
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        spec->type = SYSLOG_ARG_DOUBLE;
+        break;
+
+      case 'p':
+        spec->type = SYSLOG_ARG_PTR;
+        break;
+
+      case 's':
+        if (nlong != 0 || half)
+          {
+            return -ENOTSUP;
+          }
+
+        spec->type = SYSLOG_ARG_STR;
+        break;
+
+      default:
+        return -ENOTSUP;
+    }
+
+  if (p + 1 - fmt > SYSLOG_SPECLEN)
+    {
+      return -E2BIG;
+    }
+
+  spec->len = p + 1 - fmt;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_pack
+ *
+ * Description:
+ *   Append size bytes to the record at byte offset *pos, rounding the
+ *   offset up to the next word.
+ *
+ ****************************************************************************/
+
+static int syslog_pack(FAR union syslog_recbuf_u *rec, FAR size_t *pos,
+                       FAR const void *data, size_t size)
+{
+  if (*pos + size > sizeof(rec->bytes))
+    {
+      return -E2BIG;
+    }
+
+  memcpy(&rec->bytes[*pos], data, size);
+  *pos = (*pos + size + 3) & ~(size_t)3;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_unpack
+ *
+ * Description:
+ *   The counterpart of syslog_pack().
+ *
+ ****************************************************************************/
+
+static void syslog_unpack(FAR const union syslog_recbuf_u *rec,
+                          FAR size_t *pos, FAR void *data, size_t size)
+{
+  memcpy(data, &rec->bytes[*pos], size);
+  *pos = (*pos + size + 3) & ~(size_t)3;
+}
+
+/****************************************************************************
+ * Name: syslog_pack_args
+ *
+ * Description:
+ *   Scan the format string and append the raw arguments to the record.
+ *
+ ****************************************************************************/
+
+static int syslog_pack_args(FAR union syslog_recbuf_u *rec,
+                            FAR size_t *pos, FAR const char *fmt,
+                            FAR va_list *ap)
+{
+  struct syslog_spec_s spec;
+  FAR const char *str;
+  long long llval;
+  uint16_t slen;
+  size_t len;
+  double dval;
+  void *pval;
+  long lval;
+  int prec;
+  int ival;
+  int ret;
+  int i;
+
+  while ((fmt = strchr(fmt, '%')) != NULL)
+    {
+      fmt++;
+      ret = syslog_scan_spec(fmt, &spec);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      fmt += spec.len;
+      prec = spec.prec;
+
+      for (i = 0; i < spec.nstar; i++)
+        {
+          ival = va_arg(*ap, int);
+          ret  = syslog_pack(rec, pos, &ival, sizeof(ival));
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          /* A '*' precision is the last '*' argument.  As with printf(),
+           * a negative value means that there is no precision.
+           */
+
+          if (spec.prec == SYSLOG_PREC_STAR)
+            {
+              prec = ival;
+            }
+        }
+
+      switch (spec.type)
+        {
+          case SYSLOG_ARG_INT:
+            ival = va_arg(*ap, int);
+            ret  = syslog_pack(rec, pos, &ival, sizeof(ival));
+            break;
+
+          case SYSLOG_ARG_LONG:
+            lval = va_arg(*ap, long);
+            ret  = syslog_pack(rec, pos, &lval, sizeof(lval));
+            break;
+
+          case SYSLOG_ARG_LLONG:
+            llval = va_arg(*ap, long long);
+            ret   = syslog_pack(rec, pos, &llval, sizeof(llval));
+            break;
+
+          case SYSLOG_ARG_DOUBLE:
+            dval = va_arg(*ap, double);
+            ret  = syslog_pack(rec, pos, &dval, sizeof(dval));
+            break;
+
+          case SYSLOG_ARG_PTR:
+            pval = va_arg(*ap, FAR void *);
+            ret  = syslog_pack(rec, pos, &pval, sizeof(pval));
+            break;
+
+          case SYSLOG_ARG_STR:
+
+            /* Copy the string with a 16-bit length in front of it.  With
+             * a precision, the string need not be NUL terminated.
+             */
+
+            str = va_arg(*ap, FAR const char *);
+            if (str == NULL)
+              {
+                len = SYSLOG_NULLSTR;
+              }
+            else if (prec >= 0 && (size_t)prec < sizeof(rec->bytes))
+              {
+                len = strnlen(str, prec);
+              }
+            else
+              {
+                len = strnlen(str, sizeof(rec->bytes));
+              }
+
+            if (str != NULL && len >= sizeof(rec->bytes))
+              {
+                return -E2BIG;
+              }
+
+            slen = len;
+
+            ret = syslog_pack(rec, pos, &slen, sizeof(slen));
+            if (ret >= 0 && str != NULL)
+              {
+                ret = syslog_pack(rec, pos, str, slen);
+              }
+            break;
+
+          default:
+            ret = OK;
+            break;
+        }
+
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_render
+ *
+ * Description:
+ *   Format one record to the SYSLOG channels.  Each conversion is handed
+ *   to lib_sprintf() with just its own argument, with any '*' replaced by
+ *   the saved value.
+ *
+ ****************************************************************************/
+
+static void syslog_render(FAR const union syslog_recbuf_u *rec)
+{
+  struct lib_syslogstream_s stream;
+  struct syslog_spec_s spec;
+  struct timespec ts;
+  FAR const char *fmt = rec->hdr.fmt;
+  FAR const char *next;
+  char buf[SYSLOG_SPECBUF];
+  char str[CONFIG_SYSLOG_DEFERRED_RECSIZE];
+  size_t pos = sizeof(struct syslog_record_s);
+  long long llval;
+  uint16_t slen;
+  double dval;
+  void *pval;
+  long lval;
+  int ival;
+  int blen;
+  int i;
+
+  ts.tv_sec  = rec->hdr.sec;
+  ts.tv_nsec = rec->hdr.nsec;
+
+  syslogstream_create(&stream);
+  syslog_header(&stream.public, rec->hdr.priority, &ts, rec->hdr.cpu,
+                rec->hdr.pid);
+
+  while ((next = strchr(fmt, '%')) != NULL)
+    {
+      if (next > fmt)
+        {
+          stream.public.puts(&stream.public, fmt, next - fmt);
+        }
+
+      /* The specification was accepted when the record was made */
+
+      next++;
+      syslog_scan_spec(next, &spec);
+      fmt = next + spec.len;
+
+      /* Rebuild the specification with the '*' values filled in */
+
+      buf[0] = '%';
+      blen   = 1;
+
+      for (i = 0; i < spec.len; i++)
+        {
+          if (next[i] == '*')
+            {
+              syslog_unpack(rec, &pos, &ival, sizeof(ival));
+              blen += snprintf(&buf[blen], sizeof(buf) - blen, "%d", ival);
+            }
+          else
+            {
+              buf[blen++] = next[i];
+            }
+        }
+
+      buf[blen] = '\0';
+
+      switch (spec.type)
+        {
+          case SYSLOG_ARG_NONE:
+            lib_sprintf(&stream.public, "%%");
+            break;
+
+          case SYSLOG_ARG_INT:
+            syslog_unpack(rec, &pos, &ival, sizeof(ival));
+            lib_sprintf(&stream.public, buf, ival);
+            break;
+
+          case SYSLOG_ARG_LONG:
+            syslog_unpack(rec, &pos, &lval, sizeof(lval));
+            lib_sprintf(&stream.public, buf, lval);
+            break;
+
+          case SYSLOG_ARG_LLONG:
+            syslog_unpack(rec, &pos, &llval, sizeof(llval));
+            lib_sprintf(&stream.public, buf, llval);
+            break;
+
+          case SYSLOG_ARG_DOUBLE:
+            syslog_unpack(rec, &pos, &dval, sizeof(dval));
+            lib_sprintf(&stream.public, buf, dval);
+            break;
+
+          case SYSLOG_ARG_PTR:
+            syslog_unpack(rec, &pos, &pval, sizeof(pval));
+            lib_sprintf(&stream.public, buf, pval);
+            break;
+
+          case SYSLOG_ARG_STR:
+            syslog_unpack(rec, &pos, &slen, sizeof(slen));
+            if (slen == SYSLOG_NULLSTR)
+              {
+                lib_sprintf(&stream.public, buf, (FAR const char *)NULL);
+              }
+            else
+              {
+                syslog_unpack(rec, &pos, str, slen);
+                str[slen] = '\0';
+                lib_sprintf(&stream.public, buf, str);
+              }
+            break;
+        }
+    }
+
+  if (*fmt != '\0')
+    {
+      stream.public.puts(&stream.public, fmt, strlen(fmt));
+    }
+
+  syslog_trailer(&stream.public);
+
+#ifdef CONFIG_SYSLOG_BUFFER
+  syslogstream_destroy(&stream);
+#endif
+}
+
+/****************************************************************************
+ * Name: syslog_ring_peek
+ *
+ * Description:
+ *   Copy nwords of the oldest record in the ring, if any.
+ *
+ ****************************************************************************/
+
+static bool syslog_ring_peek(FAR struct syslog_ring_s *ring,
+                             FAR union syslog_recbuf_u *rec, size_t nwords)
+{
+  uint32_t tail = ring->tail;
+  size_t i;
+
+  if (ring->head == tail)
+    {
+      return false;
+    }
+
+  /* Read the record only after seeing the head that publishes it */
+
+  SYSLOG_DMB();
+
+  for (i = 0; i < nwords; i++)
+    {
+      rec->words[i] = ring->buffer[(tail + i) & SYSLOG_RINGMASK];
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_worker
+ ****************************************************************************/
+
+static void syslog_deferred_worker(FAR void *arg)
+{
+  syslog_deferred_flush();
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_deferred_post
+ *
+ * Description:
+ *   Save the format string pointer and the raw arguments of a message in
+ *   the per-CPU binary log to be formatted later by the SYSLOG worker.
+ *
+ ****************************************************************************/
+
+int syslog_deferred_post(int priority, FAR const IPTR char *fmt,
+                         FAR va_list *ap)
+{
+  union syslog_recbuf_u rec;
+  FAR struct syslog_ring_s *ring;
+  struct timespec ts;
+  irqstate_t flags;
+  size_t pos = sizeof(struct syslog_record_s);
+  uint32_t head;
+  size_t len;
+  size_t i;
+  va_list copy;
+  int ret;
+
+  /* Format synchronously until the work queues are running.  Urgent
+   * messages are also formatted synchronously, after everything that was
+   * logged before them.
+   */
+
+  if (!OSINIT_OS_READY())
+    {
+      return -EAGAIN;
+    }
+
+  if (priority <= SYSLOG_URGENT)
+    {
+      syslog_deferred_flush();
+      return -EAGAIN;
+    }
+
+  va_copy(copy, *ap);
+  ret = syslog_pack_args(&rec, &pos, fmt, &copy);
+  va_end(copy);
+
+  if (ret < 0)
+    {
+      /* This one will be formatted synchronously, so keep the order */
+
+      syslog_deferred_flush();
+      return ret;
+    }
+
+  syslog_gettime(&ts);
+
+  len                = pos / 4;
+  rec.hdr.len        = len;
+  rec.hdr.priority   = priority;
+  rec.hdr.pid        = getpid();
+  rec.hdr.sec        = ts.tv_sec;
+  rec.hdr.nsec       = ts.tv_nsec;
+  rec.hdr.fmt        = fmt;
+
+  /* Interrupts are disabled only to keep this CPU to itself; the ring is
+   * not shared with any other producer.
+   */
+
+  flags          = up_irq_save();
+  rec.hdr.cpu    = syslog_cpu();
+  ring           = &g_syslog_ring[rec.hdr.cpu];
+  head           = ring->head;
+
+  if (SYSLOG_RINGWORDS - (head - ring->tail) < len)
+    {
+      ring->dropped++;
+    }
+  else
+    {
+      for (i = 0; i < len; i++)
+        {
+          ring->buffer[(head + i) & SYSLOG_RINGMASK] = rec.words[i];
+        }
+
+      /* Publish the record only after it is complete */
+
+      SYSLOG_DMB();
+      ring->head = head + len;
+    }
+
+  up_irq_restore(flags);
+
+  /* Wake up the worker, unless it is already pending */
+
+  if (work_available(&g_syslog_work))
+    {
+      work_queue(SYSLOGWORK, &g_syslog_work, syslog_deferred_worker, NULL,
+                 MSEC2TICK(CONFIG_SYSLOG_DEFERRED_DELAY));
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_flush
+ *
+ * Description:
+ *   Format all pending records of the binary log in time stamp order and
+ *   send them to the SYSLOG channels.  If another thread is flushing, wait
+ *   until it is done:  the records may refer to format strings in memory
+ *   that the caller is about to release.  Interrupt handlers and a nested
+ *   call from the flushing thread itself cannot wait and return at once.
+ *
+ ****************************************************************************/
+
+int syslog_deferred_flush(void)
+{
+  union syslog_recbuf_u rec;
+  FAR struct syslog_ring_s *ring;
+  uint32_t dropped;
+  uint32_t sec;
+  uint32_t nsec;
+  int count = 0;
+  int cpu;
+  int i;
+
+  /* There is only one consumer at a time.  It keeps going until all rings
+   * are empty, including records added while it runs, so the records of
+   * the caller have been rendered when the active consumer is done.
+   */
+
+  if (up_interrupt_context() || !OSINIT_OS_READY() ||
+      g_syslog_flusher == gettid())
+    {
+      if (nxsem_trywait(&g_syslog_flushsem) < 0)
+        {
+          return 0;
+        }
+    }
+  else
+    {
+      nxsem_wait_uninterruptible(&g_syslog_flushsem);
+    }
+
+  g_syslog_flusher = up_interrupt_context() ? -1 : gettid();
+
+  for (; ; )
+    {
+      /* Pick the CPU with the oldest pending record */
+
+      cpu  = -1;
+      sec  = UINT32_MAX;
+      nsec = UINT32_MAX;
+
+      for (i = 0; i < SYSLOG_NCPUS; i++)
+        {
+          ring = &g_syslog_ring[i];
+
+          dropped = ring->dropped;
+          if (dropped != ring->reported)
+            {
+              syslog(LOG_WARNING, "syslog: CPU%d dropped %" PRIu32
+                     " messages\n", i, dropped - ring->reported);
+              ring->reported = dropped;
+            }
+
+          if (syslog_ring_peek(ring, &rec, SYSLOG_HDRWORDS) &&
+              (rec.hdr.sec < sec ||
+               (rec.hdr.sec == sec && rec.hdr.nsec < nsec)))
+            {
+              cpu  = i;
+              sec  = rec.hdr.sec;
+              nsec = rec.hdr.nsec;
+            }
+        }
+
+      if (cpu < 0)
+        {
+          break;
+        }
+
+      ring = &g_syslog_ring[cpu];
+      syslog_ring_peek(ring, &rec, SYSLOG_HDRWORDS);
+      syslog_ring_peek(ring, &rec, rec.hdr.len);
+
+      /* Release the space only after the record has been copied out */
+
+      SYSLOG_DMB();
+      ring->tail += rec.hdr.len;
+
+      syslog_render(&rec);
+      count++;
+    }
+
+  g_syslog_flusher = -1;
+  nxsem_post(&g_syslog_flushsem);
+  return count;
+}
+
+#endif /* CONFIG_SYSLOG_DEFERRED */
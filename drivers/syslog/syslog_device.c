@@ -25,6 +25,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <stdint.h>
 #include <stdio.h>
@@ -55,6 +56,12 @@
 
 #define SYSLOG_OFLAGS (O_WRONLY | O_CREAT | O_APPEND)
 
+/* The number of pieces (runs of text and inserted CR-LF sequences) that
+ * are gathered and written with one file_writev().
+ */
+
+#define SYSLOG_DEV_NIOV 16
+
 /* An invalid thread ID */
 
 #define NO_HOLDER     ((pid_t)-1)
@@ -413,10 +420,12 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
                                 FAR const char *buffer, size_t buflen)
 {
   FAR struct syslog_dev_s *syslog_dev = (FAR struct syslog_dev_s *)channel;
+  struct iovec iov[SYSLOG_DEV_NIOV];
   FAR const char *endptr;
   ssize_t nwritten;
   size_t writelen;
   size_t remaining;
+  int niov = 0;
   int ret;
 
   /* Check if the system is ready to do output operations */
@@ -441,7 +450,10 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
       return ret;
     }
 
-  /* Loop until we have output all characters */
+  /* Loop until we have output all characters.  The text between special
+   * characters and the CR-LF sequences that replace them are gathered in
+   * iov[] and written together.
+   */
 
   for (endptr = buffer, remaining = buflen;
        remaining > 0;
@@ -464,7 +476,7 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
             }
           else
             {
-              /* Write everything up to the position of the special
+              /* Gather everything up to the position of the special
                * character.
                *
                * - buffer points to next byte to output.
@@ -474,13 +486,9 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
               writelen = (size_t)((uintptr_t)endptr - (uintptr_t)buffer);
               if (writelen > 0)
                 {
-                  nwritten = file_write(&syslog_dev->sl_file,
-                                        buffer, writelen);
-                  if (nwritten < 0)
-                    {
-                      ret = (int)nwritten;
-                      goto errout_with_sem;
-                    }
+                  iov[niov].iov_base = (FAR void *)buffer;
+                  iov[niov].iov_len  = writelen;
+                  niov++;
                 }
 
               /* Ignore the carriage return, but for the linefeed, output
@@ -489,19 +497,28 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
 
               if (*endptr == '\n')
                 {
-                  nwritten = file_write(&syslog_dev->sl_file,
-                                        g_syscrlf, 2);
+                  iov[niov].iov_base = (FAR void *)g_syscrlf;
+                  iov[niov].iov_len  = 2;
+                  niov++;
+                }
+
+              /* Points past the special character */
+
+              buffer = endptr + 1;
+
+              /* Write out the gathered pieces before iov[] overflows */
+
+              if (niov > SYSLOG_DEV_NIOV - 2)
+                {
+                  nwritten = file_writev(&syslog_dev->sl_file, iov, niov);
                   if (nwritten < 0)
                     {
                       ret = (int)nwritten;
                       goto errout_with_sem;
                     }
-                }
 
-              /* Adjust pointers */
-
-               writelen++;         /* Skip the special character */
-               buffer += writelen; /* Points past the special character */
+                  niov = 0;
+                }
             }
         }
     }
@@ -515,7 +532,14 @@ static ssize_t syslog_dev_write(FAR struct syslog_channel_s *channel,
   writelen = (size_t)((uintptr_t)endptr - (uintptr_t)buffer);
   if (writelen > 0)
     {
-      nwritten = file_write(&syslog_dev->sl_file, buffer, writelen);
+      iov[niov].iov_base = (FAR void *)buffer;
+      iov[niov].iov_len  = writelen;
+      niov++;
+    }
+
+  if (niov > 0)
+    {
+      nwritten = file_writev(&syslog_dev->sl_file, iov, niov);
       if (nwritten < 0)
         {
           ret = (int)nwritten;
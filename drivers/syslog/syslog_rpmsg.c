@@ -26,6 +26,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <string.h>
 
 #include <nuttx/irq.h>
@@ -74,6 +75,11 @@ struct syslog_rpmsg_s
 static void syslog_rpmsg_work(FAR void *priv_);
 static void syslog_rpmsg_putchar(FAR struct syslog_rpmsg_s *priv, int ch,
                                  bool last);
+static void syslog_rpmsg_kick(FAR struct syslog_rpmsg_s *priv, int ch);
+#if CHAR_BIT == 8
+static void syslog_rpmsg_putbuf(FAR struct syslog_rpmsg_s *priv,
+                                FAR const char *buffer, size_t len);
+#endif
 static void syslog_rpmsg_device_created(FAR struct rpmsg_device *rdev,
                                         FAR void *priv_);
 static void syslog_rpmsg_device_destroy(FAR struct rpmsg_device *rdev,
@@ -186,8 +192,17 @@ static void syslog_rpmsg_putchar(FAR struct syslog_rpmsg_s *priv, int ch,
         }
     }
 
-  if (last && !priv->suspend && !priv->transfer &&
-          is_rpmsg_ept_ready(&priv->ept))
+  if (last)
+    {
+      syslog_rpmsg_kick(priv, ch);
+    }
+}
+
+/* Schedule the transfer of the new data; ch is the last character added */
+
+static void syslog_rpmsg_kick(FAR struct syslog_rpmsg_s *priv, int ch)
+{
+  if (!priv->suspend && !priv->transfer && is_rpmsg_ept_ready(&priv->ept))
     {
       clock_t delay = SYSLOG_RPMSG_WORK_DELAY;
       size_t space = SYSLOG_RPMSG_SPACE(priv->head, priv->tail, priv->size);
@@ -203,6 +218,79 @@ static void syslog_rpmsg_putchar(FAR struct syslog_rpmsg_s *priv, int ch,
     }
 }
 
+#if CHAR_BIT == 8
+/* Add a run of characters with at most two memcpy() calls.  Like
+ * syslog_rpmsg_putchar(), the oldest data is overwritten when the buffer
+ * is full.
+ */
+
+static void syslog_rpmsg_putbuf(FAR struct syslog_rpmsg_s *priv,
+                                FAR const char *buffer, size_t len)
+{
+  size_t size = priv->size;
+  size_t head = priv->head;
+  size_t tail = priv->tail;
+  bool full   = false;
+  size_t space;
+  size_t chunk;
+  size_t skip;
+
+  space = SYSLOG_RPMSG_SPACE(head, tail, size);
+  if (len > space)
+    {
+      if (priv->transfer)
+        {
+          priv->trans_len -= len - space;
+        }
+
+      /* Only the end of the run can be kept if it is larger than the
+       * whole buffer; the head moves on as if the rest had been written.
+       */
+
+      if (len > size - 1)
+        {
+          skip    = len - (size - 1);
+          head    = (head + skip) % size;
+          buffer += skip;
+          len     = size - 1;
+        }
+
+      tail = (head + len + 1) % size;
+      full = true;
+    }
+
+  while (len > 0)
+    {
+      chunk = size - head;
+      if (chunk > len)
+        {
+          chunk = len;
+        }
+
+      memcpy(&priv->buffer[head], buffer, chunk);
+
+      head += chunk;
+      if (head >= size)
+        {
+          head = 0;
+        }
+
+      buffer += chunk;
+      len    -= chunk;
+    }
+
+  /* The byte after the last one written is kept zeroed when full */
+
+  if (full)
+    {
+      priv->buffer[head] = 0;
+    }
+
+  priv->head = head;
+  priv->tail = tail;
+}
+#endif
+
 static void syslog_rpmsg_device_created(FAR struct rpmsg_device *rdev,
                                         FAR void *priv_)
 {
@@ -329,15 +417,27 @@ ssize_t syslog_rpmsg_write(FAR struct syslog_channel_s *channel,
 {
   FAR struct syslog_rpmsg_s *priv = &g_syslog_rpmsg;
   irqstate_t flags;
+#if CHAR_BIT != 8
   size_t nwritten;
+#endif
 
   UNUSED(channel);
 
+  if (buflen == 0)
+    {
+      return 0;
+    }
+
   flags = enter_critical_section();
+#if CHAR_BIT == 8
+  syslog_rpmsg_putbuf(priv, buffer, buflen);
+  syslog_rpmsg_kick(priv, buffer[buflen - 1]);
+#else
   for (nwritten = 1; nwritten <= buflen; nwritten++)
     {
       syslog_rpmsg_putchar(priv, *buffer++, nwritten == buflen);
     }
+#endif
 
   leave_critical_section(flags);
 
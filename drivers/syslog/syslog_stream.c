@@ -174,6 +174,23 @@ static void syslogstream_putc(FAR struct lib_outstream_s *this, int ch)
     }
 }
 
+/****************************************************************************
+ * Name: syslogstream_puts
+ ****************************************************************************/
+
+static void syslogstream_puts(FAR struct lib_outstream_s *this,
+                              FAR const void *buf, int len)
+{
+  FAR const char *ptr = buf;
+
+  /* Carriage returns need special handling, so go character by character */
+
+  while (len-- > 0)
+    {
+      syslogstream_putc(this, *ptr++);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -205,6 +222,7 @@ void syslogstream_create(FAR struct lib_syslogstream_s *stream)
   /* Initialize the common fields */
 
   stream->public.put   = syslogstream_putc;
+  stream->public.puts  = syslogstream_puts;
   stream->public.flush = lib_noflush;
   stream->public.nput  = 0;
 
@@ -83,6 +83,12 @@
 #  define CONFIG_USBMSC_NRDREQS 4
 #endif
 
+/* Number of sectors in each half of the I/O buffer */
+
+#ifndef CONFIG_USBMSC_IOBUFSECTORS
+#  define CONFIG_USBMSC_IOBUFSECTORS 1
+#endif
+
 /* Logical endpoint numbers / max packet sizes */
 
 #ifndef CONFIG_USBMSC_COMPOSITE
@@ -333,6 +339,10 @@
 #define USBMSC_DRVR_GEOMETRY(l,g) \
   ((l)->inode->u.i_bops->geometry((l)->inode,g))
 
+/* Size of the I/O buffer for a given sector size */
+
+#define USBMSC_IOBUFSIZE(s) (2 * CONFIG_USBMSC_IOBUFSECTORS * (s))
+
 /* Everpresent MIN/MAX macros ***********************************************/
 
 #ifndef MIN
@@ -416,9 +426,12 @@ struct usbmsc_dev_s
   uint8_t           cbwdir:2;         /* Direction from CBW. See USBMSC_FLAGS_DIR* definitions */
   uint8_t           cdblen;           /* Length of cdb[] from CBW */
   uint8_t           cbwlun;           /* LUN from the CBW */
-  uint16_t          nsectbytes;       /* Bytes buffered in iobuffer[] */
+  uint8_t           iohead;           /* Read: Half of iobuffer[] being sent */
   uint16_t          nreqbytes;        /* Bytes buffered in head write requests */
-  uint16_t          iosize;           /* Size of iobuffer[] */
+  uint32_t          nsectbytes;       /* Bytes buffered in iobuffer[] */
+  uint32_t          iooffset;         /* Read: Offset of next byte to send */
+  uint32_t          ionext;           /* Read: Bytes read ahead in other half */
+  uint32_t          iosize;           /* Size of iobuffer[] */
   uint32_t          cbwlen;           /* Length of data from CBW */
   uint32_t          cbwtag;           /* Tag from the CBW */
   union
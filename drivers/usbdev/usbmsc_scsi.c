@@ -162,6 +162,9 @@ static inline int usbmsc_setupcmd(FAR struct usbmsc_dev_s *priv,
 
 /* SCSI Worker Thread *******************************************************/
 
+static ssize_t usbmsc_readsectors(FAR struct usbmsc_dev_s *priv, int half);
+static int    usbmsc_writesectors(FAR struct usbmsc_dev_s *priv,
+                size_t nsectors);
 static int    usbmsc_idlestate(FAR struct usbmsc_dev_s *priv);
 static int    usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv);
 static int    usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv);
@@ -1920,6 +1923,9 @@ static int usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv)
 
   priv->nsectbytes   = 0;
   priv->nreqbytes    = 0;
+  priv->iohead       = 0;
+  priv->iooffset     = 0;
+  priv->ionext       = 0;
 
   /* Get exclusive access to the block driver */
 
@@ -2200,6 +2206,74 @@ static int usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv)
   return ret;
 }
 
+/****************************************************************************
+ * Name: usbmsc_readsectors
+ *
+ * Description:
+ *   Read the next sectors of a SCSI read command from the block driver into
+ *   one half of the I/O buffer and advance the command state.
+ *
+ * Returned Value:
+ *   The number of bytes read on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static ssize_t usbmsc_readsectors(FAR struct usbmsc_dev_s *priv, int half)
+{
+  FAR struct usbmsc_lun_s *lun = priv->lun;
+  FAR uint8_t *dest;
+  ssize_t nread;
+
+  dest  = &priv->iobuffer[half * CONFIG_USBMSC_IOBUFSECTORS *
+                          lun->sectorsize];
+  nread = USBMSC_DRVR_READ(lun, dest, priv->sector,
+                           MIN(priv->u.xfrlen, CONFIG_USBMSC_IOBUFSECTORS));
+  if (nread <= 0)
+    {
+      return nread < 0 ? nread : -EIO;
+    }
+
+  priv->u.xfrlen -= nread;
+  priv->sector   += nread;
+  return nread * lun->sectorsize;
+}
+
+/****************************************************************************
+ * Name: usbmsc_writesectors
+ *
+ * Description:
+ *   Write the sectors gathered in the I/O buffer by a SCSI write command to
+ *   the block driver and advance the command state.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int usbmsc_writesectors(FAR struct usbmsc_dev_s *priv,
+                               size_t nsectors)
+{
+  FAR struct usbmsc_lun_s *lun = priv->lun;
+  ssize_t nwritten;
+
+  nwritten = USBMSC_DRVR_WRITE(lun, priv->iobuffer, priv->sector, nsectors);
+  priv->nsectbytes = 0;
+
+  if (nwritten > 0)
+    {
+      priv->residue  -= nwritten * lun->sectorsize;
+      priv->u.xfrlen -= nwritten;
+      priv->sector   += nwritten;
+    }
+
+  if (nwritten < 0)
+    {
+      return nwritten;
+    }
+
+  return nwritten < nsectors ? -EIO : OK;
+}
+
 /****************************************************************************
  * Name: usbmsc_cmdreadstate
  *
@@ -2210,6 +2284,11 @@ static int usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv)
  *   of the USBMSC_STATE_CMDPARSE state that handles extended SCSI read
  *   command handling.
  *
+ *   The sectors are read CONFIG_USBMSC_IOBUFSECTORS at a time into one
+ *   half of the I/O buffer.  When all write requests are in flight, the
+ *   next sectors are read into the other half while the host is still
+ *   receiving the data of the current one.
+ *
  * Returned Value:
  *   If no USBDEV write request is available or certain other errors occur,
  *   this function returns a negated errno and stays in the
@@ -2220,7 +2299,10 @@ static int usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv)
  * State variables:
  *   xfrlen     - holds the number of sectors read to be read.
  *   sector     - holds the sector number of the next sector to be read
- *   nsectbytes - holds the number of bytes buffered for the current sector
+ *   iohead     - holds the half of the I/O buffer being sent
+ *   iooffset   - holds the offset of the next byte to send in that half
+ *   nsectbytes - holds the number of bytes left to send in that half
+ *   ionext     - holds the number of bytes read ahead in the other half
  *   nreqbytes  - holds the number of bytes currently buffered in the request
  *                at the head of the wrreqlist.
  *
@@ -2233,39 +2315,57 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
   FAR struct usbdev_req_s *req;
   irqstate_t flags;
   ssize_t nread;
+  bool readahead = true;
+  uint16_t reqlen;
   uint8_t *src;
   uint8_t *dest;
   int nbytes;
   int ret;
 
+  /* Fill each request with as many full packets as its buffer can hold */
+
+  reqlen = CONFIG_USBMSC_BULKINREQLEN -
+           CONFIG_USBMSC_BULKINREQLEN % priv->epbulkin->maxpacket;
+
   /* Loop transferring data until either (1) all of the data has been
    * transferred, or (2) we have used up all of the write requests that we
    * have available.
    */
 
-  while (priv->u.xfrlen > 0 || priv->nsectbytes > 0)
+  while (priv->u.xfrlen > 0 || priv->nsectbytes > 0 || priv->ionext > 0)
     {
       usbtrace(TRACE_CLASSSTATE(USBMSC_CLASSSTATE_CMDREAD), priv->u.xfrlen);
 
-      /* Is the I/O buffer empty? */
+      /* Is the current half of the I/O buffer empty? */
 
       if (priv->nsectbytes <= 0)
         {
-          /* Yes.. read the next sector */
+          if (priv->ionext > 0)
+            {
+              /* Yes.. continue with the sectors read ahead */
 
-          nread = USBMSC_DRVR_READ(lun, priv->iobuffer, priv->sector, 1);
-          if (nread < 0)
+              priv->iohead    ^= 1;
+              priv->nsectbytes = priv->ionext;
+              priv->ionext     = 0;
+            }
+          else
             {
-              usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL),
-                       -nread);
-              lun->sd     = SCSI_KCQME_UNRRE1;
-              lun->sdinfo = priv->sector;
-              break;
+              /* Yes.. read the next sectors */
+
+              nread = usbmsc_readsectors(priv, priv->iohead);
+              if (nread < 0)
+                {
+                  usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL),
+                           -nread);
+                  lun->sd     = SCSI_KCQME_UNRRE1;
+                  lun->sdinfo = priv->sector;
+                  break;
+                }
+
+              priv->nsectbytes = nread;
             }
 
-          priv->nsectbytes = lun->sectorsize;
-          priv->u.xfrlen--;
-          priv->sector++;
+          priv->iooffset = 0;
         }
 
       /* Check if there is a request in the wrreqlist that we will be able to
@@ -2282,6 +2382,24 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
 
       if (!privreq)
         {
+          /* All requests are in flight.  Rather than waiting idle for one
+           * of them to complete, read the next sectors into the other half
+           * of the I/O buffer.  A failed read ahead is not reported here:
+           * the read is retried when the host gets to these sectors.
+           */
+
+          if (readahead && priv->ionext == 0 && priv->u.xfrlen > 0)
+            {
+              nread = usbmsc_readsectors(priv, priv->iohead ^ 1);
+              if (nread > 0)
+                {
+                  priv->ionext = nread;
+                }
+
+              readahead = false;
+              continue;
+            }
+
           usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADWRRQEMPTY), 0);
           priv->nreqbytes = 0;
           return -ENOMEM;
@@ -2293,11 +2411,11 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
        * OR (2) all of the data available in the sector buffer.
        */
 
-      src    = &priv->iobuffer[lun->sectorsize - priv->nsectbytes];
+      src    = &priv->iobuffer[priv->iohead * CONFIG_USBMSC_IOBUFSECTORS *
+                               lun->sectorsize + priv->iooffset];
       dest   = &req->buf[priv->nreqbytes];
 
-      nbytes = MIN(priv->epbulkin->maxpacket - priv->nreqbytes,
-                   priv->nsectbytes);
+      nbytes = MIN(reqlen - priv->nreqbytes, priv->nsectbytes);
 
       /* Copy the data from the sector buffer to the USB request and update
        * counts
@@ -2306,14 +2424,16 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
       memcpy(dest, src, nbytes);
       priv->nreqbytes  += nbytes;
       priv->nsectbytes -= nbytes;
+      priv->iooffset   += nbytes;
 
       /* If (1) the request buffer is full OR (2) this is the final request
        * full of data,
        * then submit the request
        */
 
-      if (priv->nreqbytes >= priv->epbulkin->maxpacket ||
-          (priv->u.xfrlen <= 0 && priv->nsectbytes <= 0))
+      if (priv->nreqbytes >= reqlen ||
+          (priv->u.xfrlen <= 0 && priv->nsectbytes <= 0 &&
+           priv->ionext <= 0))
         {
           /* Remove the request that we just filled from wrreqlist (we've
            * already checked that is it not NULL
@@ -2366,6 +2486,11 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
  *   of the USBMSC_STATE_CMDPARSE state that handles extended SCSI write
  *   command handling.
  *
+ *   The received data is gathered in the whole I/O buffer and written with
+ *   one block driver write.  A read request is returned to the endpoint as
+ *   soon as its data has been copied so that the host can keep sending
+ *   while the sectors are written.
+ *
  * Returned Value:
  *   If no USBDEV write request is available or certain other errors occur,
  *   this function returns a negated errno and stays in the
@@ -2376,7 +2501,7 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
  * State variables:
  *   xfrlen     - holds the number of sectors read to be written.
  *   sector     - holds the sector number of the next sector to write
- *   nsectbytes - holds the number of bytes buffered for the current sector
+ *   nsectbytes - holds the number of bytes gathered in the I/O buffer
  *   nreqbytes  - holds the number of untransferred bytes currently in the
  *                request at the head of the rdreqlist.
  *
@@ -2387,12 +2512,13 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
   FAR struct usbmsc_lun_s *lun = priv->lun;
   FAR struct usbmsc_req_s *privreq;
   FAR struct usbdev_req_s *req;
-  ssize_t nwritten;
+  size_t nsectors;
   uint16_t xfrd;
   uint8_t *src;
   uint8_t *dest;
   int nbytes;
   int ret;
+  int ret2;
 
   /* Loop transferring data until either (1) all of the data has been
    * transferred, or (2) we have written all of the data in the available
@@ -2427,9 +2553,10 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
       req             = privreq->req;
       xfrd            = req->xfrd;
       priv->nreqbytes = xfrd;
+      ret             = OK;
 
       /* Now loop until all of the data in the read request has been
-       * transferred to the block driver OR all of the request data has been
+       * transferred to the I/O buffer OR all of the request data has been
        * transferred.
        */
 
@@ -2439,10 +2566,12 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
            * buffer
            */
 
-          src  = &req->buf[xfrd - priv->nreqbytes];
-          dest = &priv->iobuffer[priv->nsectbytes];
+          nsectors = MIN(priv->u.xfrlen, 2 * CONFIG_USBMSC_IOBUFSECTORS);
+          src      = &req->buf[xfrd - priv->nreqbytes];
+          dest     = &priv->iobuffer[priv->nsectbytes];
 
-          nbytes = MIN(lun->sectorsize - priv->nsectbytes, priv->nreqbytes);
+          nbytes   = MIN(nsectors * lun->sectorsize - priv->nsectbytes,
+                         priv->nreqbytes);
 
           /* Copy the data from the sector buffer to the USB request and
            * update counts
@@ -2452,44 +2581,60 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
           priv->nsectbytes += nbytes;
           priv->nreqbytes  -= nbytes;
 
-          /* Is the I/O buffer full? */
+          /* Is the I/O buffer full while the request still holds data? */
 
-          if (priv->nsectbytes >= lun->sectorsize)
+          if (priv->nreqbytes > 0 &&
+              priv->nsectbytes >= nsectors * lun->sectorsize)
             {
-              /* Yes.. Write the next sector */
+              /* Yes.. Write the sectors now to make room */
 
-              nwritten = USBMSC_DRVR_WRITE(lun, priv->iobuffer,
-                                           priv->sector, 1);
-              if (nwritten < 0)
+              ret = usbmsc_writesectors(priv, nsectors);
+              if (ret < 0)
                 {
-                  usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDWRITEWRITEFAIL),
-                           -nwritten);
-                  lun->sd     = SCSI_KCQME_WRITEFAULTAUTOREALLOCFAILED;
-                  lun->sdinfo = priv->sector;
-                  goto errout;
+                  break;
                 }
-
-              priv->nsectbytes = 0;
-              priv->residue   -= lun->sectorsize;
-              priv->u.xfrlen--;
-              priv->sector++;
             }
         }
 
       /* In either case, we are finished with this read request and can
-       * return it to the endpoint.  Then we will go back to the top of the
-       * top and attempt to get the next read request.
+       * return it to the endpoint before the sectors are written.  Then we
+       * will go back to the top of the top and attempt to get the next
+       * read request.
        */
 
       req->len      = priv->epbulkout->maxpacket;
       req->priv     = privreq;
       req->callback = usbmsc_rdcomplete;
 
-      ret = EP_SUBMIT(priv->epbulkout, req);
-      if (ret != OK)
+      ret2 = EP_SUBMIT(priv->epbulkout, req);
+      if (ret2 != OK)
         {
           usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDWRITERDSUBMIT),
-                   (uint16_t)-ret);
+                   (uint16_t)-ret2);
+        }
+
+      /* Write the I/O buffer if it is full.  If the host decided to stop
+       * early, write the complete sectors that were received.
+       */
+
+      nsectors = MIN(priv->u.xfrlen, 2 * CONFIG_USBMSC_IOBUFSECTORS);
+      if (xfrd != priv->epbulkout->maxpacket)
+        {
+          nsectors = priv->nsectbytes / lun->sectorsize;
+        }
+
+      if (ret >= 0 && nsectors > 0 &&
+          priv->nsectbytes >= nsectors * lun->sectorsize)
+        {
+          ret = usbmsc_writesectors(priv, nsectors);
+        }
+
+      if (ret < 0)
+        {
+          usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDWRITEWRITEFAIL), -ret);
+          lun->sd     = SCSI_KCQME_WRITEFAULTAUTOREALLOCFAILED;
+          lun->sdinfo = priv->sector;
+          goto errout;
         }
 
       /* Did the host decide to stop early? */
@@ -0,0 +1,856 @@
+/****************************************************************************
+ * fs/aio/aio_ring.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/aioring.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sched.h>
+#include <queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "inode/inode.h"
+
+#ifdef CONFIG_FS_AIORING
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FS_AIORING_VFS_PATH
+#  define CONFIG_FS_AIORING_VFS_PATH "/dev"
+#endif
+
+#ifndef CONFIG_FS_AIORING_MAXENTRIES
+#  define CONFIG_FS_AIORING_MAXENTRIES 64
+#endif
+
+#ifndef CONFIG_FS_AIORING_NPOLLWAITERS
+#  define CONFIG_FS_AIORING_NPOLLWAITERS 2
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One in-flight request.  The submission queue entry is copied in at
+ * submission time so that the caller's array may be reused immediately.
+ * The target descriptor is duplicated into req_file, so that the request
+ * is not affected if the caller closes the descriptor before it completes.
+ */
+
+struct aioring_s;
+struct aioring_req_s
+{
+  sq_entry_t req_link;               /* Link in the free request list */
+  struct work_s req_work;            /* Used to defer I/O to a worker */
+  FAR struct aioring_s *req_ring;    /* The ring that owns the request */
+  struct file req_file;              /* Duplicate of the target file */
+  struct aioring_sqe_s req_sqe;      /* Copy of the submitted SQE */
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  uint8_t req_prio;                  /* Priority of the submitting task */
+#endif
+};
+
+/* This structure describes the internal state of one ring */
+
+struct aioring_s
+{
+  sem_t exclsem;                     /* Enforces exclusive access */
+  sem_t cqsem;                       /* Waiters for completions */
+  sem_t sqsem;                       /* Waiters for free submission slots */
+  sem_t drainsem;                    /* Waits for in-flight I/O on close */
+  sq_queue_t freereq;                /* List of free request containers */
+  FAR struct aioring_req_s *reqs;    /* Pre-allocated request containers */
+  FAR struct aioring_cqe_s *cq;      /* Completion queue ring buffer */
+  uint16_t entries;                  /* Ring depth */
+  uint16_t cqhead;                   /* Index of the oldest completion */
+  uint16_t cqcount;                  /* Number of unreaped completions */
+  uint16_t inflight;                 /* Number of requests not complete */
+  uint8_t crefs;                     /* Reference count */
+  bool draining;                     /* Close is waiting for inflight */
+  int minor;                         /* Ring minor number */
+
+  /* The following is a list if poll structures of threads waiting for
+   * ring events.
+   */
+
+  FAR struct pollfd *fds[CONFIG_FS_AIORING_NPOLLWAITERS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     aioring_open(FAR struct file *filep);
+static int     aioring_close(FAR struct file *filep);
+static ssize_t aioring_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen);
+static ssize_t aioring_write(FAR struct file *filep, FAR const char *buffer,
+                             size_t buflen);
+static int     aioring_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                            bool setup);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_aioring_minor;
+
+static const struct file_operations g_aioring_fops =
+{
+  aioring_open,   /* open */
+  aioring_close,  /* close */
+  aioring_read,   /* read */
+  aioring_write,  /* write */
+  NULL,           /* seek */
+  NULL,           /* ioctl */
+  aioring_poll    /* poll */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , NULL          /* unlink */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aioring_wakeall
+ *
+ * Description:
+ *   Wake up every thread waiting on the given semaphore.
+ *
+ ****************************************************************************/
+
+static void aioring_wakeall(FAR sem_t *sem)
+{
+  int sval;
+
+  while (nxsem_get_value(sem, &sval) == 0 && sval < 0)
+    {
+      nxsem_post(sem);
+    }
+}
+
+/****************************************************************************
+ * Name: aioring_pollnotify
+ ****************************************************************************/
+
+static void aioring_pollnotify(FAR struct aioring_s *ring,
+                               pollevent_t eventset)
+{
+  FAR struct pollfd *fds;
+  int i;
+
+  for (i = 0; i < CONFIG_FS_AIORING_NPOLLWAITERS; i++)
+    {
+      fds = ring->fds[i];
+      if (fds)
+        {
+          fds->revents |= eventset & fds->events;
+          if (fds->revents != 0)
+            {
+              nxsem_post(fds->sem);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: aioring_perform
+ *
+ * Description:
+ *   Perform the I/O described by one request on a low-priority worker
+ *   thread.
+ *
+ ****************************************************************************/
+
+static ssize_t aioring_perform(FAR struct aioring_req_s *req)
+{
+  FAR struct aioring_sqe_s *sqe = &req->req_sqe;
+  FAR struct file *filep = &req->req_file;
+#ifdef CONFIG_NET
+  FAR struct socket *psock;
+#endif
+
+  if (sqe->sqe_opcode == AIORING_OP_NOP)
+    {
+      return OK;
+    }
+
+  if (filep->f_inode == NULL)
+    {
+      return -EBADF;
+    }
+
+  switch (sqe->sqe_opcode)
+    {
+      case AIORING_OP_READ:
+        if (sqe->sqe_offset == AIORING_OFFSET_CURRENT)
+          {
+            return file_read(filep, (FAR void *)sqe->sqe_buf,
+                             sqe->sqe_nbytes);
+          }
+
+        return file_pread(filep, (FAR void *)sqe->sqe_buf,
+                          sqe->sqe_nbytes, sqe->sqe_offset);
+
+      case AIORING_OP_WRITE:
+        if (sqe->sqe_offset == AIORING_OFFSET_CURRENT ||
+            (filep->f_oflags & O_APPEND) != 0)
+          {
+            return file_write(filep, (FAR const void *)sqe->sqe_buf,
+                              sqe->sqe_nbytes);
+          }
+
+        return file_pwrite(filep, (FAR const void *)sqe->sqe_buf,
+                           sqe->sqe_nbytes, sqe->sqe_offset);
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+      case AIORING_OP_FSYNC:
+        return file_fsync(filep);
+#endif
+
+#ifdef CONFIG_NET
+      case AIORING_OP_SEND:
+        psock = file_socket(filep);
+        if (psock == NULL)
+          {
+            return -ENOTSOCK;
+          }
+
+        return psock_send(psock, (FAR const void *)sqe->sqe_buf,
+                          sqe->sqe_nbytes, sqe->sqe_flags);
+
+      case AIORING_OP_RECV:
+        psock = file_socket(filep);
+        if (psock == NULL)
+          {
+            return -ENOTSOCK;
+          }
+
+        return psock_recvfrom(psock, (FAR void *)sqe->sqe_buf,
+                              sqe->sqe_nbytes, sqe->sqe_flags, NULL, NULL);
+#endif
+
+      default:
+        return -ENOSYS;
+    }
+}
+
+/****************************************************************************
+ * Name: aioring_complete
+ *
+ * Description:
+ *   Post the completion of one request to the completion queue, return
+ *   the request container to the free list and wake up any waiters.
+ *
+ ****************************************************************************/
+
+static void aioring_complete(FAR struct aioring_req_s *req, ssize_t result)
+{
+  FAR struct aioring_s *ring = req->req_ring;
+  FAR struct aioring_cqe_s *cqe;
+
+  /* Release the duplicate of the target file before the request container
+   * is returned to the free list.
+   */
+
+  file_close(&req->req_file);
+
+  nxsem_wait_uninterruptible(&ring->exclsem);
+
+  /* The submission logic guarantees that inflight + cqcount never exceeds
+   * the ring depth, so there is always room for this completion.
+   */
+
+  DEBUGASSERT(ring->inflight > 0 && ring->cqcount < ring->entries);
+  cqe = &ring->cq[(ring->cqhead + ring->cqcount) % ring->entries];
+  cqe->cqe_udata  = req->req_sqe.sqe_udata;
+  cqe->cqe_result = result;
+
+  ring->cqcount++;
+  ring->inflight--;
+  sq_addlast(&req->req_link, &ring->freereq);
+
+  if (ring->draining)
+    {
+      if (ring->inflight == 0)
+        {
+          nxsem_post(&ring->drainsem);
+        }
+    }
+  else
+    {
+      aioring_wakeall(&ring->cqsem);
+      aioring_pollnotify(ring, POLLIN);
+    }
+
+  nxsem_post(&ring->exclsem);
+}
+
+/****************************************************************************
+ * Name: aioring_worker
+ *
+ * Description:
+ *   This function executes on one of the low-priority worker threads and
+ *   performs the deferred I/O.  With CONFIG_SCHED_LPNTHREADS > 1 several
+ *   requests of a ring proceed concurrently.
+ *
+ ****************************************************************************/
+
+static void aioring_worker(FAR void *arg)
+{
+  FAR struct aioring_req_s *req = (FAR struct aioring_req_s *)arg;
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  uint8_t prio = req->req_prio;
+#endif
+
+  aioring_complete(req, aioring_perform(req));
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  /* Restore the low priority worker thread default priority */
+
+  lpwork_restorepriority(prio);
+#endif
+}
+
+/****************************************************************************
+ * Name: aioring_dispatch
+ *
+ * Description:
+ *   Dispatch one request.  NOPs and requests on bad descriptors complete
+ *   directly in the submitting context without a round trip through the
+ *   work queue.  All other requests are deferred to the low-priority work
+ *   queue, including those on descriptors opened O_NONBLOCK:  A
+ *   non-blocking driver may still take a long time to complete.
+ *
+ *   Called with the ring exclsem released.
+ *
+ ****************************************************************************/
+
+static void aioring_dispatch(FAR struct aioring_req_s *req)
+{
+  int ret;
+
+  if (req->req_file.f_inode == NULL)
+    {
+      aioring_complete(req, aioring_perform(req));
+      return;
+    }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  sched_lock();
+
+  /* Make sure that the low-priority worker thread is running at at least
+   * the priority of the submitter.
+   */
+
+  lpwork_boostpriority(req->req_prio);
+#endif
+
+  ret = work_queue(LPWORK, &req->req_work, aioring_worker, req, 0);
+  if (ret < 0)
+    {
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      lpwork_restorepriority(req->req_prio);
+#endif
+      aioring_complete(req, ret);
+    }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  sched_unlock();
+#endif
+}
+
+/****************************************************************************
+ * Name: aioring_wait
+ *
+ * Description:
+ *   Release exclsem, wait on 'sem' then re-acquire exclsem.  The wakers
+ *   hold exclsem and only post to threads that are already waiting, so
+ *   the scheduler is locked until this thread waits on 'sem'.
+ *
+ ****************************************************************************/
+
+static int aioring_wait(FAR struct aioring_s *ring, FAR sem_t *sem)
+{
+  int ret;
+
+  sched_lock();
+  nxsem_post(&ring->exclsem);
+  ret = nxsem_wait(sem);
+  sched_unlock();
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return nxsem_wait(&ring->exclsem);
+}
+
+/****************************************************************************
+ * Name: aioring_open
+ ****************************************************************************/
+
+static int aioring_open(FAR struct file *filep)
+{
+  FAR struct aioring_s *ring = filep->f_inode->i_private;
+  int ret;
+
+  ret = nxsem_wait(&ring->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (ring->crefs >= 255)
+    {
+      ret = -EMFILE;
+    }
+  else
+    {
+      ring->crefs++;
+    }
+
+  nxsem_post(&ring->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: aioring_close
+ ****************************************************************************/
+
+static int aioring_close(FAR struct file *filep)
+{
+  FAR struct aioring_s *ring = filep->f_inode->i_private;
+  char devpath[sizeof(CONFIG_FS_AIORING_VFS_PATH) + 8 + 11];
+  int ret;
+
+  ret = nxsem_wait(&ring->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* If this is the last reference, wait for the in-flight requests to
+   * complete:  The workers still reference the ring.
+   */
+
+  if (ring->crefs == 1 && ring->inflight > 0)
+    {
+      ring->draining = true;
+      nxsem_post(&ring->exclsem);
+      nxsem_wait_uninterruptible(&ring->drainsem);
+      nxsem_wait_uninterruptible(&ring->exclsem);
+      ring->draining = false;
+    }
+
+  /* The ring may have been opened again while draining.  Completions
+   * posted meanwhile did not wake up the readers.
+   */
+
+  if (ring->crefs > 1)
+    {
+      ring->crefs--;
+      if (ring->cqcount > 0)
+        {
+          aioring_wakeall(&ring->cqsem);
+          aioring_pollnotify(ring, POLLIN);
+        }
+
+      nxsem_post(&ring->exclsem);
+      return OK;
+    }
+
+  /* Unregister and free the ring while still holding exclsem, so that no
+   * open can take a reference between the check above and the removal of
+   * the device node.
+   */
+
+  snprintf(devpath, sizeof(devpath),
+           CONFIG_FS_AIORING_VFS_PATH "/aioring%d", ring->minor);
+  unregister_driver(devpath);
+
+  nxsem_destroy(&ring->exclsem);
+  nxsem_destroy(&ring->cqsem);
+  nxsem_destroy(&ring->sqsem);
+  nxsem_destroy(&ring->drainsem);
+  kmm_free(ring->reqs);
+  kmm_free(ring->cq);
+  kmm_free(ring);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: aioring_read
+ *
+ * Description:
+ *   Reap completions.  The buffer receives an array of struct
+ *   aioring_cqe_s.
+ *
+ ****************************************************************************/
+
+static ssize_t aioring_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct aioring_s *ring = filep->f_inode->i_private;
+  FAR struct aioring_cqe_s *cqes = (FAR struct aioring_cqe_s *)buffer;
+  size_t ncqes = buflen / sizeof(struct aioring_cqe_s);
+  size_t nreaped;
+  int ret;
+
+  if (ncqes == 0 || buffer == NULL)
+    {
+      return -EINVAL;
+    }
+
+  ret = nxsem_wait(&ring->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while (ring->cqcount == 0)
+    {
+      if ((filep->f_oflags & O_NONBLOCK) != 0)
+        {
+          nxsem_post(&ring->exclsem);
+          return -EAGAIN;
+        }
+
+      ret = aioring_wait(ring, &ring->cqsem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Copy out as many completions as are available and fit */
+
+  for (nreaped = 0; nreaped < ncqes && ring->cqcount > 0; nreaped++)
+    {
+      cqes[nreaped] = ring->cq[ring->cqhead];
+      ring->cqhead  = (ring->cqhead + 1) % ring->entries;
+      ring->cqcount--;
+    }
+
+  /* Submission slots were released */
+
+  aioring_wakeall(&ring->sqsem);
+  aioring_pollnotify(ring, POLLOUT);
+
+  nxsem_post(&ring->exclsem);
+  return nreaped * sizeof(struct aioring_cqe_s);
+}
+
+/****************************************************************************
+ * Name: aioring_write
+ *
+ * Description:
+ *   Submit requests.  The buffer holds an array of struct aioring_sqe_s.
+ *   Requests are admitted while inflight + unreaped completions stay
+ *   within the ring depth.
+ *
+ ****************************************************************************/
+
+static ssize_t aioring_write(FAR struct file *filep, FAR const char *buffer,
+                             size_t buflen)
+{
+  FAR struct aioring_s *ring = filep->f_inode->i_private;
+  FAR const struct aioring_sqe_s *sqes =
+    (FAR const struct aioring_sqe_s *)buffer;
+  size_t nsqes = buflen / sizeof(struct aioring_sqe_s);
+  FAR struct aioring_req_s *req;
+  sq_queue_t submitted;
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  struct sched_param param;
+#endif
+  size_t navail;
+  size_t nsubmitted;
+  int ret;
+
+  if (nsqes == 0 || buffer == NULL)
+    {
+      return -EINVAL;
+    }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  DEBUGVERIFY(nxsched_get_param(getpid(), &param));
+#endif
+
+  ret = nxsem_wait(&ring->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while ((navail = ring->entries - ring->inflight - ring->cqcount) == 0)
+    {
+      if ((filep->f_oflags & O_NONBLOCK) != 0)
+        {
+          nxsem_post(&ring->exclsem);
+          return -EAGAIN;
+        }
+
+      ret = aioring_wait(ring, &ring->sqsem);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Claim the request containers for the whole batch while holding the
+   * lock once, then dispatch them without it.
+   */
+
+  sq_init(&submitted);
+  for (nsubmitted = 0; nsubmitted < nsqes && nsubmitted < navail;
+       nsubmitted++)
+    {
+      FAR struct file *target;
+
+      req = (FAR struct aioring_req_s *)sq_remfirst(&ring->freereq);
+      DEBUGASSERT(req != NULL && req->req_file.f_inode == NULL);
+
+      /* Take a reference on the target file.  A bad descriptor leaves
+       * req_file closed and is reported through the completion queue.
+       */
+
+      if (sqes[nsubmitted].sqe_opcode != AIORING_OP_NOP &&
+          fs_getfilep(sqes[nsubmitted].sqe_fildes, &target) >= 0)
+        {
+          file_dup2(target, &req->req_file);
+        }
+
+      req->req_ring  = ring;
+      req->req_sqe   = sqes[nsubmitted];
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      req->req_prio  = param.sched_priority;
+#endif
+      sq_addlast(&req->req_link, &submitted);
+      ring->inflight++;
+    }
+
+  nxsem_post(&ring->exclsem);
+
+  while ((req = (FAR struct aioring_req_s *)sq_remfirst(&submitted))
+         != NULL)
+    {
+      aioring_dispatch(req);
+    }
+
+  return nsubmitted * sizeof(struct aioring_sqe_s);
+}
+
+/****************************************************************************
+ * Name: aioring_poll
+ ****************************************************************************/
+
+static int aioring_poll(FAR struct file *filep, FAR struct pollfd *fds,
+                        bool setup)
+{
+  FAR struct aioring_s *ring = filep->f_inode->i_private;
+  pollevent_t eventset;
+  int ret;
+  int i;
+
+  ret = nxsem_wait(&ring->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (!setup)
+    {
+      /* This is a request to tear down the poll. */
+
+      FAR struct pollfd **slot = (FAR struct pollfd **)fds->priv;
+
+      *slot     = NULL;
+      fds->priv = NULL;
+      goto errout;
+    }
+
+  /* Find an available slot for the poll structure reference */
+
+  for (i = 0; i < CONFIG_FS_AIORING_NPOLLWAITERS; i++)
+    {
+      if (!ring->fds[i])
+        {
+          ring->fds[i] = fds;
+          fds->priv    = &ring->fds[i];
+          break;
+        }
+    }
+
+  if (i >= CONFIG_FS_AIORING_NPOLLWAITERS)
+    {
+      fds->priv = NULL;
+      ret       = -EBUSY;
+      goto errout;
+    }
+
+  eventset = 0;
+  if (ring->cqcount > 0)
+    {
+      eventset |= POLLIN;
+    }
+
+  if (ring->inflight + ring->cqcount < ring->entries)
+    {
+      eventset |= POLLOUT;
+    }
+
+  if (eventset)
+    {
+      aioring_pollnotify(ring, eventset);
+    }
+
+errout:
+  nxsem_post(&ring->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aioring_setup
+ *
+ * Description:
+ *   Create a new I/O submission/completion ring.  See include/sys/aioring.h
+ *
+ ****************************************************************************/
+
+int aioring_setup(unsigned int entries, int flags)
+{
+  FAR struct aioring_s *ring;
+  irqstate_t irqflags;
+  char devpath[sizeof(CONFIG_FS_AIORING_VFS_PATH) + 8 + 11];
+  unsigned int i;
+  int ret;
+  int fd;
+
+  if (entries == 0 || entries > CONFIG_FS_AIORING_MAXENTRIES)
+    {
+      ret = EINVAL;
+      goto errout;
+    }
+
+  ring = (FAR struct aioring_s *)kmm_zalloc(sizeof(struct aioring_s));
+  if (ring == NULL)
+    {
+      ret = ENOMEM;
+      goto errout;
+    }
+
+  ring->reqs = (FAR struct aioring_req_s *)
+    kmm_zalloc(entries * sizeof(struct aioring_req_s));
+  ring->cq   = (FAR struct aioring_cqe_s *)
+    kmm_malloc(entries * sizeof(struct aioring_cqe_s));
+  if (ring->reqs == NULL || ring->cq == NULL)
+    {
+      ret = ENOMEM;
+      goto errout_with_ring;
+    }
+
+  /* The ring is not usable until registration completes */
+
+  nxsem_init(&ring->exclsem, 0, 0);
+  nxsem_init(&ring->cqsem, 0, 0);
+  nxsem_init(&ring->sqsem, 0, 0);
+  nxsem_init(&ring->drainsem, 0, 0);
+  nxsem_set_protocol(&ring->cqsem, SEM_PRIO_NONE);
+  nxsem_set_protocol(&ring->sqsem, SEM_PRIO_NONE);
+  nxsem_set_protocol(&ring->drainsem, SEM_PRIO_NONE);
+
+  sq_init(&ring->freereq);
+  for (i = 0; i < entries; i++)
+    {
+      sq_addlast(&ring->reqs[i].req_link, &ring->freereq);
+    }
+
+  ring->entries = entries;
+
+  irqflags    = enter_critical_section();
+  ring->minor = g_aioring_minor++;
+  leave_critical_section(irqflags);
+
+  snprintf(devpath, sizeof(devpath),
+           CONFIG_FS_AIORING_VFS_PATH "/aioring%d", ring->minor);
+
+  ret = register_driver(devpath, &g_aioring_fops, 0666, ring);
+  if (ret < 0)
+    {
+      ferr("ERROR: Failed to register %s: %d\n", devpath, ret);
+      ret = -ret;
+      goto errout_with_sem;
+    }
+
+  nxsem_post(&ring->exclsem);
+
+  fd = nx_open(devpath, O_RDWR | (flags & (O_NONBLOCK | O_CLOEXEC)));
+  if (fd < 0)
+    {
+      ret = -fd;
+      unregister_driver(devpath);
+      goto errout_with_sem;
+    }
+
+  return fd;
+
+errout_with_sem:
+  nxsem_destroy(&ring->exclsem);
+  nxsem_destroy(&ring->cqsem);
+  nxsem_destroy(&ring->sqsem);
+  nxsem_destroy(&ring->drainsem);
+
+errout_with_ring:
+  kmm_free(ring->reqs);
+  kmm_free(ring->cq);
+  kmm_free(ring);
+
+errout:
+  set_errno(ret);
+  return ERROR;
+}
+
+#endif /* CONFIG_FS_AIORING */
@@ -28,6 +28,14 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Values of the cn_flags field of struct cromfs_node_s */
+
+#define CROMFS_FLAG_BLKTAB (1 << 0) /* u.cn_blocks refers to a block table */
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -100,12 +108,22 @@ struct cromfs_volume_s
  *                Return 0
  *   st_ctime   - Time of last status change
  *                Return 0
+ *
+ * The compressed data of a regular file is normally a contiguous sequence
+ * of LZF blocks starting at u.cn_blocks.  If CROMFS_FLAG_BLKTAB is set in
+ * cn_flags, u.cn_blocks instead refers to a table of
+ * (cn_size + cv_bsize - 1) / cv_bsize offsets, one per block, to the LZF
+ * header of each block.  Every block but the last then holds exactly
+ * cv_bsize bytes of uncompressed data so that the block containing any file
+ * position can be found directly.  The blocks need not be contiguous and
+ * identical blocks may be shared by several table entries, even of
+ * different files.  The table entries are not necessarily aligned.
  */
 
 struct cromfs_node_s
 {
   uint16_t cn_mode;      /* File type, attributes, and access mode bits */
-  uint16_t cn_pad;       /* Not used */
+  uint16_t cn_flags;     /* See CROMFS_FLAG_* definitions */
   uint32_t cn_name;      /* Offset from the beginning of the volume header to the
                           * node name string.  NUL-terminated. */
   uint32_t cn_size;      /* Size of the uncompressed data (in bytes) */
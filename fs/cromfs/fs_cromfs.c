@@ -39,6 +39,7 @@
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/dirent.h>
 #include <nuttx/fs/ioctl.h>
@@ -53,18 +54,49 @@
 
 #define CROMFS_MAX_LINKS 64
 
+#ifndef CONFIG_FS_CROMFS_CACHE_BLOCKS
+#  define CONFIG_FS_CROMFS_CACHE_BLOCKS 4
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
-/* This structure represents an open, regular file */
+/* This structure describes one decompressed block in the block cache */
+
+struct cromfs_cblock_s
+{
+  uint32_t cb_offset;                       /* Image offset of the LZF block
+                                             * (zero means none) */
+  uint32_t cb_age;                          /* cm_clock at last access */
+  uint16_t cb_ulen;                         /* Length of decompressed data */
+  FAR uint8_t *cb_buffer;                   /* Decompressed data */
+};
+
+/* This structure represents the mounted volume.  The decompressed blocks
+ * are cached here so that they are shared by all open files.
+ */
+
+struct cromfs_mount_s
+{
+  FAR const struct cromfs_volume_s *cm_vol; /* The CROMFS image */
+  mutex_t cm_lock;                          /* Protects the block cache */
+  uint32_t cm_clock;                        /* Incremented on each access */
+  struct cromfs_cblock_s cm_cache[CONFIG_FS_CROMFS_CACHE_BLOCKS];
+};
+
+/* This structure represents an open, regular file.  For files without a
+ * block table, the block that satisfied the last read is remembered so that
+ * sequential reads do not search from the first block again.
+ */
 
 struct cromfs_file_s
 {
   FAR const struct cromfs_node_s *ff_node;  /* The open file node */
-  uint32_t ff_offset;                       /* Cached block offset (zero means none) */
-  uint16_t ff_ulen;                         /* Length of decompressed data in cache */
-  FAR uint8_t *ff_buffer;                   /* Cached, decompressed data */
+  uint32_t ff_blkhdr;                       /* Image offset of the last
+                                             * block (zero means none) */
+  uint32_t ff_blkoffs;                      /* File offset of the last
+                                             * block */
 };
 
 /* This is the form of the callback from cromfs_foreach_node(): */
@@ -125,6 +157,15 @@ static int      cromfs_find_node(FAR const struct cromfs_volume_s *fs,
                   FAR const char *relpath,
                   FAR struct cromfs_nodeinfo_s *info,
                   FAR uint32_t *offset);
+static uint32_t cromfs_block_info(FAR const struct lzf_header_s *hdr,
+                  FAR uint16_t *ulen, FAR uint16_t *clen);
+static FAR const struct lzf_header_s *
+                cromfs_find_block(FAR const struct cromfs_volume_s *fs,
+                  FAR struct cromfs_file_s *ff, uint32_t fpos,
+                  FAR uint32_t *blkoffs);
+static FAR struct cromfs_cblock_s *
+                cromfs_cache_block(FAR struct cromfs_mount_s *cm,
+                  FAR const struct lzf_header_s *hdr);
 
 /* Common file system methods */
 
@@ -333,7 +374,7 @@ static int cromfs_follow_link(FAR const struct cromfs_volume_s *fs,
            */
 
           newnode->cn_mode    = S_IFDIR | (node->cn_mode & ~S_IFMT);
-          newnode->cn_pad     = 0;
+          newnode->cn_flags   = 0;
           newnode->cn_name    = node->cn_name;
           newnode->cn_size    = 0;
           newnode->cn_peer    = node->cn_peer;
@@ -350,13 +391,13 @@ static int cromfs_follow_link(FAR const struct cromfs_volume_s *fs,
       /* Copy the origin node file name into the writable node copy */
 
       newnode->cn_name   = node->cn_name;
-      newnode->cn_pad    = 0;
 
       /* Copy all attributes of the target node, but retain the hard link
        * file name and, possibly, the peer node reference.
        */
 
       newnode->cn_mode   = linknode->cn_mode;
+      newnode->cn_flags  = linknode->cn_flags;
       newnode->cn_size   = linknode->cn_size;
       newnode->u.cn_link = linknode->u.cn_link;
 
@@ -708,6 +749,182 @@ static int cromfs_find_node(FAR const struct cromfs_volume_s *fs,
     }
 }
 
+/****************************************************************************
+ * Name: cromfs_block_info
+ *
+ * Description:
+ *   Decode the LZF header of a block of file data.  The uncompressed and
+ *   compressed data lengths are returned in ulen and clen (they are the
+ *   same for an uncompressed block).  The returned value is the size of the
+ *   block in the image, including the header.
+ *
+ ****************************************************************************/
+
+static uint32_t cromfs_block_info(FAR const struct lzf_header_s *hdr,
+                                  FAR uint16_t *ulen, FAR uint16_t *clen)
+{
+  if (hdr->lzf_type == LZF_TYPE0_HDR)
+    {
+      FAR const struct lzf_type0_header_s *hdr0 =
+        (FAR const struct lzf_type0_header_s *)hdr;
+
+      *ulen = (uint16_t)hdr0->lzf_len[0] << 8 |
+              (uint16_t)hdr0->lzf_len[1];
+      *clen = *ulen;
+      return (uint32_t)*ulen + LZF_TYPE0_HDR_SIZE;
+    }
+  else
+    {
+      FAR const struct lzf_type1_header_s *hdr1 =
+        (FAR const struct lzf_type1_header_s *)hdr;
+
+      *ulen = (uint16_t)hdr1->lzf_ulen[0] << 8 |
+              (uint16_t)hdr1->lzf_ulen[1];
+      *clen = (uint16_t)hdr1->lzf_clen[0] << 8 |
+              (uint16_t)hdr1->lzf_clen[1];
+      return (uint32_t)*clen + LZF_TYPE1_HDR_SIZE;
+    }
+}
+
+/****************************************************************************
+ * Name: cromfs_find_block
+ *
+ * Description:
+ *   Return the LZF header of the block holding the file offset fpos and the
+ *   file offset of the first byte of that block in blkoffs.  fpos must be
+ *   less than the size of the file.
+ *
+ *   If the file has a block table, the block is found directly.  Otherwise,
+ *   the search starts at the block found by the previous call, or at the
+ *   first block of the file if fpos lies before that block.
+ *
+ ****************************************************************************/
+
+static FAR const struct lzf_header_s *
+cromfs_find_block(FAR const struct cromfs_volume_s *fs,
+                  FAR struct cromfs_file_s *ff, uint32_t fpos,
+                  FAR uint32_t *blkoffs)
+{
+  FAR const struct cromfs_node_s *node = ff->ff_node;
+  FAR const struct lzf_header_s *hdr;
+  uint32_t blksize;
+  uint16_t ulen;
+  uint16_t clen;
+
+  DEBUGASSERT(fpos < node->cn_size);
+
+  if ((node->cn_flags & CROMFS_FLAG_BLKTAB) != 0)
+    {
+      FAR const uint8_t *blktab;
+      uint32_t blkno;
+      uint32_t offset;
+
+      /* The table entries are not aligned in the image */
+
+      blkno  = fpos / fs->cv_bsize;
+      blktab = (FAR const uint8_t *)
+               cromfs_offset2addr(fs, node->u.cn_blocks);
+      memcpy(&offset, &blktab[blkno * sizeof(uint32_t)], sizeof(uint32_t));
+
+      *blkoffs = blkno * fs->cv_bsize;
+      return (FAR const struct lzf_header_s *)cromfs_offset2addr(fs, offset);
+    }
+
+  if (ff->ff_blkhdr == 0 || fpos < ff->ff_blkoffs)
+    {
+      ff->ff_blkhdr  = node->u.cn_blocks;
+      ff->ff_blkoffs = 0;
+    }
+
+  hdr = (FAR const struct lzf_header_s *)
+        cromfs_offset2addr(fs, ff->ff_blkhdr);
+
+  for (; ; )
+    {
+      blksize = cromfs_block_info(hdr, &ulen, &clen);
+      if (fpos < ff->ff_blkoffs + ulen)
+        {
+          break;
+        }
+
+      /* Go to the next block */
+
+      ff->ff_blkoffs += ulen;
+      hdr = (FAR const struct lzf_header_s *)
+            ((FAR const uint8_t *)hdr + blksize);
+    }
+
+  ff->ff_blkhdr = cromfs_addr2offset(fs, hdr);
+  *blkoffs      = ff->ff_blkoffs;
+  return hdr;
+}
+
+/****************************************************************************
+ * Name: cromfs_cache_block
+ *
+ * Description:
+ *   Return the cache entry holding the decompressed data of the compressed
+ *   block at hdr.  If the block is not cached, it is decompressed into the
+ *   least recently used entry.  NULL is returned if the block is corrupted.
+ *   The caller must hold cm_lock.
+ *
+ ****************************************************************************/
+
+static FAR struct cromfs_cblock_s *
+cromfs_cache_block(FAR struct cromfs_mount_s *cm,
+                   FAR const struct lzf_header_s *hdr)
+{
+  FAR const struct cromfs_volume_s *fs = cm->cm_vol;
+  FAR struct cromfs_cblock_s *victim = NULL;
+  FAR struct cromfs_cblock_s *cb;
+  unsigned int decomplen;
+  uint32_t offset;
+  uint16_t ulen;
+  uint16_t clen;
+  int i;
+
+  offset = cromfs_addr2offset(fs, hdr);
+  cm->cm_clock++;
+
+  for (i = 0; i < CONFIG_FS_CROMFS_CACHE_BLOCKS; i++)
+    {
+      cb = &cm->cm_cache[i];
+      if (cb->cb_offset == offset)
+        {
+          cb->cb_age = cm->cm_clock;
+          return cb;
+        }
+
+      /* Unused entries have the oldest age, zero */
+
+      if (victim == NULL ||
+          cm->cm_clock - cb->cb_age > cm->cm_clock - victim->cb_age)
+        {
+          victim = cb;
+        }
+    }
+
+  cromfs_block_info(hdr, &ulen, &clen);
+  decomplen = lzf_decompress((FAR const uint8_t *)hdr + LZF_TYPE1_HDR_SIZE,
+                             clen, victim->cb_buffer, fs->cv_bsize);
+
+  finfo("offset=%" PRIu32 " ulen=%" PRIu16 " clen=%" PRIu16
+        " decomplen=%u\n", offset, ulen, clen, decomplen);
+
+  if (decomplen != ulen)
+    {
+      ferr("ERROR: Corrupted block at offset %" PRIu32 "\n", offset);
+      victim->cb_offset = 0;
+      victim->cb_age    = 0;
+      return NULL;
+    }
+
+  victim->cb_offset = offset;
+  victim->cb_age    = cm->cm_clock;
+  victim->cb_ulen   = ulen;
+  return victim;
+}
+
 /****************************************************************************
  * Name: cromfs_open
  ****************************************************************************/
@@ -716,6 +933,7 @@ static int cromfs_open(FAR struct file *filep, FAR const char *relpath,
                        int oflags, mode_t mode)
 {
   FAR struct inode *inode;
+  FAR struct cromfs_mount_s *cm;
   FAR const struct cromfs_volume_s *fs;
   struct cromfs_nodeinfo_s info;
   FAR struct cromfs_file_s *ff;
@@ -733,9 +951,10 @@ static int cromfs_open(FAR struct file *filep, FAR const char *relpath,
    */
 
   inode = filep->f_inode;
-  fs    = inode->i_private;
+  cm    = inode->i_private;
 
-  DEBUGASSERT(fs != NULL);
+  DEBUGASSERT(cm != NULL);
+  fs    = cm->cm_vol;
 
   /* CROMFS is read-only.  Any attempt to open with any kind of write
    * access is not permitted.
@@ -776,15 +995,6 @@ static int cromfs_open(FAR struct file *filep, FAR const char *relpath,
       return -ENOMEM;
     }
 
-  /* Create a file buffer to support partial sector accesses */
-
-  ff->ff_buffer = (FAR uint8_t *)kmm_malloc(fs->cv_bsize);
-  if (!ff->ff_buffer)
-    {
-      kmm_free(ff);
-      return -ENOMEM;
-    }
-
   /* Save the node in the open file instance */
 
   ff->ff_node = (FAR const struct cromfs_node_s *)
@@ -810,11 +1020,10 @@ static int cromfs_close(FAR struct file *filep)
   /* Get the open file instance from the file structure */
 
   ff = filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   /* Free all resources consumed by the opened file */
 
-  kmm_free(ff->ff_buffer);
   kmm_free(ff);
 
   return OK;
@@ -828,10 +1037,11 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
                            size_t buflen)
 {
   FAR struct inode *inode;
+  FAR struct cromfs_mount_s *cm;
   FAR const struct cromfs_volume_s *fs;
   FAR struct cromfs_file_s *ff;
-  FAR struct lzf_header_s *currhdr;
-  FAR struct lzf_header_s *nexthdr;
+  FAR const struct lzf_header_s *currhdr;
+  FAR struct cromfs_cblock_s *cb;
   FAR uint8_t *dest;
   FAR const uint8_t *src;
   off_t fpos;
@@ -841,6 +1051,7 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
   uint16_t clen;
   unsigned int copysize;
   unsigned int copyoffs;
+  int ret = OK;
 
   finfo("Read %zu bytes from offset %jd\n", buflen, (intmax_t)filep->f_pos);
   DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
@@ -850,13 +1061,14 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
    */
 
   inode = filep->f_inode;
-  fs    = inode->i_private;
-  DEBUGASSERT(fs != NULL);
+  cm    = inode->i_private;
+  DEBUGASSERT(cm != NULL);
+  fs    = cm->cm_vol;
 
   /* Get the open file instance from the file structure */
 
   ff = (FAR struct cromfs_file_s *)filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   /* Check for a read past the end of the file */
 
@@ -877,66 +1089,26 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
       buflen = ff->ff_node->cn_size - filep->f_pos;
     }
 
-  /* Find the compressed block containing the current offset, f_pos */
-
   dest      = (FAR uint8_t *)buffer;
   remaining = buflen;
   fpos      = filep->f_pos;
-  blkoffs   = 0;
-  ulen      = 0;
-  nexthdr   = (FAR struct lzf_header_s *)
-               cromfs_offset2addr(fs, ff->ff_node->u.cn_blocks);
-
-  /* Look until we find the compressed block containing the start of the
-   * requested data.
-   */
 
   while (remaining > 0)
     {
-      /* Search for the next block containing the fpos file offset.  This is
-       * real search on the first time through but the remaining blocks
-       * should be contiguous so that the logic should not loop.
-       *
-       */
+      /* Find the compressed block containing the current offset, fpos */
 
-      do
-        {
-          uint32_t blksize;
-
-          /* Go to the next block */
+      currhdr = cromfs_find_block(fs, ff, fpos, &blkoffs);
+      DEBUGASSERT(currhdr != NULL);
 
-          currhdr  = nexthdr;
-          blkoffs += ulen;
+      cromfs_block_info(currhdr, &ulen, &clen);
+      copyoffs = fpos - blkoffs;
+      DEBUGASSERT(ulen > copyoffs);
+      copysize = ulen - copyoffs;
 
-          if (currhdr->lzf_type == LZF_TYPE0_HDR)
-            {
-              FAR struct lzf_type0_header_s *hdr0 =
-                (FAR struct lzf_type0_header_s *)currhdr;
-
-              ulen    = (uint16_t)hdr0->lzf_len[0] << 8 |
-                        (uint16_t)hdr0->lzf_len[1];
-              blksize = (uint32_t)ulen + LZF_TYPE0_HDR_SIZE;
-            }
-          else
-            {
-              FAR struct lzf_type1_header_s * hdr1 =
-                (FAR struct lzf_type1_header_s *)currhdr;
-
-              ulen    = (uint16_t)hdr1->lzf_ulen[0] << 8 |
-                        (uint16_t)hdr1->lzf_ulen[1];
-              clen    = (uint16_t)hdr1->lzf_clen[0] << 8 |
-                        (uint16_t)hdr1->lzf_clen[1];
-              blksize = (uint32_t)clen + LZF_TYPE1_HDR_SIZE;
-            }
-
-          nexthdr  = (FAR struct lzf_header_s *)
-                     ((FAR uint8_t *)currhdr + blksize);
+      if (copysize > remaining)  /* Clip to the size really needed */
+        {
+          copysize = remaining;
         }
-      while (fpos >= (blkoffs + ulen));
-
-      /* Check if we need to decompress the next block into the user
-       * buffer.
-       */
 
       if (currhdr->lzf_type == LZF_TYPE0_HDR)
         {
@@ -944,103 +1116,38 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
            * user buffer.
            */
 
-          copyoffs = (blkoffs >= filep->f_pos) ? 0 : filep->f_pos - blkoffs;
-          DEBUGASSERT(ulen > copyoffs);
-          copysize = ulen - copyoffs;
-
-          if (copysize > remaining)  /* Clip to the size really needed */
-            {
-              copysize = remaining;
-            }
-
           src = (FAR const uint8_t *)currhdr + LZF_TYPE0_HDR_SIZE;
           memcpy(dest, &src[copyoffs], copysize);
-
-          finfo("blkoffs=%" PRIu32 " ulen=%" PRIu16 " copysize=%u\n",
-                blkoffs, ulen, copysize);
         }
       else
         {
-          /* If the source of the data is at the beginning of the compressed
-           * data buffer and if the uncompressed data would not overrun the
-           * buffer, then we can decompress directly into the user buffer.
+          /* Get the decompressed data from the shared block cache,
+           * decompressing the block if it is not already cached.
            */
 
-          if (filep->f_pos <= blkoffs && ulen <= remaining)
+          ret = nxmutex_lock(&cm->cm_lock);
+          if (ret < 0)
             {
-              uint32_t voloffs;
-
-              copyoffs = 0;
-              copysize = ulen;
-
-              /* Get the address and offset in the CROMFS image to obtain
-               * the data.  Check if we already have this offset in the
-               * cache.
-               */
-
-              src     = (FAR const uint8_t *)currhdr + LZF_TYPE1_HDR_SIZE;
-              voloffs = cromfs_addr2offset(fs, src);
-              if (voloffs != ff->ff_offset)
-                {
-                  unsigned int decomplen;
-
-                  decomplen = lzf_decompress(src, clen, dest, fs->cv_bsize);
-
-                  ff->ff_offset = voloffs;
-                  ff->ff_ulen   = decomplen;
-                }
-
-              finfo("voloffs=%" PRIu32 " blkoffs=%" PRIu32
-                    " ulen=%" PRIu16 " ff_offset=%" PRIu32 " copysize=%u\n",
-                    voloffs, blkoffs, ulen, ff->ff_offset, copysize);
-              DEBUGASSERT(ff->ff_ulen >= copysize);
+              break;
             }
-          else
-            {
-              uint32_t voloffs;
-
-              /* No, we will need to decompress into the our intermediate
-               * decompression buffer.
-               */
-
-              copyoffs = (blkoffs >= filep->f_pos) ?
-                            0 : filep->f_pos - blkoffs;
-              DEBUGASSERT(ulen > copyoffs);
-              copysize = ulen - copyoffs;
-
-              if (copysize > remaining)  /* Clip to the size really needed */
-                {
-                  copysize = remaining;
-                }
-
-              DEBUGASSERT((copyoffs + copysize) <=  fs->cv_bsize);
-
-              src = (FAR const uint8_t *)currhdr + LZF_TYPE1_HDR_SIZE;
-              voloffs = cromfs_addr2offset(fs, src);
-              if (voloffs != ff->ff_offset)
-                {
-                  unsigned int decomplen;
-
-                  decomplen = lzf_decompress(src, clen, ff->ff_buffer,
-                                             fs->cv_bsize);
-
-                  ff->ff_offset = voloffs;
-                  ff->ff_ulen   = decomplen;
-                }
-
-              finfo("voloffs=%" PRIu32 " blkoffs=%" PRIu32 " ulen=%" PRIu16
-                    " clen=%" PRIu16 " ff_offset=%" PRIu32
-                    "  copyoffs=%u copysize=%u\n",
-                    voloffs, blkoffs, ulen, clen, ff->ff_offset,
-                    copyoffs, copysize);
-              DEBUGASSERT(ff->ff_ulen >= (copyoffs + copysize));
-
-              /* Then copy to user buffer */
 
-              memcpy(dest, &ff->ff_buffer[copyoffs], copysize);
+          cb = cromfs_cache_block(cm, currhdr);
+          if (cb == NULL)
+            {
+              nxmutex_unlock(&cm->cm_lock);
+              ret = -EIO;
+              break;
             }
+
+          DEBUGASSERT(cb->cb_ulen >= copyoffs + copysize);
+          memcpy(dest, &cb->cb_buffer[copyoffs], copysize);
+          nxmutex_unlock(&cm->cm_lock);
         }
 
+      finfo("blkoffs=%" PRIu32 " ulen=%" PRIu16 " clen=%" PRIu16
+            " copyoffs=%u copysize=%u\n",
+            blkoffs, ulen, clen, copyoffs, copysize);
+
       /* Adjust pointers counts and offset */
 
       dest      += copysize;
@@ -1048,10 +1155,17 @@ static ssize_t cromfs_read(FAR struct file *filep, FAR char *buffer,
       fpos      += copysize;
     }
 
+  /* Return an error only if no data was transferred */
+
+  if (ret < 0 && remaining == buflen)
+    {
+      return ret;
+    }
+
   /* Update the file pointer */
 
   filep->f_pos = fpos;
-  return buflen;
+  return buflen - remaining;
 }
 
 /****************************************************************************
@@ -1077,7 +1191,6 @@ static int cromfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
 static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
 {
-  FAR struct cromfs_volume_s *fs;
   FAR struct cromfs_file_s *oldff;
   FAR struct cromfs_file_s *newff;
 
@@ -1085,15 +1198,10 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
   DEBUGASSERT(oldp->f_priv != NULL && oldp->f_inode != NULL &&
               newp->f_priv == NULL && newp->f_inode != NULL);
 
-  /* Recover our private data from the struct file instance */
-
-  fs = (FAR struct cromfs_volume_s *)oldp->f_inode->i_private;
-  DEBUGASSERT(fs != NULL);
-
   /* Get the open file instance from the file structure */
 
   oldff = oldp->f_priv;
-  DEBUGASSERT(oldff->ff_node != NULL && oldff->ff_buffer != NULL);
+  DEBUGASSERT(oldff->ff_node != NULL);
 
   /* Allocate and initialize an new open file instance referring to the
    * same node.
@@ -1105,15 +1213,6 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
       return -ENOMEM;
     }
 
-  /* Create a file buffer to support partial sector accesses */
-
-  newff->ff_buffer = (FAR uint8_t *)kmm_malloc(fs->cv_bsize);
-  if (newff->ff_buffer == NULL)
-    {
-      kmm_free(newff);
-      return -ENOMEM;
-    }
-
   /* Save the node in the open file instance */
 
   newff->ff_node = oldff->ff_node;
@@ -1136,24 +1235,26 @@ static int cromfs_dup(FAR const struct file *oldp, FAR struct file *newp)
 static int cromfs_fstat(FAR const struct file *filep, FAR struct stat *buf)
 {
   FAR struct inode *inode;
-  FAR struct cromfs_volume_s *fs;
+  FAR struct cromfs_mount_s *cm;
+  FAR const struct cromfs_volume_s *fs;
   FAR struct cromfs_file_s *ff;
   uint32_t fsize;
   uint32_t bsize;
 
   /* Sanity checks */
 
-  DEBUGASSERT(filep->f_priv == NULL && filep->f_inode != NULL);
+  DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
 
   /* Get the mountpoint inode reference from the file structure and the
    * volume private data from the inode structure
    */
 
   ff              = filep->f_priv;
-  DEBUGASSERT(ff->ff_node != NULL && ff->ff_buffer != NULL);
+  DEBUGASSERT(ff->ff_node != NULL);
 
   inode           = filep->f_inode;
-  fs              = inode->i_private;
+  cm              = inode->i_private;
+  fs              = cm->cm_vol;
 
   /* Return the stat info */
 
@@ -1182,6 +1283,7 @@ static int cromfs_fstat(FAR const struct file *filep, FAR struct stat *buf)
 static int cromfs_opendir(FAR struct inode *mountpt, FAR const char *relpath,
                           FAR struct fs_dirent_s *dir)
 {
+  FAR struct cromfs_mount_s *cm;
   FAR const struct cromfs_volume_s *fs;
   FAR struct cromfs_nodeinfo_s info;
   uint32_t offset;
@@ -1195,7 +1297,8 @@ static int cromfs_opendir(FAR struct inode *mountpt, FAR const char *relpath,
 
   /* Recover our private data from the inode instance */
 
-  fs = mountpt->i_private;
+  cm = mountpt->i_private;
+  fs = cm->cm_vol;
 
   /* Locate the node for this relative path */
 
@@ -1232,6 +1335,7 @@ static int cromfs_opendir(FAR struct inode *mountpt, FAR const char *relpath,
 
 static int cromfs_readdir(struct inode *mountpt, struct fs_dirent_s *dir)
 {
+  FAR struct cromfs_mount_s *cm;
   FAR const struct cromfs_volume_s *fs;
   FAR const struct cromfs_node_s *node;
   struct cromfs_node_s newnode;
@@ -1247,7 +1351,8 @@ static int cromfs_readdir(struct inode *mountpt, struct fs_dirent_s *dir)
 
   /* Recover our private data from the inode instance */
 
-  fs = mountpt->i_private;
+  cm = mountpt->i_private;
+  fs = cm->cm_vol;
 
   /* Have we reached the end of the directory */
 
@@ -1376,14 +1481,45 @@ static int cromfs_rewinddir(struct inode *mountpt, struct fs_dirent_s *dir)
 static int cromfs_bind(FAR struct inode *blkdriver, const void *data,
                       void **handle)
 {
+  FAR struct cromfs_mount_s *cm;
+  FAR uint8_t *buffer;
+  uint32_t bsize;
+  int i;
+
   finfo("blkdriver: %p data: %p handle: %p\n", blkdriver, data, handle);
 
   DEBUGASSERT(blkdriver == NULL && handle != NULL);
   DEBUGASSERT(g_cromfs_image.cv_magic == CROMFS_MAGIC);
 
+  /* Create the mountpoint private data with the shared block cache */
+
+  cm = (FAR struct cromfs_mount_s *)
+    kmm_zalloc(sizeof(struct cromfs_mount_s));
+  if (cm == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  bsize  = g_cromfs_image.cv_bsize;
+  buffer = (FAR uint8_t *)
+    kmm_malloc(CONFIG_FS_CROMFS_CACHE_BLOCKS * bsize);
+  if (buffer == NULL)
+    {
+      kmm_free(cm);
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < CONFIG_FS_CROMFS_CACHE_BLOCKS; i++)
+    {
+      cm->cm_cache[i].cb_buffer = &buffer[i * bsize];
+    }
+
+  nxmutex_init(&cm->cm_lock);
+  cm->cm_vol = &g_cromfs_image;
+
   /* Return the new file system handle */
 
-  *handle = (FAR void *)&g_cromfs_image;
+  *handle = (FAR void *)cm;
   return OK;
 }
 
@@ -1398,8 +1534,18 @@ static int cromfs_bind(FAR struct inode *blkdriver, const void *data,
 static int cromfs_unbind(FAR void *handle, FAR struct inode **blkdriver,
                         unsigned int flags)
 {
+  FAR struct cromfs_mount_s *cm = (FAR struct cromfs_mount_s *)handle;
+
   finfo("handle: %p blkdriver: %p flags: %02x\n",
         handle, blkdriver, flags);
+
+  DEBUGASSERT(cm != NULL);
+
+  /* Release the block cache and the mountpoint private data */
+
+  nxmutex_destroy(&cm->cm_lock);
+  kmm_free(cm->cm_cache[0].cb_buffer);
+  kmm_free(cm);
   return OK;
 }
 
@@ -1412,7 +1558,8 @@ static int cromfs_unbind(FAR void *handle, FAR struct inode **blkdriver,
 
 static int cromfs_statfs(struct inode *mountpt, struct statfs *buf)
 {
-  FAR struct cromfs_volume_s *fs;
+  FAR struct cromfs_mount_s *cm;
+  FAR const struct cromfs_volume_s *fs;
 
   finfo("mountpt: %p buf: %p\n", mountpt, buf);
 
@@ -1422,7 +1569,8 @@ static int cromfs_statfs(struct inode *mountpt, struct statfs *buf)
 
   /* Recover our private data from the inode instance */
 
-  fs             = mountpt->i_private;
+  cm             = mountpt->i_private;
+  fs             = cm->cm_vol;
 
   /* Fill in the statfs info. */
 
@@ -1445,6 +1593,7 @@ static int cromfs_statfs(struct inode *mountpt, struct statfs *buf)
 static int cromfs_stat(FAR struct inode *mountpt, FAR const char *relpath,
                        FAR struct stat *buf)
 {
+  FAR struct cromfs_mount_s *cm;
   FAR const struct cromfs_volume_s *fs;
   struct cromfs_nodeinfo_s info;
   uint32_t offset;
@@ -1459,7 +1608,8 @@ static int cromfs_stat(FAR struct inode *mountpt, FAR const char *relpath,
 
   /* Recover our private data from the inode instance */
 
-  fs = mountpt->i_private;
+  cm = mountpt->i_private;
+  fs = cm->cm_vol;
 
   /* Locate the node for this relative path */
 
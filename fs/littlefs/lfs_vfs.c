@@ -24,13 +24,16 @@
 
 #include <nuttx/config.h>
 
+#include <debug.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <nuttx/fs/dirent.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/lib/lib.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/semaphore.h>
 
@@ -40,6 +43,15 @@
 #include "littlefs/lfs.h"
 #include "littlefs/lfs_util.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Flags set by the mount options */
+
+#define LITTLEFS_FORCEFORMAT  (1 << 0)
+#define LITTLEFS_AUTOFORMAT   (1 << 1)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -47,6 +59,7 @@
 struct littlefs_file_s
 {
   struct lfs_file       file;
+  struct lfs_file_config cfg;
   int                   refs;
 };
 
@@ -62,6 +75,22 @@ struct littlefs_mountpt_s
   struct mtd_geometry_s geo;
   struct lfs_config     cfg;
   struct lfs            lfs;
+  off_t                 nblocks;  /* Number of device blocks */
+
+  /* Sequential read prefetch */
+
+  FAR uint8_t          *pfbuffer; /* Prefetched data */
+  size_t                pfsize;   /* Size of pfbuffer in bytes */
+  off_t                 pfblock;  /* First device block in pfbuffer */
+  size_t                pfcount;  /* Number of device blocks in pfbuffer */
+  off_t                 pfnext;   /* Device block after the last read */
+
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+  /* Pool of per-file caches */
+
+  FAR uint8_t          *pool;     /* CACHE_POOL caches of cache_size */
+  uint32_t              poolfree; /* Bit set of the free caches */
+#endif
 };
 
 /****************************************************************************
@@ -183,6 +212,53 @@ static void littlefs_semgive(FAR struct littlefs_mountpt_s *fs)
   nxsem_post(&fs->sem);
 }
 
+/****************************************************************************
+ * Name: littlefs_cache_alloc
+ *
+ * Description:
+ *   Take a file cache from the pool.  NULL means that the pool is empty
+ *   and that littlefs should allocate the cache itself.
+ *
+ ****************************************************************************/
+
+static FAR void *littlefs_cache_alloc(FAR struct littlefs_mountpt_s *fs)
+{
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+  int i;
+
+  for (i = 0; i < CONFIG_FS_LITTLEFS_CACHE_POOL; i++)
+    {
+      if ((fs->poolfree & (1u << i)) != 0)
+        {
+          fs->poolfree &= ~(1u << i);
+          return &fs->pool[i * fs->cfg.cache_size];
+        }
+    }
+#endif
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: littlefs_cache_free
+ *
+ * Description:
+ *   Return a file cache obtained with littlefs_cache_alloc() to the pool.
+ *
+ ****************************************************************************/
+
+static void littlefs_cache_free(FAR struct littlefs_mountpt_s *fs,
+                                FAR void *buffer)
+{
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+  if (buffer != NULL)
+    {
+      fs->poolfree |= 1u << (((FAR uint8_t *)buffer - fs->pool) /
+                             fs->cfg.cache_size);
+    }
+#endif
+}
+
 /****************************************************************************
  * Name: littlefs_convert_oflags
  ****************************************************************************/
@@ -252,6 +328,7 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
     }
 
   priv->refs = 1;
+  memset(&priv->cfg, 0, sizeof(priv->cfg));
 
   /* Take the semaphore */
 
@@ -261,14 +338,17 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
       goto errsem;
     }
 
-  /* Try to open the file */
+  /* Try to open the file, with a cache from the pool if there is one */
 
   oflags = littlefs_convert_oflags(oflags);
-  ret = lfs_file_open(&fs->lfs, &priv->file, relpath, oflags);
+  priv->cfg.buffer = littlefs_cache_alloc(fs);
+  ret = lfs_file_opencfg(&fs->lfs, &priv->file, relpath, oflags,
+                         &priv->cfg);
   if (ret < 0)
     {
       /* Error opening file */
 
+      littlefs_cache_free(fs, priv->cfg.buffer);
       goto errout;
     }
 
@@ -303,6 +383,7 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
 
 errout_with_file:
   lfs_file_close(&fs->lfs, &priv->file);
+  littlefs_cache_free(fs, priv->cfg.buffer);
 errout:
   littlefs_semgive(fs);
 errsem:
@@ -338,6 +419,7 @@ static int littlefs_close(FAR struct file *filep)
   if (--priv->refs <= 0)
     {
       ret = lfs_file_close(&fs->lfs, &priv->file);
+      littlefs_cache_free(fs, priv->cfg.buffer);
     }
 
   littlefs_semgive(fs);
@@ -831,37 +913,106 @@ static int littlefs_rewinddir(FAR struct inode *mountpt,
 }
 
 /****************************************************************************
- * Name: littlefs_bind
+ * Name: littlefs_read_device
  *
- * Description: This implements a portion of the mount operation. This
- *  function allocates and initializes the mountpoint private data and
- *  binds the driver inode to the filesystem private data. The final
- *  binding of the private data (containing the driver) to the
- *  mountpoint is performed by mount().
+ * Description: Read 'nblocks' device blocks starting at 'block'.
  *
  ****************************************************************************/
 
+static int littlefs_read_device(FAR struct littlefs_mountpt_s *fs,
+                                off_t block, size_t nblocks,
+                                FAR void *buffer)
+{
+  FAR struct inode *drv = fs->drv;
+
+  if (INODE_IS_MTD(drv))
+    {
+      return MTD_BREAD(drv->u.i_mtd, block, nblocks, buffer);
+    }
+  else
+    {
+      return drv->u.i_bops->read(drv, buffer, block, nblocks);
+    }
+}
+
+/****************************************************************************
+ * Name: littlefs_prefetch_invalidate
+ *
+ * Description:
+ *   Drop the prefetched data if it overlaps device blocks that are being
+ *   written or erased.
+ *
+ ****************************************************************************/
+
+static void littlefs_prefetch_invalidate(FAR struct littlefs_mountpt_s *fs,
+                                         off_t block, size_t nblocks)
+{
+  if (fs->pfcount > 0 && block < fs->pfblock + (off_t)fs->pfcount &&
+      block + (off_t)nblocks > fs->pfblock)
+    {
+      fs->pfcount = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: littlefs_read_block
+ ****************************************************************************/
+
 static int littlefs_read_block(FAR const struct lfs_config *c,
                                lfs_block_t block, lfs_off_t off,
                                FAR void *buffer, lfs_size_t size)
 {
   FAR struct littlefs_mountpt_s *fs = c->context;
   FAR struct mtd_geometry_s *geo = &fs->geo;
-  FAR struct inode *drv = fs->drv;
+  off_t start;
+  size_t count;
   int ret;
 
-  block = (block * c->block_size + off) / geo->blocksize;
+  start = ((off_t)block * c->block_size + off) / geo->blocksize;
   size  = size / geo->blocksize;
 
-  if (INODE_IS_MTD(drv))
-    {
-      ret = MTD_BREAD(drv->u.i_mtd, block, size, buffer);
-    }
-  else
+  if (fs->pfbuffer != NULL)
     {
-      ret = drv->u.i_bops->read(drv, buffer, block, size);
+      /* Serve the read from the prefetched data if it is all there */
+
+      if (start >= fs->pfblock &&
+          start + size <= fs->pfblock + (off_t)fs->pfcount)
+        {
+          memcpy(buffer,
+                 &fs->pfbuffer[(start - fs->pfblock) * geo->blocksize],
+                 size * geo->blocksize);
+          fs->pfnext = start + size;
+          return OK;
+        }
+
+      /* A read that continues the previous one is likely to be followed
+       * by more:  fetch a whole buffer full now.
+       */
+
+      if (start == fs->pfnext && size * geo->blocksize < fs->pfsize)
+        {
+          count = fs->pfsize / geo->blocksize;
+          if (count > fs->nblocks - start)
+            {
+              count = fs->nblocks - start;
+            }
+
+          fs->pfcount = 0;
+          ret = littlefs_read_device(fs, start, count, fs->pfbuffer);
+          if (ret >= 0)
+            {
+              fs->pfblock = start;
+              fs->pfcount = count;
+              memcpy(buffer, fs->pfbuffer, size * geo->blocksize);
+              fs->pfnext = start + size;
+              return OK;
+            }
+        }
+
+      fs->pfnext = start + size;
     }
 
+  ret = littlefs_read_device(fs, start, size, buffer);
   return ret >= 0 ? OK : ret;
 }
 
@@ -881,6 +1032,8 @@ static int littlefs_write_block(FAR const struct lfs_config *c,
   block = (block * c->block_size + off) / geo->blocksize;
   size  = size / geo->blocksize;
 
+  littlefs_prefetch_invalidate(fs, block, size);
+
   if (INODE_IS_MTD(drv))
     {
       ret = MTD_BWRITE(drv->u.i_mtd, block, size, buffer);
@@ -904,6 +1057,10 @@ static int littlefs_erase_block(FAR const struct lfs_config *c,
   FAR struct inode *drv = fs->drv;
   int ret = OK;
 
+  littlefs_prefetch_invalidate(fs, (off_t)block * c->block_size /
+                                   fs->geo.blocksize,
+                               c->block_size / fs->geo.blocksize);
+
   if (INODE_IS_MTD(drv))
     {
       FAR struct mtd_geometry_s *geo = &fs->geo;
@@ -938,14 +1095,137 @@ static int littlefs_sync_block(FAR const struct lfs_config *c)
   return ret == -ENOTTY ? OK : ret;
 }
 
+/****************************************************************************
+ * Name: littlefs_parse_options
+ *
+ * Description:
+ *   Apply the mount options in 'data' (see littlefs_bind()) to the
+ *   configuration and check the result.  Unknown options are ignored.
+ *
+ ****************************************************************************/
+
+static int littlefs_parse_options(FAR struct littlefs_mountpt_s *fs,
+                                  FAR const char *data, FAR int *flags)
+{
+  FAR struct lfs_config *cfg = &fs->cfg;
+  FAR char *options = NULL;
+  FAR char *saveptr;
+  FAR char *value;
+  FAR char *end;
+  FAR char *ptr;
+  unsigned long num = 0;
+  int ret = OK;
+
+  *flags = 0;
+
+  if (data != NULL)
+    {
+      options = strdup(data);
+      if (options == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      ptr = strtok_r(options, ",", &saveptr);
+      while (ptr != NULL)
+        {
+          value = strchr(ptr, '=');
+          if (value != NULL)
+            {
+              *value++ = '\0';
+              num = strtoul(value, &end, 0);
+              if (*value == '\0' || *end != '\0')
+                {
+                  ret = -EINVAL;
+                  break;
+                }
+            }
+
+          if (strcmp(ptr, "forceformat") == 0)
+            {
+              *flags |= LITTLEFS_FORCEFORMAT;
+            }
+          else if (strcmp(ptr, "autoformat") == 0)
+            {
+              *flags |= LITTLEFS_AUTOFORMAT;
+            }
+          else if (value != NULL && strcmp(ptr, "read_size") == 0)
+            {
+              cfg->read_size = num;
+            }
+          else if (value != NULL && strcmp(ptr, "prog_size") == 0)
+            {
+              cfg->prog_size = num;
+            }
+          else if (value != NULL && strcmp(ptr, "cache_size") == 0)
+            {
+              cfg->cache_size = num;
+            }
+          else if (value != NULL && strcmp(ptr, "lookahead_size") == 0)
+            {
+              cfg->lookahead_size = num;
+            }
+          else if (value != NULL && strcmp(ptr, "prefetch") == 0)
+            {
+              fs->pfsize = num;
+            }
+          else
+            {
+              fwarn("WARNING: Unknown mount option %s\n", ptr);
+            }
+
+          ptr = strtok_r(NULL, ",", &saveptr);
+        }
+
+      lib_free(options);
+    }
+
+  /* The device is accessed in whole blocks and littlefs has constraints
+   * of its own on the cache sizes.
+   */
+
+  if (ret < 0 ||
+      cfg->read_size == 0 || cfg->read_size % fs->geo.blocksize != 0 ||
+      cfg->prog_size == 0 || cfg->prog_size % fs->geo.blocksize != 0 ||
+      cfg->cache_size == 0 || cfg->cache_size % cfg->read_size != 0 ||
+      cfg->cache_size % cfg->prog_size != 0 ||
+      cfg->block_size % cfg->cache_size != 0 ||
+      cfg->lookahead_size == 0 || cfg->lookahead_size % 8 != 0 ||
+      fs->pfsize % fs->geo.blocksize != 0)
+    {
+      ferr("ERROR: Invalid cache configuration\n");
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: littlefs_bind
+ *
+ * Description: This implements a portion of the mount operation. This
+ *  function allocates and initializes the mountpoint private data and
+ *  binds the driver inode to the filesystem private data. The final
+ *  binding of the private data (containing the driver) to the
+ *  mountpoint is performed by mount().
+ *
+ *  The mount data is a comma separated list of options:
+ *
+ *    forceformat       - Format the device before mounting it
+ *    autoformat        - Format the device if it cannot be mounted
+ *    read_size=<n>     - Size of littlefs reads, in bytes
+ *    prog_size=<n>     - Size of littlefs programs, in bytes
+ *    cache_size=<n>    - Size of the read, program and file caches
+ *    lookahead_size=<n> - Size of the block allocation lookahead buffer
+ *    prefetch=<n>      - Size of the sequential read prefetch buffer
+ *
  ****************************************************************************/
 
 static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
                          FAR void **handle)
 {
   FAR struct littlefs_mountpt_s *fs;
+  int flags;
   int ret;
 
   /* Open the block driver */
@@ -1030,13 +1310,45 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   fs->cfg.lookahead_size = lfs_min(lfs_alignup(fs->cfg.block_count, 64) / 8,
                                    fs->cfg.read_size);
 
+  fs->nblocks = (off_t)fs->geo.neraseblocks *
+                (fs->geo.erasesize / fs->geo.blocksize);
+  fs->pfsize  = CONFIG_FS_LITTLEFS_PREFETCH_SIZE;
+
+  /* Let the mount options override the defaults */
+
+  ret = littlefs_parse_options(fs, data, &flags);
+  if (ret < 0)
+    {
+      goto errout_with_fs;
+    }
+
+  if (fs->pfsize > 0)
+    {
+      fs->pfbuffer = kmm_malloc(fs->pfsize);
+      if (fs->pfbuffer == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout_with_fs;
+        }
+    }
+
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+  /* Without the pool, file caches just come from the heap */
+
+  fs->pool = kmm_malloc(CONFIG_FS_LITTLEFS_CACHE_POOL * fs->cfg.cache_size);
+  if (fs->pool != NULL)
+    {
+      fs->poolfree = UINT32_MAX >> (32 - CONFIG_FS_LITTLEFS_CACHE_POOL);
+    }
+#endif
+
   /* Then get information about the littlefs filesystem on the devices
    * managed by this driver.
    */
 
   /* Force format the device if -o forceformat */
 
-  if (data && strcmp(data, "forceformat") == 0)
+  if ((flags & LITTLEFS_FORCEFORMAT) != 0)
     {
       ret = lfs_format(&fs->lfs, &fs->cfg);
       if (ret < 0)
@@ -1051,7 +1363,7 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
       /* Auto format the device if -o autoformat */
 
       if (ret != LFS_ERR_CORRUPT ||
-          !data || strcmp(data, "autoformat"))
+          (flags & LITTLEFS_AUTOFORMAT) == 0)
         {
           goto errout_with_fs;
         }
@@ -1076,6 +1388,10 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   return OK;
 
 errout_with_fs:
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+  kmm_free(fs->pool);
+#endif
+  kmm_free(fs->pfbuffer);
   nxsem_destroy(&fs->sem);
   kmm_free(fs);
 errout_with_block:
@@ -1135,6 +1451,10 @@ static int littlefs_unbind(FAR void *handle, FAR struct inode **driver,
 
       /* Release the mountpoint private data */
 
+#if CONFIG_FS_LITTLEFS_CACHE_POOL > 0
+      kmm_free(fs->pool);
+#endif
+      kmm_free(fs->pfbuffer);
       nxsem_destroy(&fs->sem);
       kmm_free(fs);
     }
@@ -269,6 +269,16 @@ struct nxffs_wrfile_s
   uint32_t                  crc;        /* Accumulated data block CRC */
 };
 
+/* One entry of the in-memory inode index */
+
+#ifdef CONFIG_NXFFS_INDEX
+struct nxffs_ixentry_s
+{
+  uint32_t                  hash;       /* Hash of the inode name */
+  off_t                     hoffset;    /* FLASH offset to the inode header */
+};
+#endif
+
 /* This structure represents the overall state of on NXFFS instance. */
 
 struct nxffs_volume_s
@@ -283,10 +293,19 @@ struct nxffs_volume_s
   off_t                     froffset;  /* Offset to the first free byte */
   off_t                     nblocks;   /* Number of R/W blocks on volume */
   off_t                     ioblock;   /* Current block number being accessed */
-  off_t                     cblock;    /* Starting block number in cache */
+  off_t                     cblock;    /* Block number of the current cache block */
+  off_t                     cfirst;    /* First block number in the read cache */
+  off_t                     ncached;   /* Number of blocks in the read cache */
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
-  FAR uint8_t              *cache;     /* On cached erase block for general I/O */
+  FAR uint8_t              *cache;     /* The current cached block for general I/O */
+  FAR uint8_t              *cbuffer;   /* CONFIG_NXFFS_CACHE_NBLOCKS blocks of cache */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#ifdef CONFIG_NXFFS_INDEX
+  FAR struct nxffs_ixentry_s *index;   /* Inode index sorted by name hash */
+  uint16_t                  nindex;    /* Number of entries in the index */
+  uint16_t                  ixalloc;   /* Number of entries allocated */
+  bool                      ixvalid;   /* True: The index describes all inodes */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -493,6 +512,26 @@ int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block);
 
 int nxffs_wrcache(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_invalidate
+ *
+ * Description:
+ *   Discard the content of the volume read cache.  This must be called
+ *   after FLASH is erased or written other than through nxffs_wrcache().
+ *   The memory that volume->cache refers to is left untouched.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_cache.c
+ *
+ ****************************************************************************/
+
+void nxffs_invalidate(FAR struct nxffs_volume_s *volume);
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
@@ -652,6 +691,152 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
 off_t nxffs_inodeend(FAR struct nxffs_volume_s *volume,
                      FAR struct nxffs_entry_s *entry);
 
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid.  This is done before the
+ *   index is (re-)built and when the volume is reformatted.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ixbuild
+ *
+ * Description:
+ *   Rebuild the inode index by scanning all inodes on the volume.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.  On failure the
+ *   index is left invalid and inode look-ups fall back to scanning.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+int nxffs_ixbuild(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ixadd
+ *
+ * Description:
+ *   Add the inode header at 'hoffset' with name 'name' to the index.  If
+ *   memory for the index is exhausted, the index is marked invalid.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixadd(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 off_t hoffset);
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove the inode header at 'hoffset' from the index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume, off_t hoffset);
+
+/****************************************************************************
+ * Name: nxffs_ixmove
+ *
+ * Description:
+ *   Record that packing moved the inode header at 'oldoffset' to
+ *   'newoffset'.
+ *
+ * Input Parameters:
+ *   volume    - Describes the NXFFS volume
+ *   oldoffset - The previous FLASH offset to the inode header
+ *   newoffset - The new FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+void nxffs_ixmove(FAR struct nxffs_volume_s *volume, off_t oldoffset,
+                  off_t newoffset);
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Find the inode with name 'name' using the index.  Only inode headers
+ *   whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success.  Otherwise, a negated errno value is
+ *   returned indicating the nature of the failure.  -ENOENT is returned
+ *   if the inode does not exist.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 FAR struct nxffs_entry_s *entry);
+
+/****************************************************************************
+ * Name: nxffs_ixnext
+ *
+ * Description:
+ *   Return the offset of the first inode header at or after 'offset'.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   offset - The FLASH offset to begin the search
+ *
+ * Returned Value:
+ *   The offset of the next inode header or -ENOENT if there is none.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+off_t nxffs_ixnext(FAR struct nxffs_volume_s *volume, off_t offset);
+#endif
+
 /****************************************************************************
  * Name: nxffs_verifyblock
  *
@@ -42,7 +42,9 @@
  * Name: nxffs_rdcache
  *
  * Description:
- *   Read one I/O block into the volume block cache memory.
+ *   Make one I/O block the current block of the volume cache memory,
+ *   reading it (and up to CONFIG_NXFFS_CACHE_NBLOCKS - 1 following blocks)
+ *   from FLASH if it is not already cached.
  *
  * Input Parameters:
  *   volume - Describes the current volume
@@ -57,24 +59,58 @@
 int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block)
 {
   size_t nxfrd;
+  off_t nblocks;
 
-  /* Check if the requested data is already in the cache */
+  /* Check if the requested data is already the current cache block */
 
   if (block != volume->cblock)
     {
-      /* Read the specified blocks into cache */
+      /* Is the block anywhere in the read cache? */
 
-      nxfrd = MTD_BREAD(volume->mtd, block, 1, volume->cache);
-      if (nxfrd != 1)
+      if (block < volume->cfirst ||
+          block >= volume->cfirst + volume->ncached)
         {
-          ferr("ERROR: Read block %jd failed: %zu\n",
-               (intmax_t)block, nxfrd);
-          return -EIO;
+          /* No.. Read the block and the blocks that follow it with a
+           * single transfer.  The scans done at mount time, on open and
+           * while packing are sequential so the following blocks are
+           * usually needed next.
+           */
+
+          nblocks = MIN(volume->nblocks - block, CONFIG_NXFFS_CACHE_NBLOCKS);
+          if (nblocks < 1)
+            {
+              nblocks = 1;
+            }
+
+          volume->ncached = 0;
+          nxfrd = MTD_BREAD(volume->mtd, block, nblocks, volume->cbuffer);
+          if (nxfrd != (size_t)nblocks && nblocks > 1)
+            {
+              /* A bad block following the requested one must not cause
+               * the requested block to fail.  Retry with just that block.
+               */
+
+              nblocks = 1;
+              nxfrd = MTD_BREAD(volume->mtd, block, 1, volume->cbuffer);
+            }
+
+          if (nxfrd != (size_t)nblocks)
+            {
+              ferr("ERROR: Read block %jd failed: %zu\n",
+                   (intmax_t)block, nxfrd);
+              volume->cblock = (off_t)-1;
+              return -EIO;
+            }
+
+          volume->cfirst  = block;
+          volume->ncached = nblocks;
         }
 
       /* Remember what is in the cache */
 
-      volume->cblock  = block;
+      volume->cache  = volume->cbuffer +
+                       (block - volume->cfirst) * volume->geo.blocksize;
+      volume->cblock = block;
     }
 
   return OK;
@@ -113,6 +149,29 @@ int nxffs_wrcache(FAR struct nxffs_volume_s *volume)
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxffs_invalidate
+ *
+ * Description:
+ *   Discard the content of the volume read cache.  This must be called
+ *   after FLASH is erased or written other than through nxffs_wrcache().
+ *
+ *   The next nxffs_rdcache() will read from FLASH again, but the memory
+ *   that volume->cache refers to is left untouched:  Packing continues to
+ *   copy from the source block that it last read.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *
+ ****************************************************************************/
+
+void nxffs_invalidate(FAR struct nxffs_volume_s *volume)
+{
+  volume->cblock  = (off_t)-1;
+  volume->cfirst  = 0;
+  volume->ncached = 0;
+}
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
@@ -120,7 +120,26 @@ int nxffs_readdir(FAR struct inode *mountpt, FAR struct fs_dirent_s *dir)
   /* Read the next inode header from the offset */
 
   offset = dir->u.nxffs.nx_offset;
-  ret = nxffs_nextentry(volume, offset, &entry);
+
+#ifdef CONFIG_NXFFS_INDEX
+  /* The index knows where the next inode header is.  This avoids searching
+   * through the data of deleted inodes for the next inode header.
+   */
+
+  if (volume->ixvalid)
+    {
+      offset = nxffs_ixnext(volume, offset);
+    }
+#endif
+
+  if (offset < 0)
+    {
+      ret = -ENOENT;
+    }
+  else
+    {
+      ret = nxffs_nextentry(volume, offset, &entry);
+    }
 
   /* If the read was successful, then handle the reported inode.  Note
    * that when the last inode has been reported, the value -ENOENT will
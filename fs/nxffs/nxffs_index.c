@@ -0,0 +1,430 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "nxffs.h"
+
+#ifdef CONFIG_NXFFS_INDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The index grows by this number of entries at a time */
+
+#define NXFFS_IXGROW   16
+
+/* The index size is limited by the width of nindex */
+
+#define NXFFS_IXMAX    UINT16_MAX
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixhash
+ *
+ * Description:
+ *   Return the 32-bit FNV-1a hash of an inode name.
+ *
+ ****************************************************************************/
+
+static uint32_t nxffs_ixhash(FAR const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0')
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixlower
+ *
+ * Description:
+ *   Return the position of the first index entry with a hash greater than
+ *   or equal to 'hash' (or nindex if there is none).
+ *
+ ****************************************************************************/
+
+static int nxffs_ixlower(FAR struct nxffs_volume_s *volume, uint32_t hash)
+{
+  int lo = 0;
+  int hi = volume->nindex;
+  int mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) >> 1;
+      if (volume->index[mid].hash < hash)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+
+  return lo;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixsearch
+ *
+ * Description:
+ *   Return the position of the index entry for the inode header at
+ *   'hoffset' or -ENOENT if the inode is not in the index.
+ *
+ ****************************************************************************/
+
+static int nxffs_ixsearch(FAR struct nxffs_volume_s *volume, off_t hoffset)
+{
+  int i;
+
+  for (i = 0; i < volume->nindex; i++)
+    {
+      if (volume->index[i].hoffset == hoffset)
+        {
+          return i;
+        }
+    }
+
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid.  This is done before the
+ *   index is (re-)built and when the volume is reformatted.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ ****************************************************************************/
+
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume)
+{
+  volume->nindex  = 0;
+  volume->ixvalid = true;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixbuild
+ *
+ * Description:
+ *   Rebuild the inode index by scanning all inodes on the volume.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.  On failure the
+ *   index is left invalid and inode look-ups fall back to scanning.
+ *
+ ****************************************************************************/
+
+int nxffs_ixbuild(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t offset;
+  int ret;
+
+  nxffs_ixreset(volume);
+
+  offset = volume->inoffset;
+  while ((ret = nxffs_nextentry(volume, offset, &entry)) == OK)
+    {
+      nxffs_ixadd(volume, entry.name, entry.hoffset);
+
+      offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+
+  /* -ENOENT just means that the end of the inodes was reached */
+
+  if (ret != -ENOENT)
+    {
+      ferr("ERROR: Failed to index the volume: %d\n", -ret);
+      volume->ixvalid = false;
+      return ret;
+    }
+
+  return volume->ixvalid ? OK : -ENOMEM;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixadd
+ *
+ * Description:
+ *   Add the inode header at 'hoffset' with name 'name' to the index.  If
+ *   memory for the index is exhausted, the index is marked invalid.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - FLASH offset to the inode header
+ *
+ ****************************************************************************/
+
+void nxffs_ixadd(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 off_t hoffset)
+{
+  FAR struct nxffs_ixentry_s *index;
+  uint32_t hash;
+  int ixalloc;
+  int pos;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  /* Make room for one more entry */
+
+  if (volume->nindex >= volume->ixalloc)
+    {
+      ixalloc = volume->ixalloc + NXFFS_IXGROW;
+      if (ixalloc > NXFFS_IXMAX)
+        {
+          ixalloc = NXFFS_IXMAX;
+        }
+
+      index = NULL;
+      if (ixalloc > volume->nindex)
+        {
+          index = (FAR struct nxffs_ixentry_s *)
+            kmm_realloc(volume->index,
+                        ixalloc * sizeof(struct nxffs_ixentry_s));
+        }
+
+      if (index == NULL)
+        {
+          fwarn("WARNING: Inode index disabled\n");
+          volume->ixvalid = false;
+          return;
+        }
+
+      volume->index   = index;
+      volume->ixalloc = ixalloc;
+    }
+
+  /* Insert the new entry after all entries with the same hash */
+
+  hash = nxffs_ixhash(name);
+  pos  = nxffs_ixlower(volume, hash);
+  while (pos < volume->nindex && volume->index[pos].hash == hash)
+    {
+      pos++;
+    }
+
+  memmove(&volume->index[pos + 1], &volume->index[pos],
+          (volume->nindex - pos) * sizeof(struct nxffs_ixentry_s));
+
+  volume->index[pos].hash    = hash;
+  volume->index[pos].hoffset = hoffset;
+  volume->nindex++;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove the inode header at 'hoffset' from the index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the inode header
+ *
+ ****************************************************************************/
+
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume, off_t hoffset)
+{
+  int pos;
+
+  if (volume->ixvalid)
+    {
+      pos = nxffs_ixsearch(volume, hoffset);
+      if (pos >= 0)
+        {
+          volume->nindex--;
+          memmove(&volume->index[pos], &volume->index[pos + 1],
+                  (volume->nindex - pos) * sizeof(struct nxffs_ixentry_s));
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ixmove
+ *
+ * Description:
+ *   Record that packing moved the inode header at 'oldoffset' to
+ *   'newoffset'.  The name, and hence the position in the index, does not
+ *   change.
+ *
+ * Input Parameters:
+ *   volume    - Describes the NXFFS volume
+ *   oldoffset - The previous FLASH offset to the inode header
+ *   newoffset - The new FLASH offset to the inode header
+ *
+ ****************************************************************************/
+
+void nxffs_ixmove(FAR struct nxffs_volume_s *volume, off_t oldoffset,
+                  off_t newoffset)
+{
+  int pos;
+
+  if (volume->ixvalid)
+    {
+      pos = nxffs_ixsearch(volume, oldoffset);
+      if (pos >= 0)
+        {
+          volume->index[pos].hoffset = newoffset;
+        }
+      else
+        {
+          /* Not an inode that we know of?  Stop trusting the index. */
+
+          fwarn("WARNING: Inode at %jd not indexed\n", (intmax_t)oldoffset);
+          volume->ixvalid = false;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Find the inode with name 'name' using the index.  Only inode headers
+ *   whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success.  Otherwise, a negated errno value is
+ *   returned indicating the nature of the failure.  -ENOENT is returned
+ *   if the inode does not exist.
+ *
+ ****************************************************************************/
+
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 FAR struct nxffs_entry_s *entry)
+{
+  uint32_t hash;
+  off_t hoffset;
+  int pos;
+  int ret;
+
+  DEBUGASSERT(volume->ixvalid);
+
+  hash = nxffs_ixhash(name);
+  for (pos = nxffs_ixlower(volume, hash);
+       pos < volume->nindex && volume->index[pos].hash == hash;
+       pos++)
+    {
+      /* Read the candidate inode header.  The index entry points right at
+       * it, so nxffs_nextentry() will not need to search.
+       */
+
+      hoffset = volume->index[pos].hoffset;
+      ret = nxffs_nextentry(volume, hoffset, entry);
+      if (ret < 0)
+        {
+          ferr("ERROR: Indexed inode at %jd not found: %d\n",
+               (intmax_t)hoffset, -ret);
+          return ret;
+        }
+
+      if (entry->hoffset == hoffset && strcmp(name, entry->name) == 0)
+        {
+          return OK;
+        }
+
+      nxffs_freeentry(entry);
+    }
+
+  finfo("No inode found\n");
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixnext
+ *
+ * Description:
+ *   Return the offset of the first inode header at or after 'offset'.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   offset - The FLASH offset to begin the search
+ *
+ * Returned Value:
+ *   The offset of the next inode header or -ENOENT if there is none.
+ *
+ ****************************************************************************/
+
+off_t nxffs_ixnext(FAR struct nxffs_volume_s *volume, off_t offset)
+{
+  off_t next = -ENOENT;
+  off_t hoffset;
+  int i;
+
+  DEBUGASSERT(volume->ixvalid);
+
+  for (i = 0; i < volume->nindex; i++)
+    {
+      hoffset = volume->index[i].hoffset;
+      if (hoffset >= offset && (next < 0 || hoffset < next))
+        {
+          next = hoffset;
+        }
+    }
+
+  return next;
+}
+
+#endif /* CONFIG_NXFFS_INDEX */
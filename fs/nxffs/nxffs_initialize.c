@@ -187,10 +187,12 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
       goto errout_with_volume;
     }
 
-  /* Allocate one I/O block buffer to general files system access */
+  /* Allocate the I/O block buffers for general files system access */
 
-  volume->cache = (FAR uint8_t *)kmm_malloc(volume->geo.blocksize);
-  if (!volume->cache)
+  volume->cbuffer = (FAR uint8_t *)
+    kmm_malloc(CONFIG_NXFFS_CACHE_NBLOCKS * volume->geo.blocksize);
+  volume->cache   = volume->cbuffer;
+  if (!volume->cbuffer)
     {
       ferr("ERROR: Failed to allocate an erase block buffer\n");
       ret = -ENOMEM;
@@ -300,9 +302,16 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   ferr("ERROR: Failed to calculate file system limits: %d\n", -ret);
 
 errout_with_buffer:
+#ifdef CONFIG_NXFFS_INDEX
+  if (volume->index)
+    {
+      kmm_free(volume->index);
+    }
+
+#endif
   kmm_free(volume->pack);
 errout_with_cache:
-  kmm_free(volume->cache);
+  kmm_free(volume->cbuffer);
 errout_with_volume:
 #ifndef CONFIG_NXFFS_PREALLOCATED
   kmm_free(volume);
@@ -344,6 +353,12 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
   int nerased;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* Start with an empty inode index */
+
+  nxffs_ixreset(volume);
+#endif
+
   /* Get the offset to the first valid block on the FLASH */
 
   block = 0;
@@ -387,6 +402,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
       volume->inoffset = entry.hoffset;
       finfo("First inode at offset %jd\n", (intmax_t)volume->inoffset);
 
+#ifdef CONFIG_NXFFS_INDEX
+      nxffs_ixadd(volume, entry.name, entry.hoffset);
+#endif
+
       /* Discard this entry and set the next offset. */
 
       offset = nxffs_inodeend(volume, &entry);
@@ -399,6 +418,12 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
     {
       while (nxffs_nextentry(volume, offset, &entry) == OK)
         {
+#ifdef CONFIG_NXFFS_INDEX
+          /* Build the inode index while we are passing by */
+
+          nxffs_ixadd(volume, entry.name, entry.hoffset);
+#endif
+
           /* Discard the entry and guess the next offset. */
 
           offset = nxffs_inodeend(volume, &entry);
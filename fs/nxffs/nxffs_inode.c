@@ -369,6 +369,15 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
   off_t offset;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* Use the inode index if it describes all inodes on the volume */
+
+  if (volume->ixvalid)
+    {
+      return nxffs_ixfind(volume, name, entry);
+    }
+#endif
+
   /* Start with the first valid inode that was discovered when the volume
    * was created (or modified after the last file system re-packing).
    */
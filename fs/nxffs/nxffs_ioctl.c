@@ -107,6 +107,16 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       /* Command not recognized, forward to the MTD driver */
 
       ret = MTD_IOCTL(volume->mtd, cmd, arg);
+
+      /* The MTD driver may have changed the FLASH content */
+
+      nxffs_invalidate(volume);
+#ifdef CONFIG_NXFFS_INDEX
+      if (cmd == MTDIOC_BULKERASE)
+        {
+          nxffs_ixreset(volume);
+        }
+#endif
     }
 
 errout_with_semaphore:
@@ -895,6 +895,16 @@ static inline int nxffs_wrclose(FAR struct nxffs_volume_s *volume,
 
   ret = nxffs_wrinode(volume, &wrfile->ofile.entry);
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* Then add the new inode to the index */
+
+  if (ret >= 0)
+    {
+      nxffs_ixadd(volume, wrfile->ofile.entry.name,
+                  wrfile->ofile.entry.hoffset);
+    }
+#endif
+
   /* The volume is now available for other writers */
 
 errout:
@@ -697,6 +697,16 @@ static int nxffs_wrinodehdr(FAR struct nxffs_volume_s *volume,
         }
     }
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* The inode index now needs to refer to the new inode header location */
+
+  if (ret >= 0)
+    {
+      nxffs_ixmove(volume, pack->src.entry.hoffset,
+                   pack->dest.entry.hoffset);
+    }
+#endif
+
   /* Reset the dest inode information */
 
   nxffs_freeentry(&pack->dest.entry);
@@ -1596,6 +1606,10 @@ start_pack:
 
       ret = MTD_BWRITE(volume->mtd, pack.block0, volume->blkper,
                        volume->pack);
+
+      /* Whatever the read cache held of this erase block is now stale */
+
+      nxffs_invalidate(volume);
       if (ret < 0)
         {
           ferr("ERROR: Failed to write erase block %jd [%jd]: %d\n",
@@ -1605,6 +1619,17 @@ start_pack:
     }
 
 errout_with_pack:
+#ifdef CONFIG_NXFFS_INDEX
+  /* If packing failed part way, some of the inode headers recorded in the
+   * index may not have been written.  Rebuild the index from FLASH.
+   */
+
+  if (ret < 0 || !volume->ixvalid)
+    {
+      nxffs_ixbuild(volume);
+    }
+
+#endif
   nxffs_freeentry(&pack.src.entry);
   nxffs_freeentry(&pack.dest.entry);
   return ret;
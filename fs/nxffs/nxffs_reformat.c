@@ -273,6 +273,14 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
   /* Erase and reformat the entire volume */
 
   ret = nxffs_format(volume);
+
+  /* Nothing that was cached or indexed from the old volume is valid now */
+
+  nxffs_invalidate(volume);
+#ifdef CONFIG_NXFFS_INDEX
+  nxffs_ixreset(volume);
+#endif
+
   if (ret < 0)
     {
       ferr("ERROR: Failed to reformat the volume: %d\n", -ret);
@@ -282,6 +290,7 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
   /* Check for bad blocks */
 
   ret = nxffs_badblocks(volume);
+  nxffs_invalidate(volume);
   if (ret < 0)
     {
       ferr("ERROR: Bad block check failed: %d\n", -ret);
@@ -113,6 +113,12 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name)
       ferr("ERROR: Failed to write block %jd: %d\n",
            (intmax_t)volume->ioblock, ret);
     }
+#ifdef CONFIG_NXFFS_INDEX
+  else
+    {
+      nxffs_ixremove(volume, entry.hoffset);
+    }
+#endif
 
 errout_with_entry:
   nxffs_freeentry(&entry);
@@ -200,10 +200,23 @@
 #define SMARTFS_NEXTSECTOR(h)    (*((uint16_t *)h->nextsector))
 #define SMARTFS_USED(h)          (*((uint16_t *)h->used))
 
-#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+#if defined(CONFIG_MTD_SMART_ENABLE_CRC) || \
+    defined(CONFIG_SMARTFS_SECTOR_BUFFER)
 #define CONFIG_SMARTFS_USE_SECTOR_BUFFER
 #endif
 
+#ifndef CONFIG_SMARTFS_CACHE_NSECTORS
+#  define CONFIG_SMARTFS_CACHE_NSECTORS 0
+#endif
+
+#ifndef CONFIG_SMARTFS_DIRHASH_NDIRS
+#  define CONFIG_SMARTFS_DIRHASH_NDIRS 4
+#endif
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0 || defined(CONFIG_SMARTFS_DIRHASH)
+#  define SMARTFS_HAVE_CACHE 1
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -294,6 +307,57 @@ struct smartfs_ofile_s
                                            */
 };
 
+#ifdef SMARTFS_HAVE_CACHE
+/* This structure describes one logical sector held in the sector cache */
+
+struct smartfs_csector_s
+{
+  FAR uint8_t              *data;         /* Sector data (availbytes) */
+  uint32_t                  lastuse;      /* Age for LRU replacement */
+  uint16_t                  sector;       /* Logical sector number */
+  bool                      valid;        /* True: data holds the sector */
+};
+
+/* One entry of a directory name hash table:  the name hash of an active
+ * directory entry and where that entry lives.
+ */
+
+struct smartfs_dhentry_s
+{
+  uint32_t                  hash;         /* Hash of the entry name */
+  uint16_t                  sector;       /* Directory sector of the entry */
+  uint16_t                  offset;       /* Offset of the entry in sector */
+};
+
+/* The name hash table of one directory, sorted by hash */
+
+struct smartfs_dirhash_s
+{
+  FAR struct smartfs_dhentry_s *entries;  /* Sorted hash table */
+  uint32_t                  lastuse;      /* Age for LRU replacement */
+  uint16_t                  dirsector;    /* First sector of the directory */
+  uint16_t                  nentries;     /* Number of entries in use */
+  uint16_t                  nalloc;       /* Number of entries allocated */
+  bool                      valid;        /* True: table is complete */
+};
+
+/* The RAM caches of a volume.  Like the working buffers, these are shared
+ * by all mountpoints on the same block driver.
+ */
+
+struct smartfs_cache_s
+{
+  uint32_t                  clock;        /* Source of LRU ages */
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  FAR uint8_t              *cbuffer;      /* Memory for all cached sectors */
+  struct smartfs_csector_s  sectors[CONFIG_SMARTFS_CACHE_NSECTORS];
+#endif
+#ifdef CONFIG_SMARTFS_DIRHASH
+  struct smartfs_dirhash_s  dirs[CONFIG_SMARTFS_DIRHASH_NDIRS];
+#endif
+};
+#endif /* SMARTFS_HAVE_CACHE */
+
 /* This structure represents the overall mountpoint state.  An instance of
  * this structure is retained as inode private data on each mountpoint that
  * is mounted with a smartfs filesystem.
@@ -311,6 +375,9 @@ struct smartfs_mountpt_s
   struct smart_format_s       fs_llformat;   /* Low level device format info */
   char                       *fs_rwbuffer;   /* Read/Write working buffer */
   char                       *fs_workbuffer; /* Working buffer */
+#ifdef SMARTFS_HAVE_CACHE
+  FAR struct smartfs_cache_s *fs_cache;      /* Sector and directory caches */
+#endif
   uint8_t                     fs_rootsector; /* Root directory sector num */
 };
 
@@ -365,6 +432,42 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs,
 int smartfs_extendfile(FAR struct smartfs_mountpt_s *fs,
         FAR struct smartfs_ofile_s *sf, off_t length);
 
+/* Sector access through the volume caches */
+
+int smartfs_readsector(FAR struct smartfs_mountpt_s *fs,
+        FAR struct smart_read_write_s *req);
+
+int smartfs_writesector(FAR struct smartfs_mountpt_s *fs,
+        FAR struct smart_read_write_s *req);
+
+int smartfs_allocsector(FAR struct smartfs_mountpt_s *fs);
+
+int smartfs_freesector(FAR struct smartfs_mountpt_s *fs, uint16_t sector);
+
+#ifdef SMARTFS_HAVE_CACHE
+int smartfs_cache_initialize(FAR struct smartfs_mountpt_s *fs);
+
+void smartfs_cache_uninitialize(FAR struct smartfs_mountpt_s *fs);
+#endif
+
+#ifdef CONFIG_SMARTFS_DIRHASH
+FAR struct smartfs_dirhash_s *
+smartfs_dirhash_get(FAR struct smartfs_mountpt_s *fs, uint16_t dirsector);
+
+uint32_t smartfs_dirhash_name(FAR struct smartfs_mountpt_s *fs,
+        FAR const char *name);
+
+uint16_t smartfs_dirhash_next(FAR struct smartfs_dirhash_s *dh,
+        uint32_t hash, FAR int *pos);
+
+void smartfs_dirhash_add(FAR struct smartfs_mountpt_s *fs,
+        uint16_t dirsector, FAR const char *name, uint16_t sector,
+        uint16_t offset);
+
+void smartfs_dirhash_remove(FAR struct smartfs_mountpt_s *fs,
+        uint16_t dirsector, uint16_t sector, uint16_t offset);
+#endif
+
 uint16_t smartfs_rdle16(FAR const void *val);
 
 void smartfs_wrle16(void *dest, uint16_t val);
@@ -0,0 +1,802 @@
+/****************************************************************************
+ * fs/smartfs/smartfs_cache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+
+#include "smartfs.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* A directory hash table grows by this number of entries at a time */
+
+#define SMARTFS_DHGROW  16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef SMARTFS_HAVE_CACHE
+/****************************************************************************
+ * Name: smartfs_cache_age
+ *
+ * Description:
+ *   Return a new age for an LRU entry that was just used.
+ *
+ ****************************************************************************/
+
+static uint32_t smartfs_cache_age(FAR struct smartfs_cache_s *cache)
+{
+  return ++cache->clock;
+}
+#endif
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+/****************************************************************************
+ * Name: smartfs_cache_find
+ *
+ * Description:
+ *   Return the cache entry holding 'sector' or NULL if it is not cached.
+ *
+ ****************************************************************************/
+
+static FAR struct smartfs_csector_s *
+smartfs_cache_find(FAR struct smartfs_cache_s *cache, uint16_t sector)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_SMARTFS_CACHE_NSECTORS; i++)
+    {
+      if (cache->sectors[i].valid && cache->sectors[i].sector == sector)
+        {
+          return &cache->sectors[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: smartfs_cache_victim
+ *
+ * Description:
+ *   Return an unused cache entry or, if there is none, the least recently
+ *   used one.
+ *
+ ****************************************************************************/
+
+static FAR struct smartfs_csector_s *
+smartfs_cache_victim(FAR struct smartfs_cache_s *cache)
+{
+  FAR struct smartfs_csector_s *victim = &cache->sectors[0];
+  int i;
+
+  for (i = 0; i < CONFIG_SMARTFS_CACHE_NSECTORS; i++)
+    {
+      if (!cache->sectors[i].valid)
+        {
+          return &cache->sectors[i];
+        }
+
+      if (cache->sectors[i].lastuse < victim->lastuse)
+        {
+          victim = &cache->sectors[i];
+        }
+    }
+
+  return victim;
+}
+
+/****************************************************************************
+ * Name: smartfs_cache_drop
+ *
+ * Description:
+ *   Forget any cached copy of 'sector'.
+ *
+ ****************************************************************************/
+
+static void smartfs_cache_drop(FAR struct smartfs_mountpt_s *fs,
+                               uint16_t sector)
+{
+  FAR struct smartfs_csector_s *cs;
+
+  if (fs->fs_cache != NULL)
+    {
+      cs = smartfs_cache_find(fs->fs_cache, sector);
+      if (cs != NULL)
+        {
+          cs->valid = false;
+        }
+    }
+}
+#endif /* CONFIG_SMARTFS_CACHE_NSECTORS > 0 */
+
+#ifdef CONFIG_SMARTFS_DIRHASH
+/****************************************************************************
+ * Name: smartfs_dirhash_find
+ *
+ * Description:
+ *   Return the valid hash table of the directory starting at 'dirsector'
+ *   or NULL if there is none.
+ *
+ ****************************************************************************/
+
+static FAR struct smartfs_dirhash_s *
+smartfs_dirhash_find(FAR struct smartfs_mountpt_s *fs, uint16_t dirsector)
+{
+  FAR struct smartfs_dirhash_s *dh;
+  int i;
+
+  if (fs->fs_cache != NULL)
+    {
+      for (i = 0; i < CONFIG_SMARTFS_DIRHASH_NDIRS; i++)
+        {
+          dh = &fs->fs_cache->dirs[i];
+          if (dh->valid && dh->dirsector == dirsector)
+            {
+              return dh;
+            }
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_lower
+ *
+ * Description:
+ *   Return the position of the first table entry with a hash greater than
+ *   or equal to 'hash' (or nentries if there is none).
+ *
+ ****************************************************************************/
+
+static int smartfs_dirhash_lower(FAR struct smartfs_dirhash_s *dh,
+                                 uint32_t hash)
+{
+  int lo = 0;
+  int hi = dh->nentries;
+  int mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) >> 1;
+      if (dh->entries[mid].hash < hash)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+
+  return lo;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_insert
+ *
+ * Description:
+ *   Insert one entry into a directory hash table, growing it as needed.
+ *
+ ****************************************************************************/
+
+static int smartfs_dirhash_insert(FAR struct smartfs_dirhash_s *dh,
+                                  uint32_t hash, uint16_t sector,
+                                  uint16_t offset)
+{
+  FAR struct smartfs_dhentry_s *entries;
+  int nalloc;
+  int pos;
+
+  if (dh->nentries >= dh->nalloc)
+    {
+      nalloc = dh->nalloc + SMARTFS_DHGROW;
+      if (nalloc > UINT16_MAX)
+        {
+          return -ENOMEM;
+        }
+
+      entries = (FAR struct smartfs_dhentry_s *)
+        kmm_realloc(dh->entries, nalloc * sizeof(struct smartfs_dhentry_s));
+      if (entries == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      dh->entries = entries;
+      dh->nalloc  = nalloc;
+    }
+
+  pos = smartfs_dirhash_lower(dh, hash);
+  memmove(&dh->entries[pos + 1], &dh->entries[pos],
+          (dh->nentries - pos) * sizeof(struct smartfs_dhentry_s));
+
+  dh->entries[pos].hash   = hash;
+  dh->entries[pos].sector = sector;
+  dh->entries[pos].offset = offset;
+  dh->nentries++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_build
+ *
+ * Description:
+ *   Fill the hash table 'dh' by walking the sector chain of the directory
+ *   starting at 'dirsector'.  This uses fs_rwbuffer.
+ *
+ ****************************************************************************/
+
+static int smartfs_dirhash_build(FAR struct smartfs_mountpt_s *fs,
+                                 FAR struct smartfs_dirhash_s *dh,
+                                 uint16_t dirsector)
+{
+  FAR struct smartfs_chain_header_s *header;
+  FAR struct smartfs_entry_header_s *entry;
+  struct smart_read_write_s readwrite;
+  uint16_t entrysize;
+  uint16_t offset;
+  uint16_t flags;
+  uint16_t sector;
+  int nsectors = 0;
+  int ret;
+
+  dh->valid     = false;
+  dh->dirsector = dirsector;
+  dh->nentries  = 0;
+
+  entrysize = sizeof(struct smartfs_entry_header_s) +
+              fs->fs_llformat.namesize;
+  header    = (FAR struct smartfs_chain_header_s *)fs->fs_rwbuffer;
+
+  sector = dirsector;
+  while (sector != SMARTFS_ERASEDSTATE_16BIT)
+    {
+      /* Do not follow a broken chain forever */
+
+      if (++nsectors > fs->fs_llformat.nsectors)
+        {
+          return -EIO;
+        }
+
+      readwrite.logsector = sector;
+      readwrite.offset    = 0;
+      readwrite.count     = fs->fs_llformat.availbytes;
+      readwrite.buffer    = (FAR uint8_t *)fs->fs_rwbuffer;
+      ret = smartfs_readsector(fs, &readwrite);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Add every active entry, as smartfs_finddirentry() would see it */
+
+      for (offset = sizeof(struct smartfs_chain_header_s);
+           offset < readwrite.count;
+           offset += entrysize)
+        {
+          entry = (FAR struct smartfs_entry_header_s *)
+            &fs->fs_rwbuffer[offset];
+#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
+          flags = smartfs_rdle16(&entry->flags);
+#else
+          flags = entry->flags;
+#endif
+          if ((flags & SMARTFS_DIRENT_EMPTY) ==
+              (SMARTFS_ERASEDSTATE_16BIT & SMARTFS_DIRENT_EMPTY) ||
+              (flags & SMARTFS_DIRENT_ACTIVE) !=
+              (SMARTFS_ERASEDSTATE_16BIT & SMARTFS_DIRENT_ACTIVE))
+            {
+              continue;
+            }
+
+          ret = smartfs_dirhash_insert(dh,
+                                       smartfs_dirhash_name(fs, entry->name),
+                                       sector, offset);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      sector = SMARTFS_NEXTSECTOR(header);
+    }
+
+  dh->valid = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_drop
+ *
+ * Description:
+ *   Invalidate every directory hash table that refers to 'sector', either
+ *   as the directory itself or as the home of one of its entries.
+ *
+ ****************************************************************************/
+
+static void smartfs_dirhash_drop(FAR struct smartfs_mountpt_s *fs,
+                                 uint16_t sector)
+{
+  FAR struct smartfs_dirhash_s *dh;
+  int i;
+  int j;
+
+  if (fs->fs_cache == NULL)
+    {
+      return;
+    }
+
+  for (i = 0; i < CONFIG_SMARTFS_DIRHASH_NDIRS; i++)
+    {
+      dh = &fs->fs_cache->dirs[i];
+      if (!dh->valid)
+        {
+          continue;
+        }
+
+      if (dh->dirsector == sector)
+        {
+          dh->valid = false;
+          continue;
+        }
+
+      for (j = 0; j < dh->nentries; j++)
+        {
+          if (dh->entries[j].sector == sector)
+            {
+              dh->valid = false;
+              break;
+            }
+        }
+    }
+}
+#endif /* CONFIG_SMARTFS_DIRHASH */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#ifdef SMARTFS_HAVE_CACHE
+/****************************************************************************
+ * Name: smartfs_cache_initialize
+ *
+ * Description:
+ *   Allocate the sector cache and directory hash tables of a volume.  The
+ *   caches are an optimization only:  on failure, fs_cache is left NULL
+ *   and all sector accesses go straight to the block driver.
+ *
+ ****************************************************************************/
+
+int smartfs_cache_initialize(FAR struct smartfs_mountpt_s *fs)
+{
+  FAR struct smartfs_cache_s *cache;
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  int i;
+#endif
+
+  cache = (FAR struct smartfs_cache_s *)
+    kmm_zalloc(sizeof(struct smartfs_cache_s));
+  if (cache == NULL)
+    {
+      return -ENOMEM;
+    }
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  cache->cbuffer = (FAR uint8_t *)
+    kmm_malloc(CONFIG_SMARTFS_CACHE_NSECTORS * fs->fs_llformat.availbytes);
+  if (cache->cbuffer == NULL)
+    {
+      kmm_free(cache);
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < CONFIG_SMARTFS_CACHE_NSECTORS; i++)
+    {
+      cache->sectors[i].data = &cache->cbuffer[i *
+                                               fs->fs_llformat.availbytes];
+    }
+#endif
+
+  fs->fs_cache = cache;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_cache_uninitialize
+ *
+ * Description:
+ *   Free the caches allocated by smartfs_cache_initialize().
+ *
+ ****************************************************************************/
+
+void smartfs_cache_uninitialize(FAR struct smartfs_mountpt_s *fs)
+{
+  FAR struct smartfs_cache_s *cache = fs->fs_cache;
+#ifdef CONFIG_SMARTFS_DIRHASH
+  int i;
+#endif
+
+  if (cache != NULL)
+    {
+#ifdef CONFIG_SMARTFS_DIRHASH
+      for (i = 0; i < CONFIG_SMARTFS_DIRHASH_NDIRS; i++)
+        {
+          if (cache->dirs[i].entries != NULL)
+            {
+              kmm_free(cache->dirs[i].entries);
+            }
+        }
+#endif
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+      kmm_free(cache->cbuffer);
+#endif
+      kmm_free(cache);
+      fs->fs_cache = NULL;
+    }
+}
+#endif /* SMARTFS_HAVE_CACHE */
+
+/****************************************************************************
+ * Name: smartfs_readsector
+ *
+ * Description:
+ *   Read (part of) a logical sector like BIOC_READSECT.  With the sector
+ *   cache enabled, the whole sector is read into the cache on a miss and
+ *   later reads of the same sector are served from RAM.
+ *
+ * Returned Value:
+ *   The number of bytes read on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int smartfs_readsector(FAR struct smartfs_mountpt_s *fs,
+                       FAR struct smart_read_write_s *req)
+{
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  FAR struct smartfs_cache_s *cache = fs->fs_cache;
+  FAR struct smartfs_csector_s *cs;
+  struct smart_read_write_s readwrite;
+  int ret;
+
+  if (cache != NULL &&
+      req->offset + req->count <= fs->fs_llformat.availbytes)
+    {
+      cs = smartfs_cache_find(cache, req->logsector);
+      if (cs == NULL)
+        {
+          cs = smartfs_cache_victim(cache);
+          cs->valid = false;
+
+          readwrite.logsector = req->logsector;
+          readwrite.offset    = 0;
+          readwrite.count     = fs->fs_llformat.availbytes;
+          readwrite.buffer    = cs->data;
+          ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+          if (ret < 0)
+            {
+              /* Let the driver handle the request as it was given */
+
+              return FS_IOCTL(fs, BIOC_READSECT, (unsigned long)req);
+            }
+
+          cs->sector = req->logsector;
+          cs->valid  = true;
+        }
+
+      cs->lastuse = smartfs_cache_age(cache);
+      memcpy((FAR uint8_t *)req->buffer, &cs->data[req->offset],
+             req->count);
+      return req->count;
+    }
+#endif
+
+  return FS_IOCTL(fs, BIOC_READSECT, (unsigned long)req);
+}
+
+/****************************************************************************
+ * Name: smartfs_writesector
+ *
+ * Description:
+ *   Write (part of) a logical sector like BIOC_WRITESECT.  The sector
+ *   cache is written through.
+ *
+ ****************************************************************************/
+
+int smartfs_writesector(FAR struct smartfs_mountpt_s *fs,
+                        FAR struct smart_read_write_s *req)
+{
+  int ret;
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  FAR struct smartfs_csector_s *cs;
+#endif
+
+  ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)req);
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  if (fs->fs_cache != NULL)
+    {
+      cs = smartfs_cache_find(fs->fs_cache, req->logsector);
+      if (cs != NULL)
+        {
+          if (ret < 0 ||
+              req->offset + req->count > fs->fs_llformat.availbytes)
+            {
+              /* We no longer know what is in the sector */
+
+              cs->valid = false;
+            }
+          else
+            {
+              memcpy(&cs->data[req->offset], req->buffer, req->count);
+            }
+        }
+    }
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smartfs_allocsector
+ *
+ * Description:
+ *   Allocate a new logical sector like BIOC_ALLOCSECT.
+ *
+ * Returned Value:
+ *   The logical sector number on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int smartfs_allocsector(FAR struct smartfs_mountpt_s *fs)
+{
+  int ret;
+
+  ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  if (ret >= 0)
+    {
+      smartfs_cache_drop(fs, (uint16_t)ret);
+    }
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smartfs_freesector
+ *
+ * Description:
+ *   Release a logical sector like BIOC_FREESECT and forget everything the
+ *   caches know about it.
+ *
+ ****************************************************************************/
+
+int smartfs_freesector(FAR struct smartfs_mountpt_s *fs, uint16_t sector)
+{
+#if CONFIG_SMARTFS_CACHE_NSECTORS > 0
+  smartfs_cache_drop(fs, sector);
+#endif
+#ifdef CONFIG_SMARTFS_DIRHASH
+  smartfs_dirhash_drop(fs, sector);
+#endif
+
+  return FS_IOCTL(fs, BIOC_FREESECT, (unsigned long)sector);
+}
+
+#ifdef CONFIG_SMARTFS_DIRHASH
+/****************************************************************************
+ * Name: smartfs_dirhash_name
+ *
+ * Description:
+ *   Return the 32-bit FNV-1a hash of a directory entry name.  Only the
+ *   first namesize characters count, as in the on-FLASH entries.
+ *
+ ****************************************************************************/
+
+uint32_t smartfs_dirhash_name(FAR struct smartfs_mountpt_s *fs,
+                              FAR const char *name)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < fs->fs_llformat.namesize && name[i] != '\0'; i++)
+    {
+      hash ^= (uint8_t)name[i];
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_get
+ *
+ * Description:
+ *   Return the name hash table of the directory starting at 'dirsector',
+ *   building it first if the directory is not among the hashed ones.
+ *   This may use fs_rwbuffer.
+ *
+ * Returned Value:
+ *   The hash table or NULL if none is available.  The caller must then
+ *   walk the directory chain.
+ *
+ ****************************************************************************/
+
+FAR struct smartfs_dirhash_s *
+smartfs_dirhash_get(FAR struct smartfs_mountpt_s *fs, uint16_t dirsector)
+{
+  FAR struct smartfs_cache_s *cache = fs->fs_cache;
+  FAR struct smartfs_dirhash_s *dh;
+  int ret;
+  int i;
+
+  if (cache == NULL)
+    {
+      return NULL;
+    }
+
+  dh = smartfs_dirhash_find(fs, dirsector);
+  if (dh == NULL)
+    {
+      /* Replace an unused or the least recently used table */
+
+      dh = &cache->dirs[0];
+      for (i = 0; i < CONFIG_SMARTFS_DIRHASH_NDIRS; i++)
+        {
+          if (!cache->dirs[i].valid)
+            {
+              dh = &cache->dirs[i];
+              break;
+            }
+
+          if (cache->dirs[i].lastuse < dh->lastuse)
+            {
+              dh = &cache->dirs[i];
+            }
+        }
+
+      ret = smartfs_dirhash_build(fs, dh, dirsector);
+      if (ret < 0)
+        {
+          fwarn("WARNING: Directory %d not hashed: %d\n", dirsector, ret);
+          dh->valid = false;
+          return NULL;
+        }
+    }
+
+  dh->lastuse = smartfs_cache_age(cache);
+  return dh;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_next
+ *
+ * Description:
+ *   Return the next directory sector that may hold an entry whose name
+ *   hash is 'hash'.  '*pos' must be -1 on the first call.
+ *
+ * Returned Value:
+ *   A logical sector number or SMARTFS_ERASEDSTATE_16BIT when there are
+ *   no more candidates.
+ *
+ ****************************************************************************/
+
+uint16_t smartfs_dirhash_next(FAR struct smartfs_dirhash_s *dh,
+                              uint32_t hash, FAR int *pos)
+{
+  if (*pos < 0)
+    {
+      *pos = smartfs_dirhash_lower(dh, hash);
+    }
+  else
+    {
+      (*pos)++;
+    }
+
+  if (*pos < dh->nentries && dh->entries[*pos].hash == hash)
+    {
+      return dh->entries[*pos].sector;
+    }
+
+  return SMARTFS_ERASEDSTATE_16BIT;
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_add
+ *
+ * Description:
+ *   Record a new entry in the hash table of its directory, if the
+ *   directory is hashed.
+ *
+ ****************************************************************************/
+
+void smartfs_dirhash_add(FAR struct smartfs_mountpt_s *fs,
+                         uint16_t dirsector, FAR const char *name,
+                         uint16_t sector, uint16_t offset)
+{
+  FAR struct smartfs_dirhash_s *dh;
+
+  dh = smartfs_dirhash_find(fs, dirsector);
+  if (dh != NULL &&
+      smartfs_dirhash_insert(dh, smartfs_dirhash_name(fs, name),
+                             sector, offset) < 0)
+    {
+      dh->valid = false;
+    }
+}
+
+/****************************************************************************
+ * Name: smartfs_dirhash_remove
+ *
+ * Description:
+ *   Remove the entry at sector/offset from the hash table of its
+ *   directory, if the directory is hashed.
+ *
+ ****************************************************************************/
+
+void smartfs_dirhash_remove(FAR struct smartfs_mountpt_s *fs,
+                            uint16_t dirsector, uint16_t sector,
+                            uint16_t offset)
+{
+  FAR struct smartfs_dirhash_s *dh;
+  int i;
+
+  dh = smartfs_dirhash_find(fs, dirsector);
+  if (dh == NULL)
+    {
+      return;
+    }
+
+  for (i = 0; i < dh->nentries; i++)
+    {
+      if (dh->entries[i].sector == sector &&
+          dh->entries[i].offset == offset)
+        {
+          dh->nentries--;
+          memmove(&dh->entries[i], &dh->entries[i + 1],
+                  (dh->nentries - i) * sizeof(struct smartfs_dhentry_s));
+          break;
+        }
+    }
+}
+#endif /* CONFIG_SMARTFS_DIRHASH */
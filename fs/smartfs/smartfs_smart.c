@@ -329,7 +329,7 @@ static int smartfs_open(FAR struct file *filep, const char *relpath,
       readwrite.count     = fs->fs_llformat.availbytes;
       readwrite.buffer    = (uint8_t *) sf->buffer;
 
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d header\n",
@@ -551,7 +551,7 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer,
       readwrite.offset = 0;
       readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
       readwrite.count = fs->fs_llformat.availbytes;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d data\n",
@@ -738,7 +738,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
 
       if (readwrite.count > 0)
         {
-          ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+          ret = smartfs_writesector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error %d writing sector %d data\n",
@@ -766,7 +766,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
           readwrite.offset = 0;
           readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
           readwrite.count = sizeof(struct smartfs_chain_header_s);
-          ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+          ret = smartfs_readsector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error %d reading sector %d header\n",
@@ -816,7 +816,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
 
       if (readwrite.count > 0)
         {
-          ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+          ret = smartfs_writesector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error %d writing sector %d data\n",
@@ -843,7 +843,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
         {
           /* First get a new chained sector */
 
-          ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+          ret = smartfs_allocsector(fs);
           if (ret < 0)
             {
               ferr("ERROR: Error %d allocating new sector\n", ret);
@@ -899,7 +899,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
             {
               /* Allocate a new sector */
 
-              ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+              ret = smartfs_allocsector(fs);
               if (ret < 0)
                 {
                   ferr("ERROR: Error %d allocating new sector\n", ret);
@@ -914,7 +914,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
                 nextsector);
               readwrite.buffer = (uint8_t *) header->nextsector;
               readwrite.count = sizeof(uint16_t);
-              ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+              ret = smartfs_writesector(fs, &readwrite);
               if (ret < 0)
                 {
                   ferr("ERROR: Error %d writing next sector\n", ret);
@@ -1305,7 +1305,7 @@ static int smartfs_readdir(struct inode *mountpt, struct fs_dirent_s *dir)
       readwrite.count = fs->fs_llformat.availbytes;
       readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
       readwrite.offset = 0;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           goto errout_with_semaphore;
@@ -1949,7 +1949,7 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath,
       readwrite.offset = 0;
       readwrite.count = fs->fs_llformat.availbytes;
       readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d data\n",
@@ -1970,13 +1970,18 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath,
       readwrite.offset = oldentry.doffset;
       readwrite.count = sizeof(direntry->flags);
       readwrite.buffer = (uint8_t *) &direntry->flags;
-      ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+      ret = smartfs_writesector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d writing flag bytes for sector %d\n",
                ret, readwrite.logsector);
           goto errout_with_semaphore;
         }
+
+#ifdef CONFIG_SMARTFS_DIRHASH
+      smartfs_dirhash_remove(fs, oldentry.dfirst, oldentry.dsector,
+                             oldentry.doffset);
+#endif
     }
   else
     {
@@ -248,6 +248,9 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
 
           fs->fs_rwbuffer = nextfs->fs_rwbuffer;
           fs->fs_workbuffer = nextfs->fs_workbuffer;
+#ifdef SMARTFS_HAVE_CACHE
+          fs->fs_cache = nextfs->fs_cache;
+#endif
           break;
         }
 
@@ -262,6 +265,12 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
     {
       fs->fs_rwbuffer = (char *) kmm_malloc(fs->fs_llformat.availbytes);
       fs->fs_workbuffer = (char *) kmm_malloc(WORKBUFFER_SIZE);
+#ifdef SMARTFS_HAVE_CACHE
+      if (smartfs_cache_initialize(fs) < 0)
+        {
+          fwarn("WARNING: Running without caches\n");
+        }
+#endif
     }
 
   /* Now add ourselves to the linked list of SMART mounts */
@@ -287,6 +296,12 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
   fs->fs_rwbuffer = (char *) kmm_malloc(fs->fs_llformat.availbytes);
   fs->fs_workbuffer = (char *) kmm_malloc(WORKBUFFER_SIZE);
   fs->fs_rootsector = SMARTFS_ROOT_DIR_SECTOR;
+#ifdef SMARTFS_HAVE_CACHE
+  if (smartfs_cache_initialize(fs) < 0)
+    {
+      fwarn("WARNING: Running without caches\n");
+    }
+#endif
 
 #endif /* CONFIG_SMARTFS_MULTI_ROOT_DIRS */
 
@@ -402,6 +417,9 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
 
       kmm_free(fs->fs_rwbuffer);
       kmm_free(fs->fs_workbuffer);
+#ifdef SMARTFS_HAVE_CACHE
+      smartfs_cache_uninitialize(fs);
+#endif
 
       /* Set the buffer's to invalid value to catch program bugs */
 
@@ -440,6 +458,9 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
 
   kmm_free(fs->fs_rwbuffer);
   kmm_free(fs->fs_workbuffer);
+#ifdef SMARTFS_HAVE_CACHE
+  smartfs_cache_uninitialize(fs);
+#endif
 #endif
 
   return ret;
@@ -477,6 +498,11 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
   struct      smartfs_chain_header_s *header;
   struct      smart_read_write_s readwrite;
   struct      smartfs_entry_header_s *entry;
+#ifdef CONFIG_SMARTFS_DIRHASH
+  FAR struct  smartfs_dirhash_s *dh;
+  uint32_t    hash = 0;
+  int         pos = -1;
+#endif
 
   /* Set the initial value of the output */
 
@@ -574,6 +600,20 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
 
           dirsector = dirstack[depth];
 
+#ifdef CONFIG_SMARTFS_DIRHASH
+          /* If the directory is hashed, visit only the sectors that may
+           * hold the name rather than the whole directory chain.
+           */
+
+          dh = smartfs_dirhash_get(fs, dirsector);
+          if (dh != NULL)
+            {
+              hash = smartfs_dirhash_name(fs, fs->fs_workbuffer);
+              pos = -1;
+              dirsector = smartfs_dirhash_next(dh, hash, &pos);
+            }
+#endif
+
           /* Read the directory */
 
           offset = 0xffff;
@@ -590,7 +630,7 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
               readwrite.count = fs->fs_llformat.availbytes;
               readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
               readwrite.offset = 0;
-              ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+              ret = smartfs_readsector(fs, &readwrite);
               if (ret < 0)
                 {
                   goto errout;
@@ -599,7 +639,16 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
               /* Point to next sector in chain */
 
               header = (struct smartfs_chain_header_s *) fs->fs_rwbuffer;
-              dirsector = SMARTFS_NEXTSECTOR(header);
+#ifdef CONFIG_SMARTFS_DIRHASH
+              if (dh != NULL)
+                {
+                  dirsector = smartfs_dirhash_next(dh, hash, &pos);
+                }
+              else
+#endif
+                {
+                  dirsector = SMARTFS_NEXTSECTOR(header);
+                }
 
               /* Search for the entry */
 
@@ -704,8 +753,7 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
                                   /* Read the next sector of the file */
 
                                   readwrite.logsector = dirsector;
-                                  ret = FS_IOCTL(fs, BIOC_READSECT,
-                                                 (unsigned long) &readwrite);
+                                  ret = smartfs_readsector(fs, &readwrite);
                                   if (ret < 0)
                                     {
                                       ferr("ERROR: Error in sector"
@@ -884,7 +932,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
       readwrite.count = fs->fs_llformat.availbytes;
       readwrite.offset = 0;
       readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           goto errout;
@@ -941,7 +989,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
         {
           /* Allocate a new sector and chain it to the last one */
 
-          ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+          ret = smartfs_allocsector(fs);
           if (ret < 0)
             {
               goto errout;
@@ -991,7 +1039,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
     {
       /* Allocate a new sector for the file / dir */
 
-      ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+      ret = smartfs_allocsector(fs);
       if (ret < 0)
         {
           goto errout;
@@ -1030,7 +1078,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
           readwrite.offset = offsetof(struct smartfs_chain_header_s, type);
           readwrite.buffer = (uint8_t *) &chainheader->type;
           readwrite.logsector = nextsector;
-          ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+          ret = smartfs_writesector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error %d setting new sector type for sector %d\n",
@@ -1064,7 +1112,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
   readwrite.offset = offset;
   readwrite.count = entrysize;
   readwrite.buffer = (uint8_t *) &fs->fs_rwbuffer[offset];
-  ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+  ret = smartfs_writesector(fs, &readwrite);
   if (ret < 0)
     {
       goto errout;
@@ -1074,7 +1122,7 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
     {
       /* Update chain header after the next sector was written */
 
-      ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &update_readwrite);
+      ret = smartfs_writesector(fs, &update_readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error chaining sector %d\n",
@@ -1083,6 +1131,10 @@ int smartfs_createentry(FAR struct smartfs_mountpt_s *fs,
         }
     }
 
+#ifdef CONFIG_SMARTFS_DIRHASH
+  smartfs_dirhash_add(fs, parentdirsector, filename, psector, offset);
+#endif
+
   /* Now fill in the entry */
 
   direntry->firstsector = nextsector;
@@ -1158,7 +1210,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
 
       sector = nextsector;
       readwrite.logsector = sector;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error reading sector %d\n", nextsector);
@@ -1168,7 +1220,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
       /* Release this sector */
 
       nextsector = SMARTFS_NEXTSECTOR(header);
-      ret = FS_IOCTL(fs, BIOC_FREESECT, sector);
+      ret = smartfs_freesector(fs, sector);
     }
 
   /* Remove the entry from the directory tree */
@@ -1177,7 +1229,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
   readwrite.offset = 0;
   readwrite.count = fs->fs_llformat.availbytes;
   readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
-  ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+  ret = smartfs_readsector(fs, &readwrite);
   if (ret < 0)
     {
       ferr("ERROR: Error reading directory info at sector %d\n",
@@ -1210,7 +1262,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
   readwrite.offset = entry->doffset;
   readwrite.count = sizeof(uint16_t);
   readwrite.buffer = (uint8_t *) &direntry->flags;
-  ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+  ret = smartfs_writesector(fs, &readwrite);
   if (ret < 0)
     {
       ferr("ERROR: Error marking entry inactive at sector %d\n",
@@ -1218,6 +1270,10 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
       goto errout;
     }
 
+#ifdef CONFIG_SMARTFS_DIRHASH
+  smartfs_dirhash_remove(fs, entry->dfirst, entry->dsector, entry->doffset);
+#endif
+
   /* Test if any entries in this sector are being used */
 
   if ((entry->dsector != fs->fs_rootsector) &&
@@ -1283,7 +1339,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
               /* Read the header for the next sector */
 
               readwrite.logsector = sector;
-              ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+              ret = smartfs_readsector(fs, &readwrite);
               if (ret < 0)
                 {
                   ferr("ERROR: Error reading sector %d\n", nextsector);
@@ -1302,8 +1358,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
                   readwrite.count  = sizeof(uint16_t);
                   readwrite.buffer = header->nextsector;
 
-                  ret = FS_IOCTL(fs, BIOC_WRITESECT,
-                                 (unsigned long)&readwrite);
+                  ret = smartfs_writesector(fs, &readwrite);
                   if (ret < 0)
                     {
                       ferr("ERROR: Error unchaining sector (%d)\n",
@@ -1313,8 +1368,7 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
 
                   /* Now release our sector */
 
-                  ret = FS_IOCTL(fs, BIOC_FREESECT,
-                                 (unsigned long)entry->dsector);
+                  ret = smartfs_freesector(fs, entry->dsector);
                   if (ret < 0)
                     {
                       ferr("ERROR: Error freeing sector %d\n",
@@ -1374,7 +1428,7 @@ int smartfs_countdirentries(struct smartfs_mountpt_s *fs,
       readwrite.offset = 0;
       readwrite.count = fs->fs_llformat.availbytes;
       readwrite.buffer = (uint8_t *) fs->fs_rwbuffer;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error reading sector %d\n", nextsector);
@@ -1468,7 +1522,7 @@ int smartfs_sync_internal(FAR struct smartfs_mountpt_s *fs,
       readwrite.count     = fs->fs_llformat.availbytes;
       readwrite.buffer    = sf->buffer;
 
-      ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+      ret = smartfs_writesector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d writing used bytes for sector %d\n",
@@ -1496,7 +1550,7 @@ int smartfs_sync_internal(FAR struct smartfs_mountpt_s *fs,
       readwrite.buffer    = (uint8_t *) fs->fs_rwbuffer;
       readwrite.count     = sizeof(struct smartfs_chain_header_s);
 
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d data\n",
@@ -1520,7 +1574,7 @@ int smartfs_sync_internal(FAR struct smartfs_mountpt_s *fs,
       readwrite.count  = sizeof(uint16_t);
       readwrite.buffer = (uint8_t *) &fs->fs_rwbuffer[readwrite.offset];
 
-      ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+      ret = smartfs_writesector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d writing used bytes for sector %d\n",
@@ -1650,7 +1704,7 @@ off_t smartfs_seek_internal(FAR struct smartfs_mountpt_s *fs,
       readwrite.count     = sizeof(struct smartfs_chain_header_s);
       readwrite.buffer    = (uint8_t *) fs->fs_rwbuffer;
 
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d header\n",
@@ -1676,7 +1730,7 @@ off_t smartfs_seek_internal(FAR struct smartfs_mountpt_s *fs,
       readwrite.offset = 0;
       readwrite.count = fs->fs_llformat.availbytes;
       readwrite.buffer = (uint8_t *) sf->buffer;
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error %d reading sector %d header\n",
@@ -1738,7 +1792,7 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs,
       readwrite.count     = fs->fs_llformat.availbytes;
       readwrite.buffer    = (FAR uint8_t *)fs->fs_rwbuffer;
 
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           ferr("ERROR: Error reading sector %d header\n", nextsector);
@@ -1782,7 +1836,7 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs,
         {
           /* Yes.. just release the sector */
 
-          ret = FS_IOCTL(fs, BIOC_FREESECT, (unsigned long)nextsector);
+          ret = smartfs_freesector(fs, nextsector);
           if (ret < 0)
             {
               ferr("ERROR: Error freeing sector %d\n", nextsector);
@@ -1829,7 +1883,7 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs,
 
           readwrite.count = fs->fs_llformat.availbytes;
 
-          ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)&readwrite);
+          ret = smartfs_writesector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error blanking 1st sector (%d) of file\n",
@@ -1860,7 +1914,7 @@ int smartfs_shrinkfile(FAR struct smartfs_mountpt_s *fs,
       readwrite.count     = fs->fs_llformat.availbytes;
       readwrite.buffer    = (uint8_t *)sf->buffer;
 
-      ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+      ret = smartfs_readsector(fs, &readwrite);
       if (ret < 0)
         {
           return ret;
@@ -1996,7 +2050,7 @@ int smartfs_extendfile(FAR struct smartfs_mountpt_s *fs,
 
       if (readwrite.count > 0)
         {
-          ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+          ret = smartfs_writesector(fs, &readwrite);
           if (ret < 0)
             {
               ferr("ERROR: Error %d writing sector %d data\n",
@@ -2020,7 +2074,7 @@ int smartfs_extendfile(FAR struct smartfs_mountpt_s *fs,
         {
           /* First get a new chained sector */
 
-          ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+          ret = smartfs_allocsector(fs);
           if (ret < 0)
             {
               ferr("ERROR: Error %d allocating new sector\n", ret);
@@ -2076,7 +2130,7 @@ int smartfs_extendfile(FAR struct smartfs_mountpt_s *fs,
             {
               /* Allocate a new sector */
 
-              ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xffff);
+              ret = smartfs_allocsector(fs);
               if (ret < 0)
                 {
                   ferr("ERROR: Error %d allocating new sector\n", ret);
@@ -2093,7 +2147,7 @@ int smartfs_extendfile(FAR struct smartfs_mountpt_s *fs,
               readwrite.buffer = (FAR uint8_t *)header->nextsector;
               readwrite.count  = sizeof(uint16_t);
 
-              ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+              ret = smartfs_writesector(fs, &readwrite);
               if (ret < 0)
                 {
                   ferr("ERROR: Error %d writing next sector\n", ret);
@@ -30,6 +30,8 @@
 #include <nuttx/mm/mm.h>
 
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <string.h>
 #include <assert.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -51,6 +53,10 @@ static int sock_file_ioctl(FAR struct file *filep, int cmd,
                            unsigned long arg);
 static int sock_file_poll(FAR struct file *filep, struct pollfd *fds,
                           bool setup);
+static ssize_t sock_file_readv(FAR struct file *filep,
+                               FAR const struct iovec *iov, int iovcnt);
+static ssize_t sock_file_writev(FAR struct file *filep,
+                                FAR const struct iovec *iov, int iovcnt);
 
 /****************************************************************************
  * Private Data
@@ -66,8 +72,10 @@ static const struct file_operations g_sock_fileops =
   sock_file_ioctl,  /* ioctl */
   sock_file_poll,   /* poll */
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-  NULL,               /* unlink */
+  NULL,             /* unlink */
 #endif
+  sock_file_readv,  /* readv */
+  sock_file_writev  /* writev */
 };
 
 static struct inode g_sock_inode =
@@ -139,6 +147,34 @@ static int sock_file_poll(FAR struct file *filep, FAR struct pollfd *fds,
   return psock_poll(filep->f_priv, fds, setup);
 }
 
+static ssize_t sock_file_readv(FAR struct file *filep,
+                               FAR const struct iovec *iov, int iovcnt)
+{
+  struct msghdr msg;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov    = (FAR struct iovec *)iov;
+  msg.msg_iovlen = iovcnt;
+
+  return psock_recvmsg(filep->f_priv, &msg, 0);
+}
+
+static ssize_t sock_file_writev(FAR struct file *filep,
+                                FAR const struct iovec *iov, int iovcnt)
+{
+  struct msghdr msg;
+
+  /* The address family gathers the iovecs so that e.g. a header plus
+   * payload leave as a single segment or datagram.
+   */
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov    = (FAR struct iovec *)iov;
+  msg.msg_iovlen = iovcnt;
+
+  return psock_sendmsg(filep->f_priv, &msg, 0);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -26,6 +26,7 @@
 
 #include <sys/stat.h>
 #include <sys/statfs.h>
+#include <sys/uio.h>
 #include <stdint.h>
 #include <string.h>
 #include <fcntl.h>
@@ -122,6 +123,10 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
               size_t buflen);
 static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
               size_t buflen);
+static ssize_t tmpfs_readv(FAR struct file *filep,
+              FAR const struct iovec *iov, int iovcnt);
+static ssize_t tmpfs_writev(FAR struct file *filep,
+              FAR const struct iovec *iov, int iovcnt);
 static off_t tmpfs_seek(FAR struct file *filep, off_t offset, int whence);
 static int  tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg);
 static int  tmpfs_dup(FAR const struct file *oldp, FAR struct file *newp);
@@ -185,7 +190,10 @@ const struct mountpt_operations tmpfs_operations =
   tmpfs_rmdir,      /* rmdir */
   tmpfs_rename,     /* rename */
   tmpfs_stat,       /* stat */
-  NULL              /* chstat */
+  NULL,             /* chstat */
+
+  tmpfs_readv,      /* readv */
+  tmpfs_writev      /* writev */
 };
 
 /****************************************************************************
@@ -1544,20 +1552,20 @@ static int tmpfs_close(FAR struct file *filep)
 }
 
 /****************************************************************************
- * Name: tmpfs_read
+ * Name: tmpfs_readv
  ****************************************************************************/
 
-static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
-                          size_t buflen)
+static ssize_t tmpfs_readv(FAR struct file *filep,
+                           FAR const struct iovec *iov, int iovcnt)
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nread;
+  size_t ncopy;
   off_t startpos;
-  off_t endpos;
   int ret;
+  int i;
 
-  finfo("filep: %p buffer: %p buflen: %lu\n",
-        filep, buffer, (unsigned long)buflen);
+  finfo("filep: %p iov: %p iovcnt: %d\n", filep, iov, iovcnt);
   DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
 
   /* Recover our private data from the struct file instance */
@@ -1572,21 +1580,26 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
       return ret;
     }
 
-  /* Handle attempts to read beyond the end of the file. */
+  /* Copy data from the memory object to the user buffers, stopping at the
+   * end of the file.
+   */
 
   startpos = filep->f_pos;
-  nread    = buflen;
-  endpos   = startpos + buflen;
+  nread    = 0;
 
-  if (endpos > tfo->tfo_size)
+  for (i = 0; i < iovcnt && startpos < tfo->tfo_size; i++)
     {
-      endpos = tfo->tfo_size;
-      nread  = endpos - startpos;
-    }
+      ncopy = iov[i].iov_len;
+      if (ncopy > tfo->tfo_size - startpos)
+        {
+          ncopy = tfo->tfo_size - startpos;
+        }
 
-  /* Copy data from the memory object to the user buffer */
+      memcpy(iov[i].iov_base, &tfo->tfo_data[startpos], ncopy);
+      startpos += ncopy;
+      nread    += ncopy;
+    }
 
-  memcpy(buffer, &tfo->tfo_data[startpos], nread);
   filep->f_pos += nread;
 
   /* Release the lock on the file */
@@ -1596,20 +1609,34 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 }
 
 /****************************************************************************
- * Name: tmpfs_write
+ * Name: tmpfs_read
  ****************************************************************************/
 
-static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
-                           size_t buflen)
+static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  struct iovec iov;
+
+  iov.iov_base = buffer;
+  iov.iov_len  = buflen;
+  return tmpfs_readv(filep, &iov, 1);
+}
+
+/****************************************************************************
+ * Name: tmpfs_writev
+ ****************************************************************************/
+
+static ssize_t tmpfs_writev(FAR struct file *filep,
+                            FAR const struct iovec *iov, int iovcnt)
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nwritten;
   off_t startpos;
   off_t endpos;
   int ret;
+  int i;
 
-  finfo("filep: %p buffer: %p buflen: %lu\n",
-        filep, buffer, (unsigned long)buflen);
+  finfo("filep: %p iov: %p iovcnt: %d\n", filep, iov, iovcnt);
   DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
 
   /* Recover our private data from the struct file instance */
@@ -1624,12 +1651,17 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
       return ret;
     }
 
-  /* Handle attempts to write beyond the end of the file */
+  /* Handle attempts to write beyond the end of the file.  The file is
+   * reallocated at most once for the whole gather list.
+   */
 
   startpos = filep->f_pos;
-  nwritten = buflen;
-  endpos   = startpos + buflen;
+  for (nwritten = 0, i = 0; i < iovcnt; i++)
+    {
+      nwritten += iov[i].iov_len;
+    }
 
+  endpos = startpos + nwritten;
   if (endpos > tfo->tfo_size)
     {
       /* Reallocate the file to handle the write past the end of the file. */
@@ -1641,9 +1673,14 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
         }
     }
 
-  /* Copy data from the memory object to the user buffer */
+  /* Copy data from the user buffers to the memory object */
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      memcpy(&tfo->tfo_data[startpos], iov[i].iov_base, iov[i].iov_len);
+      startpos += iov[i].iov_len;
+    }
 
-  memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
   filep->f_pos += nwritten;
 
   /* Release the lock on the file */
@@ -1656,6 +1693,20 @@ errout_with_lock:
   return (ssize_t)ret;
 }
 
+/****************************************************************************
+ * Name: tmpfs_write
+ ****************************************************************************/
+
+static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
+                           size_t buflen)
+{
+  struct iovec iov;
+
+  iov.iov_base = (FAR void *)buffer;
+  iov.iov_len  = buflen;
+  return tmpfs_writev(filep, &iov, 1);
+}
+
 /****************************************************************************
  * Name: tmpfs_seek
  ****************************************************************************/
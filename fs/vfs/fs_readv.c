@@ -0,0 +1,289 @@
+/****************************************************************************
+ * fs/vfs/fs_readv.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/cancelpt.h>
+
+#include "inode/inode.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_readv_loop
+ *
+ * Description:
+ *   Fallback for drivers and file systems without a readv method:  Read
+ *   each iovec in turn, stopping at the first short read.
+ *
+ ****************************************************************************/
+
+static ssize_t file_readv_loop(FAR struct file *filep,
+                               FAR const struct iovec *iov, int iovcnt)
+{
+  ssize_t ntotal = 0;
+  ssize_t nread;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      if (iov[i].iov_len == 0)
+        {
+          continue;
+        }
+
+      nread = file_read(filep, iov[i].iov_base, iov[i].iov_len);
+      if (nread < 0)
+        {
+          return ntotal > 0 ? ntotal : nread;
+        }
+
+      ntotal += nread;
+      if ((size_t)nread < iov[i].iov_len)
+        {
+          break;
+        }
+    }
+
+  return ntotal;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_readv
+ *
+ * Description:
+ *   Equivalent to the standard readv() function except that is accepts a
+ *   struct file instance instead of a file descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t file_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                   int iovcnt)
+{
+  FAR struct inode *inode;
+  size_t total;
+  int i;
+
+  DEBUGASSERT(filep);
+  inode = filep->f_inode;
+
+  /* Was this file opened for read access? */
+
+  if ((filep->f_oflags & O_RDOK) == 0)
+    {
+      return -EACCES;
+    }
+
+  if (inode == NULL || inode->u.i_ops == NULL)
+    {
+      return -EBADF;
+    }
+
+  /* Verify that the total length does not overflow an ssize_t */
+
+  if (iov == NULL || iovcnt < 0 || iovcnt > IOV_MAX)
+    {
+      return -EINVAL;
+    }
+
+  for (total = 0, i = 0; i < iovcnt; i++)
+    {
+      if (iov[i].iov_len > SSIZE_MAX - total)
+        {
+          return -EINVAL;
+        }
+
+      total += iov[i].iov_len;
+    }
+
+  if (total == 0)
+    {
+      return 0;
+    }
+
+  /* Use the scatter method of the driver or file system, if any.  Note
+   * that it lives at different positions in the driver and mountpoint
+   * vtables.
+   */
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  if (INODE_IS_MOUNTPT(inode))
+    {
+      if (inode->u.i_mops->readv != NULL)
+        {
+          return inode->u.i_mops->readv(filep, iov, iovcnt);
+        }
+    }
+  else
+#endif
+  if (inode->u.i_ops->readv != NULL)
+    {
+      return inode->u.i_ops->readv(filep, iov, iovcnt);
+    }
+
+  return file_readv_loop(filep, iov, iovcnt);
+}
+
+/****************************************************************************
+ * Name: nx_readv
+ *
+ * Description:
+ *   nx_readv() is an internal OS interface.  It is functionally similar to
+ *   the standard readv() interface except that it does not modify the
+ *   errno variable and it is not a cancellation point.
+ *
+ ****************************************************************************/
+
+ssize_t nx_readv(int fd, FAR const struct iovec *iov, int iovcnt)
+{
+  FAR struct file *filep;
+  ssize_t ret;
+
+  ret = (ssize_t)fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return file_readv(filep, iov, iovcnt);
+}
+
+/****************************************************************************
+ * Name: readv
+ *
+ * Description:
+ *   The standard, POSIX readv() interface.  See include/sys/uio.h.
+ *
+ ****************************************************************************/
+
+ssize_t readv(int fd, FAR const struct iovec *iov, int iovcnt)
+{
+  ssize_t ret;
+
+  /* readv() is a cancellation point */
+
+  enter_cancellation_point();
+
+  ret = nx_readv(fd, iov, iovcnt);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_preadv
+ *
+ * Description:
+ *   Equivalent to the standard preadv function except that is accepts a
+ *   struct file instance instead of a file descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t file_preadv(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt, off_t offset)
+{
+  off_t savepos;
+  off_t pos;
+  ssize_t ret;
+
+  /* Get the current position so that it can be restored */
+
+  savepos = file_seek(filep, 0, SEEK_CUR);
+  if (savepos < 0)
+    {
+      return (ssize_t)savepos;
+    }
+
+  pos = file_seek(filep, offset, SEEK_SET);
+  if (pos < 0)
+    {
+      return (ssize_t)pos;
+    }
+
+  ret = file_readv(filep, iov, iovcnt);
+
+  /* Restore the file position */
+
+  pos = file_seek(filep, savepos, SEEK_SET);
+  if (pos < 0 && ret >= 0)
+    {
+      ret = (ssize_t)pos;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: preadv
+ *
+ * Description:
+ *   Equivalent to readv() but reads from the given offset without changing
+ *   the file position.
+ *
+ ****************************************************************************/
+
+ssize_t preadv(int fd, FAR const struct iovec *iov, int iovcnt,
+               off_t offset)
+{
+  FAR struct file *filep;
+  ssize_t ret;
+
+  /* preadv() is a cancellation point */
+
+  enter_cancellation_point();
+
+  ret = (ssize_t)fs_getfilep(fd, &filep);
+  if (ret >= 0)
+    {
+      ret = file_preadv(filep, iov, iovcnt, offset);
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
@@ -0,0 +1,291 @@
+/****************************************************************************
+ * fs/vfs/fs_writev.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/cancelpt.h>
+
+#include "inode/inode.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_writev_loop
+ *
+ * Description:
+ *   Fallback for drivers and file systems without a writev method:  Write
+ *   each iovec in turn, repeating partial writes until the iovec is
+ *   consumed.
+ *
+ ****************************************************************************/
+
+static ssize_t file_writev_loop(FAR struct file *filep,
+                                FAR const struct iovec *iov, int iovcnt)
+{
+  FAR const uint8_t *buffer;
+  ssize_t ntotal = 0;
+  ssize_t nwritten;
+  size_t remaining;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      buffer    = iov[i].iov_base;
+      remaining = iov[i].iov_len;
+
+      while (remaining > 0)
+        {
+          nwritten = file_write(filep, buffer, remaining);
+          if (nwritten <= 0)
+            {
+              return ntotal > 0 ? ntotal : nwritten;
+            }
+
+          buffer    += nwritten;
+          remaining -= nwritten;
+          ntotal    += nwritten;
+        }
+    }
+
+  return ntotal;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_writev
+ *
+ * Description:
+ *   Equivalent to the standard writev() function except that is accepts a
+ *   struct file instance instead of a file descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t file_writev(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt)
+{
+  FAR struct inode *inode;
+  size_t total;
+  int i;
+
+  DEBUGASSERT(filep);
+  inode = filep->f_inode;
+
+  /* Was this file opened for write access? */
+
+  if ((filep->f_oflags & O_WROK) == 0)
+    {
+      return -EACCES;
+    }
+
+  if (inode == NULL || inode->u.i_ops == NULL)
+    {
+      return -EBADF;
+    }
+
+  /* Verify that the total length does not overflow an ssize_t */
+
+  if (iov == NULL || iovcnt < 0 || iovcnt > IOV_MAX)
+    {
+      return -EINVAL;
+    }
+
+  for (total = 0, i = 0; i < iovcnt; i++)
+    {
+      if (iov[i].iov_len > SSIZE_MAX - total)
+        {
+          return -EINVAL;
+        }
+
+      total += iov[i].iov_len;
+    }
+
+  if (total == 0)
+    {
+      return 0;
+    }
+
+  /* Use the gather method of the driver or file system, if any.  Note
+   * that it lives at different positions in the driver and mountpoint
+   * vtables.
+   */
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  if (INODE_IS_MOUNTPT(inode))
+    {
+      if (inode->u.i_mops->writev != NULL)
+        {
+          return inode->u.i_mops->writev(filep, iov, iovcnt);
+        }
+    }
+  else
+#endif
+  if (inode->u.i_ops->writev != NULL)
+    {
+      return inode->u.i_ops->writev(filep, iov, iovcnt);
+    }
+
+  return file_writev_loop(filep, iov, iovcnt);
+}
+
+/****************************************************************************
+ * Name: nx_writev
+ *
+ * Description:
+ *   nx_writev() is an internal OS interface.  It is functionally similar to
+ *   the standard writev() interface except that it does not modify the
+ *   errno variable and it is not a cancellation point.
+ *
+ ****************************************************************************/
+
+ssize_t nx_writev(int fd, FAR const struct iovec *iov, int iovcnt)
+{
+  FAR struct file *filep;
+  ssize_t ret;
+
+  ret = (ssize_t)fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return file_writev(filep, iov, iovcnt);
+}
+
+/****************************************************************************
+ * Name: writev
+ *
+ * Description:
+ *   The standard, POSIX writev() interface.  See include/sys/uio.h.
+ *
+ ****************************************************************************/
+
+ssize_t writev(int fd, FAR const struct iovec *iov, int iovcnt)
+{
+  ssize_t ret;
+
+  /* writev() is a cancellation point */
+
+  enter_cancellation_point();
+
+  ret = nx_writev(fd, iov, iovcnt);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_pwritev
+ *
+ * Description:
+ *   Equivalent to the standard pwritev function except that is accepts a
+ *   struct file instance instead of a file descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t file_pwritev(FAR struct file *filep, FAR const struct iovec *iov,
+                     int iovcnt, off_t offset)
+{
+  off_t savepos;
+  off_t pos;
+  ssize_t ret;
+
+  /* Get the current position so that it can be restored */
+
+  savepos = file_seek(filep, 0, SEEK_CUR);
+  if (savepos < 0)
+    {
+      return (ssize_t)savepos;
+    }
+
+  pos = file_seek(filep, offset, SEEK_SET);
+  if (pos < 0)
+    {
+      return (ssize_t)pos;
+    }
+
+  ret = file_writev(filep, iov, iovcnt);
+
+  /* Restore the file position */
+
+  pos = file_seek(filep, savepos, SEEK_SET);
+  if (pos < 0 && ret >= 0)
+    {
+      ret = (ssize_t)pos;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pwritev
+ *
+ * Description:
+ *   Equivalent to writev() but writes at the given offset without changing
+ *   the file position.
+ *
+ ****************************************************************************/
+
+ssize_t pwritev(int fd, FAR const struct iovec *iov, int iovcnt,
+                off_t offset)
+{
+  FAR struct file *filep;
+  ssize_t ret;
+
+  /* pwritev() is a cancellation point */
+
+  enter_cancellation_point();
+
+  ret = (ssize_t)fs_getfilep(fd, &filep);
+  if (ret >= 0)
+    {
+      ret = file_pwritev(filep, iov, iovcnt, offset);
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
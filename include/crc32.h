@@ -60,6 +60,17 @@ uint32_t crc32part(FAR const uint8_t *src, size_t len, uint32_t crc32val);
 
 uint32_t crc32(FAR const uint8_t *src, size_t len);
 
+/****************************************************************************
+ * Name: crc32combine
+ *
+ * Description:
+ *   Return the CRC of the concatenation of two buffers given crc1, the CRC
+ *   of the first, and crc2, the CRC of the second buffer of length len2.
+ *
+ ****************************************************************************/
+
+uint32_t crc32combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -32,6 +32,16 @@
 #ifndef __INCLUDE_LZF_H
 #define __INCLUDE_LZF_H
 
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -48,6 +58,10 @@
 #define LZF_MAX_HDR_SIZE   7
 #define LZF_MIN_HDR_SIZE   5
 
+#ifdef CONFIG_LIBC_LZF_STREAM
+#  define LZF_STREAM_BLKSIZE CONFIG_LIBC_LZF_STREAM_BLKSIZE
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -87,6 +101,34 @@ struct lzf_type1_header_s   /* Compressed data header */
 
 typedef lzf_hslot_t lzf_state_t[1 << HLOG];
 
+#ifdef CONFIG_LIBC_LZF_STREAM
+/* State of a compressed stream.  The caller sets next_in/avail_in and
+ * next_out/avail_out before each call to lzf_stream_compress() or
+ * lzf_stream_decompress().  These are advanced past the data consumed and
+ * produced on return.  The other fields are private.
+ */
+
+struct lzf_stream_s
+{
+  FAR const uint8_t *next_in;   /* Next input octet */
+  size_t avail_in;              /* Number of octets available at next_in */
+  FAR uint8_t *next_out;        /* Next output octet */
+  size_t avail_out;             /* Free space at next_out */
+
+  /* Private state */
+
+  FAR lzf_hslot_t *ls_htab;     /* Hash table (compression only) */
+  FAR const uint8_t *ls_out;    /* Output that was not yet returned */
+  uint16_t ls_outlen;           /* Number of octets at ls_out */
+  uint16_t ls_outpos;           /* Octets at ls_out already returned */
+  uint16_t ls_inlen;            /* Octets of the block in ls_inbuf */
+  uint8_t ls_hdrlen;            /* Octets of the header in ls_hdr */
+  uint8_t ls_hdr[LZF_MAX_HDR_SIZE];
+  uint8_t ls_inbuf[LZF_MAX_HDR_SIZE + LZF_STREAM_BLKSIZE];
+  uint8_t ls_outbuf[LZF_MAX_HDR_SIZE + LZF_STREAM_BLKSIZE];
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -151,4 +193,67 @@ unsigned int lzf_decompress(FAR const void *const in_data,
                             unsigned int in_len, FAR void *out_data,
                             unsigned int out_len);
 
+#ifdef CONFIG_LIBC_LZF_STREAM
+
+/****************************************************************************
+ * Name: lzf_stream_init
+ *
+ * Description:
+ *   Initialize a stream for compression or decompression.  htab is the
+ *   hash table used by lzf_stream_compress() and may be NULL if the stream
+ *   is only decompressed.  A stream may be initialized again to start a
+ *   new stream with the same state.
+ *
+ ****************************************************************************/
+
+void lzf_stream_init(FAR struct lzf_stream_s *strm, lzf_state_t htab);
+
+/****************************************************************************
+ * Name: lzf_stream_compress
+ *
+ * Description:
+ *   Compress data from next_in into next_out.  Input is gathered until a
+ *   block of LZF_STREAM_BLKSIZE octets is complete; if flush is true, a
+ *   partial block is compressed as well.  The output of one call never
+ *   extends past the end of a block, so a buffer of LZF_MAX_HDR_SIZE +
+ *   LZF_STREAM_BLKSIZE octets receives exactly one block.  Call again
+ *   until no output is produced.
+ *
+ *   Zero (OK) is always returned.
+ *
+ ****************************************************************************/
+
+int lzf_stream_compress(FAR struct lzf_stream_s *strm, bool flush);
+
+/****************************************************************************
+ * Name: lzf_stream_decompress
+ *
+ * Description:
+ *   Decompress as much data from next_in as possible into next_out.  The
+ *   input may be split anywhere, even within a block header.  Call again
+ *   while avail_out is zero on return to get the rest of the output.
+ *
+ *   Zero (OK) is returned on success.  Otherwise ERROR is returned and
+ *   errno is set to EINVAL if the stream is corrupted or to E2BIG if a
+ *   block is larger than LZF_STREAM_BLKSIZE.
+ *
+ ****************************************************************************/
+
+int lzf_stream_decompress(FAR struct lzf_stream_s *strm);
+
+/****************************************************************************
+ * Name: lzf_stream_pending
+ *
+ * Description:
+ *   Return true if a partial block or output that was not yet returned is
+ *   held in the stream state.  At the end of the input, this indicates a
+ *   truncated stream after lzf_stream_decompress() or a missing flush
+ *   after lzf_stream_compress().
+ *
+ ****************************************************************************/
+
+bool lzf_stream_pending(FAR const struct lzf_stream_s *strm);
+
+#endif /* CONFIG_LIBC_LZF_STREAM */
+
 #endif /* __INCLUDE_LZF_H */
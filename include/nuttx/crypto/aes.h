@@ -42,6 +42,7 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+#include <sys/types.h>
 #include <stdint.h>
 
 /****************************************************************************
@@ -49,14 +50,39 @@
  ****************************************************************************/
 
 #define AES128_KEY_SIZE    16
+#define AES192_KEY_SIZE    24
+#define AES256_KEY_SIZE    32
+
+#define AES_BLOCK_SIZE     16
+#define AES_MAXROUNDS      14
+
+#define AES_GCM_TAG_SIZE   16
 
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* The round keys.  The generic implementation keeps them as big-endian
+ * words, the decryption keys in the order and form of the equivalent
+ * inverse cipher (FIPS-197, section 5.3.5).  An architecture that provides
+ * its own block functions (CONFIG_CRYPTO_ARCH_AES) may use the storage in
+ * any way it likes.
+ */
+
 struct aes_state_s
 {
-  uint8_t expanded_key[176];
+  uint32_t ek[4 * (AES_MAXROUNDS + 1)];  /* Encryption round keys */
+  uint32_t dk[4 * (AES_MAXROUNDS + 1)];  /* Decryption round keys */
+  int nrounds;                           /* 10, 12 or 14 */
+};
+
+/* AES-GCM context:  The block cipher key and the GHASH key table */
+
+struct aes_gcm_s
+{
+  struct aes_state_s aes;
+  uint64_t hl[16];                       /* Multiples of H, low halves */
+  uint64_t hh[16];                       /* Multiples of H, high halves */
 };
 
 /****************************************************************************
@@ -118,14 +144,12 @@ void aes_decrypt(FAR uint8_t *state, FAR const uint8_t *key);
  *
  * Input Parameters:
  *  state  an AES context that can be used for AES operations
- *  key    a pointer to a 16-byte buffer holding the AES-128 key
- *  len    length of the key, must be 16
- *
- * TODO: Support other key lengths of 24 (AES-192) and 32 (AES-256)
+ *  key    a pointer to the AES key
+ *  len    length of the key: 16, 24 or 32
  *
  * Returned Value:
  *   0 if OK
- *   -EINVAL if len is not 16
+ *   -EINVAL if len is not a valid key length
  *
  ****************************************************************************/
 
@@ -164,6 +188,115 @@ void aes_encipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
 void aes_decipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
                   int nblk);
 
+/****************************************************************************
+ * Name: aes_cbc_encrypt
+ *
+ * Description:
+ *   Encrypt len bytes in CBC mode.  len must be a multiple of the block
+ *   size.  iv is updated so that a following call continues the chain.
+ *   out may be the same buffer as in.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if len is not a multiple of the block size
+ *
+ ****************************************************************************/
+
+int aes_cbc_encrypt(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len);
+
+/****************************************************************************
+ * Name: aes_cbc_decrypt
+ *
+ * Description:
+ *   Decrypt len bytes in CBC mode.  len must be a multiple of the block
+ *   size.  iv is updated so that a following call continues the chain.
+ *   out may be the same buffer as in.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if len is not a multiple of the block size
+ *
+ ****************************************************************************/
+
+int aes_cbc_decrypt(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len);
+
+/****************************************************************************
+ * Name: aes_ctr_crypt
+ *
+ * Description:
+ *   Encrypt or decrypt len bytes in CTR mode with a 128-bit big-endian
+ *   counter.  ctr is advanced by one for each block used, so a following
+ *   call continues the key stream as long as len was a multiple of the
+ *   block size.  out may be the same buffer as in.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_ctr_crypt(FAR struct aes_state_s *state, FAR uint8_t *ctr,
+                   FAR uint8_t *out, FAR const uint8_t *in, size_t len);
+
+/****************************************************************************
+ * Name: aes_gcm_setupkey
+ *
+ * Description:
+ *   Configure the given AES-GCM context for operation with the selected
+ *   key.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if len is not a valid key length
+ *
+ ****************************************************************************/
+
+int aes_gcm_setupkey(FAR struct aes_gcm_s *gcm, FAR const uint8_t *key,
+                     int len);
+
+/****************************************************************************
+ * Name: aes_gcm_encrypt
+ *
+ * Description:
+ *   Authenticated encryption in GCM mode (NIST SP 800-38D).  Encrypts len
+ *   bytes from in to out, authenticates them together with the aadlen
+ *   bytes of additional data and returns the first taglen bytes of the
+ *   authentication tag.  out may be the same buffer as in.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if ivlen is zero or taglen is not between 1 and 16
+ *
+ ****************************************************************************/
+
+int aes_gcm_encrypt(FAR struct aes_gcm_s *gcm,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR uint8_t *tag, size_t taglen);
+
+/****************************************************************************
+ * Name: aes_gcm_decrypt
+ *
+ * Description:
+ *   Authenticated decryption in GCM mode.  The tag is checked before
+ *   anything is decrypted; out is left untouched if it does not match.
+ *   out may be the same buffer as in.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if ivlen is zero or taglen is not between 1 and 16
+ *   -EBADMSG if the tag does not match
+ *
+ ****************************************************************************/
+
+int aes_gcm_decrypt(FAR struct aes_gcm_s *gcm,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR const uint8_t *tag, size_t taglen);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
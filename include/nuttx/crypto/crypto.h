@@ -31,7 +31,7 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#if defined(CONFIG_CRYPTO_AES)
+#if defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES)
 #  define AES_MODE_MIN 1
 
 #  define AES_MODE_ECB 1
@@ -38,7 +38,8 @@
 #define CRYPTO_AES_ECB          1
 #define CRYPTO_AES_CBC          2
 #define CRYPTO_AES_CTR          3
-#define CRYPTO_ALGORITHM_MAX    1
+#define CRYPTO_AES_GCM          4
+#define CRYPTO_ALGORITHM_MAX    4
 
 #define CRYPTO_FLAG_HARDWARE    0x01000000 /* hardware accelerated */
 #define CRYPTO_FLAG_SOFTWARE    0x02000000 /* software implementation */
@@ -47,9 +48,10 @@
 #define COP_DECRYPT             2
 #define COP_F_BATCH             0x0008 /* Batch op if possible */
 
-#define CIOCGSESSION            101
-#define CIOCFSESSION            102
-#define CIOCCRYPT               103
+#define CIOCGSESSION            101 /* Arg: struct session_op * */
+#define CIOCFSESSION            102 /* Arg: uint32_t * session # */
+#define CIOCCRYPT               103 /* Arg: struct crypt_op * */
+#define CIOCAUTHCRYPT           104 /* Arg: struct crypt_auth_op * */
 
 typedef char *caddr_t;
 
@@ -77,4 +79,24 @@ struct crypt_op
   caddr_t iv;
 };
 
+/* Authenticated encryption (CRYPTO_AES_GCM).  On encryption the tag is
+ * written to tag, on decryption it is verified and CIOCAUTHCRYPT fails with
+ * EBADMSG if it does not match.
+ */
+
+struct crypt_auth_op
+{
+  uint32_t ses;
+  uint16_t op;        /* i.e. COP_ENCRYPT */
+  uint16_t flags;
+  unsigned len;       /* Length of src and dst */
+  unsigned auth_len;  /* Length of the additional authenticated data */
+  caddr_t auth_src;   /* Additional authenticated data */
+  caddr_t src, dst;
+  caddr_t tag;        /* Authentication tag */
+  unsigned tag_len;   /* Length of tag, zero for the full 16 bytes */
+  caddr_t iv;
+  unsigned iv_len;
+};
+
 #endif /* __INCLUDE_NUTTX_CRYPTO_CRYPTODEV_H */
@@ -127,6 +127,27 @@ void devcrypto_register(void);
 
 void devzero_register(void);
 
+/****************************************************************************
+ * Name: devlzf_register
+ *
+ * Description:
+ *   Register a character device at 'devpath' that compresses the data
+ *   written to it into the file at 'path', and returns the decompressed
+ *   content of that file when read.
+ *
+ * Input Parameters:
+ *   devpath - The full path to the character device, e.g. "/dev/lzflog"
+ *   path    - The full path to the compressed file
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_LZF
+int devlzf_register(FAR const char *devpath, FAR const char *path);
+#endif
+
 /****************************************************************************
  * Name: bchdev_register
  *
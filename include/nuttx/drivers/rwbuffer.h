@@ -100,6 +100,8 @@ struct rwbuffer_s
   uint16_t      wrmaxblocks;     /* The number of blocks to buffer in memory */
   uint16_t      wralignblocks;   /* The buffer to be flash is always multiplied by this
                                   * number. It must be 0 or divisible by wrmaxblocks.
+                                  * With CONFIG_DRVR_WRITEBACK, this is the size of
+                                  * one cache page.
                                   */
 #endif
 #ifdef CONFIG_DRVR_READAHEAD
@@ -132,6 +134,21 @@ struct rwbuffer_s
   uint8_t      *wrbuffer;        /* Allocated write buffer */
   uint16_t      wrnblocks;       /* Number of blocks in write buffer */
   off_t         wrblockstart;    /* First block in write buffer */
+#ifdef CONFIG_DRVR_WRITEBACK
+
+  /* Write-back cache page descriptors */
+
+  FAR struct rwb_page_s *wrpages;
+  FAR uint8_t  *wrvalid;         /* Valid block bitmaps of the pages */
+  uint16_t      wrnpages;        /* Number of pages in the cache */
+  uint16_t      wrndirty;        /* Number of dirty pages */
+  uint16_t      wrnbusy;         /* Number of pages being written */
+  uint16_t      wrwaiters;       /* Threads waiting for a page write */
+  sem_t         wrwaitsem;       /* Signals the end of a page write */
+  sem_t         wrflushsem;      /* Serializes the wrflush calls */
+  uint32_t      wrclock;         /* Page age stamp */
+  int           wrerror;         /* First background write error */
+#endif
 #endif
 
   /* This is the state of the read-ahead buffering */
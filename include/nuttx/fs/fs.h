@@ -179,6 +179,7 @@ struct inode;
 struct stat;
 struct statfs;
 struct pollfd;
+struct iovec;
 struct fs_dirent_s;
 struct mtd_dev_s;
 
@@ -210,6 +211,15 @@ struct file_operations
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   int     (*unlink)(FAR struct inode *inode);
 #endif
+
+  /* Optional scatter/gather methods.  If these are not provided, readv()
+   * and writev() fall back to calling read() or write() once per iovec.
+   */
+
+  ssize_t (*readv)(FAR struct file *filep, FAR const struct iovec *iov,
+                   int iovcnt);
+  ssize_t (*writev)(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt);
 };
 
 /* This structure provides information about the state of a block driver */
@@ -335,6 +345,13 @@ struct mountpt_operations
             FAR struct stat *buf);
   int     (*chstat)(FAR struct inode *mountpt, FAR const char *relpath,
             FAR const struct stat *buf, int flags);
+
+  /* Optional scatter/gather methods (see struct file_operations) */
+
+  ssize_t (*readv)(FAR struct file *filep, FAR const struct iovec *iov,
+            int iovcnt);
+  ssize_t (*writev)(FAR struct file *filep, FAR const struct iovec *iov,
+            int iovcnt);
 };
 #endif /* CONFIG_DISABLE_MOUNTPOINT */
 
@@ -1105,6 +1122,67 @@ ssize_t file_write(FAR struct file *filep, FAR const void *buf,
 
 ssize_t nx_write(int fd, FAR const void *buf, size_t nbytes);
 
+/****************************************************************************
+ * Name: file_readv
+ *
+ * Description:
+ *   Equivalent to the standard readv() function except that is accepts a
+ *   struct file instance instead of a file descriptor, it does not modify
+ *   the errno variable and it is not a cancellation point.  The driver or
+ *   file system readv method is used if provided; otherwise the data is
+ *   read with one read() per iovec.
+ *
+ * Returned Value:
+ *   The number of bytes read on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+ssize_t file_readv(FAR struct file *filep, FAR const struct iovec *iov,
+                   int iovcnt);
+
+/****************************************************************************
+ * Name: nx_readv
+ *
+ * Description:
+ *   nx_readv() is an internal OS interface.  It is functionally similar to
+ *   the standard readv() interface except that it does not modify the
+ *   errno variable and it is not a cancellation point.
+ *
+ ****************************************************************************/
+
+ssize_t nx_readv(int fd, FAR const struct iovec *iov, int iovcnt);
+
+/****************************************************************************
+ * Name: file_writev
+ *
+ * Description:
+ *   Equivalent to the standard writev() function except that is accepts a
+ *   struct file instance instead of a file descriptor, it does not modify
+ *   the errno variable and it is not a cancellation point.  The driver or
+ *   file system writev method is used if provided; otherwise the data is
+ *   written with one write() per iovec.
+ *
+ * Returned Value:
+ *   The number of bytes written on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t file_writev(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt);
+
+/****************************************************************************
+ * Name: nx_writev
+ *
+ * Description:
+ *   nx_writev() is an internal OS interface.  It is functionally similar to
+ *   the standard writev() interface except that it does not modify the
+ *   errno variable and it is not a cancellation point.
+ *
+ ****************************************************************************/
+
+ssize_t nx_writev(int fd, FAR const struct iovec *iov, int iovcnt);
+
 /****************************************************************************
  * Name: file_pread
  *
@@ -1131,6 +1209,20 @@ ssize_t file_pread(FAR struct file *filep, FAR void *buf, size_t nbytes,
 ssize_t file_pwrite(FAR struct file *filep, FAR const void *buf,
                     size_t nbytes, off_t offset);
 
+/****************************************************************************
+ * Name: file_preadv and file_pwritev
+ *
+ * Description:
+ *   Equivalent to the standard preadv() and pwritev() functions except that
+ *   they accept a struct file instance instead of a file descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t file_preadv(FAR struct file *filep, FAR const struct iovec *iov,
+                    int iovcnt, off_t offset);
+ssize_t file_pwritev(FAR struct file *filep, FAR const struct iovec *iov,
+                     int iovcnt, off_t offset);
+
 /****************************************************************************
  * Name: file_sendfile
  *
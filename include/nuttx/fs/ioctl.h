@@ -88,6 +88,7 @@
 #define _EFUSEBASE      (0x3000) /* Efuse device ioctl commands */
 #define _MTRIOBASE      (0x3100) /* Motor device ioctl commands */
 #define _MATHIOBASE     (0x3200) /* MATH device ioctl commands */
+#define _RAMLOGBASE     (0x3300) /* RAM log device ioctl commands */
 #define _WLIOCBASE      (0x8b00) /* Wireless modules ioctl network commands */
 
 /* boardctl() commands share the same number space */
@@ -184,6 +185,10 @@
 #define FIOC_FILEPATH   _FIOC(0x000f)     /* IN:  FAR char *(length >= PATH_MAX)
                                            * OUT: The full file path
                                            */
+#define FIOC_FLUSH      _FIOC(0x0010)     /* IN:  None
+                                           * OUT: None (data buffered by the
+                                           *      driver has been written)
+                                           */
 
 /* NuttX file system ioctl definitions **************************************/
 
@@ -286,6 +291,14 @@
                                            * OUT: Partition information structure
                                            *      populated with data from the block
                                            *      device partition */
+#define BIOC_REQSTATS   _BIOC(0x000f)     /* Return and reset the request
+                                           * statistics of the block driver.
+                                           * IN:  Pointer to writable
+                                           *      driver specific statistics
+                                           *      structure (see
+                                           *      include/nuttx/mmcsd.h)
+                                           * OUT: Statistics since the
+                                           *      previous BIOC_REQSTATS */
 
 /* NuttX MTD driver ioctl definitions ***************************************/
 
@@ -564,6 +577,11 @@
 #define _MATHIOCVALID(c)    (_IOC_TYPE(c) == _MATHIOBASE)
 #define _MATHIOC(nr)        _IOC(_MATHIOBASE, nr)
 
+/* RAM log driver ***********************************************************/
+
+#define _RAMLOGIOCVALID(c)  (_IOC_TYPE(c) == _RAMLOGBASE)
+#define _RAMLOGIOC(nr)      _IOC(_RAMLOGBASE, nr)
+
 /* Wireless driver network ioctl definitions ********************************/
 
 /* (see nuttx/include/wireless/wireless.h */
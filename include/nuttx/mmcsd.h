@@ -27,6 +27,47 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of buckets of the request latency histograms.  Bucket 0 counts
+ * the requests that completed in less than 1 microsecond, bucket n those
+ * that took from 2^(n-1) up to 2^n microseconds.  The last bucket also
+ * counts all slower requests.
+ */
+
+#define MMCSD_NLATBUCKETS 24
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Request statistics of one transfer direction */
+
+struct mmcsd_dirstats_s
+{
+  uint32_t nreqs;                     /* Number of completed requests */
+  uint32_t nerrors;                   /* Number of failed requests */
+  uint32_t nxfers;                    /* Number of transfers on the bus */
+  uint32_t nblocks;                   /* Number of blocks transferred */
+  uint32_t maxlatency;                /* Largest latency (microseconds) */
+  uint32_t hist[MMCSD_NLATBUCKETS];   /* Latency histogram */
+};
+
+/* Returned by the BIOC_REQSTATS ioctl command when
+ * CONFIG_MMCSD_REQUEST_STATS is selected.  The latency of a request is the
+ * time from queueing it until its completion.
+ */
+
+struct mmcsd_reqstats_s
+{
+  struct mmcsd_dirstats_s read;       /* Read requests */
+  struct mmcsd_dirstats_s write;      /* Write requests */
+};
+
 /****************************************************************************
  * Public Functions Definitions
  ****************************************************************************/
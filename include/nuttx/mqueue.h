@@ -88,6 +88,9 @@ struct mqueue_inode_s
 {
   FAR struct inode *inode;    /* Containing inode */
   sq_queue_t msglist;         /* Prioritized message list */
+#ifdef CONFIG_MQ_QUEUE_POOL
+  sq_queue_t msgfree;         /* Free messages of the queue's own pool */
+#endif
   int16_t maxmsgs;            /* Maximum number of messages in the queue */
   int16_t nmsgs;              /* Number of message in the queue */
   int16_t nwaitnotfull;       /* Number tasks waiting for not full */
@@ -642,6 +645,45 @@ ssize_t file_mq_timedreceive(FAR struct file *mq, FAR char *msg,
                              size_t msglen, FAR unsigned int *prio,
                              FAR const struct timespec *abstime);
 
+/****************************************************************************
+ * Name: file_mq_receive_loan and file_mq_return_loan
+ *
+ * Description:
+ *   Zero-copy receive for use within the OS.  file_mq_receive_loan()
+ *   behaves like file_mq_receive() but, instead of copying the message,
+ *   returns the address of the message buffer in '*msg'.  The buffer
+ *   stays valid until it is handed back with file_mq_return_loan(), which
+ *   must happen before the message queue is closed.
+ *
+ * Input Parameters:
+ *   mq     - Message Queue Descriptor
+ *   msg    - The location to return (or the address of) the message
+ *   prio   - If not NULL, the location to store message priority.
+ *
+ * Returned Value:
+ *   file_mq_receive_loan() returns the length of the message and
+ *   file_mq_return_loan() returns zero (OK) on success.  A negated errno
+ *   value is returned on failure.
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_receive_loan(FAR struct file *mq, FAR char **msg,
+                             FAR unsigned int *prio);
+int file_mq_return_loan(FAR struct file *mq, FAR char *msg);
+
+/****************************************************************************
+ * Name: nxmq_receive_loan and nxmq_return_loan
+ *
+ * Description:
+ *   The same as file_mq_receive_loan() and file_mq_return_loan(), but
+ *   taking a message queue descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t nxmq_receive_loan(mqd_t mqdes, FAR char **msg,
+                          FAR unsigned int *prio);
+int nxmq_return_loan(mqd_t mqdes, FAR char *msg);
+
 /****************************************************************************
  * Name:  file_mq_setattr
  *
@@ -93,6 +93,35 @@
 #  define RADIO_MAX_ADDRLEN CONFIG_PKTRADIO_ADDRLEN
 #endif
 
+/* Checksum offload capabilities of a network device.  A driver sets these
+ * bits in d_features to tell the stack that it can skip the software
+ * checksum pass:
+ *
+ *   NETDEV_FEATURE_RXCSUM_IP - The driver has verified the IPv4 header
+ *     checksum of every packet that it passes to the stack.
+ *   NETDEV_FEATURE_RXCSUM_L4 - The driver has verified the TCP and UDP
+ *     checksums of every packet that it passes to the stack.
+ *   NETDEV_FEATURE_TXCSUM_IP - The device computes the IPv4 header checksum
+ *     on transmission.  The stack leaves the field zero.
+ *   NETDEV_FEATURE_TXCSUM_L4 - The device computes the TCP, UDP and ICMP
+ *     checksums on transmission.  The stack leaves the field zero.
+ */
+
+#define NETDEV_FEATURE_RXCSUM_IP  (1 << 0)
+#define NETDEV_FEATURE_RXCSUM_L4  (1 << 1)
+#define NETDEV_FEATURE_TXCSUM_IP  (1 << 2)
+#define NETDEV_FEATURE_TXCSUM_L4  (1 << 3)
+
+#define NETDEV_FEATURE_CSUM_ALL \
+  (NETDEV_FEATURE_RXCSUM_IP | NETDEV_FEATURE_RXCSUM_L4 | \
+   NETDEV_FEATURE_TXCSUM_IP | NETDEV_FEATURE_TXCSUM_L4)
+
+#ifdef CONFIG_NETDEV_CHKSUM_OFFLOAD
+#  define NETDEV_HAS_FEATURE(dev,f) (((dev)->d_features & (f)) != 0)
+#else
+#  define NETDEV_HAS_FEATURE(dev,f) (0)
+#endif
+
 /* Helper macros for network device statistics */
 
 #ifdef CONFIG_NETDEV_STATISTICS
@@ -253,6 +282,9 @@ struct net_driver_s
 #ifdef CONFIG_NETDEV_IFINDEX
   uint8_t d_ifindex;            /* Device index */
 #endif
+#ifdef CONFIG_NETDEV_CHKSUM_OFFLOAD
+  uint8_t d_features;           /* See NETDEV_FEATURE_* definitions */
+#endif
 
   uint16_t d_pktsize;           /* Maximum packet size */
 
@@ -607,6 +607,10 @@ struct tcb_s
 #if CONFIG_SEM_NNESTPRIO > 0
   uint8_t  npend_reprio;             /* Number of nested reprioritizations  */
   uint8_t  pend_reprios[CONFIG_SEM_NNESTPRIO];
+#endif
+#ifdef CONFIG_PRIORITY_PROTECT
+  uint8_t  nceilings;                    /* Number of ceilings in force     */
+  uint8_t  ceilings[CONFIG_SEM_NPROTECT];
 #endif
   uint8_t  base_priority;                /* "Normal" priority of the thread */
 #endif
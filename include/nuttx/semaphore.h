@@ -494,6 +494,30 @@ int nxsem_reset(FAR sem_t *sem, int16_t count);
 
 int nxsem_set_protocol(FAR sem_t *sem, int protocol);
 
+/****************************************************************************
+ * Name: nxsem_set_prioceiling
+ *
+ * Description:
+ *    Set the priority ceiling of a semaphore that uses, or will use, the
+ *    SEM_PRIO_PROTECT protocol.
+ *
+ * Input Parameters:
+ *    sem         - A pointer to the semaphore whose ceiling is to be set
+ *    prioceiling - The new priority ceiling
+ *    oldceiling  - If not NULL, the location to return the old ceiling
+ *
+ * Returned Value:
+ *   This is an internal OS interface and should not be used by applications.
+ *   It follows the NuttX internal error return policy:  Zero (OK) is
+ *   returned on success.  A negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_PROTECT
+int nxsem_set_prioceiling(FAR sem_t *sem, int prioceiling,
+                          FAR int *oldceiling);
+#endif
+
 /****************************************************************************
  * Name: nxsem_wait_uninterruptible
  *
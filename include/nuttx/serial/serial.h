@@ -89,6 +89,8 @@
 #define uart_txempty(dev)        dev->ops->txempty(dev)
 #define uart_send(dev,ch)        dev->ops->send(dev,ch)
 #define uart_receive(dev,s)      dev->ops->receive(dev,s)
+#define uart_sendbuf(dev,b,l)    dev->ops->sendbuf(dev,b,l)
+#define uart_recvbuf(dev,b,l)    dev->ops->recvbuf(dev,b,l)
 
 #ifdef CONFIG_SERIAL_TXDMA
 #define uart_dmasend(dev)      \
@@ -256,6 +258,22 @@ struct uart_ops_s
    */
 
   CODE bool (*txempty)(FAR struct uart_dev_s *dev);
+
+  /* Optional bulk transfers.  These may be NULL, in which case the upper
+   * half falls back to the send() and receive() methods above.
+   *
+   * sendbuf() queues as many of the 'len' bytes as the TX hardware will
+   * currently accept and returns the number queued.  recvbuf() moves up to
+   * 'len' bytes that have already been received into 'buffer' and returns
+   * the number moved, zero if there are none.  Neither may block.  The
+   * buffers are contiguous runs of the serial ring buffers, so a driver
+   * can copy (or start a FIFO burst) directly to or from them.
+   */
+
+  CODE ssize_t (*sendbuf)(FAR struct uart_dev_s *dev,
+                          FAR const char *buffer, size_t len);
+  CODE ssize_t (*recvbuf)(FAR struct uart_dev_s *dev,
+                          FAR char *buffer, size_t len);
 };
 
 /* This is the device structure used by the driver.  The caller of
@@ -289,6 +307,11 @@ struct uart_dev_s
 #if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGTSTP)
   pid_t                pid;          /* Thread PID to receive signals (-1 if none) */
 #endif
+#ifdef CONFIG_SERIAL_TERMIOS_MINTIME
+  cc_t                 tc_vmin;      /* c_cc[VMIN]: Minimum read count */
+  cc_t                 tc_vtime;     /* c_cc[VTIME]: Read timeout (deciseconds) */
+  volatile uint16_t    recvwake;     /* Bytes buffered before waking reader */
+#endif
 #endif
 
   /* Semaphores */
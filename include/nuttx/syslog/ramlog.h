@@ -40,6 +40,10 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/syslog/syslog.h>
 
 #ifdef CONFIG_RAMLOG
@@ -78,6 +82,40 @@
 #  define CONFIG_RAMLOG_BUFSIZE 1024
 #endif
 
+/* IOCTL Commands ***********************************************************/
+
+/* Besides FIONREAD, the RAM log supports collecting the log without
+ * copying it through read():  FIOC_MMAP (or mmap()) returns the address of
+ * the circular buffer, and the following commands manage the positions.
+ *
+ * RAMLOGIOC_GETPOS
+ *   Description: Get the head and tail offsets and the buffer size.  The
+ *                data is between tail and head and may wrap around.
+ *   Argument:    A reference to a struct ramlog_pos_s
+ *   Returned:    Zero (OK)
+ *
+ * RAMLOGIOC_CONSUME
+ *   Description: Release data after it has been collected, as if it had
+ *                been read.  The tail advances by at most the amount of
+ *                data in the buffer.
+ *   Argument:    The number of bytes (size_t)
+ *   Returned:    Zero (OK)
+ */
+
+#define RAMLOGIOC_GETPOS    _RAMLOGIOC(0x0001)
+#define RAMLOGIOC_CONSUME   _RAMLOGIOC(0x0002)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct ramlog_pos_s
+{
+  size_t head;              /* Offset where the next data will be added */
+  size_t tail;              /* Offset of the oldest data */
+  size_t size;              /* Size of the circular buffer */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
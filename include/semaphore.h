@@ -49,6 +49,8 @@
 
 #define PRIOINHERIT_FLAGS_DISABLE (1 << 0)  /* Bit 0: Priority inheritance
                                              * is disabled for this semaphore. */
+#define PRIOINHERIT_FLAGS_PROTECT (1 << 1)  /* Bit 1: Holders run at the
+                                             * priority ceiling. */
 
 /****************************************************************************
  * Public Type Declarations
@@ -87,6 +89,9 @@ struct sem_s
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t flags;                 /* See PRIOINHERIT_FLAGS_* definitions */
+# ifdef CONFIG_PRIORITY_PROTECT
+  uint8_t ceiling;               /* Priority ceiling (SEM_PRIO_PROTECT) */
+# endif
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
   FAR struct semholder_s *hhead; /* List of holders of semaphore counts */
 # else
@@ -99,7 +104,15 @@ typedef struct sem_s sem_t;
 
 /* Initializers */
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef CONFIG_PRIORITY_PROTECT
+# if CONFIG_SEM_PREALLOCHOLDERS > 0
+#  define SEM_INITIALIZER(c) \
+    {(c), 0, 0, NULL}            /* semcount, flags, ceiling, hhead */
+# else
+#  define SEM_INITIALIZER(c) \
+    {(c), 0, 0, {SEMHOLDER_INITIALIZER, SEMHOLDER_INITIALIZER}} /* semcount, flags, ceiling, holder[2] */
+# endif
+#elif defined(CONFIG_PRIORITY_INHERITANCE)
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
 #  define SEM_INITIALIZER(c) \
     {(c), 0, NULL}               /* semcount, flags, hhead */
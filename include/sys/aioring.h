@@ -0,0 +1,158 @@
+/****************************************************************************
+ * include/sys/aioring.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_AIORING_H
+#define __INCLUDE_SYS_AIORING_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <fcntl.h>
+
+#ifdef CONFIG_FS_AIORING
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* aioring_setup() flags */
+
+#define AIORING_NONBLOCK    O_NONBLOCK
+#define AIORING_CLOEXEC     O_CLOEXEC
+
+/* Submission queue entry operation codes */
+
+#define AIORING_OP_NOP      0  /* Complete immediately with result 0 */
+#define AIORING_OP_READ     1  /* read()/pread() into sqe_buf */
+#define AIORING_OP_WRITE    2  /* write()/pwrite() from sqe_buf */
+#define AIORING_OP_FSYNC    3  /* fsync() the descriptor */
+#define AIORING_OP_SEND     4  /* send() sqe_buf with sqe_flags */
+#define AIORING_OP_RECV     5  /* recv() into sqe_buf with sqe_flags */
+
+/* Use the current file position rather than an explicit offset for
+ * AIORING_OP_READ and AIORING_OP_WRITE.  A request operates on a duplicate
+ * of the descriptor taken at submission, so this is the position at
+ * submission and the position of the descriptor itself does not move.
+ */
+
+#define AIORING_OFFSET_CURRENT ((off_t)-1)
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* A submission queue entry describes one I/O operation.  An array of these
+ * is passed to aioring_submit() (or written to the ring descriptor) so that
+ * many operations are queued with a single system call.
+ */
+
+struct aioring_sqe_s
+{
+  uint8_t sqe_opcode;                /* One of AIORING_OP_* */
+  int sqe_fildes;                    /* File or socket descriptor */
+  int sqe_flags;                     /* send()/recv() flags */
+  off_t sqe_offset;                  /* File offset or AIORING_OFFSET_CURRENT */
+  FAR volatile void *sqe_buf;        /* Location of the I/O buffer */
+  size_t sqe_nbytes;                 /* Length of transfer */
+  FAR void *sqe_udata;               /* Returned unmodified in the CQE */
+};
+
+/* A completion queue entry reports the outcome of one operation.  An array
+ * of these is filled by aioring_reap() (or by reading the ring descriptor).
+ */
+
+struct aioring_cqe_s
+{
+  FAR void *cqe_udata;               /* sqe_udata of the completed request */
+  ssize_t cqe_result;                /* Bytes transferred or negated errno */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: aioring_setup
+ *
+ * Description:
+ *   Create a new I/O submission/completion ring able to hold 'entries'
+ *   requests in flight or awaiting reaping.  A descriptor referring to the
+ *   ring is returned.  Writing an array of struct aioring_sqe_s to the
+ *   descriptor submits requests; reading returns an array of struct
+ *   aioring_cqe_s.  The descriptor is pollable:  POLLIN means that
+ *   completions are available, POLLOUT that submission slots are free.
+ *
+ * Input Parameters:
+ *   entries - Ring depth
+ *   flags   - AIORING_NONBLOCK and/or AIORING_CLOEXEC
+ *
+ * Returned Value:
+ *   A new descriptor on success; -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int aioring_setup(unsigned int entries, int flags);
+
+/****************************************************************************
+ * Name: aioring_submit
+ *
+ * Description:
+ *   Submit up to 'nsqes' requests to the ring.  Returns the number of
+ *   requests accepted (which may be fewer than requested if the ring is
+ *   nearly full) or -1 with errno set.
+ *
+ ****************************************************************************/
+
+int aioring_submit(int fd, FAR const struct aioring_sqe_s *sqes,
+                   unsigned int nsqes);
+
+/****************************************************************************
+ * Name: aioring_reap
+ *
+ * Description:
+ *   Reap up to 'ncqes' completions from the ring, waiting for at least one
+ *   unless the ring was created with AIORING_NONBLOCK.  Returns the number
+ *   of completions copied or -1 with errno set.
+ *
+ ****************************************************************************/
+
+int aioring_reap(int fd, FAR struct aioring_cqe_s *cqes,
+                 unsigned int ncqes);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_FS_AIORING */
+#endif /* __INCLUDE_SYS_AIORING_H */
@@ -205,11 +205,18 @@ SYSCALL_LOOKUP(read,                       3)
 SYSCALL_LOOKUP(write,                      3)
 SYSCALL_LOOKUP(pread,                      4)
 SYSCALL_LOOKUP(pwrite,                     4)
+SYSCALL_LOOKUP(readv,                      3)
+SYSCALL_LOOKUP(writev,                     3)
+SYSCALL_LOOKUP(preadv,                     4)
+SYSCALL_LOOKUP(pwritev,                    4)
 #ifdef CONFIG_FS_AIO
   SYSCALL_LOOKUP(aio_read,                 1)
   SYSCALL_LOOKUP(aio_write,                1)
   SYSCALL_LOOKUP(aio_fsync,                2)
   SYSCALL_LOOKUP(aio_cancel,               2)
+#endif
+#ifdef CONFIG_FS_AIORING
+  SYSCALL_LOOKUP(aioring_setup,            2)
 #endif
   SYSCALL_LOOKUP(poll,                     3)
   SYSCALL_LOOKUP(select,                   5)
@@ -156,6 +156,21 @@ ssize_t readv(int fildes, FAR const struct iovec *iov, int iovcnt);
 
 ssize_t writev(int fildes, FAR const struct iovec *iov, int iovcnt);
 
+/****************************************************************************
+ * Name: preadv() and pwritev()
+ *
+ * Description:
+ *   Equivalent to readv() and writev() except that the transfer takes
+ *   place at the file position 'offset' and the file position is not
+ *   changed.
+ *
+ ****************************************************************************/
+
+ssize_t preadv(int fildes, FAR const struct iovec *iov, int iovcnt,
+               off_t offset);
+ssize_t pwritev(int fildes, FAR const struct iovec *iov, int iovcnt,
+                off_t offset);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
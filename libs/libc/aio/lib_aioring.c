@@ -0,0 +1,79 @@
+/****************************************************************************
+ * libs/libc/aio/lib_aioring.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/aioring.h>
+#include <unistd.h>
+
+#ifdef CONFIG_FS_AIORING
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aioring_submit
+ *
+ * Description:
+ *   Submit a batch of requests with a single write() of the SQE array.
+ *
+ ****************************************************************************/
+
+int aioring_submit(int fd, FAR const struct aioring_sqe_s *sqes,
+                   unsigned int nsqes)
+{
+  ssize_t ret;
+
+  ret = write(fd, sqes, nsqes * sizeof(struct aioring_sqe_s));
+  if (ret < 0)
+    {
+      return ERROR;
+    }
+
+  return ret / sizeof(struct aioring_sqe_s);
+}
+
+/****************************************************************************
+ * Name: aioring_reap
+ *
+ * Description:
+ *   Reap a batch of completions with a single read() of the CQE array.
+ *
+ ****************************************************************************/
+
+int aioring_reap(int fd, FAR struct aioring_cqe_s *cqes, unsigned int ncqes)
+{
+  ssize_t ret;
+
+  ret = read(fd, cqes, ncqes * sizeof(struct aioring_cqe_s));
+  if (ret < 0)
+    {
+      return ERROR;
+    }
+
+  return ret / sizeof(struct aioring_cqe_s);
+}
+
+#endif /* CONFIG_FS_AIORING */
@@ -31,6 +31,7 @@
 
 #include <nuttx/module.h>
 #include <nuttx/lib/modlib.h>
+#include <nuttx/syslog/syslog.h>
 
 #include "libc.h"
 
@@ -112,6 +113,14 @@ static inline int dlremove(FAR void *handle)
 #endif
     }
 
+#ifdef CONFIG_SYSLOG_DEFERRED
+  /* Format any deferred syslog records that may still reference format
+   * strings in the module text.
+   */
+
+  syslog_flush();
+#endif
+
   /* Release resources held by the module */
 
   if (modp->textalloc != NULL)
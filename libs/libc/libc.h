@@ -94,10 +94,13 @@ int lib_mode2oflags(FAR const char *mode);
 
 /* Defined in lib_libfwrite.c */
 
+ssize_t lib_fwrite_unlocked(FAR const void *ptr, size_t count,
+                            FAR FILE *stream);
 ssize_t lib_fwrite(FAR const void *ptr, size_t count, FAR FILE *stream);
 
 /* Defined in lib_libfread.c */
 
+ssize_t lib_fread_unlocked(FAR void *ptr, size_t count, FAR FILE *stream);
 ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream);
 
 /* Defined in lib_libfgets.c */
@@ -32,10 +32,62 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
+#include <stddef.h>
+
+#include <nuttx/compiler.h>
+
 #include "lzf/lzf.h"
 
 #ifdef CONFIG_LIBC_LZF
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Words are accessed through a packed structure so that the compiler uses
+ * unaligned word loads and stores where the CPU supports them and falls
+ * back to octet accesses where it does not.
+ */
+
+begin_packed_struct struct lzf_word_s
+{
+  uintptr_t w;
+} end_packed_struct;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lzf_copy
+ *
+ * Description:
+ *   Copy len octets from src to dest a word at a time.  The areas may
+ *   overlap only if dest lies at least one word after src.
+ *
+ ****************************************************************************/
+
+static inline void lzf_copy(FAR uint8_t *dest, FAR const uint8_t *src,
+                            unsigned int len)
+{
+  while (len >= sizeof(uintptr_t))
+    {
+      ((FAR struct lzf_word_s *)dest)->w =
+        ((FAR const struct lzf_word_s *)src)->w;
+
+      dest += sizeof(uintptr_t);
+      src  += sizeof(uintptr_t);
+      len  -= sizeof(uintptr_t);
+    }
+
+  while (len-- > 0)
+    {
+      *dest++ = *src++;
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -94,104 +146,9 @@ unsigned int lzf_decompress (FAR const void *const in_data,
 #ifdef lzf_movsb
           lzf_movsb(op, ip, ctrl);
 #else
-          switch (ctrl)
-            {
-              case 32:
-                *op++ = *ip++;
-
-              case 31:
-                *op++ = *ip++;
-
-              case 30:
-                *op++ = *ip++;
-
-              case 29:
-                *op++ = *ip++;
-
-              case 28:
-                *op++ = *ip++;
-
-              case 27:
-                *op++ = *ip++;
-
-              case 26:
-                *op++ = *ip++;
-
-              case 25:
-                *op++ = *ip++;
-
-              case 24:
-                *op++ = *ip++;
-
-              case 23:
-                *op++ = *ip++;
-
-              case 22:
-                *op++ = *ip++;
-
-              case 21:
-                *op++ = *ip++;
-
-              case 20:
-                *op++ = *ip++;
-
-              case 19:
-                *op++ = *ip++;
-
-              case 18:
-                *op++ = *ip++;
-
-              case 17:
-                *op++ = *ip++;
-
-              case 16:
-                *op++ = *ip++;
-
-              case 15:
-                *op++ = *ip++;
-
-              case 14:
-                *op++ = *ip++;
-
-              case 13:
-                *op++ = *ip++;
-
-              case 12:
-                *op++ = *ip++;
-
-              case 11:
-                *op++ = *ip++;
-
-              case 10:
-                *op++ = *ip++;
-
-              case 9:
-                *op++ = *ip++;
-
-              case 8:
-                *op++ = *ip++;
-
-              case 7:
-                *op++ = *ip++;
-
-              case 6:
-                *op++ = *ip++;
-
-              case 5:
-                *op++ = *ip++;
-
-              case 4:
-                *op++ = *ip++;
-
-              case 3:
-                *op++ = *ip++;
-
-              case 2:
-                *op++ = *ip++;
-
-              case 1:
-                *op++ = *ip++;
-            }
+          lzf_copy(op, ip, ctrl);
+          op += ctrl;
+          ip += ctrl;
 #endif
         }
       else /* back reference */
@@ -238,65 +195,36 @@ unsigned int lzf_decompress (FAR const void *const in_data,
           len += 2;
           lzf_movsb(op, ref, len);
 #else
-          switch (len)
-            {
-              default:
-                len += 2;
-
-                if (op >= ref + len)
-                  {
-                    /* Disjunct areas */
-
-                    memcpy (op, ref, len);
-                    op += len;
-                  }
-                else
-                  {
-                    /* Overlapping, use octet by octet copying */
-
-                    do
-                      {
-                        *op++ = *ref++;
-                      }
-                    while (--len);
-                  }
-
-                break;
-
-              case 9:
-                *op++ = *ref++;
-
-              case 8:
-                *op++ = *ref++;
-
-              case 7:
-                *op++ = *ref++;
-
-              case 6:
-                *op++ = *ref++;
-
-              case 5:
-                *op++ = *ref++;
-
-              case 4:
-                *op++ = *ref++;
-
-              case 3:
-                *op++ = *ref++;
+          len += 2;
 
-              case 2:
-                *op++ = *ref++;
+          if (op - ref >= (ptrdiff_t)sizeof(uintptr_t))
+            {
+              /* The areas do not overlap within one word, so they can be
+               * copied a word at a time even if the match overlaps the
+               * data being produced.
+               */
 
-              case 1:
-                *op++ = *ref++;
+              lzf_copy(op, ref, len);
+            }
+          else if (op - ref == 1)
+            {
+              /* A run of one repeated octet */
 
-              case 0:
+              memset(op, *ref, len);
+            }
+          else
+            {
+              /* Overlapping, use octet by octet copying */
 
-                /* Two octets more */
+              unsigned int i;
 
-                *op++ = *ref++;
-                *op++ = *ref++;
+              for (i = 0; i < len; i++)
+                {
+                  op[i] = ref[i];
+                }
             }
+
+          op += len;
 #endif
         }
     }
@@ -0,0 +1,402 @@
+/****************************************************************************
+ * libs/libc/lzf/lzf_stream.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "lzf/lzf.h"
+
+#ifdef CONFIG_LIBC_LZF_STREAM
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LZF_CMN_HDR_SIZE 3 /* Magic and type */
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lzf_stream_drain
+ *
+ * Description:
+ *   Copy output held in the stream state to next_out.  Returns true if all
+ *   of it has been returned.
+ *
+ ****************************************************************************/
+
+static bool lzf_stream_drain(FAR struct lzf_stream_s *strm)
+{
+  size_t nbytes;
+
+  nbytes = MIN(strm->avail_out,
+               (size_t)(strm->ls_outlen - strm->ls_outpos));
+  if (nbytes > 0)
+    {
+      /* ls_out may be NULL when nothing is pending */
+
+      memcpy(strm->next_out, &strm->ls_out[strm->ls_outpos], nbytes);
+
+      strm->next_out  += nbytes;
+      strm->avail_out -= nbytes;
+      strm->ls_outpos += nbytes;
+    }
+
+  if (strm->ls_outpos < strm->ls_outlen)
+    {
+      return false;
+    }
+
+  strm->ls_outpos = 0;
+  strm->ls_outlen = 0;
+  return true;
+}
+
+/****************************************************************************
+ * Name: lzf_stream_header
+ *
+ * Description:
+ *   Gather the header of the next block from next_in.  Returns 1 with the
+ *   compressed and uncompressed lengths of the block if the header is
+ *   complete, 0 if more input is needed or -EINVAL if it is invalid.
+ *
+ ****************************************************************************/
+
+static int lzf_stream_header(FAR struct lzf_stream_s *strm,
+                             FAR unsigned int *clen, FAR unsigned int *ulen)
+{
+  FAR uint8_t *hdr = strm->ls_hdr;
+  unsigned int hdrsize = LZF_CMN_HDR_SIZE;
+
+  for (; ; )
+    {
+      while (strm->ls_hdrlen < hdrsize)
+        {
+          if (strm->avail_in == 0)
+            {
+              return 0;
+            }
+
+          hdr[strm->ls_hdrlen++] = *strm->next_in++;
+          strm->avail_in--;
+        }
+
+      if (hdrsize > LZF_CMN_HDR_SIZE)
+        {
+          break;
+        }
+
+      /* The common part is complete, get the size of the full header */
+
+      if (hdr[0] != 'Z' || hdr[1] != 'V')
+        {
+          return -EINVAL;
+        }
+
+      if (hdr[2] == LZF_TYPE0_HDR)
+        {
+          hdrsize = LZF_TYPE0_HDR_SIZE;
+        }
+      else if (hdr[2] == LZF_TYPE1_HDR)
+        {
+          hdrsize = LZF_TYPE1_HDR_SIZE;
+        }
+      else
+        {
+          return -EINVAL;
+        }
+    }
+
+  if (hdr[2] == LZF_TYPE0_HDR)
+    {
+      *ulen = (unsigned int)hdr[3] << 8 | hdr[4];
+      *clen = *ulen;
+    }
+  else
+    {
+      *clen = (unsigned int)hdr[3] << 8 | hdr[4];
+      *ulen = (unsigned int)hdr[5] << 8 | hdr[6];
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lzf_stream_init
+ *
+ * Description:
+ *   Initialize a stream for compression or decompression.  htab is the
+ *   hash table used by lzf_stream_compress() and may be NULL if the stream
+ *   is only decompressed.  A stream may be initialized again to start a
+ *   new stream with the same state.
+ *
+ ****************************************************************************/
+
+void lzf_stream_init(FAR struct lzf_stream_s *strm, lzf_state_t htab)
+{
+  strm->next_in   = NULL;
+  strm->avail_in  = 0;
+  strm->next_out  = NULL;
+  strm->avail_out = 0;
+  strm->ls_htab   = htab;
+  strm->ls_out    = NULL;
+  strm->ls_outlen = 0;
+  strm->ls_outpos = 0;
+  strm->ls_inlen  = 0;
+  strm->ls_hdrlen = 0;
+}
+
+/****************************************************************************
+ * Name: lzf_stream_compress
+ *
+ * Description:
+ *   Compress data from next_in into next_out.  Input is gathered until a
+ *   block of LZF_STREAM_BLKSIZE octets is complete; if flush is true, a
+ *   partial block is compressed as well.  The output of one call never
+ *   extends past the end of a block, so a buffer of LZF_MAX_HDR_SIZE +
+ *   LZF_STREAM_BLKSIZE octets receives exactly one block.  Call again
+ *   until no output is produced.
+ *
+ *   Zero (OK) is always returned.
+ *
+ ****************************************************************************/
+
+int lzf_stream_compress(FAR struct lzf_stream_s *strm, bool flush)
+{
+  FAR struct lzf_header_s *hdr;
+  unsigned int inlen;
+  size_t nbytes;
+  bool done;
+
+  DEBUGASSERT(strm->ls_htab != NULL);
+
+  for (; ; )
+    {
+      /* Return the previous block first and stop at its end.  An
+       * uncompressed block is returned from ls_inbuf, so no new input may
+       * be gathered before.
+       */
+
+      done = strm->ls_outlen > 0;
+      if (!lzf_stream_drain(strm) || done)
+        {
+          return OK;
+        }
+
+      /* Gather the input of the next block.  Room for the header of an
+       * uncompressed block is left in front of it.
+       */
+
+      nbytes = MIN(strm->avail_in,
+                   (size_t)(LZF_STREAM_BLKSIZE - strm->ls_inlen));
+      memcpy(&strm->ls_inbuf[LZF_TYPE0_HDR_SIZE + strm->ls_inlen],
+             strm->next_in, nbytes);
+
+      strm->next_in  += nbytes;
+      strm->avail_in -= nbytes;
+      strm->ls_inlen += nbytes;
+
+      if (strm->ls_inlen < LZF_STREAM_BLKSIZE &&
+          (!flush || strm->ls_inlen == 0))
+        {
+          return OK;
+        }
+
+      /* Compress the block, keeping it uncompressed unless that saves
+       * space.  The hash table is reused without clearing it:  Stale
+       * entries are verified against the data before they are used.
+       */
+
+      inlen = strm->ls_inlen;
+      nbytes = lzf_compress(&strm->ls_inbuf[LZF_TYPE0_HDR_SIZE], inlen,
+                            &strm->ls_outbuf[LZF_TYPE1_HDR_SIZE],
+                            inlen > 2 ? inlen - 2 : 0,
+                            strm->ls_htab, &hdr);
+
+      strm->ls_out    = (FAR const uint8_t *)hdr;
+      strm->ls_outlen = nbytes;
+      strm->ls_inlen  = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: lzf_stream_decompress
+ *
+ * Description:
+ *   Decompress as much data from next_in as possible into next_out.  The
+ *   input may be split anywhere, even within a block header.  Call again
+ *   while avail_out is zero on return to get the rest of the output.
+ *
+ *   Zero (OK) is returned on success.  Otherwise ERROR is returned and
+ *   errno is set to EINVAL if the stream is corrupted or to E2BIG if a
+ *   block is larger than LZF_STREAM_BLKSIZE.
+ *
+ ****************************************************************************/
+
+int lzf_stream_decompress(FAR struct lzf_stream_s *strm)
+{
+  FAR const uint8_t *src;
+  unsigned int clen;
+  unsigned int ulen;
+  unsigned int decomplen;
+  size_t nbytes;
+  int ret;
+
+  for (; ; )
+    {
+      /* Return the output of the previous block first */
+
+      if (!lzf_stream_drain(strm))
+        {
+          return OK;
+        }
+
+      ret = lzf_stream_header(strm, &clen, &ulen);
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            {
+              set_errno(-ret);
+              return ERROR;
+            }
+
+          return OK;
+        }
+
+      if (ulen > LZF_STREAM_BLKSIZE || clen > sizeof(strm->ls_inbuf))
+        {
+          set_errno(E2BIG);
+          return ERROR;
+        }
+
+      if (strm->ls_hdr[2] == LZF_TYPE1_HDR && (clen == 0 || ulen == 0))
+        {
+          set_errno(EINVAL);
+          return ERROR;
+        }
+
+      /* If the whole block is available in the input and its data fits in
+       * the output, then decompress it directly.
+       */
+
+      if (strm->ls_inlen == 0 && strm->avail_in >= clen &&
+          strm->avail_out >= ulen)
+        {
+          if (strm->ls_hdr[2] == LZF_TYPE0_HDR)
+            {
+              memcpy(strm->next_out, strm->next_in, ulen);
+              decomplen = ulen;
+            }
+          else
+            {
+              decomplen = lzf_decompress(strm->next_in, clen,
+                                         strm->next_out, ulen);
+            }
+
+          if (decomplen != ulen)
+            {
+              set_errno(EINVAL);
+              return ERROR;
+            }
+
+          strm->next_in   += clen;
+          strm->avail_in  -= clen;
+          strm->next_out  += ulen;
+          strm->avail_out -= ulen;
+          strm->ls_hdrlen  = 0;
+          continue;
+        }
+
+      /* Otherwise gather the block data in ls_inbuf */
+
+      nbytes = MIN(strm->avail_in, (size_t)(clen - strm->ls_inlen));
+      memcpy(&strm->ls_inbuf[strm->ls_inlen], strm->next_in, nbytes);
+
+      strm->next_in  += nbytes;
+      strm->avail_in -= nbytes;
+      strm->ls_inlen += nbytes;
+
+      if (strm->ls_inlen < clen)
+        {
+          return OK;
+        }
+
+      if (strm->ls_hdr[2] == LZF_TYPE0_HDR)
+        {
+          src = strm->ls_inbuf;
+        }
+      else
+        {
+          decomplen = lzf_decompress(strm->ls_inbuf, clen,
+                                     strm->ls_outbuf, ulen);
+          if (decomplen != ulen)
+            {
+              set_errno(EINVAL);
+              return ERROR;
+            }
+
+          src = strm->ls_outbuf;
+        }
+
+      /* The block data will be returned from the stream state */
+
+      strm->ls_out    = src;
+      strm->ls_outlen = ulen;
+      strm->ls_inlen  = 0;
+      strm->ls_hdrlen = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: lzf_stream_pending
+ *
+ * Description:
+ *   Return true if a partial block or output that was not yet returned is
+ *   held in the stream state.  At the end of the input, this indicates a
+ *   truncated stream after lzf_stream_decompress() or a missing flush
+ *   after lzf_stream_compress().
+ *
+ ****************************************************************************/
+
+bool lzf_stream_pending(FAR const struct lzf_stream_s *strm)
+{
+  return strm->ls_outpos < strm->ls_outlen || strm->ls_inlen > 0 ||
+         strm->ls_hdrlen > 0;
+}
+
+#endif /* CONFIG_LIBC_LZF_STREAM */
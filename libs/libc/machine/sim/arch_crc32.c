@@ -0,0 +1,244 @@
+/****************************************************************************
+ * libs/libc/machine/sim/arch_crc32.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The folding algorithm and constants are from "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction", V. Gopal et al., Intel,
+ * 2009.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <crc32.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PCLMUL_TARGET  __attribute__((target("sse2,pclmul")))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Use the compiler's generic vector types so that no host intrinsics
+ * header is needed.
+ */
+
+typedef long long v2di_t __attribute__((vector_size(16)));
+typedef int v4si_t __attribute__((vector_size(16)));
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Folding constants for the bit-reflected polynomial 0x104c11db7:
+ * x^(4*128+32) mod P, x^(4*128-32) mod P, x^(128+32) mod P,
+ * x^(128-32) mod P, x^64 mod P, and the Barrett constants.
+ */
+
+static const v2di_t g_k1k2 =
+{
+  0x0154442bd4, 0x01c6e41596
+};
+
+static const v2di_t g_k3k4 =
+{
+  0x01751997d0, 0x00ccaa009e
+};
+
+static const v2di_t g_k5k0 =
+{
+  0x0163cd6124, 0x0000000000
+};
+
+static const v2di_t g_poly =
+{
+  0x01db710641, 0x01f7011641
+};
+
+static const v2di_t g_mask32 =
+{
+  0x00000000ffffffff, 0x00000000ffffffff
+};
+
+/* CRC of a nibble, for the tail that does not fill a 128-bit block */
+
+static const uint32_t g_crc32_nibble[16] =
+{
+  0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+  0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+  0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+  0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t crc32_bytes(FAR const uint8_t *src, size_t len,
+                            uint32_t crc)
+{
+  while (len-- > 0)
+    {
+      crc ^= *src++;
+      crc  = (crc >> 4) ^ g_crc32_nibble[crc & 0xf];
+      crc  = (crc >> 4) ^ g_crc32_nibble[crc & 0xf];
+    }
+
+  return crc;
+}
+
+static inline v2di_t PCLMUL_TARGET loadu(FAR const uint8_t *src)
+{
+  v2di_t v;
+
+  __builtin_memcpy(&v, src, sizeof(v));
+  return v;
+}
+
+static inline v2di_t PCLMUL_TARGET mkv2di(long long lo, long long hi)
+{
+  v2di_t v;
+
+  v[0] = lo;
+  v[1] = hi;
+  return v;
+}
+
+static inline v2di_t PCLMUL_TARGET clmul(v2di_t a, v2di_t b, const int imm)
+{
+  return __builtin_ia32_pclmulqdq128(a, b, imm);
+}
+
+/* Fold the 128-bit remainder x forward by 128 bits and add in y */
+
+static inline v2di_t PCLMUL_TARGET fold(v2di_t x, v2di_t k, v2di_t y)
+{
+  return clmul(x, k, 0x00) ^ clmul(x, k, 0x11) ^ y;
+}
+
+/****************************************************************************
+ * Name: crc32_pclmul
+ *
+ * Description:
+ *   CRC of a buffer whose length is a multiple of 16 and at least 64.
+ *
+ ****************************************************************************/
+
+static uint32_t PCLMUL_TARGET crc32_pclmul(FAR const uint8_t *src,
+                                           size_t len, uint32_t crc)
+{
+  v2di_t x1;
+  v2di_t x2;
+  v2di_t x3;
+  v2di_t x4;
+  v4si_t w;
+
+  x1 = loadu(src + 0x00) ^ mkv2di(crc, 0);
+  x2 = loadu(src + 0x10);
+  x3 = loadu(src + 0x20);
+  x4 = loadu(src + 0x30);
+
+  src += 64;
+  len -= 64;
+
+  /* Fold 512 bits at a time */
+
+  while (len >= 64)
+    {
+      x1 = fold(x1, g_k1k2, loadu(src + 0x00));
+      x2 = fold(x2, g_k1k2, loadu(src + 0x10));
+      x3 = fold(x3, g_k1k2, loadu(src + 0x20));
+      x4 = fold(x4, g_k1k2, loadu(src + 0x30));
+
+      src += 64;
+      len -= 64;
+    }
+
+  /* Fold the four accumulators into one, then 128 bits at a time */
+
+  x1 = fold(x1, g_k3k4, x2);
+  x1 = fold(x1, g_k3k4, x3);
+  x1 = fold(x1, g_k3k4, x4);
+
+  while (len >= 16)
+    {
+      x1 = fold(x1, g_k3k4, loadu(src));
+
+      src += 16;
+      len -= 16;
+    }
+
+  /* Fold 128 bits to 64 bits */
+
+  x2 = clmul(x1, g_k3k4, 0x10);
+  x1 = mkv2di(x1[1], 0) ^ x2;
+
+  w    = (v4si_t)x1;
+  w[0] = w[1];
+  w[1] = w[2];
+  w[2] = w[3];
+  w[3] = 0;
+  x2   = (v2di_t)w;
+
+  x1 = clmul(x1 & g_mask32, g_k5k0, 0x00) ^ x2;
+
+  /* Barrett reduction to 32 bits */
+
+  x2 = clmul(x1 & g_mask32, g_poly, 0x10);
+  x2 = clmul(x2 & g_mask32, g_poly, 0x00);
+  x1 = x1 ^ x2;
+
+  w = (v4si_t)x1;
+  return (uint32_t)w[1];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: crc32part
+ *
+ * Description:
+ *   Continue CRC calculation on a part of the buffer.
+ *
+ ****************************************************************************/
+
+uint32_t crc32part(FAR const uint8_t *src, size_t len, uint32_t crc32val)
+{
+  size_t n;
+
+  if (len >= 64)
+    {
+      n        = len & ~(size_t)15;
+      crc32val = crc32_pclmul(src, n, crc32val);
+      src     += n;
+      len     -= n;
+    }
+
+  return crc32_bytes(src, len, crc32val);
+}
@@ -76,6 +76,14 @@
 #  define CONFIG_NETDB_DNSCLIENT_LIFESEC 3600
 #endif
 
+#ifndef CONFIG_NETDB_DNSCLIENT_NEGLIFESEC
+#  define CONFIG_NETDB_DNSCLIENT_NEGLIFESEC 0
+#endif
+
+#ifndef CONFIG_NETDB_DNSCLIENT_PARALLEL
+#  define CONFIG_NETDB_DNSCLIENT_PARALLEL 2
+#endif
+
 #ifndef CONFIG_NETDB_RESOLVCONF_PATH
 #  define CONFIG_NETDB_RESOLVCONF_PATH "/etc/resolv.conf"
 #endif
@@ -212,7 +220,9 @@ int dns_query(int sd, FAR const char *hostname, FAR union dns_addr_u *addr,
  * Input Parameters:
  *   hostname - The hostname string to be cached.
  *   addr     - The IP addresses associated with the hostname.
- *   naddr    - The count of the IP addresses.
+ *   naddr    - The count of the IP addresses.  Zero records that the
+ *     hostname has no address.
+ *   ttl      - The time to live of the answer in seconds.
  *
  * Returned Value:
  *   None
@@ -221,7 +231,8 @@ int dns_query(int sd, FAR const char *hostname, FAR union dns_addr_u *addr,
 
 #if CONFIG_NETDB_DNSCLIENT_ENTRIES > 0
 void dns_save_answer(FAR const char *hostname,
-                     FAR const union dns_addr_u *addr, int naddr);
+                     FAR const union dns_addr_u *addr, int naddr,
+                     uint32_t ttl);
 #endif
 
 /****************************************************************************
@@ -256,8 +267,9 @@ void dns_clear_answer(void);
  * Returned Value:
  *   If the host name was successfully found in the DNS name resolution
  *   cache, zero (OK) will be returned.  Otherwise, some negated errno
- *   value will be returned, typically -ENOENT meaning that the hostname
- *   was not found in the cache.
+ *   value will be returned:  -ENOENT meaning that the hostname was not
+ *   found in the cache, or -EADDRNOTAVAIL if the cache remembers that the
+ *   hostname has no address.
  *
  ****************************************************************************/
 
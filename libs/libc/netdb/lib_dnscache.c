@@ -47,11 +47,19 @@
 #  define DNS_CLOCK CLOCK_REALTIME
 #endif
 
+/* Hash chain links hold the entry index plus one, so that zero ends a
+ * chain and the statically zeroed table starts out empty.
+ */
+
+#define DNS_NOENTRY 0
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
-/* This described one entry in the cache of resolved hostnames.
+/* This described one entry in the cache of resolved hostnames.  An entry
+ * with no addresses records that the name has no address (a negative
+ * answer).
  *
  * REVISIT: this consumes extra space, especially when multiple
  * addresses per name are stored.
@@ -59,11 +67,11 @@
 
 struct dns_cache_s
 {
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
-  time_t            ctime;      /* Creation time */
-#endif
-  char              name[CONFIG_NETDB_DNSCLIENT_NAMESIZE];
+  time_t            expire;     /* Time when the entry expires */
+  uint32_t          hash;       /* Hash of the name */
+  uint8_t           hnext;      /* Next entry in the hash chain */
   uint8_t           naddr;      /* How many addresses per name */
+  char              name[CONFIG_NETDB_DNSCLIENT_NAMESIZE];
   union dns_addr_u  addr[CONFIG_NETDB_MAX_IPADDR];
 };
 
@@ -74,14 +82,100 @@ struct dns_cache_s
 static uint8_t g_dns_head;        /* Head of the circular, DNS resolver cache */
 static uint8_t g_dns_tail;        /* Tail of the circular, DNS resolver cache */
 
-/* This is the DNS resolver cache */
+/* This is the DNS resolver cache.  The circular buffer gives the order in
+ * which entries are replaced, the hash chains are used to find them.
+ */
 
 static struct dns_cache_s g_dns_cache[CONFIG_NETDB_DNSCLIENT_ENTRIES];
+static uint8_t g_dns_hash[CONFIG_NETDB_DNSCLIENT_ENTRIES];
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: dns_hash_name
+ *
+ * Description:
+ *   FNV-1a hash of the part of the name that is kept in the cache.
+ *
+ ****************************************************************************/
+
+static uint32_t dns_hash_name(FAR const char *hostname)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < CONFIG_NETDB_DNSCLIENT_NAMESIZE && hostname[i]; i++)
+    {
+      hash ^= (uint8_t)hostname[i];
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: dns_lookup_name
+ *
+ * Description:
+ *   Return the address of the hash chain link that refers to the entry for
+ *   hostname, or to DNS_NOENTRY at the end of the chain if there is none.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *dns_lookup_name(FAR const char *hostname, uint32_t hash)
+{
+  FAR struct dns_cache_s *entry;
+  FAR uint8_t *link;
+
+  for (link = &g_dns_hash[hash % CONFIG_NETDB_DNSCLIENT_ENTRIES];
+       *link != DNS_NOENTRY;
+       link = &entry->hnext)
+    {
+      entry = &g_dns_cache[*link - 1];
+
+      /* Because the names are truncated to CONFIG_NETDB_DNSCLIENT_NAMESIZE,
+       * this has the possibility of aliasing two names and returning the
+       * wrong entry from the cache.
+       */
+
+      if (entry->hash == hash &&
+          strncmp(hostname, entry->name,
+                  CONFIG_NETDB_DNSCLIENT_NAMESIZE) == 0)
+        {
+          break;
+        }
+    }
+
+  return link;
+}
+
+/****************************************************************************
+ * Name: dns_unlink_entry
+ *
+ * Description:
+ *   Remove the entry at ndx from its hash chain, if it is still there.
+ *
+ ****************************************************************************/
+
+static void dns_unlink_entry(int ndx)
+{
+  FAR struct dns_cache_s *entry = &g_dns_cache[ndx];
+  FAR uint8_t *link;
+
+  for (link = &g_dns_hash[entry->hash % CONFIG_NETDB_DNSCLIENT_ENTRIES];
+       *link != DNS_NOENTRY;
+       link = &g_dns_cache[*link - 1].hnext)
+    {
+      if (*link == ndx + 1)
+        {
+          *link = entry->hnext;
+          break;
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -95,7 +189,9 @@ static struct dns_cache_s g_dns_cache[CONFIG_NETDB_DNSCLIENT_ENTRIES];
  * Input Parameters:
  *   hostname - The hostname string to be cached.
  *   addr     - The IP addresses associated with the hostname.
- *   naddr    - The count of the IP addresses.
+ *   naddr    - The count of the IP addresses.  Zero records that the
+ *     hostname has no address.
+ *   ttl      - The time to live of the answer in seconds.
  *
  * Returned Value:
  *   None
@@ -103,22 +199,62 @@ static struct dns_cache_s g_dns_cache[CONFIG_NETDB_DNSCLIENT_ENTRIES];
  ****************************************************************************/
 
 void dns_save_answer(FAR const char *hostname,
-                     FAR const union dns_addr_u *addr, int naddr)
+                     FAR const union dns_addr_u *addr, int naddr,
+                     uint32_t ttl)
 {
   FAR struct dns_cache_s *entry;
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
+  FAR uint8_t *link;
   struct timespec now;
-#endif
+  uint32_t hash;
   int next;
   int ndx;
 
   naddr = MIN(naddr, CONFIG_NETDB_MAX_IPADDR);
-  DEBUGASSERT(naddr >= 1 && naddr <= UCHAR_MAX);
+  DEBUGASSERT(naddr >= 0 && naddr <= UCHAR_MAX);
+
+  /* Limit the life of the entry */
+
+  if (naddr == 0)
+    {
+      ttl = CONFIG_NETDB_DNSCLIENT_NEGLIFESEC;
+    }
+#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
+  else if (ttl > CONFIG_NETDB_DNSCLIENT_LIFESEC)
+    {
+      ttl = CONFIG_NETDB_DNSCLIENT_LIFESEC;
+    }
+#endif
+
+  if (ttl == 0)
+    {
+      /* The answer must not be cached */
+
+      return;
+    }
+
+  /* Get the current time, using CLOCK_MONOTONIC if possible */
+
+  if (clock_gettime(DNS_CLOCK, &now) < 0)
+    {
+      return;
+    }
+
+  hash = dns_hash_name(hostname);
 
   /* Get exclusive access to the DNS cache */
 
   dns_semtake();
 
+  /* Drop any older answer for the same name.  Its slot in the circular
+   * buffer is reclaimed in turn.
+   */
+
+  link = dns_lookup_name(hostname, hash);
+  if (*link != DNS_NOENTRY)
+    {
+      *link = g_dns_cache[*link - 1].hnext;
+    }
+
   /* Get the index to the new head of the list */
 
   ndx  = g_dns_head;
@@ -140,24 +276,26 @@ void dns_save_answer(FAR const char *hostname,
           tmp = 0;
         }
 
+      dns_unlink_entry(g_dns_tail);
       g_dns_tail = tmp;
     }
 
   /* Save the answer in the cache */
 
-  entry = &g_dns_cache[ndx];
-
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
-  /* Get the current time, using CLOCK_MONOTONIC if possible */
-
-  clock_gettime(DNS_CLOCK, &now);
-  entry->ctime = (time_t)now.tv_sec;
-#endif
+  entry         = &g_dns_cache[ndx];
+  entry->expire = now.tv_sec + ttl;
+  entry->hash   = hash;
 
   strncpy(entry->name, hostname, CONFIG_NETDB_DNSCLIENT_NAMESIZE);
   memcpy(&entry->addr, addr, naddr * sizeof(*addr));
   entry->naddr = naddr;
 
+  /* Put it at the front of its hash chain */
+
+  link          = &g_dns_hash[hash % CONFIG_NETDB_DNSCLIENT_ENTRIES];
+  entry->hnext  = *link;
+  *link         = ndx + 1;
+
   /* Save the updated head index */
 
   g_dns_head = next;
@@ -181,10 +319,11 @@ void dns_clear_answer(void)
 
   dns_semtake();
 
-  /* Reset the circular of DNS cache */
+  /* Reset the circular of DNS cache and the hash chains */
 
   g_dns_head = 0;
   g_dns_tail = 0;
+  memset(g_dns_hash, 0, sizeof(g_dns_hash));
 
   dns_semgive();
 }
@@ -206,8 +345,9 @@ void dns_clear_answer(void)
  * Returned Value:
  *   If the host name was successfully found in the DNS name resolution
  *   cache, zero (OK) will be returned.  Otherwise, some negated errno
- *   value will be returned, typically -ENOENT meaning that the hostname
- *   was not found in the cache.
+ *   value will be returned:  -ENOENT meaning that the hostname was not
+ *   found in the cache, or -EADDRNOTAVAIL if the cache remembers that the
+ *   hostname has no address.
  *
  ****************************************************************************/
 
@@ -215,85 +355,61 @@ int dns_find_answer(FAR const char *hostname, FAR union dns_addr_u *addr,
                     FAR int *naddr)
 {
   FAR struct dns_cache_s *entry;
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
+  FAR uint8_t *link;
   struct timespec now;
-  uint32_t elapsed;
   int ret;
-#endif
-  int next;
-  int ndx;
-
-  /* Get exclusive access to the DNS cache */
-
-  dns_semtake();
 
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
   /* Get the current time, using CLOCK_MONOTONIC if possible */
 
   ret = clock_gettime(DNS_CLOCK, &now);
-#endif
-
-  for (ndx = g_dns_tail; ndx != g_dns_head; ndx = next)
+  if (ret < 0)
     {
-      entry = &g_dns_cache[ndx];
+      return -ENOENT;
+    }
 
-      /* Advance the index for the next time through the loop, handling
-       * wrapping to the beginning of the circular buffer.
-       */
+  /* Get exclusive access to the DNS cache */
 
-      next = ndx + 1;
-      if (next >= CONFIG_NETDB_DNSCLIENT_ENTRIES)
-        {
-          next = 0;
-        }
+  dns_semtake();
 
-#if CONFIG_NETDB_DNSCLIENT_LIFESEC > 0
-      /* Check if this entry has expired
-       * REVISIT: Does not this calculation assume that the sizeof(time_t)
-       * is equal to the sizeof(uint32_t)?
-       */
+  link = dns_lookup_name(hostname, dns_hash_name(hostname));
+  if (*link == DNS_NOENTRY)
+    {
+      ret = -ENOENT;
+    }
+  else
+    {
+      entry = &g_dns_cache[*link - 1];
+
+      /* Check if this entry has expired */
 
-      elapsed = (uint32_t)now.tv_sec - (uint32_t)entry->ctime;
-      if (ret >= 0 && elapsed > CONFIG_NETDB_DNSCLIENT_LIFESEC)
+      if (now.tv_sec - entry->expire >= 0)
         {
-          /* This entry has expired.  Increment the tail index to exclude
-           * this entry on future traversals.
+          /* Remove it from its hash chain to exclude it on future
+           * searches.
            */
 
-          g_dns_tail = next;
+          *link = entry->hnext;
+          ret   = -ENOENT;
+        }
+      else if (entry->naddr == 0)
+        {
+          ret = -EADDRNOTAVAIL;
         }
       else
-#endif
         {
-          /* The entry has not expired, check for a name match. Because
-           * the names are truncated to CONFIG_NETDB_DNSCLIENT_NAMESIZE,
-           * this has the possibility of aliasing two names and returning
-           * the wrong entry from the cache.
+          /* We have a match.  Make sure that the address will fit in the
+           * caller-provided buffer.
            */
 
-          if (strncmp(hostname, entry->name,
-                      CONFIG_NETDB_DNSCLIENT_NAMESIZE) == 0)
-            {
-              /* We have a match.  Return the resolved host address */
-
-              /* Make sure that the address will fit in the caller-provided
-               * buffer.
-               */
+          *naddr = MIN(*naddr, entry->naddr);
 
-              *naddr = MIN(*naddr, entry->naddr);
+          /* Return the address information */
 
-              /* Return the address information */
-
-              memcpy(addr, &entry->addr, *naddr * sizeof(*addr));
-
-              dns_semgive();
-              return OK;
-            }
+          memcpy(addr, &entry->addr, *naddr * sizeof(*addr));
+          ret = OK;
         }
     }
 
-  ret = -ENOENT;
-
   dns_semgive();
   return ret;
 }
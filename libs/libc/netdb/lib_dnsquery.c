@@ -48,6 +48,7 @@
 
 #include <nuttx/config.h>
 
+#include <inttypes.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
@@ -79,6 +80,14 @@
 #define SEND_BUFFER_SIZE (16 + CONFIG_NETDB_DNSCLIENT_NAMESIZE + 2)
 #define RECV_BUFFER_SIZE CONFIG_NETDB_DNSCLIENT_MAXRESPONSE
 
+/* The address record types that are queried */
+
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
+#  define DNS_NRECTYPES 2
+#else
+#  define DNS_NRECTYPES 1
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -90,9 +99,11 @@ struct dns_query_s
   FAR const char *hostname;       /* Hostname to lookup */
   FAR union dns_addr_u *addr;     /* Location to return host address */
   FAR int *naddr;                 /* Number of returned addresses */
+  int nservers;                   /* Number of name servers in servers[] */
+  union dns_addr_u servers[CONFIG_NETDB_DNSCLIENT_PARALLEL];
 };
 
-/* Query info to check response against. */
+/* Query info to check response against, and the answer to the query. */
 
 struct dns_query_info_s
 {
@@ -101,6 +112,11 @@ struct dns_query_info_s
   uint16_t qnamelen;                               /* Queried hostname length */
   char qname[CONFIG_NETDB_DNSCLIENT_NAMESIZE + 2]; /* Queried hostname in
                                                     * encoded format + NUL */
+  int result;                                      /* Zero while waiting, then
+                                                    * number of addresses or
+                                                    * negated errno */
+  uint32_t ttl;                                    /* Lowest TTL of answers */
+  union dns_addr_u addr[CONFIG_NETDB_MAX_IPADDR];  /* Addresses returned */
 };
 
 /****************************************************************************
@@ -189,37 +205,34 @@ static inline uint16_t dns_alloc_id(void)
  * Name: dns_send_query
  *
  * Description:
- *   Runs through the list of names to see if there are any that have
- *   not yet been queried and, if so, sends out a query.
+ *   Send a query for the 'rectype' record of the hostname to each of the
+ *   name servers of the query.
  *
  ****************************************************************************/
 
-static int dns_send_query(int sd, FAR const char *name,
-                          FAR union dns_addr_u *uaddr, uint16_t rectype,
+static int dns_send_query(FAR struct dns_query_s *query, uint16_t rectype,
                           FAR struct dns_query_info_s *qinfo)
 {
   FAR struct dns_header_s *hdr;
+  FAR union dns_addr_u *uaddr;
   FAR uint8_t *dest;
   FAR uint8_t *nptr;
   FAR char *qname;
   FAR char *qptr;
   FAR const char *src;
   uint8_t buffer[SEND_BUFFER_SIZE];
-  uint16_t id;
   socklen_t addrlen;
-  int ret;
+  int ret = -EADDRNOTAVAIL;
+  int sent = 0;
   int len;
   int n;
-
-  /* Get a new ID for query */
-
-  id = dns_alloc_id();
+  int i;
 
   /* Initialize the request header */
 
   hdr               = (FAR struct dns_header_s *)buffer;
   memset(hdr, 0, sizeof(*hdr));
-  hdr->id           = htons(id);
+  hdr->id           = htons(qinfo->id);
   hdr->flags1       = DNS_FLAG1_RD;
   hdr->numquestions = HTONS(1);
 
@@ -230,7 +243,7 @@ static int dns_send_query(int sd, FAR const char *name,
    * (other pre-pended name lengths replace dots).
    */
 
-  src   = name - 1;
+  src   = query->hostname - 1;
   dest  = buffer + sizeof(*hdr);
   qname = qinfo->qname;
   len   = 0;
@@ -282,89 +295,71 @@ static int dns_send_query(int sd, FAR const char *name,
   qinfo->rectype = htons(rectype);
   qinfo->id      = hdr->id;
 
-  /* Send the request */
-
-  if (uaddr->addr.sa_family == AF_INET)
-    {
-      addrlen = sizeof(struct sockaddr_in);
-    }
-  else
-    {
-      addrlen = sizeof(struct sockaddr_in6);
-    }
+  /* Send the request to every name server.  The one socket is not
+   * connected, so that it can talk to all of them at once.
+   */
 
-  ret = connect(sd, &uaddr->addr, addrlen);
-  if (ret < 0)
+  for (i = 0; i < query->nservers; i++)
     {
-      ret = -get_errno();
-      nerr("ERROR: connect failed: %d\n", ret);
-      return ret;
-    }
+      uaddr = &query->servers[i];
+      if (uaddr->addr.sa_family == AF_INET)
+        {
+          addrlen = sizeof(struct sockaddr_in);
+        }
+      else
+        {
+          addrlen = sizeof(struct sockaddr_in6);
+        }
 
-  ret = send(sd, buffer, dest - buffer, 0);
-  if (ret < 0)
-    {
-      ret = -get_errno();
-      nerr("ERROR: sendto failed: %d\n", ret);
-      return ret;
+      ret = sendto(query->sd, buffer, dest - buffer, 0, &uaddr->addr,
+                   addrlen);
+      if (ret < 0)
+        {
+          ret = -get_errno();
+          nerr("ERROR: sendto failed: %d\n", ret);
+        }
+      else
+        {
+          sent++;
+        }
     }
 
-  return OK;
+  return sent > 0 ? OK : ret;
 }
 
 /****************************************************************************
- * Name: dns_recv_response
+ * Name: dns_parse_response
  *
  * Description:
- *   Called when new UDP data arrives
+ *   Parse a response to the query described by qinfo and save the
+ *   addresses in it.
  *
  * Returned Value:
  *   Returns number of valid IP address responses.  Negated errno value is
- *   returned in all other cases.
+ *   returned in all other cases:  -EADDRNOTAVAIL means that the name
+ *   server answered that the name has no such address.
  *
  ****************************************************************************/
 
-static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
-                             FAR struct dns_query_info_s *qinfo)
+static int dns_parse_response(FAR uint8_t *buffer, int buflen,
+                              FAR struct dns_query_info_s *qinfo)
 {
   FAR uint8_t *nameptr;
   FAR uint8_t *namestart;
   FAR uint8_t *endofbuffer;
-  char buffer[RECV_BUFFER_SIZE];
   FAR struct dns_answer_s *ans;
   FAR struct dns_header_s *hdr;
   FAR struct dns_question_s *que;
+  FAR union dns_addr_u *addr = qinfo->addr;
   uint16_t nquestions;
   uint16_t nanswers;
   uint16_t temp;
+  uint32_t ttl;
   int naddr_read;
   int ret;
 
-  if (naddr <= 0)
-    {
-      return -ERANGE;
-    }
-
-  /* Receive the response */
-
-  ret = recv(sd, buffer, RECV_BUFFER_SIZE, 0);
-  if (ret < 0)
-    {
-      ret = -get_errno();
-      nerr("ERROR: recv failed: %d\n", ret);
-      return ret;
-    }
-
-  if (ret < sizeof(*hdr))
-    {
-      /* DNS header can't fit in received data */
-
-      nerr("ERROR: DNS response is too short\n");
-      return -EILSEQ;
-    }
-
   hdr         = (FAR struct dns_header_s *)buffer;
-  endofbuffer = (FAR uint8_t *)buffer + ret;
+  endofbuffer = buffer + buflen;
 
   ninfo("ID %d\n", ntohs(hdr->id));
   ninfo("Query %d\n", hdr->flags1 & DNS_FLAG1_RESPONSE);
@@ -373,21 +368,19 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
         ntohs(hdr->numquestions), ntohs(hdr->numanswers),
         ntohs(hdr->numauthrr), ntohs(hdr->numextrarr));
 
-  /* Check for error */
+  /* Check for error.  A name error is an answer:  the name does not
+   * exist.  Anything else is a failure of this name server.
+   */
 
-  if ((hdr->flags2 & DNS_FLAG2_ERR_MASK) != 0)
+  if ((hdr->flags2 & DNS_FLAG2_ERR_MASK) == DNS_FLAG2_ERR_NAME)
     {
-      nerr("ERROR: DNS reported error: flags2=%02x\n", hdr->flags2);
-      return -EPROTO;
+      ninfo("DNS name does not exist\n");
+      return -EADDRNOTAVAIL;
     }
-
-  /* Check for matching ID. */
-
-  if (hdr->id != qinfo->id)
+  else if ((hdr->flags2 & DNS_FLAG2_ERR_MASK) != 0)
     {
-      nerr("ERROR: DNS wrong response ID (expected %d, got %d)\n",
-           ntohs(qinfo->id), ntohs(hdr->id));
-      return -EBADMSG;
+      nerr("ERROR: DNS reported error: flags2=%02x\n", hdr->flags2);
+      return -EPROTO;
     }
 
   /* We only care about the question(s) and the answers. The authrr
@@ -409,7 +402,7 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
    * matches against the name in the question.
    */
 
-  namestart = (uint8_t *)buffer + sizeof(*hdr);
+  namestart = buffer + sizeof(*hdr);
   nameptr   = dns_parse_name(namestart, endofbuffer);
   if (nameptr == endofbuffer)
     {
@@ -454,6 +447,7 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
 
   ret = OK;
   naddr_read = 0;
+  qinfo->ttl = UINT32_MAX;
 
   for (; nanswers > 0; nanswers--)
     {
@@ -468,11 +462,11 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
         }
 
       ans = (FAR struct dns_answer_s *)nameptr;
+      ttl = ((uint32_t)ntohs(ans->ttl[0]) << 16) | ntohs(ans->ttl[1]);
 
-      ninfo("Answer: type=%04x, class=%04x, ttl=%06x, length=%04x \n",
-            ntohs(ans->type), ntohs(ans->class),
-            (ntohs(ans->ttl[0]) << 16) | ntohs(ans->ttl[1]),
-            ntohs(ans->len));
+      ninfo("Answer: type=%04x, class=%04x, ttl=%06" PRIx32
+            ", length=%04x \n",
+            ntohs(ans->type), ntohs(ans->class), ttl, ntohs(ans->len));
 
       /* Check for IPv4/6 address type and Internet class. Others are
        * discarded.
@@ -499,9 +493,9 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
           inaddr->sin_port        = 0;
           inaddr->sin_addr.s_addr = ans->u.ipv4.s_addr;
 
-          if (++naddr_read >= naddr)
+          qinfo->ttl = MIN(qinfo->ttl, ttl);
+          if (++naddr_read >= CONFIG_NETDB_MAX_IPADDR)
             {
-              ret = -ERANGE;
               break;
             }
         }
@@ -532,9 +526,9 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
           inaddr->sin6_port       = 0;
           memcpy(inaddr->sin6_addr.s6_addr, ans->u.ipv6.s6_addr, 16);
 
-          if (++naddr_read >= naddr)
+          qinfo->ttl = MIN(qinfo->ttl, ttl);
+          if (++naddr_read >= CONFIG_NETDB_MAX_IPADDR)
             {
-              ret = -ERANGE;
               break;
             }
         }
@@ -554,32 +548,165 @@ static int dns_recv_response(int sd, FAR union dns_addr_u *addr, int naddr,
 }
 
 /****************************************************************************
- * Name: dns_query_callback
+ * Name: dns_recv_response
  *
  * Description:
- *   Using the DNS information and this DNS server address, look up the
- *   hostname.
+ *   Receive one response from any of the name servers of the query and
+ *   record it as the answer to the matching query in qinfo[], unless that
+ *   query already has an answer.
  *
- * Input Parameters:
- *   arg      - Query arguments
- *   addr     - DNS name server address
- *   addrlen  - Length of the DNS name server address.
+ * Returned Value:
+ *   Zero (OK) if a datagram was received, whatever it contained.  A
+ *   negated errno value is returned if the receive failed.
+ *
+ ****************************************************************************/
+
+static int dns_recv_response(FAR struct dns_query_s *query,
+                             FAR struct dns_query_info_s *qinfo, int ninfo)
+{
+  FAR struct dns_header_s *hdr;
+  FAR union dns_addr_u *server;
+  uint8_t buffer[RECV_BUFFER_SIZE];
+  union dns_addr_u from;
+  socklen_t fromlen = sizeof(from);
+  int ret;
+  int i;
+
+  /* Receive the response */
+
+  ret = recvfrom(query->sd, buffer, RECV_BUFFER_SIZE, 0, &from.addr,
+                 &fromlen);
+  if (ret < 0)
+    {
+      ret = -get_errno();
+      nerr("ERROR: recv failed: %d\n", ret);
+      return ret;
+    }
+
+  /* Only accept responses from the name servers that were asked */
+
+  for (i = 0; i < query->nservers; i++)
+    {
+      server = &query->servers[i];
+      if (server->addr.sa_family != from.addr.sa_family)
+        {
+          continue;
+        }
+
+#ifdef CONFIG_NET_IPv4
+      if (from.addr.sa_family == AF_INET &&
+          server->ipv4.sin_port == from.ipv4.sin_port &&
+          server->ipv4.sin_addr.s_addr == from.ipv4.sin_addr.s_addr)
+        {
+          break;
+        }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+      if (from.addr.sa_family == AF_INET6 &&
+          server->ipv6.sin6_port == from.ipv6.sin6_port &&
+          memcmp(&server->ipv6.sin6_addr, &from.ipv6.sin6_addr,
+                 sizeof(struct in6_addr)) == 0)
+        {
+          break;
+        }
+#endif
+    }
+
+  if (i >= query->nservers)
+    {
+      nerr("ERROR: DNS response from unknown server\n");
+      return OK;
+    }
+
+  if (ret < sizeof(*hdr))
+    {
+      /* DNS header can't fit in received data */
+
+      nerr("ERROR: DNS response is too short\n");
+      query->result = -EILSEQ;
+      return OK;
+    }
+
+  /* Find the query with the matching ID */
+
+  hdr = (FAR struct dns_header_s *)buffer;
+  for (i = 0; i < ninfo; i++)
+    {
+      if (qinfo[i].id == hdr->id)
+        {
+          break;
+        }
+    }
+
+  if (i >= ninfo)
+    {
+      nerr("ERROR: DNS wrong response ID %d\n", ntohs(hdr->id));
+      query->result = -EBADMSG;
+      return OK;
+    }
+
+  if (qinfo[i].result != 0)
+    {
+      /* Another name server was faster */
+
+      return OK;
+    }
+
+  ret = dns_parse_response(buffer, ret, &qinfo[i]);
+  if (ret > 0 || ret == -EADDRNOTAVAIL)
+    {
+      /* This is the answer, whether it has addresses or not */
+
+      qinfo[i].result = ret;
+    }
+  else
+    {
+      /* Keep waiting for the other name servers */
+
+      nerr("ERROR: DNS response failed: %d\n", ret);
+      query->result = ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dns_query_servers
+ *
+ * Description:
+ *   Send the address queries for the hostname to all of the name servers
+ *   in query->servers[] at once and take the first answer to each.
  *
  * Returned Value:
- *   Returns one (1) if the query was successful.  Zero is returned in all
- *   other cases.  The result field of the query structure is set to a
- *   negated errno value indicate the reason for the last failure (only).
+ *   Returns one (1) if there is an answer:  query->result is then zero if
+ *   addresses were found or -EADDRNOTAVAIL if the name has none.  Zero is
+ *   returned in all other cases.  The result field of the query structure
+ *   is set to a negated errno value indicate the reason for the last
+ *   failure (only).
  *
  ****************************************************************************/
 
-static int dns_query_callback(FAR void *arg, FAR struct sockaddr *addr,
-                              FAR socklen_t addrlen)
+static int dns_query_servers(FAR struct dns_query_s *query)
 {
-  FAR struct dns_query_s *query = (FAR struct dns_query_s *)arg;
-  FAR struct dns_query_info_s qinfo;
-  int next = 0;
+  static const uint16_t rectypes[DNS_NRECTYPES] =
+  {
+#ifdef CONFIG_NET_IPv6
+    DNS_RECTYPE_AAAA,
+#endif
+#ifdef CONFIG_NET_IPv4
+    DNS_RECTYPE_A,
+#endif
+  };
+
+  struct dns_query_info_s qinfo[DNS_NRECTYPES];
+  uint32_t ttl;
+  int pending;
+  int nrecv;
+  int next;
   int retries;
   int ret;
+  int i;
 
   /* Loop while receive timeout errors occur and there are remaining
    * retries.
@@ -587,76 +714,100 @@ static int dns_query_callback(FAR void *arg, FAR struct sockaddr *addr,
 
   for (retries = 0; retries < CONFIG_NETDB_DNSCLIENT_RETRIES; retries++)
     {
-#ifdef CONFIG_NET_IPv6
-      /* Send the IPv6 query */
+      /* Send the queries for all address types before waiting for any
+       * response.
+       */
 
-      ret = dns_send_query(query->sd, query->hostname,
-                          (FAR union dns_addr_u *)addr,
-                           DNS_RECTYPE_AAAA, &qinfo);
-      if (ret < 0)
+      pending = 0;
+      for (i = 0; i < DNS_NRECTYPES; i++)
         {
-          nerr("ERROR: IPv6 dns_send_query failed: %d\n", ret);
-          query->result = ret;
-        }
-      else
-        {
-          /* Obtain the IPv6 response */
-
-          ret = dns_recv_response(query->sd, &query->addr[next],
-                                  *query->naddr - next, &qinfo);
-          if (ret >= 0)
+          qinfo[i].id = dns_alloc_id() + i;
+          ret = dns_send_query(query, rectypes[i], &qinfo[i]);
+          if (ret < 0)
             {
-              next += ret;
+              nerr("ERROR: dns_send_query failed: %d\n", ret);
+              query->result   = ret;
+              qinfo[i].result = ret;
             }
           else
             {
-              nerr("ERROR: IPv6 dns_recv_response failed: %d\n", ret);
-              query->result = ret;
+              qinfo[i].result = 0;
+              pending++;
             }
         }
-#endif
 
-#ifdef CONFIG_NET_IPv4
-      /* Send the IPv4 query */
+      /* Collect the responses.  Each name server should send one per
+       * query, bound the wait in case something else is answering.
+       */
 
-      ret = dns_send_query(query->sd, query->hostname,
-                           (FAR union dns_addr_u *)addr,
-                           DNS_RECTYPE_A, &qinfo);
-      if (ret < 0)
+      for (nrecv = 0;
+           pending > 0 && nrecv < 2 * DNS_NRECTYPES * query->nservers;
+           nrecv++)
         {
-          nerr("ERROR: IPv4 dns_send_query failed: %d\n", ret);
-          query->result = ret;
-        }
-      else
-        {
-          /* Obtain the IPv4 response */
+          ret = dns_recv_response(query, qinfo, DNS_NRECTYPES);
+          if (ret < 0)
+            {
+              query->result = ret;
+              break;
+            }
 
-          ret = dns_recv_response(query->sd, &query->addr[next],
-                                  *query->naddr - next, &qinfo);
-          if (ret >= 0)
+          for (i = 0, pending = 0; i < DNS_NRECTYPES; i++)
             {
-              next += ret;
+              if (qinfo[i].result == 0)
+                {
+                  pending++;
+                }
             }
-          else
+        }
+
+      /* Gather the addresses */
+
+      for (i = 0, next = 0, ttl = UINT32_MAX; i < DNS_NRECTYPES; i++)
+        {
+          ret = MIN(qinfo[i].result, *query->naddr - next);
+          if (ret > 0)
             {
-              nerr("ERROR: IPv4 dns_recv_response failed: %d\n", ret);
-              query->result = ret;
+              memcpy(&query->addr[next], qinfo[i].addr,
+                     ret * sizeof(union dns_addr_u));
+              next += ret;
+              ttl   = MIN(ttl, qinfo[i].ttl);
             }
         }
-#endif /* CONFIG_NET_IPv4 */
 
       if (next > 0)
         {
 #if CONFIG_NETDB_DNSCLIENT_ENTRIES > 0
           /* Save the answer in the DNS cache */
 
-          dns_save_answer(query->hostname, query->addr, next);
+          dns_save_answer(query->hostname, query->addr, next, ttl);
 #endif
           /* Return 1 to indicate to (1) stop the traversal, and (2)
            * indicate that the address was found.
            */
 
           *query->naddr = next;
+          query->result = OK;
+          return 1;
+        }
+
+      for (i = 0; i < DNS_NRECTYPES; i++)
+        {
+          if (qinfo[i].result != -EADDRNOTAVAIL)
+            {
+              break;
+            }
+        }
+
+      if (i >= DNS_NRECTYPES)
+        {
+          /* The name has no address:  asking other name servers is of no
+           * use.
+           */
+
+#if CONFIG_NETDB_DNSCLIENT_ENTRIES > 0
+          dns_save_answer(query->hostname, query->addr, 0, 0);
+#endif
+          query->result = -EADDRNOTAVAIL;
           return 1;
         }
       else if (query->result != -EAGAIN)
@@ -668,6 +819,44 @@ static int dns_query_callback(FAR void *arg, FAR struct sockaddr *addr,
   return 0;
 }
 
+/****************************************************************************
+ * Name: dns_query_callback
+ *
+ * Description:
+ *   Add this DNS server address to the servers to be queried and, once
+ *   there are CONFIG_NETDB_DNSCLIENT_PARALLEL of them, look up the
+ *   hostname.
+ *
+ * Input Parameters:
+ *   arg      - Query arguments
+ *   addr     - DNS name server address
+ *   addrlen  - Length of the DNS name server address.
+ *
+ * Returned Value:
+ *   Returns one (1) if the query has an answer.  Zero is returned in all
+ *   other cases.  The result field of the query structure is set to a
+ *   negated errno value indicate the reason for the last failure (only).
+ *
+ ****************************************************************************/
+
+static int dns_query_callback(FAR void *arg, FAR struct sockaddr *addr,
+                              FAR socklen_t addrlen)
+{
+  FAR struct dns_query_s *query = (FAR struct dns_query_s *)arg;
+  int ret = 0;
+
+  memcpy(&query->servers[query->nservers++], addr,
+         MIN(addrlen, sizeof(union dns_addr_u)));
+
+  if (query->nservers >= CONFIG_NETDB_DNSCLIENT_PARALLEL)
+    {
+      ret = dns_query_servers(query);
+      query->nservers = 0;
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -706,6 +895,7 @@ int dns_query(int sd, FAR const char *hostname, FAR union dns_addr_u *addr,
   query.hostname = hostname;
   query.addr     = addr;
   query.naddr    = naddr;
+  query.nservers = 0;
 
   /* Perform the query. dns_foreach_nameserver() will return:
    *
@@ -715,14 +905,17 @@ int dns_query(int sd, FAR const char *hostname, FAR union dns_addr_u *addr,
    */
 
   ret = dns_foreach_nameserver(dns_query_callback, &query);
-  if (ret > 0)
+  if (ret == 0 && query.nservers > 0)
     {
-      /* The lookup was successful */
+      /* Query the last few name servers */
 
-      ret = OK;
+      ret = dns_query_servers(&query);
     }
-  else if (ret == 0)
+
+  if (ret >= 0)
     {
+      /* The result of the lookup, OK if it was successful */
+
       ret = query.result;
     }
 
@@ -60,6 +60,12 @@ int sem_getprotocol(FAR sem_t *sem, FAR int *protocol)
     {
       *protocol = SEM_PRIO_NONE;
     }
+#ifdef CONFIG_PRIORITY_PROTECT
+  else if ((sem->flags & PRIOINHERIT_FLAGS_PROTECT) != 0)
+    {
+      *protocol = SEM_PRIO_PROTECT;
+    }
+#endif
   else
     {
       *protocol = SEM_PRIO_INHERIT;
@@ -75,6 +75,9 @@ int nxsem_init(FAR sem_t *sem, int pshared, unsigned int value)
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
       sem->flags            = 0;
+#  ifdef CONFIG_PRIORITY_PROTECT
+      sem->ceiling          = 0;
+#  endif
 #  if CONFIG_SEM_PREALLOCHOLDERS > 0
       sem->hhead            = NULL;
 #  else
@@ -38,6 +38,7 @@
  ****************************************************************************/
 
 #include <math.h>
+#include <stdbool.h>
 
 #include "lib_dtoa_engine.h"
 
@@ -59,6 +60,303 @@
 #define MAX(a, b)     ((a) > (b) ? (a) : (b))
 #define MIN(a, b)     ((a) < (b) ? (a) : (b))
 
+/* Grisu operates on 64-bit "do-it-yourself" floating point numbers f * 2^e.
+ * The cached power of ten is chosen so that the scaled value has its
+ * binary exponent in this range.
+ */
+
+#define DIYFP_MIN_TARGET_EXP  (-60)
+#define DIYFP_MAX_TARGET_EXP  (-32)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#if DBL_MANT_DIG == 53
+/****************************************************************************
+ * Name: diyfp_mul
+ *
+ * Description:
+ *   Return the upper 64 bits of the 128-bit product x * y, rounded.
+ *
+ ****************************************************************************/
+
+static uint64_t diyfp_mul(uint64_t x, uint64_t y)
+{
+  uint64_t a   = x >> 32;
+  uint64_t b   = x & 0xffffffff;
+  uint64_t c   = y >> 32;
+  uint64_t d   = y & 0xffffffff;
+  uint64_t ac  = a * c;
+  uint64_t bc  = b * c;
+  uint64_t ad  = a * d;
+  uint64_t bd  = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & 0xffffffff) + (bc & 0xffffffff);
+
+  tmp += (uint64_t)1 << 31;
+  return ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+}
+
+/****************************************************************************
+ * Name: grisu_round
+ *
+ * Description:
+ *   Round the generated digits given the remainder 'rest' (in units of
+ *   ten_kappa) and the error bound 'unit'.  Returns false if the error
+ *   does not allow deciding the direction.
+ *
+ ****************************************************************************/
+
+static bool grisu_round(FAR char *digits, int ndigits, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t unit,
+                        FAR int *kappa)
+{
+  int i;
+
+  if (unit >= ten_kappa || ten_kappa - unit <= unit)
+    {
+      return false;
+    }
+
+  /* If 2 * (rest + unit) <= 10^kappa, we can safely round down */
+
+  if ((ten_kappa - rest > rest) && (ten_kappa - 2 * rest >= 2 * unit))
+    {
+      return true;
+    }
+
+  /* If 2 * (rest - unit) >= 10^kappa, we can safely round up */
+
+  if ((rest > unit) && (ten_kappa - (rest - unit) <= (rest - unit)))
+    {
+      digits[ndigits - 1]++;
+      for (i = ndigits - 1; i > 0; i--)
+        {
+          if (digits[i] != '0' + 10)
+            {
+              break;
+            }
+
+          digits[i] = '0';
+          digits[i - 1]++;
+        }
+
+      /* A carry out of the first digit adds a decimal position */
+
+      if (digits[0] == '0' + 10)
+        {
+          digits[0] = '1';
+          (*kappa)++;
+        }
+
+      return true;
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: grisu_digits
+ *
+ * Description:
+ *   Grisu "counted" digit generation (Florian Loitsch, "Printing
+ *   Floating-Point Numbers Quickly and Accurately with Integers", 2010):
+ *   Produce exactly 'ndigits' correctly rounded significant digits of the
+ *   positive, finite value x using only 64-bit integer arithmetic.  On
+ *   success, *exp is set to the decimal exponent of the first digit.
+ *   Fails in the rare cases where the approximation error does not allow
+ *   correct rounding.  *carry reports whether rounding carried into a new
+ *   leading digit.
+ *
+ ****************************************************************************/
+
+static bool grisu_digits(double x, FAR char *digits, int ndigits,
+                         FAR int32_t *exp, FAR bool *carry)
+{
+  static const uint32_t pow10[] =
+  {
+    0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+
+  union
+  {
+    double   d;
+    uint64_t u;
+  } v;
+
+  uint64_t wf;
+  uint64_t one;
+  uint64_t fractionals;
+  uint64_t error = 1;
+  uint32_t integrals;
+  uint32_t divisor;
+  int length = 0;
+  int kappa;
+  int digits_kappa;
+  int shift;
+  int we;
+  int mk;
+  int k;
+
+  /* Decompose and normalize x = wf * 2^we */
+
+  v.d = x;
+  wf  = v.u & 0x000fffffffffffffull;
+  we  = (int)((v.u >> 52) & 0x7ff);
+  if (we != 0)
+    {
+      wf |= 0x0010000000000000ull;
+      we -= 1075;
+    }
+  else
+    {
+      we = -1074;
+    }
+
+  while ((wf & 0x8000000000000000ull) == 0)
+    {
+      wf <<= 1;
+      we--;
+    }
+
+  /* Select the cached power c = 10^mk so that the exponent of w * c is
+   * within [DIYFP_MIN_TARGET_EXP, DIYFP_MAX_TARGET_EXP].
+   * k = ceil((DIYFP_MIN_TARGET_EXP - (we + 64) + 63) * log10(2))
+   */
+
+  k = -(((-(DIYFP_MIN_TARGET_EXP - we - 1)) * 78913) >> 18);
+  k  = (DTOA_CACHED_POWERS_OFFSET + k - 1) / DTOA_CACHED_POWERS_STEP + 1;
+  mk = k * DTOA_CACHED_POWERS_STEP - DTOA_CACHED_POWERS_OFFSET;
+
+  wf = diyfp_mul(wf, g_dtoa_cached_sig[k]);
+  we = we + g_dtoa_cached_binexp[k] + 64;
+  if (we < DIYFP_MIN_TARGET_EXP || we > DIYFP_MAX_TARGET_EXP)
+    {
+      return false;
+    }
+
+  /* Split the scaled value into integral and fractional parts.  The error
+   * of the scaled value is less than one unit in the last place.
+   */
+
+  shift       = -we;
+  one         = (uint64_t)1 << shift;
+  integrals   = (uint32_t)(wf >> shift);
+  fractionals = wf & (one - 1);
+
+  /* Find the largest power of ten not larger than integrals */
+
+  kappa = ((64 - shift + 1) * 1233 >> 12) + 1;
+  if (integrals < pow10[kappa])
+    {
+      kappa--;
+    }
+
+  divisor = pow10[kappa];
+
+  /* Generate the digits of the integral part */
+
+  while (kappa > 0)
+    {
+      digits[length++] = '0' + integrals / divisor;
+      integrals %= divisor;
+      kappa--;
+
+      if (length == ndigits)
+        {
+          break;
+        }
+
+      divisor /= 10;
+    }
+
+  if (length == ndigits)
+    {
+      digits_kappa = kappa;
+      if (!grisu_round(digits, length,
+                       ((uint64_t)integrals << shift) + fractionals,
+                       (uint64_t)divisor << shift, error, &kappa))
+        {
+          return false;
+        }
+    }
+  else
+    {
+      /* Then those of the fractional part, while they are significant */
+
+      while (length < ndigits && fractionals > error)
+        {
+          fractionals *= 10;
+          error       *= 10;
+          digits[length++] = '0' + (int)(fractionals >> shift);
+          fractionals &= one - 1;
+          kappa--;
+        }
+
+      digits_kappa = kappa;
+      if (length < ndigits ||
+          !grisu_round(digits, length, fractionals, one, error, &kappa))
+        {
+          return false;
+        }
+    }
+
+  /* The digits represent digits * 10^(kappa - mk) */
+
+  *carry = kappa != digits_kappa;
+  *exp   = kappa - mk + length - 1;
+  return true;
+}
+
+/****************************************************************************
+ * Name: grisu_engine
+ *
+ * Description:
+ *   Fast path of __dtoa_engine() for positive, finite, non-zero values.
+ *   Returns the number of digits generated or zero if the slow path must
+ *   be used.
+ *
+ ****************************************************************************/
+
+static int grisu_engine(double x, FAR struct dtoa_s *dtoa, int max_digits,
+                        int max_decimals)
+{
+  int32_t exp;
+  bool carry;
+  int ndigits;
+
+  if (!grisu_digits(x, dtoa->digits, max_digits, &exp, &carry))
+    {
+      return 0;
+    }
+
+  /* If limiting decimals, then limit the max digits to no more than the
+   * number of digits left of the decimal plus the number of digits right
+   * of the decimal.  As in the slow path, this depends on the exponent
+   * before rounding.
+   */
+
+  if (max_decimals != 0)
+    {
+      ndigits = MIN(max_digits,
+                    max_decimals + MAX(exp - (carry ? 1 : 0) + 1, 1));
+      if (ndigits <= 0 || (ndigits < max_digits &&
+          !grisu_digits(x, dtoa->digits, ndigits, &exp, &carry)))
+        {
+          return 0;
+        }
+    }
+  else
+    {
+      ndigits = max_digits;
+    }
+
+  dtoa->exp = exp;
+  return ndigits;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -90,6 +388,16 @@ int __dtoa_engine(double x, FAR struct dtoa_s *dtoa, int max_digits,
     {
       flags |= DTOA_INF;
     }
+#if DBL_MANT_DIG == 53
+  else if (max_digits > 0 &&
+           (i = grisu_engine(x, dtoa, max_digits, max_decimals)) > 0)
+    {
+      /* The fast path produced correctly rounded digits */
+
+      max_digits = i;
+      exp = dtoa->exp;
+    }
+#endif
   else
     {
       double y;
@@ -160,6 +160,12 @@
 
 #define DTOA_ROUND_NUM        (DBL_DIG + 1)
 
+/* Cached powers of ten used by the Grisu fast path */
+
+#define DTOA_CACHED_POWERS_NUM    87
+#define DTOA_CACHED_POWERS_OFFSET 348  /* -(smallest decimal exponent) */
+#define DTOA_CACHED_POWERS_STEP   8    /* Decimal exponent distance */
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -178,6 +184,10 @@ struct dtoa_s
 extern const double g_dtoa_scale_up[];
 extern const double g_dtoa_scale_down[];
 extern const double g_dtoa_round[];
+#if DBL_MANT_DIG == 53
+extern const uint64_t g_dtoa_cached_sig[DTOA_CACHED_POWERS_NUM];
+extern const int16_t g_dtoa_cached_binexp[DTOA_CACHED_POWERS_NUM];
+#endif
 
 /****************************************************************************
  * Public Function Prototypes
@@ -22,7 +22,11 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <stdio.h>
+#include <errno.h>
+
 #include "libc.h"
 
 /****************************************************************************
@@ -30,15 +34,37 @@
  ****************************************************************************/
 
 /****************************************************************************
- * fgetc
+ * Name: fgetc_unlocked
+ *
+ * Description:
+ *   Equivalent to fgetc() but without locking the stream.  The caller
+ *   must hold the stream lock (see flockfile()).  In the common case, the
+ *   character is simply taken from the stream buffer.
+ *
  ****************************************************************************/
 
-int fgetc(FAR FILE *stream)
+int fgetc_unlocked(FAR FILE *stream)
 {
   unsigned char ch;
   ssize_t ret;
 
-  ret = lib_fread(&ch, 1, stream);
+#ifndef CONFIG_STDIO_DISABLE_BUFFERING
+  /* Fast path:  There is no ungotten character and read-ahead data is
+   * already buffered.  Anything else is handled by lib_fread_unlocked().
+   */
+
+  if (stream != NULL &&
+#if CONFIG_NUNGET_CHARS > 0
+      stream->fs_nungotten == 0 &&
+#endif
+      stream->fs_bufpos < stream->fs_bufread)
+    {
+      stream->fs_flags &= ~__FS_FLAG_EOF;
+      return *stream->fs_bufpos++;
+    }
+#endif
+
+  ret = lib_fread_unlocked(&ch, 1, stream);
   if (ret > 0)
     {
       return ch;
@@ -48,3 +74,24 @@ int fgetc(FAR FILE *stream)
       return EOF;
     }
 }
+
+/****************************************************************************
+ * Name: fgetc
+ ****************************************************************************/
+
+int fgetc(FAR FILE *stream)
+{
+  int ret;
+
+  if (stream == NULL)
+    {
+      set_errno(EBADF);
+      return EOF;
+    }
+
+  lib_take_semaphore(stream);
+  ret = fgetc_unlocked(stream);
+  lib_give_semaphore(stream);
+
+  return ret;
+}
@@ -22,7 +22,12 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <stdio.h>
+#include <fcntl.h>
+#include <errno.h>
+
 #include "libc.h"
 
 /****************************************************************************
@@ -30,15 +35,37 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: fputc
+ * Name: fputc_unlocked
+ *
+ * Description:
+ *   Equivalent to fputc() but without locking the stream.  The caller
+ *   must hold the stream lock (see flockfile()).  In the common case, the
+ *   character is simply appended to the stream buffer.
+ *
  ****************************************************************************/
 
-int fputc(int c, FAR FILE *stream)
+int fputc_unlocked(int c, FAR FILE *stream)
 {
   unsigned char buf = (unsigned char)c;
   int ret;
 
-  ret = lib_fwrite(&buf, 1, stream);
+#ifndef CONFIG_STDIO_DISABLE_BUFFERING
+  /* Fast path:  The buffer is in write mode, there is room for the
+   * character without filling the buffer and no line buffered flush is
+   * needed.  Anything else is handled by lib_fwrite_unlocked().
+   */
+
+  if (stream != NULL && (stream->fs_oflags & O_WROK) != 0 &&
+      stream->fs_bufread == stream->fs_bufstart &&
+      stream->fs_bufend - stream->fs_bufpos > 1 &&
+      (c != '\n' || (stream->fs_flags & __FS_FLAG_LBF) == 0))
+    {
+      *stream->fs_bufpos++ = buf;
+      return buf;
+    }
+#endif
+
+  ret = lib_fwrite_unlocked(&buf, 1, stream);
   if (ret > 0)
     {
       /* Flush the buffer if a newline is output */
@@ -52,10 +79,31 @@ int fputc(int c, FAR FILE *stream)
             }
         }
 
-      return c;
+      return buf;
     }
   else
     {
       return EOF;
     }
 }
+
+/****************************************************************************
+ * Name: fputc
+ ****************************************************************************/
+
+int fputc(int c, FAR FILE *stream)
+{
+  int ret;
+
+  if (stream == NULL)
+    {
+      set_errno(EBADF);
+      return EOF;
+    }
+
+  lib_take_semaphore(stream);
+  ret = fputc_unlocked(c, stream);
+  lib_give_semaphore(stream);
+
+  return ret;
+}
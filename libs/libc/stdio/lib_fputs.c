@@ -103,37 +103,48 @@ int fputs(FAR const IPTR char *s, FAR FILE *stream)
     }
 #endif
 
-  /* If line buffering is enabled, then we will have to output one character
-   * at a time, checking for a newline character each time.
+  /* If line buffering is enabled, then we will have to output the string
+   * one line at a time, flushing after each newline.
    */
 
   if ((stream->fs_flags & __FS_FLAG_LBF) != 0)
     {
+      FAR const char *nl;
+      int ntowrite;
       int ret;
 
+      lib_take_semaphore(stream);
+
       /* Write the string.  Loop until the null terminator is encountered */
 
-      for (nput = 0; *s; nput++, s++)
+      for (nput = 0; *s; nput += ntowrite, s += ntowrite)
         {
-          /* Write the next character to the stream buffer */
+          /* Write the next line (or what remains) to the stream buffer */
 
-          ret = lib_fwrite(s, 1, stream);
+          nl       = strchr(s, '\n');
+          ntowrite = nl != NULL ? nl - s + 1 : strlen(s);
+
+          ret = lib_fwrite_unlocked(s, ntowrite, stream);
           if (ret <= 0)
             {
+              lib_give_semaphore(stream);
               return EOF;
             }
 
           /* Flush the buffer if a newline was written to the buffer */
 
-          if (*s == '\n')
+          if (nl != NULL)
             {
               ret = lib_fflush(stream, true);
               if (ret < 0)
                 {
+                  lib_give_semaphore(stream);
                   return EOF;
                 }
             }
         }
+
+      lib_give_semaphore(stream);
     }
 
   /* We can write the whole string in one operation without line buffering */
@@ -33,6 +33,30 @@
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: fread_unlocked
+ ****************************************************************************/
+
+size_t fread_unlocked(FAR void *ptr, size_t size, size_t n_items,
+                      FAR FILE *stream)
+{
+  size_t  full_size = n_items * (size_t)size;
+  ssize_t bytes_read;
+  size_t  items_read = 0;
+
+  /* Read the data from the stream buffer */
+
+  bytes_read = lib_fread_unlocked(ptr, full_size, stream);
+  if (bytes_read > 0)
+    {
+      /* Return the number of full items read */
+
+      items_read = bytes_read / size;
+    }
+
+  return items_read;
+}
+
 /****************************************************************************
  * Name: fread
  ****************************************************************************/
@@ -28,6 +28,11 @@
  * Public Functions
  ****************************************************************************/
 
+int getc_unlocked(FAR FILE *stream)
+{
+  return fgetc_unlocked(stream);
+}
+
 int getc(FAR FILE *stream)
 {
   return fgetc(stream);
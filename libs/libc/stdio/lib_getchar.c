@@ -28,6 +28,11 @@
  * Public Functions
  ****************************************************************************/
 
+int getchar_unlocked(void)
+{
+  return fgetc_unlocked(stdin);
+}
+
 int getchar(void)
 {
   return fgetc(stdin);
@@ -41,10 +41,16 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: lib_fread
+ * Name: lib_fread_unlocked
+ *
+ * Description:
+ *   Read 'count' bytes from the stream.  The caller must either hold the
+ *   stream lock (see flockfile()) or otherwise guarantee that the stream
+ *   is not accessed concurrently.
+ *
  ****************************************************************************/
 
-ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream)
+ssize_t lib_fread_unlocked(FAR void *ptr, size_t count, FAR FILE *stream)
 {
   FAR unsigned char *dest = (FAR unsigned char *)ptr;
   ssize_t bytes_read;
@@ -61,10 +67,6 @@ ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream)
     }
   else
     {
-      /* The stream must be stable until we complete the read */
-
-      lib_take_semaphore(stream);
-
 #if CONFIG_NUNGET_CHARS > 0
       /* First, re-read any previously ungotten characters */
 
@@ -97,7 +99,6 @@ ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream)
           ret = lib_wrflush(stream);
           if (ret < 0)
             {
-              lib_give_semaphore(stream);
               return ret;
             }
 
@@ -107,14 +108,19 @@ ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream)
             {
               /* Is there readable data in the buffer? */
 
-              while (remaining > 0 && stream->fs_bufpos < stream->fs_bufread)
+              size_t gulp_size = stream->fs_bufread - stream->fs_bufpos;
+              if (gulp_size > remaining)
                 {
-                  /* Yes, copy a byte into the user buffer */
-
-                  *dest++ = *stream->fs_bufpos++;
-                  remaining--;
+                  gulp_size = remaining;
                 }
 
+              /* Copy whatever is buffered into the user buffer */
+
+              memcpy(dest, stream->fs_bufpos, gulp_size);
+              stream->fs_bufpos += gulp_size;
+              dest              += gulp_size;
+              remaining         -= gulp_size;
+
               /* The buffer is empty OR we have already supplied the number
                * of bytes requested in the read.  Check if we need to read
                * more from the file.
@@ -268,8 +274,6 @@ shortread:
         {
           stream->fs_flags |= __FS_FLAG_EOF;
         }
-
-      lib_give_semaphore(stream);
     }
 
   return count - remaining;
@@ -278,6 +282,28 @@ shortread:
 
 errout_with_errno:
   stream->fs_flags |= __FS_FLAG_ERROR;
-  lib_give_semaphore(stream);
   return -get_errno();
 }
+
+/****************************************************************************
+ * Name: lib_fread
+ ****************************************************************************/
+
+ssize_t lib_fread(FAR void *ptr, size_t count, FAR FILE *stream)
+{
+  ssize_t ret;
+
+  if (stream == NULL)
+    {
+      set_errno(EBADF);
+      return 0;
+    }
+
+  /* The stream must be stable until we complete the read */
+
+  lib_take_semaphore(stream);
+  ret = lib_fread_unlocked(ptr, count, stream);
+  lib_give_semaphore(stream);
+
+  return ret;
+}
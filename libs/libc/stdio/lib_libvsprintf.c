@@ -74,6 +74,11 @@
 
 #define putc(c,stream)  (total_len++, (stream)->put(stream, c))
 
+/* Put a run of characters with a single call to the stream if it can */
+
+#define putstr(s,n,stream) \
+  (total_len += (n), vsprintf_putstr(stream, s, n))
+
 /* Order is relevant here and matches order in format string */
 
 #define FL_ZFILL           0x0001
@@ -142,6 +147,35 @@ struct arg
 
 static const char g_nullstring[] = "(null)";
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vsprintf_putstr
+ *
+ * Description:
+ *   Put a run of characters to the stream.  Streams that do not provide
+ *   puts() get one character at a time.
+ *
+ ****************************************************************************/
+
+static void vsprintf_putstr(FAR struct lib_outstream_s *stream,
+                            FAR const char *str, int len)
+{
+  if (stream->puts != NULL)
+    {
+      stream->puts(stream, str, len);
+    }
+  else
+    {
+      while (len-- > 0)
+        {
+          stream->put(stream, *str++);
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -184,6 +218,28 @@ static int vsprintf_internal(FAR struct lib_outstream_s *stream,
     {
       for (; ; )
         {
+#ifndef CONFIG_ARCH_ROMGETC
+          /* Emit the run of literal text up to the next conversion (or the
+           * end of the format) with one bulk put rather than character by
+           * character.
+           */
+
+          pnt = fmt;
+          while (*fmt != '\0' && *fmt != '%')
+            {
+              fmt++;
+            }
+
+#ifdef CONFIG_LIBC_NUMBERED_ARGS
+          if (fmt != pnt && stream != NULL)
+#else
+          if (fmt != pnt)
+#endif
+            {
+              putstr(pnt, fmt - pnt, stream);
+            }
+
+#endif
           c = fmt_char(fmt);
           if (c == '\0')
             {
@@ -917,15 +973,10 @@ static int vsprintf_internal(FAR struct lib_outstream_s *stream,
                 }
             }
 
-          while (size)
+          if (size > 0)
             {
-              putc(*pnt++, stream);
-              if (width != 0)
-                {
-                  width -= 1;
-                }
-
-              size -= 1;
+              putstr(pnt, size, stream);
+              width = (size_t)width > size ? width - (int)size : 0;
             }
 
           goto tail;
@@ -51,6 +51,26 @@ static void lowoutstream_putc(FAR struct lib_outstream_s *this, int ch)
     }
 }
 
+/****************************************************************************
+ * Name: lowoutstream_puts
+ ****************************************************************************/
+
+static void lowoutstream_puts(FAR struct lib_outstream_s *this,
+                              FAR const void *buf, int len)
+{
+  FAR const char *ptr = buf;
+
+  DEBUGASSERT(this);
+
+  while (len-- > 0)
+    {
+      if (up_putc(*ptr++) != EOF)
+        {
+          this->nput++;
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -73,6 +93,7 @@ static void lowoutstream_putc(FAR struct lib_outstream_s *this, int ch)
 void lib_lowoutstream(FAR struct lib_outstream_s *stream)
 {
   stream->put   = lowoutstream_putc;
+  stream->puts  = lowoutstream_puts;
   stream->flush = lib_noflush;
   stream->nput  = 0;
 }
@@ -28,6 +28,11 @@
  * Public Functions
  ****************************************************************************/
 
+int putc_unlocked(int c, FAR FILE *stream)
+{
+  return fputc_unlocked(c, stream);
+}
+
 int putc(int c, FAR FILE *stream)
 {
   return fputc(c, stream);
@@ -28,6 +28,11 @@
  * Public Functions
  ****************************************************************************/
 
+int putchar_unlocked(int c)
+{
+  return fputc_unlocked(c, stdout);
+}
+
 int putchar(int c)
 {
   return fputc(c, stdout);
@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include <fcntl.h>
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -45,12 +46,12 @@ static void stdoutstream_putc(FAR struct lib_outstream_s *this, int ch)
   DEBUGASSERT(this && sthis->stream);
 
   /* Loop until the character is successfully transferred or an irrecoverable
-   * error occurs.
+   * error occurs.  The caller (vfprintf) already holds the stream lock.
    */
 
   do
     {
-      result = fputc(ch, sthis->stream);
+      result = fputc_unlocked(ch, sthis->stream);
       if (result != EOF)
         {
           this->nput++;
@@ -64,6 +65,50 @@ static void stdoutstream_putc(FAR struct lib_outstream_s *this, int ch)
   while (get_errno() == EINTR);
 }
 
+/****************************************************************************
+ * Name: stdoutstream_puts
+ ****************************************************************************/
+
+static void stdoutstream_puts(FAR struct lib_outstream_s *this,
+                              FAR const void *buf, int len)
+{
+  FAR struct lib_stdoutstream_s *sthis =
+                               (FAR struct lib_stdoutstream_s *)this;
+  FAR const char *ptr = buf;
+  ssize_t result;
+
+  DEBUGASSERT(this && sthis->stream);
+
+  /* The caller (vfprintf) already holds the stream lock, so the whole run
+   * is copied into the stream buffer at once.
+   */
+
+  while (len > 0)
+    {
+      result = lib_fwrite_unlocked(ptr, len, sthis->stream);
+      if (result > 0)
+        {
+          this->nput += result;
+          ptr        += result;
+          len        -= result;
+        }
+      else if (get_errno() != EINTR)
+        {
+          break;
+        }
+    }
+
+#ifndef CONFIG_STDIO_DISABLE_BUFFERING
+  /* Honor line buffering as fputc() would have done */
+
+  if ((sthis->stream->fs_flags & __FS_FLAG_LBF) != 0 &&
+      memchr(buf, '\n', ptr - (FAR const char *)buf) != NULL)
+    {
+      lib_fflush(sthis->stream, true);
+    }
+#endif
+}
+
 /****************************************************************************
  * Name: stdoutstream_flush
  ****************************************************************************/
@@ -105,7 +150,8 @@ void lib_stdoutstream(FAR struct lib_stdoutstream_s *outstream,
 {
   /* Select the put operation */
 
-  outstream->public.put = stdoutstream_putc;
+  outstream->public.put  = stdoutstream_putc;
+  outstream->public.puts = stdoutstream_puts;
 
   /* Select the correct flush operation.  This flush is only called when
    * a newline is encountered in the output stream.  However, we do not
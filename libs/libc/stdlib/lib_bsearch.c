@@ -88,18 +88,12 @@
  *   the array, or a null pointer if no match is found. If two or more
  *   members compare equal, which member is returned is unspecified.
  *
- * Notes from the NetBSD version:
- *   The code below is a bit sneaky.  After a comparison fails, we divide
- *   the work in half by moving either left or right. If 'lim' is odd,
- *   moving left simply involves halving 'lim': e.g., when 'lim' is 5 we
- *   look at item 2, so we change 'lim' to 2 so that we will look at items
- *   0 & 1.  If 'lim' is even, the same applies.  If 'lim' is odd, moving
- *   right again involes halving 'lim', this time moving the base up one
- *   item past 'middle': e.g., when 'lim' is 5 we change base to item 3 and
- *   make 'lim' 2 so that we will look at items 3 and 4.  If 'lim' is
- *   even, however, we have to shrink it by one before halving: e.g.,
- *   when 'lim' is 4, we still looked at item 2, so we have to make 'lim'
- *   3, then halve, obtaining 1, so that we will only look at item 3.
+ * Implementation notes:
+ *   The loop halves the search region unconditionally and only selects
+ *   which half to keep from the comparison result, so that the number of
+ *   iterations depends only on 'nel' and the selection compiles to a
+ *   conditional move rather than a hard to predict branch.  The single
+ *   equality test is done once, on the remaining candidate.
  *
  ****************************************************************************/
 
@@ -107,33 +101,27 @@ FAR void *bsearch(FAR const void *key, FAR const void *base, size_t nel,
                   size_t width, CODE int (*compar)(FAR const void *,
                   FAR const void *))
 {
-  FAR const void *middle;  /* Current entry being tested */
   FAR const char *lower;   /* The lower limit of the search region */
-  size_t lim;              /* The number of elements in the region */
-  int cmp;                 /* Boolean comparison result */
+  FAR const char *middle;  /* Current entry being tested */
+  size_t half;             /* Half the number of elements in the region */
 
   DEBUGASSERT(key != NULL);
   DEBUGASSERT(base != NULL || nel == 0);
   DEBUGASSERT(compar != NULL);
 
-  for (lim = nel, lower = (const char *)base; lim != 0; lim >>= 1)
+  if (nel == 0)
     {
-      middle = lower + (lim >> 1) * width;
-      cmp    = (*compar)(key, middle);
-
-      if (cmp == 0)
-        {
-          return (FAR void *)middle;
-        }
+      return NULL;
+    }
 
-      if (cmp > 0)
-        {
-          /* key > middle: move right (else move left) */
+  /* Invariant: if there is a match, there is one in [lower, lower + nel) */
 
-          lower = (FAR const char *)middle + width;
-          lim--;
-        }
+  for (lower = (FAR const char *)base; nel > 1; nel -= half)
+    {
+      half   = nel >> 1;
+      middle = lower + half * width;
+      lower  = (*compar)(key, middle) >= 0 ? middle : lower;
     }
 
-  return NULL;
+  return (*compar)(key, lower) == 0 ? (FAR void *)lower : NULL;
 }
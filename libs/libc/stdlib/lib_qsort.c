@@ -1,42 +1,20 @@
 /****************************************************************************
  * libs/libc/stdlib/lib_qsort.c
  *
- *   Copyright (C) 2007, 2009, 2011 Gregory Nutt. All rights reserved.
- *   Author: Gregory Nutt <gnutt@nuttx.org>
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
  *
- * Leveraged from:
+ *   http://www.apache.org/licenses/LICENSE-2.0
  *
- *  Copyright (c) 1992, 1993
- *  The Regents of the University of California.  All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. All advertising materials mentioning features or use of this software
- *    must display the following acknowledgement:
- *    This product includes software developed by the University of
- *    California, Berkeley and its contributors.
- * 4. Neither the name of the University nor the names of its contributors
- *    may be used to endorse or promote products derived from this software
- *    without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
- * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
- * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
- * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
- * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
- * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
- * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- * SUCH DAMAGE.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
  *
  ****************************************************************************/
 
@@ -47,251 +25,713 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define min(a, b)  (a) < (b) ? a : b
-
-#define swapcode(TYPE, parmi, parmj, n) \
-  { \
-    long i = (n) / sizeof (TYPE); \
-    register TYPE *pi = (TYPE *)(parmi); \
-    register TYPE *pj = (TYPE *)(parmj); \
-    do { \
-      register TYPE  t = *pi; \
-      *pi++ = *pj; \
-      *pj++ = t; \
-    } while (--i > 0); \
-  }
-
-#define SWAPINIT(a, width) \
-  swaptype = ((FAR char *)a - (FAR char *)0) % sizeof(long) || \
-  width % sizeof(long) ? 2 : width == sizeof(long)? 0 : 1;
-
-#define swap(a, b) \
-  if (swaptype == 0) \
-    { \
-      long t = *(long *)(a); \
-      *(long *)(a) = *(long *)(b); \
-      *(long *)(b) = t; \
-    } \
-  else \
-    { \
-      swapfunc(a, b, width, swaptype); \
-    }
+/* Partitions smaller than this are sorted by insertion sort */
+
+#define QSORT_INSERTION_THRESHOLD  16
+
+/* Partitions larger than this use Tukey's ninther for pivot selection */
+
+#define QSORT_NINTHER_THRESHOLD    128
+
+/* Number of element moves the partial insertion sort of an apparently
+ * sorted partition may make before giving up.
+ */
+
+#define QSORT_PARTIAL_LIMIT        8
+
+/* Number of elements per block of the branchless partitioning */
 
-#define vecswap(a, b, n) if ((n) > 0) swapfunc(a, b, n, swaptype)
+#define QSORT_BLOCK_SIZE           64
+
+/* Swap strategies, selected once per call from the alignment and width */
+
+#define QSORT_SWAP_WORD            0  /* A single long */
+#define QSORT_SWAP_WORDS           1  /* A multiple of longs */
+#define QSORT_SWAP_BYTES           2  /* Anything else */
 
 /****************************************************************************
- * Private Function Prototypes
+ * Private Types
  ****************************************************************************/
 
-static inline void swapfunc(FAR char *a, FAR char *b, int n, int swaptype);
-static inline FAR char *med3(FAR char *a, FAR char *b, FAR char *c,
-                             CODE int (*compar)(FAR const void *,
-                             FAR const void *));
+struct qsort_s
+{
+  size_t width;
+  int swaptype;
+  CODE int (*compar)(FAR const void *, FAR const void *);
+};
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
-static inline void swapfunc(FAR char *a, FAR char *b, int n, int swaptype)
+static void qsort_swap(FAR const struct qsort_s *ctx, FAR char *a,
+                       FAR char *b)
 {
-  if (swaptype <= 1)
+  size_t n;
+
+  if (ctx->swaptype == QSORT_SWAP_WORD)
     {
-      swapcode(long, a, b, n)
+      long t = *(FAR long *)a;
+      *(FAR long *)a = *(FAR long *)b;
+      *(FAR long *)b = t;
+    }
+  else if (ctx->swaptype == QSORT_SWAP_WORDS)
+    {
+      FAR long *pa = (FAR long *)a;
+      FAR long *pb = (FAR long *)b;
+
+      for (n = ctx->width / sizeof(long); n > 0; n--)
+        {
+          long t = *pa;
+          *pa++ = *pb;
+          *pb++ = t;
+        }
     }
   else
     {
-      swapcode(char, a, b, n)
+      for (n = ctx->width; n > 0; n--)
+        {
+          char t = *a;
+          *a++ = *b;
+          *b++ = t;
+        }
     }
 }
 
-static inline FAR char *med3(FAR char *a, FAR char *b, FAR char *c,
-                             CODE int (*compar)(FAR const void *,
-                             FAR const void *))
+static inline bool qsort_less(FAR const struct qsort_s *ctx,
+                              FAR const char *a, FAR const char *b)
 {
-  return compar(a, b) < 0 ?
-         (compar(b, c) < 0 ? b : (compar(a, c) < 0 ? c : a)) :
-         (compar(b, c) > 0 ? b : (compar(a, c) < 0 ? a : c));
+  return ctx->compar(a, b) < 0;
 }
 
 /****************************************************************************
- * Public Function
+ * Name: qsort_sort2/qsort_sort3
+ *
+ * Description:
+ *   Order two or three elements in place.  After qsort_sort3(), the median
+ *   is in 'b'.
+ *
  ****************************************************************************/
 
+static void qsort_sort2(FAR const struct qsort_s *ctx, FAR char *a,
+                        FAR char *b)
+{
+  if (qsort_less(ctx, b, a))
+    {
+      qsort_swap(ctx, a, b);
+    }
+}
+
+static void qsort_sort3(FAR const struct qsort_s *ctx, FAR char *a,
+                        FAR char *b, FAR char *c)
+{
+  qsort_sort2(ctx, a, b);
+  qsort_sort2(ctx, b, c);
+  qsort_sort2(ctx, a, b);
+}
+
 /****************************************************************************
- * Name: qsort
+ * Name: qsort_insertion
  *
  * Description:
- *   The qsort() function will sort an array of 'nel' objects, the initial
- *   element of which is pointed to by 'base'. The size of each object, in
- *   bytes, is specified by the 'width" argument. If the 'nel' argument has
- *   the value zero, the comparison function pointed to by 'compar' will not
- *   be called and no rearrangement will take place.
+ *   Sort the range [begin, end) by straight insertion.
  *
- *   The application will ensure that the comparison function pointed to by
- *   'compar' does not alter the contents of the array. The implementation
- *   may reorder elements of the array between calls to the comparison
- *   function, but will not alter the contents of any individual element.
+ ****************************************************************************/
+
+static void qsort_insertion(FAR const struct qsort_s *ctx, FAR char *begin,
+                            FAR char *end)
+{
+  size_t width = ctx->width;
+  FAR char *cur;
+  FAR char *p;
+
+  for (cur = begin + width; cur < end; cur += width)
+    {
+      for (p = cur; p > begin && qsort_less(ctx, p, p - width); p -= width)
+        {
+          qsort_swap(ctx, p, p - width);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: qsort_partial_insertion
  *
- *   When the same objects (consisting of 'width" bytes, irrespective of
- *   their current positions in the array) are passed more than once to
- *   the comparison function, the results will be consistent with one
- *   another. That is, they will define a total ordering on the array.
+ * Description:
+ *   Attempt an insertion sort of [begin, end), giving up once more than
+ *   QSORT_PARTIAL_LIMIT elements had to be moved.  Returns true if the
+ *   range is now sorted.
  *
- *   The contents of the array will be sorted in ascending order according
- *   to a comparison function. The 'compar' argument is a pointer to the
- *   comparison function, which is called with two arguments that point to
- *   the elements being compared. The application will ensure that the
- *   function returns an integer less than, equal to, or greater than 0,
- *   if the first argument is considered respectively less than, equal to,
- *   or greater than the second. If two members compare as equal, their
- *   order in the sorted array is unspecified.
+ ****************************************************************************/
+
+static bool qsort_partial_insertion(FAR const struct qsort_s *ctx,
+                                    FAR char *begin, FAR char *end)
+{
+  size_t width = ctx->width;
+  size_t limit = 0;
+  FAR char *cur;
+  FAR char *p;
+
+  for (cur = begin + width; cur < end; cur += width)
+    {
+      for (p = cur; p > begin && qsort_less(ctx, p, p - width); p -= width)
+        {
+          qsort_swap(ctx, p, p - width);
+        }
+
+      limit += (cur - p) / width;
+      if (limit > QSORT_PARTIAL_LIMIT)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: qsort_heapsort
  *
- *   (Based on description from OpenGroup.org).
+ * Description:
+ *   O(n log n) fallback used when too many bad partitions were seen.
  *
- * Returned Value:
- *   The qsort() function will not return a value.
+ ****************************************************************************/
+
+static void qsort_siftdown(FAR const struct qsort_s *ctx, FAR char *base,
+                           size_t root, size_t nel)
+{
+  size_t width = ctx->width;
+  size_t child;
+
+  while ((child = 2 * root + 1) < nel)
+    {
+      if (child + 1 < nel &&
+          qsort_less(ctx, base + child * width,
+                     base + (child + 1) * width))
+        {
+          child++;
+        }
+
+      if (!qsort_less(ctx, base + root * width, base + child * width))
+        {
+          break;
+        }
+
+      qsort_swap(ctx, base + root * width, base + child * width);
+      root = child;
+    }
+}
+
+static void qsort_heapsort(FAR const struct qsort_s *ctx, FAR char *begin,
+                           FAR char *end)
+{
+  size_t nel = (end - begin) / ctx->width;
+  size_t i;
+
+  for (i = nel / 2; i > 0; i--)
+    {
+      qsort_siftdown(ctx, begin, i - 1, nel);
+    }
+
+  for (i = nel - 1; i > 0; i--)
+    {
+      qsort_swap(ctx, begin, begin + i * ctx->width);
+      qsort_siftdown(ctx, begin, 0, i);
+    }
+}
+
+/****************************************************************************
+ * Name: qsort_partition_block
  *
- * Notes from the original BSD version:
- *   Qsort routine from Bentley & McIlroy's "Engineering a Sort Function".
+ * Description:
+ *   Branchless block partitioning of [first, last) around the pivot
+ *   (Edelkamp and Weiss, "BlockQuicksort", 2016).  The comparison results
+ *   are recorded as offsets rather than acted upon with a conditional
+ *   branch, and the misplaced elements are then swapped pairwise.  Returns
+ *   the first element of the right partition.
  *
  ****************************************************************************/
 
-void qsort(FAR void *base, size_t nel, size_t width,
-           CODE int(*compar)(FAR const void *, FAR const void *))
+static FAR char *qsort_partition_block(FAR const struct qsort_s *ctx,
+                                       FAR char *pivot, FAR char *first,
+                                       FAR char *last)
 {
-  FAR char *pa;
-  FAR char *pb;
-  FAR char *pc;
-  FAR char *pd;
-  FAR char *pl;
-  FAR char *pm;
-  FAR char *pn;
-  int swaptype;
-  int swap_cnt;
-  int d;
-  int r;
+  uint8_t offsets_l[QSORT_BLOCK_SIZE];
+  uint8_t offsets_r[QSORT_BLOCK_SIZE];
+  size_t width   = ctx->width;
+  FAR char *base_l = first;
+  FAR char *base_r = last;
+  size_t num_l   = 0;
+  size_t num_r   = 0;
+  size_t start_l = 0;
+  size_t start_r = 0;
+  size_t unknown;
+  size_t split_l;
+  size_t split_r;
+  size_t num;
+  size_t i;
+
+  while (first < last)
+    {
+      /* Decide how many unknown elements each side examines */
+
+      unknown = (last - first) / width;
+      split_l = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+      split_r = num_r == 0 ? unknown - split_l : 0;
+
+      if (split_l > QSORT_BLOCK_SIZE)
+        {
+          split_l = QSORT_BLOCK_SIZE;
+        }
+
+      if (split_r > QSORT_BLOCK_SIZE)
+        {
+          split_r = QSORT_BLOCK_SIZE;
+        }
+
+      /* Record the elements on the wrong side of the pivot */
+
+      for (i = 0; i < split_l; i++)
+        {
+          offsets_l[num_l] = i;
+          num_l += !qsort_less(ctx, first, pivot);
+          first += width;
+        }
 
-loop:
-  SWAPINIT(base, width);
-  swap_cnt = 0;
+      for (i = 0; i < split_r; i++)
+        {
+          last -= width;
+          offsets_r[num_r] = i + 1;
+          num_r += qsort_less(ctx, last, pivot);
+        }
+
+      /* And exchange them pairwise */
+
+      num = num_l < num_r ? num_l : num_r;
+      for (i = 0; i < num; i++)
+        {
+          qsort_swap(ctx, base_l + offsets_l[start_l + i] * width,
+                     base_r - offsets_r[start_r + i] * width);
+        }
+
+      num_l   -= num;
+      num_r   -= num;
+      start_l += num;
+      start_r += num;
+
+      if (num_l == 0)
+        {
+          start_l = 0;
+          base_l  = first;
+        }
+
+      if (num_r == 0)
+        {
+          start_r = 0;
+          base_r  = last;
+        }
+    }
 
-  if (nel < 7)
+  /* Move the remaining misplaced elements of one side to the boundary */
+
+  if (num_l > 0)
     {
-      for (pm = (FAR char *)base + width;
-           pm < (FAR char *)base + nel * width;
-           pm += width)
+      while (num_l-- > 0)
         {
-          for (pl = pm;
-               pl > (FAR char *)base && compar(pl - width, pl) > 0;
-               pl -= width)
-            {
-              swap(pl, pl - width);
-            }
+          last -= width;
+          qsort_swap(ctx, base_l + offsets_l[start_l + num_l] * width, last);
         }
 
-      return;
+      first = last;
     }
 
-  pm = (FAR char *)base + (nel / 2) * width;
-  if (nel > 7)
+  if (num_r > 0)
     {
-      pl = base;
-      pn = (FAR char *)base + (nel - 1) * width;
-      if (nel > 40)
+      while (num_r-- > 0)
         {
-          d  = (nel / 8) * width;
-          pl = med3(pl, pl + d, pl + 2 * d, compar);
-          pm = med3(pm - d, pm, pm + d, compar);
-          pn = med3(pn - 2 * d, pn - d, pn, compar);
+          qsort_swap(ctx, base_r - offsets_r[start_r + num_r] * width,
+                     first);
+          first += width;
         }
+    }
+
+  return first;
+}
+
+/****************************************************************************
+ * Name: qsort_partition_right
+ *
+ * Description:
+ *   Partition [begin, end) around the pivot at 'begin'.  Elements equal to
+ *   the pivot go to the right partition.  The pivot is moved to its final
+ *   position, which is returned.  *partitioned is set if no element had to
+ *   be moved, a hint that the input may already be sorted.
+ *
+ ****************************************************************************/
 
-      pm = med3(pl, pm, pn, compar);
+static FAR char *qsort_partition_right(FAR const struct qsort_s *ctx,
+                                       FAR char *begin, FAR char *end,
+                                       FAR bool *partitioned)
+{
+  size_t width = ctx->width;
+  FAR char *first = begin;
+  FAR char *last = end;
+
+  /* Find the first element not less than the pivot.  The median-of-3
+   * selection guarantees one exists, but bound the scan anyway so that an
+   * inconsistent comparison function cannot run off the array.
+   */
+
+  do
+    {
+      first += width;
     }
+  while (first < end && qsort_less(ctx, first, begin));
 
-  swap(base, pm);
-  pa = pb = (FAR char *)base + width;
+  /* Find the last element less than the pivot */
 
-  pc = pd = (FAR char *)base + (nel - 1) * width;
-  for (; ; )
+  do
     {
-      while (pb <= pc && (r = compar(pb, base)) <= 0)
-        {
-          if (r == 0)
-            {
-              swap_cnt = 1;
-              swap(pa, pb);
-              pa += width;
-            }
+      last -= width;
+    }
+  while (last > first && !qsort_less(ctx, last, begin));
 
-          pb += width;
-        }
+  *partitioned = first >= last;
+  if (first < last)
+    {
+      qsort_swap(ctx, first, last);
+      first += width;
 
-      while (pb <= pc && (r = compar(pc, base)) >= 0)
+      if (ctx->swaptype == QSORT_SWAP_WORD)
         {
-          if (r == 0)
+          first = qsort_partition_block(ctx, begin, first, last);
+        }
+      else
+        {
+          for (; ; )
             {
-              swap_cnt = 1;
-              swap(pc, pd);
-              pd -= width;
+              while (first < last && qsort_less(ctx, first, begin))
+                {
+                  first += width;
+                }
+
+              do
+                {
+                  last -= width;
+                }
+              while (last >= first && !qsort_less(ctx, last, begin));
+
+              if (first >= last)
+                {
+                  break;
+                }
+
+              qsort_swap(ctx, first, last);
+              first += width;
             }
+        }
+    }
+
+  /* Put the pivot in place */
+
+  first -= width;
+  if (first != begin)
+    {
+      qsort_swap(ctx, begin, first);
+    }
+
+  return first;
+}
+
+/****************************************************************************
+ * Name: qsort_partition_left
+ *
+ * Description:
+ *   Partition [begin, end) around the pivot at 'begin', putting elements
+ *   equal to the pivot into the left partition.  Used when the pivot equals
+ *   the element preceding the range, in which case the whole left
+ *   partition is known to be equal and needs no further sorting.
+ *
+ ****************************************************************************/
 
-          pc -= width;
+static FAR char *qsort_partition_left(FAR const struct qsort_s *ctx,
+                                      FAR char *begin, FAR char *end)
+{
+  size_t width = ctx->width;
+  FAR char *first = begin;
+  FAR char *last = end;
+
+  do
+    {
+      last -= width;
+    }
+  while (last > begin && qsort_less(ctx, begin, last));
+
+  do
+    {
+      first += width;
+    }
+  while (first < last && !qsort_less(ctx, begin, first));
+
+  while (first < last)
+    {
+      qsort_swap(ctx, first, last);
+
+      do
+        {
+          last -= width;
         }
+      while (qsort_less(ctx, begin, last));
 
-      if (pb > pc)
+      do
         {
-          break;
+          first += width;
         }
+      while (first < last && !qsort_less(ctx, begin, first));
+    }
 
-      swap(pb, pc);
-      swap_cnt = 1;
-      pb      += width;
-      pc      -= width;
+  if (last != begin)
+    {
+      qsort_swap(ctx, begin, last);
     }
 
-  if (swap_cnt == 0)
+  return last;
+}
+
+/****************************************************************************
+ * Name: qsort_loop
+ *
+ * Description:
+ *   Pattern-defeating quicksort (Orson Peters, "Pattern-defeating
+ *   Quicksort", 2021) of [begin, end).  The smaller partition is sorted
+ *   recursively and the larger one iteratively, so the recursion depth is
+ *   at most log2(nel).  'bad' is the number of unbalanced partitions that
+ *   are tolerated before switching to heapsort.  'leftmost' is false if
+ *   the element before 'begin' is known not to be greater than any
+ *   element of the range.
+ *
+ ****************************************************************************/
+
+static void qsort_loop(FAR const struct qsort_s *ctx, FAR char *begin,
+                       FAR char *end, int bad, bool leftmost)
+{
+  size_t width = ctx->width;
+  FAR char *pivot;
+  size_t size;
+  size_t lsize;
+  size_t rsize;
+  size_t half;
+  size_t q;
+  bool partitioned;
+
+  for (; ; )
     {
-      /* Switch to insertion sort */
+      size = (end - begin) / width;
+      if (size < QSORT_INSERTION_THRESHOLD)
+        {
+          qsort_insertion(ctx, begin, end);
+          return;
+        }
+
+      /* Choose the pivot as the median of three or of three medians of
+       * three, and move it to the start of the range.
+       */
+
+      half = size / 2;
+      if (size > QSORT_NINTHER_THRESHOLD)
+        {
+          qsort_sort3(ctx, begin, begin + half * width, end - width);
+          qsort_sort3(ctx, begin + width, begin + (half - 1) * width,
+                      end - 2 * width);
+          qsort_sort3(ctx, begin + 2 * width, begin + (half + 1) * width,
+                      end - 3 * width);
+          qsort_sort3(ctx, begin + (half - 1) * width, begin + half * width,
+                      begin + (half + 1) * width);
+          qsort_swap(ctx, begin, begin + half * width);
+        }
+      else
+        {
+          qsort_sort3(ctx, begin + half * width, begin, end - width);
+        }
+
+      /* If the pivot equals the element before the range, all elements
+       * equal to it are already in their final place:  Put them on the
+       * left and continue with the rest.
+       */
+
+      if (!leftmost && !qsort_less(ctx, begin - width, begin))
+        {
+          begin = qsort_partition_left(ctx, begin, end) + width;
+          continue;
+        }
+
+      pivot = qsort_partition_right(ctx, begin, end, &partitioned);
+      lsize = (pivot - begin) / width;
+      rsize = (end - pivot) / width - 1;
 
-      for (pm = (FAR char *)base + width;
-           pm < (FAR char *)base + nel * width;
-           pm += width)
+      if (lsize < size / 8 || rsize < size / 8)
         {
-          for (pl = pm;
-               pl > (FAR char *)base && compar(pl - width, pl) > 0;
-               pl -= width)
+          /* A bad partition.  Give up on quicksort if there have been too
+           * many, otherwise break up patterns by swapping a few elements.
+           */
+
+          if (--bad == 0)
+            {
+              qsort_heapsort(ctx, begin, end);
+              return;
+            }
+
+          if (lsize >= QSORT_INSERTION_THRESHOLD)
+            {
+              q = lsize / 4;
+              qsort_swap(ctx, begin, begin + q * width);
+              qsort_swap(ctx, pivot - width, pivot - q * width);
+
+              if (lsize > QSORT_NINTHER_THRESHOLD)
+                {
+                  qsort_swap(ctx, begin + width, begin + (q + 1) * width);
+                  qsort_swap(ctx, begin + 2 * width,
+                             begin + (q + 2) * width);
+                  qsort_swap(ctx, pivot - 2 * width,
+                             pivot - (q + 1) * width);
+                  qsort_swap(ctx, pivot - 3 * width,
+                             pivot - (q + 2) * width);
+                }
+            }
+
+          if (rsize >= QSORT_INSERTION_THRESHOLD)
             {
-              swap(pl, pl - width);
+              q = rsize / 4;
+              qsort_swap(ctx, pivot + width, pivot + (q + 1) * width);
+              qsort_swap(ctx, end - width, end - q * width);
+
+              if (rsize > QSORT_NINTHER_THRESHOLD)
+                {
+                  qsort_swap(ctx, pivot + 2 * width,
+                             pivot + (q + 2) * width);
+                  qsort_swap(ctx, pivot + 3 * width,
+                             pivot + (q + 3) * width);
+                  qsort_swap(ctx, end - 2 * width,
+                             end - (q + 1) * width);
+                  qsort_swap(ctx, end - 3 * width,
+                             end - (q + 2) * width);
+                }
             }
         }
+      else if (partitioned &&
+               qsort_partial_insertion(ctx, begin, pivot) &&
+               qsort_partial_insertion(ctx, pivot + width, end))
+        {
+          /* The input was (nearly) sorted already */
 
-      return;
+          return;
+        }
+
+      /* Recurse into the smaller partition, iterate on the larger one */
+
+      if (lsize < rsize)
+        {
+          qsort_loop(ctx, begin, pivot, bad, leftmost);
+          begin    = pivot + width;
+          leftmost = false;
+        }
+      else
+        {
+          qsort_loop(ctx, pivot + width, end, bad, false);
+          end = pivot;
+        }
     }
+}
 
-  pn = (FAR char *)base + nel * width;
-  r  = min(pa - (FAR char *)base, pb - pa);
-  vecswap(base, pb - r, r);
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: qsort
+ *
+ * Description:
+ *   The qsort() function will sort an array of 'nel' objects, the initial
+ *   element of which is pointed to by 'base'. The size of each object, in
+ *   bytes, is specified by the 'width" argument. If the 'nel' argument has
+ *   the value zero, the comparison function pointed to by 'compar' will not
+ *   be called and no rearrangement will take place.
+ *
+ *   The application will ensure that the comparison function pointed to by
+ *   'compar' does not alter the contents of the array. The implementation
+ *   may reorder elements of the array between calls to the comparison
+ *   function, but will not alter the contents of any individual element.
+ *
+ *   When the same objects (consisting of 'width" bytes, irrespective of
+ *   their current positions in the array) are passed more than once to
+ *   the comparison function, the results will be consistent with one
+ *   another. That is, they will define a total ordering on the array.
+ *
+ *   The contents of the array will be sorted in ascending order according
+ *   to a comparison function. The 'compar' argument is a pointer to the
+ *   comparison function, which is called with two arguments that point to
+ *   the elements being compared. The application will ensure that the
+ *   function returns an integer less than, equal to, or greater than 0,
+ *   if the first argument is considered respectively less than, equal to,
+ *   or greater than the second. If two members compare as equal, their
+ *   order in the sorted array is unspecified.
+ *
+ *   (Based on description from OpenGroup.org).
+ *
+ * Returned Value:
+ *   The qsort() function will not return a value.
+ *
+ * Implementation notes:
+ *   This is a pattern-defeating quicksort:  Introsort with insertion sort
+ *   for small partitions, adaptive handling of sorted and many-duplicate
+ *   inputs, branchless block partitioning of word-sized elements and a
+ *   heapsort fallback that guarantees O(n log n) comparisons.  Stack use
+ *   is O(log n).
+ *
+ ****************************************************************************/
 
-  r  = min(pd - pc, pn - pd - width);
-  vecswap(pb, pn - r, r);
+void qsort(FAR void *base, size_t nel, size_t width,
+           CODE int(*compar)(FAR const void *, FAR const void *))
+{
+  struct qsort_s ctx;
+  size_t n;
+  int bad;
 
-  if ((r = pb - pa) > width)
+  if (nel < 2 || width == 0)
     {
-      qsort(base, r / width, width, compar);
+      return;
     }
 
-  if ((r = pd - pc) > width)
+  ctx.width  = width;
+  ctx.compar = compar;
+
+  if ((uintptr_t)base % sizeof(long) != 0 || width % sizeof(long) != 0)
     {
-      /* Iterate rather than recurse to save stack space */
+      ctx.swaptype = QSORT_SWAP_BYTES;
+    }
+  else if (width == sizeof(long))
+    {
+      ctx.swaptype = QSORT_SWAP_WORD;
+    }
+  else
+    {
+      ctx.swaptype = QSORT_SWAP_WORDS;
+    }
+
+  /* Allow log2(nel) bad partitions before falling back to heapsort */
 
-      base = pn - r;
-      nel = r / width;
-      goto loop;
+  for (bad = 0, n = nel; n > 0; n >>= 1)
+    {
+      bad++;
     }
+
+  qsort_loop(&ctx, base, (FAR char *)base + nel * width, bad, true);
 }
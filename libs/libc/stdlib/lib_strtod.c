@@ -1,35 +1,20 @@
 /****************************************************************************
  * libs/libc/stdlib/lib_strtod.c
- * Convert string to double
  *
- *   Copyright (C) 2002 Michael Ringgaard. All rights reserved.
- *   Copyright (C) 2006-2007 H. Peter Anvin.
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
  *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
+ *   http://www.apache.org/licenses/LICENSE-2.0
  *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. Neither the name of the project nor the names of its contributors
- *    may be used to endorse or promote products derived from this software
- *    without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
- * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
- * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
- * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
- * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
- * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
- * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
- * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
  *
  ****************************************************************************/
 
@@ -41,224 +26,90 @@
 #include <nuttx/compiler.h>
 
 #include <stdlib.h>
-#include <ctype.h>
-#include <errno.h>
+#include <stdint.h>
+
+#include "lib_strtod_engine.h"
 
 #ifdef CONFIG_HAVE_DOUBLE
 
 /****************************************************************************
- * Pre-processor definitions
+ * Private Data
  ****************************************************************************/
 
-/* These are predefined with GCC, but could be issues for other compilers. If
- * not defined, an arbitrary big number is put in for now.  These should be
- * added to nuttx/compiler for your compiler.
- */
-
-#if !defined(__DBL_MIN_EXP__) || !defined(__DBL_MAX_EXP__)
-#  ifdef CONFIG_CPP_HAVE_WARNING
-#    warning "Size of exponent is unknown"
-#  endif
-#  undef  __DBL_MIN_EXP__
-#  define __DBL_MIN_EXP__ (-1021)
-#  undef  __DBL_MAX_EXP__
-#  define __DBL_MAX_EXP__ (1024)
-#endif
+/* IEEE 754 binary64 */
 
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
-
-static inline int is_real(double x)
+static const struct strtod_format_s g_double_format =
 {
-  const double infinite = 1.0 / 0.0;
-  return (x < infinite) && (x >= -infinite);
-}
+  52,                         /* mbits */
+  -1023,                      /* minexp */
+  0x7ff,                      /* infexp */
+  -342,                       /* minpow10 */
+  308,                        /* maxpow10 */
+  -4,                         /* rtemin */
+  23                          /* rtemax */
+};
+
+/* Powers of ten that are exactly representable as a double */
+
+static const double g_double_pow10[] =
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define DOUBLE_MAX_POW10 22
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/***************************************************(************************
+/****************************************************************************
  * Name: strtod
  *
  * Description:
- *   Convert a string to a double value
+ *   Convert a string to a double value.  The result is correctly rounded.
  *
  ****************************************************************************/
 
 double strtod(FAR const char *str, FAR char **endptr)
 {
-  double number;
-  int exponent;
-  int negative;
-  FAR char *p = (FAR char *) str;
-  double p10;
-  int n;
-  int num_digits;
-  int num_decimals;
-  const double infinite = 1.0 / 0.0;
-
-  /* Skip leading whitespace */
-
-  while (isspace(*p))
+  struct strtod_decimal_s dec;
+  union
+  {
+    double   d;
+    uint64_t u;
+  } value;
+
+  if (!__strtod_parse(str, endptr, &dec))
     {
-      p++;
+      return 0.0;
     }
 
-  /* Handle optional sign */
+  /* Clinger's fast path:  If the mantissa and the power of ten are both
+   * exactly representable, a single correctly rounded multiplication or
+   * division gives the correctly rounded result.
+   */
 
-  negative = 0;
-  switch (*p)
+  if (dec.special == STRTOD_FINITE && !dec.truncated &&
+      dec.mantissa <= ((uint64_t)1 << 53) &&
+      dec.exponent >= -DOUBLE_MAX_POW10 && dec.exponent <= DOUBLE_MAX_POW10)
     {
-    case '-':
-      negative = 1; /* Fall through to increment position */
-
-      /* FALLTHROUGH */
-
-    case '+':
-      p++;
-
-      /* FALLTHROUGH */
-
-    default:
-      break;
-    }
-
-  number       = 0.;
-  exponent     = 0;
-  num_digits   = 0;
-  num_decimals = 0;
-
-  /* Process string of digits */
-
-  while (isdigit(*p))
-    {
-      number = number * 10. + (*p - '0');
-      p++;
-      num_digits++;
-    }
-
-  /* Process decimal part */
-
-  if (*p == '.')
-    {
-      p++;
-
-      while (isdigit(*p))
+      value.d = (double)dec.mantissa;
+      if (dec.exponent < 0)
         {
-          number = number * 10. + (*p - '0');
-          p++;
-          num_digits++;
-          num_decimals++;
-        }
-
-      exponent -= num_decimals;
-    }
-
-  if (num_digits == 0)
-    {
-      set_errno(ERANGE);
-      number = 0.0;
-      goto errout;
-    }
-
-  /* Correct for sign */
-
-  if (negative)
-    {
-      number = -number;
-    }
-
-  /* Process an exponent string */
-
-  if (*p == 'e' || *p == 'E')
-    {
-      /* Handle optional sign */
-
-      negative = 0;
-      switch (*++p)
-        {
-        case '-':
-          negative = 1;   /* Fall through to increment pos */
-
-          /* FALLTHROUGH */
-
-        case '+':
-          p++;
-
-          /* FALLTHROUGH */
-
-        default:
-          break;
-        }
-
-      /* Process string of digits */
-
-      n = 0;
-      while (isdigit(*p))
-        {
-          n = n * 10 + (*p - '0');
-          p++;
-        }
-
-      if (negative)
-        {
-          exponent -= n;
+          value.d /= g_double_pow10[0 - dec.exponent];
         }
       else
         {
-          exponent += n;
+          value.d *= g_double_pow10[dec.exponent];
         }
     }
-
-  if (exponent < __DBL_MIN_EXP__ ||
-      exponent > __DBL_MAX_EXP__)
-    {
-      set_errno(ERANGE);
-      number = infinite;
-      goto errout;
-    }
-
-  /* Scale the result */
-
-  p10 = 10.;
-  n = exponent;
-  if (n < 0)
-    {
-      n = -n;
-    }
-
-  while (n)
-    {
-      if (n & 1)
-        {
-          if (exponent < 0)
-            {
-              number /= p10;
-            }
-          else
-            {
-              number *= p10;
-            }
-        }
-
-      n >>= 1;
-      p10 *= p10;
-    }
-
-  if (!is_real(number))
-    {
-      set_errno(ERANGE);
-    }
-
-errout:
-  if (endptr)
+  else
     {
-      *endptr = p;
+      value.u = __strtod_engine(&dec, &g_double_format);
     }
 
-  return number;
+  return dec.negative ? -value.d : value.d;
 }
 
 #endif /* CONFIG_HAVE_DOUBLE */
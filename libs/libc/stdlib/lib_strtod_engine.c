@@ -0,0 +1,753 @@
+/****************************************************************************
+ * libs/libc/stdlib/lib_strtod_engine.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The fast path is the algorithm of Eisel and Lemire as described in
+ * "Number Parsing at a Gigabyte per Second" (Daniel Lemire, 2021) and
+ * "Fast Number Parsing Without Fallback" (Noble Mushtak and Daniel Lemire,
+ * 2023).  Inputs with more significant digits than fit in 64 bits whose
+ * rounding cannot be decided from the leading digits are resolved exactly
+ * with big integer arithmetic.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <stdint.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "libc.h"
+#include "lib_strtod_engine.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Halfway points between adjacent doubles have at most 767 significant
+ * decimal digits, so digits beyond this only matter as a sticky bit.
+ */
+
+#define STRTOD_MAX_DIGITS   768
+
+/* Exponents larger than this saturate while scanning.  It is small enough
+ * that STRTOD_MAX_EXPONENT * 10 + 9 does not overflow an int32_t.
+ */
+
+#define STRTOD_MAX_EXPONENT 100000000
+
+/* The largest power of five that fits in a 32-bit limb */
+
+#define POW5_LIMB           1220703125u
+#define POW5_LIMB_EXP       13
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: strtod_match
+ *
+ * Description:
+ *   Case-insensitively match the lower case string 'word' at 'p'.
+ *
+ ****************************************************************************/
+
+static bool strtod_match(FAR const char *p, FAR const char *word)
+{
+  while (*word != '\0')
+    {
+      if (tolower(*p++) != *word++)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: strtod_clz64
+ ****************************************************************************/
+
+static inline int strtod_clz64(uint64_t x)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+
+  while ((x & 0x8000000000000000ull) == 0)
+    {
+      x <<= 1;
+      n++;
+    }
+
+  return n;
+#endif
+}
+
+/****************************************************************************
+ * Name: strtod_mul128
+ *
+ * Description:
+ *   Full 64x64->128 bit multiplication.
+ *
+ ****************************************************************************/
+
+static void strtod_mul128(uint64_t a, uint64_t b, FAR uint64_t *hi,
+                          FAR uint64_t *lo)
+{
+  uint64_t alo = (uint32_t)a;
+  uint64_t ahi = a >> 32;
+  uint64_t blo = (uint32_t)b;
+  uint64_t bhi = b >> 32;
+  uint64_t p0  = alo * blo;
+  uint64_t p1  = alo * bhi;
+  uint64_t p2  = ahi * blo;
+  uint64_t p3  = ahi * bhi;
+  uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+
+  *lo = (mid << 32) | (uint32_t)p0;
+  *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
+/****************************************************************************
+ * Name: strtod_eisel_lemire
+ *
+ * Description:
+ *   Compute the bit pattern of w * 10^q correctly rounded to 'fmt'.  w must
+ *   be non-zero and q within [minpow10, maxpow10].
+ *
+ ****************************************************************************/
+
+static uint64_t strtod_eisel_lemire(uint64_t w, int q,
+                                    FAR const struct strtod_format_s *fmt)
+{
+  FAR const uint64_t *pow5;
+  uint64_t mask;
+  uint64_t mant;
+  uint64_t hi;
+  uint64_t lo;
+  uint64_t hi2;
+  uint64_t lo2;
+  int upperbit;
+  int power2;
+  int shift;
+  int lz;
+
+  lz = strtod_clz64(w);
+  w <<= lz;
+
+  /* Multiply by the 128-bit approximation of 5^q.  The low half of the
+   * power is only needed if the bits below the final precision of the
+   * first product are all ones.
+   */
+
+  pow5 = &g_strtod_pow5[2 * (q - STRTOD_POW5_MIN)];
+  strtod_mul128(w, pow5[0], &hi, &lo);
+
+  mask = UINT64_MAX >> (fmt->mbits + 3);
+  if ((hi & mask) == mask)
+    {
+      strtod_mul128(w, pow5[1], &hi2, &lo2);
+      lo += hi2;
+      if (hi2 > lo)
+        {
+          hi++;
+        }
+    }
+
+  upperbit = (int)(hi >> 63);
+  shift    = upperbit + 64 - fmt->mbits - 3;
+  mant     = hi >> shift;
+
+  /* floor(q * log2(10)) + 63, exact over the range of the table */
+
+  power2   = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz -
+             fmt->minexp;
+
+  if (power2 <= 0)
+    {
+      /* Subnormal (or zero) result */
+
+      if (-power2 + 1 >= 64)
+        {
+          return 0;
+        }
+
+      mant >>= -power2 + 1;
+      mant  += mant & 1;
+      mant >>= 1;
+
+      /* Rounding may have carried into the smallest normal exponent, in
+       * which case the implicit bit lands in the exponent field.
+       */
+
+      return mant;
+    }
+
+  /* Exact halfway cases can only occur for small powers of ten.  If only
+   * zeros were shifted out, round to even rather than up.
+   */
+
+  if (lo <= 1 && q >= fmt->rtemin && q <= fmt->rtemax &&
+      (mant & 3) == 1 && (mant << shift) == hi)
+    {
+      mant &= ~(uint64_t)1;
+    }
+
+  mant += mant & 1;
+  mant >>= 1;
+
+  if (mant >= ((uint64_t)2 << fmt->mbits))
+    {
+      mant = (uint64_t)1 << fmt->mbits;
+      power2++;
+    }
+
+  mant &= ~((uint64_t)1 << fmt->mbits);
+
+  if (power2 >= fmt->infexp)
+    {
+      return (uint64_t)fmt->infexp << fmt->mbits;
+    }
+
+  return ((uint64_t)power2 << fmt->mbits) | mant;
+}
+
+/****************************************************************************
+ * Name: bigint_muladd
+ *
+ * Description:
+ *   a = a * m + add.  Returns the new number of limbs.
+ *
+ ****************************************************************************/
+
+static int bigint_muladd(FAR uint32_t *a, int n, uint32_t m, uint32_t add)
+{
+  uint64_t carry = add;
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      carry += (uint64_t)a[i] * m;
+      a[i]   = (uint32_t)carry;
+      carry >>= 32;
+    }
+
+  if (carry != 0)
+    {
+      a[n++] = (uint32_t)carry;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: bigint_mulpow5
+ ****************************************************************************/
+
+static int bigint_mulpow5(FAR uint32_t *a, int n, int p)
+{
+  static const uint32_t pow5[POW5_LIMB_EXP] =
+  {
+    1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625,
+    48828125, 244140625
+  };
+
+  for (; p >= POW5_LIMB_EXP; p -= POW5_LIMB_EXP)
+    {
+      n = bigint_muladd(a, n, POW5_LIMB, 0);
+    }
+
+  return p > 0 ? bigint_muladd(a, n, pow5[p], 0) : n;
+}
+
+/****************************************************************************
+ * Name: bigint_shl
+ ****************************************************************************/
+
+static int bigint_shl(FAR uint32_t *a, int n, int bits)
+{
+  int limbs = bits / 32;
+  int shift = bits % 32;
+  int i;
+
+  if (shift != 0)
+    {
+      a[n] = 0;
+      for (i = n; i > 0; i--)
+        {
+          a[i] = (a[i] << shift) | (a[i - 1] >> (32 - shift));
+        }
+
+      a[0] <<= shift;
+      if (a[n] != 0)
+        {
+          n++;
+        }
+    }
+
+  if (limbs > 0)
+    {
+      for (i = n - 1; i >= 0; i--)
+        {
+          a[i + limbs] = a[i];
+        }
+
+      for (i = 0; i < limbs; i++)
+        {
+          a[i] = 0;
+        }
+
+      n += limbs;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: bigint_cmp
+ ****************************************************************************/
+
+static int bigint_cmp(FAR const uint32_t *a, int na,
+                      FAR const uint32_t *b, int nb)
+{
+  int i;
+
+  while (na > 0 && a[na - 1] == 0)
+    {
+      na--;
+    }
+
+  while (nb > 0 && b[nb - 1] == 0)
+    {
+      nb--;
+    }
+
+  if (na != nb)
+    {
+      return na > nb ? 1 : -1;
+    }
+
+  for (i = na - 1; i >= 0; i--)
+    {
+      if (a[i] != b[i])
+        {
+          return a[i] > b[i] ? 1 : -1;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: strtod_slowpath
+ *
+ * Description:
+ *   The value lies between the adjacent representable values 'bits' and
+ *   'bits + 1'.  Decide which one is nearest by comparing all of the
+ *   decimal digits against the halfway point between them.
+ *
+ ****************************************************************************/
+
+static uint64_t strtod_slowpath(FAR const struct strtod_decimal_s *dec,
+                                FAR const struct strtod_format_s *fmt,
+                                uint64_t bits)
+{
+  FAR const char *p = dec->digits;
+  FAR uint32_t *left;
+  FAR uint32_t *right;
+  uint64_t mant;
+  uint32_t chunk;
+  bool sticky = false;
+  int biased;
+  int nkeep;
+  int nleft;
+  int nright;
+  int nlimbs;
+  int bitsl;
+  int bitsr;
+  int chunkdigits;
+  int e;
+  int k;
+  int s;
+  int i;
+  int ret;
+
+  /* bits represents mant * 2^k.  The halfway point to the next value up is
+   * (2 * mant + 1) * 2^(k - 1).
+   */
+
+  biased = (int)(bits >> fmt->mbits);
+  mant   = bits & (((uint64_t)1 << fmt->mbits) - 1);
+  if (biased != 0)
+    {
+      mant |= (uint64_t)1 << fmt->mbits;
+    }
+  else
+    {
+      biased = 1;
+    }
+
+  k = biased + fmt->minexp - fmt->mbits;
+
+  /* The decimal value is N * 10^e where N holds the first nkeep digits */
+
+  nkeep = dec->ndigits < STRTOD_MAX_DIGITS ?
+          dec->ndigits : STRTOD_MAX_DIGITS;
+  e     = dec->exponent - (nkeep - (dec->ndigits < STRTOD_MANT_DIGITS ?
+                                    dec->ndigits : STRTOD_MANT_DIGITS));
+
+  /* Compare N * 5^max(e,0) * 2^max(s,0) against
+   * (2 * mant + 1) * 5^max(-e,0) * 2^max(-s,0).
+   */
+
+  s     = e - (k - 1);
+  bitsl = nkeep * 10 / 3 + 1 + (e > 0 ? e * 7 / 3 + 1 : 0) + (s > 0 ? s : 0);
+  bitsr = fmt->mbits + 3 + (e < 0 ? -e * 7 / 3 + 1 : 0) + (s < 0 ? -s : 0);
+  nlimbs = (bitsl > bitsr ? bitsl : bitsr) / 32 + 3;
+
+  left = lib_malloc(2 * nlimbs * sizeof(uint32_t));
+  if (left == NULL)
+    {
+      /* Out of memory.  bits is within one unit of the correct result. */
+
+      return bits;
+    }
+
+  right = left + nlimbs;
+
+  /* Load the digits, nine at a time */
+
+  nleft       = 0;
+  chunk       = 0;
+  chunkdigits = 0;
+
+  for (i = 0; i < dec->ndigits; p++)
+    {
+      if (*p == '.')
+        {
+          continue;
+        }
+
+      if (i < nkeep)
+        {
+          chunk = chunk * 10 + (*p - '0');
+          if (++chunkdigits == 9)
+            {
+              nleft       = bigint_muladd(left, nleft, 1000000000u, chunk);
+              chunk       = 0;
+              chunkdigits = 0;
+            }
+        }
+      else if (*p != '0')
+        {
+          sticky = true;
+          break;
+        }
+
+      i++;
+    }
+
+  if (chunkdigits > 0)
+    {
+      static const uint32_t pow10[9] =
+      {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+      };
+
+      nleft = bigint_muladd(left, nleft, pow10[chunkdigits], chunk);
+    }
+
+  /* Scale both sides */
+
+  right[0] = (uint32_t)(2 * mant + 1);
+  right[1] = (uint32_t)((2 * mant + 1) >> 32);
+  nright   = right[1] != 0 ? 2 : 1;
+
+  if (e > 0)
+    {
+      nleft = bigint_mulpow5(left, nleft, e);
+    }
+  else if (e < 0)
+    {
+      nright = bigint_mulpow5(right, nright, -e);
+    }
+
+  if (s > 0)
+    {
+      nleft = bigint_shl(left, nleft, s);
+    }
+  else if (s < 0)
+    {
+      nright = bigint_shl(right, nright, -s);
+    }
+
+  ret = bigint_cmp(left, nleft, right, nright);
+  lib_free(left);
+
+  /* Round to nearest, ties to even */
+
+  if (ret > 0 || (ret == 0 && sticky) || (ret == 0 && (mant & 1) != 0))
+    {
+      bits++;
+    }
+
+  return bits;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: __strtod_parse
+ ****************************************************************************/
+
+bool __strtod_parse(FAR const char *str, FAR char **endptr,
+                    FAR struct strtod_decimal_s *dec)
+{
+  FAR const char *p = str;
+  bool digits = false;
+  int d;
+
+  dec->mantissa  = 0;
+  dec->exponent  = 0;
+  dec->ndigits   = 0;
+  dec->digits    = NULL;
+  dec->negative  = false;
+  dec->truncated = false;
+  dec->special   = STRTOD_FINITE;
+
+  /* Skip leading whitespace and handle optional sign */
+
+  while (isspace(*p))
+    {
+      p++;
+    }
+
+  if (*p == '-' || *p == '+')
+    {
+      dec->negative = *p++ == '-';
+    }
+
+  /* Infinity and NaN */
+
+  if (strtod_match(p, "inf"))
+    {
+      p += strtod_match(p, "infinity") ? 8 : 3;
+      dec->special = STRTOD_INF;
+      goto out;
+    }
+
+  if (strtod_match(p, "nan"))
+    {
+      p += 3;
+      if (*p == '(')
+        {
+          FAR const char *q = p + 1;
+
+          while (isalnum(*q) || *q == '_')
+            {
+              q++;
+            }
+
+          if (*q == ')')
+            {
+              p = q + 1;
+            }
+        }
+
+      dec->special = STRTOD_NAN;
+      goto out;
+    }
+
+  /* Integer part.  Leading zeros are not significant. */
+
+  for (; isdigit(*p); p++)
+    {
+      digits = true;
+      d = *p - '0';
+      if (d == 0 && dec->ndigits == 0)
+        {
+          continue;
+        }
+
+      if (dec->ndigits == 0)
+        {
+          dec->digits = p;
+        }
+
+      if (dec->ndigits < STRTOD_MANT_DIGITS)
+        {
+          dec->mantissa = dec->mantissa * 10 + d;
+        }
+      else
+        {
+          dec->exponent++;
+          dec->truncated |= d != 0;
+        }
+
+      dec->ndigits++;
+    }
+
+  /* Fractional part */
+
+  if (*p == '.')
+    {
+      for (p++; isdigit(*p); p++)
+        {
+          digits = true;
+          d = *p - '0';
+          if (d == 0 && dec->ndigits == 0)
+            {
+              dec->exponent--;
+              continue;
+            }
+
+          if (dec->ndigits == 0)
+            {
+              dec->digits = p;
+            }
+
+          if (dec->ndigits < STRTOD_MANT_DIGITS)
+            {
+              dec->mantissa = dec->mantissa * 10 + d;
+              dec->exponent--;
+            }
+          else
+            {
+              dec->truncated |= d != 0;
+            }
+
+          dec->ndigits++;
+        }
+    }
+
+  if (!digits)
+    {
+      p = str;
+      goto out;
+    }
+
+  /* Optional exponent.  It is only consumed if at least one digit
+   * follows.
+   */
+
+  if (*p == 'e' || *p == 'E')
+    {
+      FAR const char *q = p + 1;
+      bool negative = false;
+      int32_t n = 0;
+
+      if (*q == '-' || *q == '+')
+        {
+          negative = *q++ == '-';
+        }
+
+      if (isdigit(*q))
+        {
+          for (; isdigit(*q); q++)
+            {
+              if (n < STRTOD_MAX_EXPONENT)
+                {
+                  n = n * 10 + (*q - '0');
+                }
+              else
+                {
+                  n = STRTOD_MAX_EXPONENT;
+                }
+            }
+
+          dec->exponent += negative ? -n : n;
+          p = q;
+        }
+    }
+
+out:
+  if (endptr != NULL)
+    {
+      *endptr = (FAR char *)p;
+    }
+
+  return digits || dec->special != STRTOD_FINITE;
+}
+
+/****************************************************************************
+ * Name: __strtod_engine
+ ****************************************************************************/
+
+uint64_t __strtod_engine(FAR const struct strtod_decimal_s *dec,
+                         FAR const struct strtod_format_s *fmt)
+{
+  uint64_t infbits = (uint64_t)fmt->infexp << fmt->mbits;
+  uint64_t bits;
+
+  if (dec->special == STRTOD_INF)
+    {
+      return infbits;
+    }
+  else if (dec->special == STRTOD_NAN)
+    {
+      return infbits | ((uint64_t)1 << (fmt->mbits - 1));
+    }
+  else if (dec->mantissa == 0)
+    {
+      return 0;
+    }
+
+  if (dec->exponent < fmt->minpow10)
+    {
+      bits = 0;
+    }
+  else if (dec->exponent > fmt->maxpow10)
+    {
+      bits = infbits;
+    }
+  else
+    {
+      bits = strtod_eisel_lemire(dec->mantissa, dec->exponent, fmt);
+
+      /* If digits were dropped, the value lies between mantissa and
+       * mantissa + 1 scaled by the same power of ten.  If those round
+       * differently, all of the digits are needed to decide.
+       */
+
+      if (dec->truncated &&
+          strtod_eisel_lemire(dec->mantissa + 1, dec->exponent, fmt) != bits)
+        {
+          bits = strtod_slowpath(dec, fmt, bits);
+        }
+    }
+
+  /* Overflow, underflow to zero and subnormal results are range errors */
+
+  if (bits < ((uint64_t)1 << fmt->mbits) || bits == infbits)
+    {
+      set_errno(ERANGE);
+    }
+
+  return bits;
+}
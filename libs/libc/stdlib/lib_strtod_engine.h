@@ -0,0 +1,122 @@
+/****************************************************************************
+ * libs/libc/stdlib/lib_strtod_engine.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __LIBS_LIBC_STDLIB_LIB_STRTOD_ENGINE_H
+#define __LIBS_LIBC_STDLIB_LIB_STRTOD_ENGINE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Range of the table of 128-bit powers of five */
+
+#define STRTOD_POW5_MIN     (-342)
+#define STRTOD_POW5_MAX     308
+
+/* The number of decimal digits that fit in the 64-bit mantissa */
+
+#define STRTOD_MANT_DIGITS  19
+
+/* Special values recognized by __strtod_parse() */
+
+#define STRTOD_FINITE       0
+#define STRTOD_INF          1
+#define STRTOD_NAN          2
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A decimal number as scanned from the input string:
+ *
+ *   value = mantissa * 10^exponent (+ any truncated digits)
+ */
+
+struct strtod_decimal_s
+{
+  uint64_t mantissa;          /* First STRTOD_MANT_DIGITS significant digits */
+  int32_t exponent;           /* Power of ten applying to mantissa */
+  int32_t ndigits;            /* Total number of significant digits */
+  FAR const char *digits;     /* First significant digit in the string */
+  bool negative;              /* A minus sign was present */
+  bool truncated;             /* Non-zero digits did not fit in mantissa */
+  uint8_t special;            /* STRTOD_FINITE, STRTOD_INF or STRTOD_NAN */
+};
+
+/* Description of an IEEE 754 binary format */
+
+struct strtod_format_s
+{
+  uint8_t mbits;              /* Explicit mantissa bits */
+  int16_t minexp;             /* Minimum exponent (-bias) */
+  int16_t infexp;             /* Biased exponent of infinity */
+  int16_t minpow10;           /* Smaller powers of ten always give zero */
+  int16_t maxpow10;           /* Larger powers of ten always overflow */
+  int8_t  rtemin;             /* Range of powers of ten where exact ... */
+  int8_t  rtemax;             /* ... halfway cases are possible */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern const uint64_t g_strtod_pow5[];
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: __strtod_parse
+ *
+ * Description:
+ *   Scan a decimal floating point number (or inf/nan) from 'str'.  Returns
+ *   false if no conversion could be performed.  In either case, *endptr
+ *   (if not NULL) is set to the first character that was not consumed.
+ *
+ ****************************************************************************/
+
+bool __strtod_parse(FAR const char *str, FAR char **endptr,
+                    FAR struct strtod_decimal_s *dec);
+
+/****************************************************************************
+ * Name: __strtod_engine
+ *
+ * Description:
+ *   Return the bit pattern (without the sign bit) of the value of 'dec'
+ *   correctly rounded to the binary format 'fmt'.  errno is set to ERANGE
+ *   on overflow or underflow to zero.
+ *
+ ****************************************************************************/
+
+uint64_t __strtod_engine(FAR const struct strtod_decimal_s *dec,
+                         FAR const struct strtod_format_s *fmt);
+
+#endif /* __LIBS_LIBC_STDLIB_LIB_STRTOD_ENGINE_H */
@@ -1,39 +1,20 @@
 /****************************************************************************
  * libs/libc/stdlib/lib_strtof.c
- * Convert string to float
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
  *
- * A pretty straight forward conversion fo strtod():
+ *   http://www.apache.org/licenses/LICENSE-2.0
  *
- *   Copyright (C) 2002 Michael Ringgaard. All rights reserved.
- *   Copyright (C) 2006-2007 H. Peter Anvin.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. Neither the name of the project nor the names of its contributors
- *    may be used to endorse or promote products derived from this software
- *    without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
- * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
- * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
- * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
- * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
- * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
- * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
- * OF THE POSSIBILITY OF SUCH DAMAGE.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
  *
  ****************************************************************************/
 
@@ -45,220 +26,85 @@
 #include <nuttx/compiler.h>
 
 #include <stdlib.h>
-#include <ctype.h>
-#include <errno.h>
+#include <stdint.h>
 
-/****************************************************************************
- * Pre-processor definitions
- ****************************************************************************/
-
-/* These are predefined with GCC, but could be issues for other compilers. If
- * not defined, an arbitrary big number is put in for now.  These should be
- * added to nuttx/compiler for your compiler.
- */
-
-#if !defined(__FLT_MIN_EXP__) || !defined(__FLT_MAX_EXP__)
-#  ifdef CONFIG_CPP_HAVE_WARNING
-#    warning "Size of exponent is unknown"
-#  endif
-#  undef  __FLT_MIN_EXP__
-#  define __FLT_MIN_EXP__ (-125)
-#  undef  __FLT_MAX_EXP__
-#  define __FLT_MAX_EXP__ (128)
-#endif
+#include "lib_strtod_engine.h"
 
 /****************************************************************************
- * Private Functions
+ * Private Data
  ****************************************************************************/
 
-static inline int is_real(float x)
+/* IEEE 754 binary32 */
+
+static const struct strtod_format_s g_float_format =
 {
-  const float infinite = 1.0F / 0.0F;
-  return (x < infinite) && (x >= -infinite);
-}
+  23,                         /* mbits */
+  -127,                       /* minexp */
+  0xff,                       /* infexp */
+  -64,                        /* minpow10 */
+  38,                         /* maxpow10 */
+  -17,                        /* rtemin */
+  10                          /* rtemax */
+};
+
+/* Powers of ten that are exactly representable as a float */
+
+static const float g_float_pow10[] =
+{
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+#define FLOAT_MAX_POW10 10
 
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-/***************************************************(************************
+/****************************************************************************
  * Name: strtof
  *
  * Description:
- *   Convert a string to a float value
+ *   Convert a string to a float value.  The result is correctly rounded.
  *
  ****************************************************************************/
 
 float strtof(FAR const char *str, FAR char **endptr)
 {
-  float number;
-  int exponent;
-  int negative;
-  FAR char *p = (FAR char *) str;
-  float p10;
-  int n;
-  int num_digits;
-  int num_decimals;
-  const float infinite = 1.0F / 0.0F;
-
-  /* Skip leading whitespace */
-
-  while (isspace(*p))
-    {
-      p++;
-    }
-
-  /* Handle optional sign */
-
-  negative = 0;
-  switch (*p)
+  struct strtod_decimal_s dec;
+  union
+  {
+    float    f;
+    uint32_t u;
+  } value;
+
+  if (!__strtod_parse(str, endptr, &dec))
     {
-    case '-':
-      negative = 1; /* Fall through to increment position */
-
-      /* FALLTHROUGH */
-
-    case '+':
-      p++;
-
-      /* FALLTHROUGH */
-
-    default:
-      break;
-    }
-
-  number       = 0.0F;
-  exponent     = 0;
-  num_digits   = 0;
-  num_decimals = 0;
-
-  /* Process string of digits */
-
-  while (isdigit(*p))
-    {
-      number = number * 10.0F + (float)(*p - '0');
-      p++;
-      num_digits++;
+      return 0.0f;
     }
 
-  /* Process decimal part */
+  /* Clinger's fast path:  If the mantissa and the power of ten are both
+   * exactly representable, a single correctly rounded multiplication or
+   * division gives the correctly rounded result.
+   */
 
-  if (*p == '.')
+  if (dec.special == STRTOD_FINITE && !dec.truncated &&
+      dec.mantissa <= ((uint64_t)1 << 24) &&
+      dec.exponent >= -FLOAT_MAX_POW10 && dec.exponent <= FLOAT_MAX_POW10)
     {
-      p++;
-
-      while (isdigit(*p))
+      value.f = (float)dec.mantissa;
+      if (dec.exponent < 0)
         {
-          number = number * 10.0F + (float)(*p - '0');
-          p++;
-          num_digits++;
-          num_decimals++;
-        }
-
-      exponent -= num_decimals;
-    }
-
-  if (num_digits == 0)
-    {
-      set_errno(ERANGE);
-      number = 0.0F;
-      goto errout;
-    }
-
-  /* Correct for sign */
-
-  if (negative)
-    {
-      number = -number;
-    }
-
-  /* Process an exponent string */
-
-  if (*p == 'e' || *p == 'E')
-    {
-      /* Handle optional sign */
-
-      negative = 0;
-      switch (*++p)
-        {
-        case '-':
-          negative = 1;   /* Fall through to increment pos */
-
-          /* FALLTHROUGH */
-
-        case '+':
-          p++;
-
-          /* FALLTHROUGH */
-
-        default:
-          break;
-        }
-
-      /* Process string of digits */
-
-      n = 0;
-      while (isdigit(*p))
-        {
-          n = n * 10 + (*p - '0');
-          p++;
-        }
-
-      if (negative)
-        {
-          exponent -= n;
+          value.f /= g_float_pow10[0 - dec.exponent];
         }
       else
         {
-          exponent += n;
+          value.f *= g_float_pow10[dec.exponent];
         }
     }
-
-  if (exponent < __FLT_MIN_EXP__ ||
-      exponent > __FLT_MAX_EXP__)
-    {
-      set_errno(ERANGE);
-      number = infinite;
-      goto errout;
-    }
-
-  /* Scale the result */
-
-  p10 = 10.0F;
-  n = exponent;
-  if (n < 0)
-    {
-      n = -n;
-    }
-
-  while (n)
-    {
-      if (n & 1)
-        {
-          if (exponent < 0)
-            {
-              number /= p10;
-            }
-          else
-            {
-              number *= p10;
-            }
-        }
-
-      n >>= 1;
-      p10 *= p10;
-    }
-
-  if (!is_real(number))
-    {
-      set_errno(ERANGE);
-    }
-
-errout:
-  if (endptr)
+  else
     {
-      *endptr = p;
+      value.u = (uint32_t)__strtod_engine(&dec, &g_float_format);
     }
 
-  return number;
+  return dec.negative ? -value.f : value.f;
 }
@@ -87,6 +87,17 @@ static inline int is_real(long double x)
  *
  ****************************************************************************/
 
+#if defined(CONFIG_HAVE_DOUBLE) && defined(__LDBL_MANT_DIG__) && \
+    defined(__DBL_MANT_DIG__) && __LDBL_MANT_DIG__ == __DBL_MANT_DIG__
+long double strtold(FAR const char *str, FAR char **endptr)
+{
+  /* long double has the same format as double, so use the correctly
+   * rounded strtod().
+   */
+
+  return strtod(str, endptr);
+}
+#else
 long double strtold(FAR const char *str, FAR char **endptr)
 {
   long double number;
@@ -260,5 +271,6 @@ errout:
 
   return number;
 }
+#endif
 
 #endif /* CONFIG_HAVE_LONG_DOUBLE */
@@ -331,10 +331,13 @@ int ipv4_input(FAR struct net_driver_s *dev)
     }
 #endif
 
-  if (ipv4_chksum(dev) != 0xffff)
-    {
-      /* Compute and check the IP header checksum. */
+  /* Compute and check the IP header checksum, unless the driver has
+   * already verified it.
+   */
 
+  if (!NETDEV_HAS_FEATURE(dev, NETDEV_FEATURE_RXCSUM_IP) &&
+      ipv4_chksum(dev) != 0xffff)
+    {
 #ifdef CONFIG_NET_STATISTICS
       g_netstats.ipv4.drop++;
       g_netstats.ipv4.chkerr++;
@@ -147,15 +147,21 @@ static void sendto_request(FAR struct net_driver_s *dev,
   /* Calculate IP checksum. */
 
   ipv4->ipchksum    = 0;
-  ipv4->ipchksum    = ~(ipv4_chksum(dev));
+  if (!NETDEV_HAS_FEATURE(dev, NETDEV_FEATURE_TXCSUM_IP))
+    {
+      ipv4->ipchksum = ~(ipv4_chksum(dev));
+    }
 
   /* Calculate the ICMP checksum. */
 
   icmp->icmpchksum  = 0;
-  icmp->icmpchksum  = ~(icmp_chksum(dev, pstate->snd_buflen));
-  if (icmp->icmpchksum == 0)
+  if (!NETDEV_HAS_FEATURE(dev, NETDEV_FEATURE_TXCSUM_L4))
     {
-      icmp->icmpchksum = 0xffff;
+      icmp->icmpchksum = ~(icmp_chksum(dev, pstate->snd_buflen));
+      if (icmp->icmpchksum == 0)
+        {
+          icmp->icmpchksum = 0xffff;
+        }
     }
 
   ninfo("Outgoing ICMP packet length: %d (%d)\n",
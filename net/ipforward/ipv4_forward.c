@@ -138,8 +138,6 @@ static int ipv4_hdrsize(FAR struct ipv4_hdr_s *ipv4)
 
 static int ipv4_decr_ttl(FAR struct ipv4_hdr_s *ipv4)
 {
-  uint16_t iphdrlen;
-  uint16_t sum;
   int ttl;
 
   /* Check time-to-live (TTL) */
@@ -162,27 +160,14 @@ static int ipv4_decr_ttl(FAR struct ipv4_hdr_s *ipv4)
 
   ipv4->ttl = ttl;
 
-  /* Get the IP header length (accounting for possible options). */
-
-  iphdrlen = (ipv4->vhl & IPv4_HLMASK) << 2;
-
-  /* Re-calculate the IPv4 checksum.  This checksum is the Internet checksum
-   * of the 20 bytes of the IPv4 header.  This checksum will be different
-   * because we just modify the IPv4 TTL.
+  /* Update the IPv4 header checksum.  Only the TTL changed, so there is no
+   * need to sum the whole header again:  Adjust the checksum for the change
+   * of the 16-bit word holding the TTL and the protocol.
    */
 
-  ipv4->ipchksum = 0;
-  sum            = chksum(0, (FAR const uint8_t *)ipv4, iphdrlen);
-  if (sum == 0)
-    {
-      sum = 0xffff;
-    }
-  else
-    {
-      sum = htons(sum);
-    }
-
-  ipv4->ipchksum = ~sum;
+  ipv4->ipchksum = net_chksum_adjust(ipv4->ipchksum,
+                                     HTONS(((ttl + 1) << 8) | ipv4->proto),
+                                     HTONS((ttl << 8) | ipv4->proto));
   return ttl;
 }
 
@@ -128,6 +128,7 @@ int local_send_packet(FAR struct file *filep, FAR const struct iovec *buf,
 {
   FAR const struct iovec *end = buf + len;
   FAR const struct iovec *iov;
+  ssize_t nsent;
   int ret = -EINVAL;
   uint16_t len16;
 
@@ -156,18 +157,43 @@ int local_send_packet(FAR struct file *filep, FAR const struct iovec *buf,
         }
     }
 
-  for (len16 = 0, iov = buf; iov != end; iov++)
+  /* Send the whole payload with one gather write so that the FIFO is
+   * locked once rather than once per segment.
+   */
+
+  nsent = file_writev(filep, buf, len);
+  if (nsent < 0)
     {
-      ret = local_fifo_write(filep, iov->iov_base, iov->iov_len);
-      if (ret < 0)
+      if (nsent != -EINTR)
         {
-          break;
+          nerr("ERROR: file_writev failed: %zd\n", nsent);
+          return nsent;
         }
 
-      if (ret > 0)
+      nsent = 0;
+    }
+
+  /* Complete any partial transfer one segment at a time */
+
+  for (len16 = 0, iov = buf; iov != end; iov++)
+    {
+      size_t done = (size_t)nsent < iov->iov_len ? nsent : iov->iov_len;
+
+      nsent -= done;
+      len16 += done;
+
+      if (done < iov->iov_len)
         {
+          ret = local_fifo_write(filep,
+                                 (FAR const uint8_t *)iov->iov_base + done,
+                                 iov->iov_len - done);
+          if (ret < 0)
+            {
+              break;
+            }
+
           len16 += ret;
-          if (ret != iov->iov_len)
+          if (ret != iov->iov_len - done)
             {
               break;
             }
@@ -24,10 +24,12 @@
 
 #include <nuttx/config.h>
 
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
 
 #include <nuttx/cancelpt.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/net/net.h>
 
 #include "socket/socket.h"
@@ -69,6 +71,13 @@
 ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
                        int flags)
 {
+  FAR const struct iovec *iov;
+  FAR const struct iovec *end;
+  FAR uint8_t *buf;
+  struct iovec bounce;
+  size_t len;
+  ssize_t ret;
+
   /* Verify that non-NULL pointers were passed */
 
   if (msg == NULL || msg->msg_iov == NULL || msg->msg_iov->iov_base == NULL)
@@ -81,11 +90,6 @@ ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
       return -EINVAL;
     }
 
-  if (msg->msg_iovlen != 1)
-    {
-      return -ENOTSUP;
-    }
-
   /* Verify that the sockfd corresponds to valid, allocated socket */
 
   if (psock == NULL || psock->s_conn == NULL)
@@ -100,7 +104,57 @@ ssize_t psock_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
   DEBUGASSERT(psock->s_sockif != NULL &&
               psock->s_sockif->si_recvmsg != NULL);
 
-  return psock->s_sockif->si_recvmsg(psock, msg, flags);
+  if (msg->msg_iovlen == 1)
+    {
+      return psock->s_sockif->si_recvmsg(psock, msg, flags);
+    }
+
+  /* The address families receive into msg_iov[0] only.  Receive once into
+   * a bounce buffer and scatter the data:  A datagram must not be split
+   * across several receive calls, and calling si_recvmsg() once per iovec
+   * on a stream socket could block on a later iovec after data was
+   * already received, since not every address family honors MSG_DONTWAIT.
+   * Single-iovec receives, the common case, take the direct path above.
+   */
+
+  end = &msg->msg_iov[msg->msg_iovlen];
+  for (len = 0, iov = msg->msg_iov; iov != end; iov++)
+    {
+      len += iov->iov_len;
+    }
+
+  buf = kmm_malloc(len);
+  if (buf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  bounce.iov_base = buf;
+  bounce.iov_len  = len;
+  iov             = msg->msg_iov;
+  msg->msg_iov    = &bounce;
+  msg->msg_iovlen = 1;
+
+  ret = psock->s_sockif->si_recvmsg(psock, msg, flags);
+
+  msg->msg_iov    = (FAR struct iovec *)iov;
+  msg->msg_iovlen = end - iov;
+
+  for (len = 0; ret > 0 && iov != end && len < (size_t)ret; iov++)
+    {
+      size_t ncopy = iov->iov_len;
+
+      if (ncopy > (size_t)ret - len)
+        {
+          ncopy = (size_t)ret - len;
+        }
+
+      memcpy(iov->iov_base, buf + len, ncopy);
+      len += ncopy;
+    }
+
+  kmm_free(buf);
+  return ret;
 }
 
 /****************************************************************************
@@ -322,10 +322,13 @@ static void tcp_input(FAR struct net_driver_s *dev, uint8_t domain,
 
   /* Start of TCP input header processing code. */
 
-  if (tcp_chksum(dev) != 0xffff)
-    {
-      /* Compute and check the TCP checksum. */
+  /* Compute and check the TCP checksum, unless the driver has already
+   * verified it.
+   */
 
+  if (!NETDEV_HAS_FEATURE(dev, NETDEV_FEATURE_RXCSUM_L4) &&
+      tcp_chksum(dev) != 0xffff)
+    {
 #ifdef CONFIG_NET_STATISTICS
       g_netstats.tcp.drop++;
       g_netstats.tcp.chkerr++;
@@ -132,8 +132,12 @@ static int udp_input(FAR struct net_driver_s *dev, unsigned int iplen)
   dev->d_appdata = &dev->d_buf[hdrlen];
 
 #ifdef CONFIG_NET_UDP_CHECKSUMS
+  /* A zero checksum means that the sender did not compute one.  There is
+   * also nothing to do if the driver has already verified it.
+   */
+
   chksum = udp->udpchksum;
-  if (chksum != 0)
+  if (chksum != 0 && !NETDEV_HAS_FEATURE(dev, NETDEV_FEATURE_RXCSUM_L4))
     {
 #ifdef CONFIG_NET_IPv6
 #ifdef CONFIG_NET_IPv4
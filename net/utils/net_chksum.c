@@ -25,33 +25,26 @@
 #include <nuttx/config.h>
 #ifdef CONFIG_NET
 
+#include <stdint.h>
+
 #include "utils/utils.h"
 
 /****************************************************************************
- * Public Functions
+ * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: chksum
+ * Name: chksum_bytes
  *
  * Description:
- *   Calculate the raw change sum over the memory region described by
- *   data and len.
- *
- * Input Parameters:
- *   sum  - Partial calculations carried over from a previous call to
- *          chksum().  This should be zero on the first time that check
- *          sum is called.
- *   data - Beginning of the data to include in the checksum.
- *   len  - Length of the data to include in the checksum.
- *
- * Returned Value:
- *   The updated checksum value.
+ *   Sum the region a byte pair at a time.  Used for odd-aligned data where
+ *   word loads are not possible.
  *
  ****************************************************************************/
 
 #ifndef CONFIG_NET_ARCH_CHKSUM
-uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
+static uint16_t chksum_bytes(uint16_t sum, FAR const uint8_t *data,
+                             uint16_t len)
 {
   FAR const uint8_t *dataptr;
   FAR const uint8_t *last_byte;
@@ -84,8 +77,111 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
         }
     }
 
+  return sum;
+}
+#endif /* CONFIG_NET_ARCH_CHKSUM */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: chksum
+ *
+ * Description:
+ *   Calculate the raw change sum over the memory region described by
+ *   data and len.
+ *
+ *   The one's complement sum does not depend on byte order (RFC 1071,
+ *   section 2(B)), so the region is summed with native 32-bit loads into a
+ *   64-bit accumulator that cannot overflow for any uint16_t length.  The
+ *   result is folded to 16 bits and only then put into host order.
+ *
+ * Input Parameters:
+ *   sum  - Partial calculations carried over from a previous call to
+ *          chksum().  This should be zero on the first time that check
+ *          sum is called.
+ *   data - Beginning of the data to include in the checksum.
+ *   len  - Length of the data to include in the checksum.
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NET_ARCH_CHKSUM
+uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
+{
+  FAR const uint32_t *wptr;
+  uint64_t acc = 0;
+  uint16_t last;
+  uint16_t t;
+
+  if (((uintptr_t)data & 1) != 0)
+    {
+      return chksum_bytes(sum, data, len);
+    }
+
+  /* Get to a 32-bit boundary */
+
+  if (((uintptr_t)data & 2) != 0 && len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  wptr = (FAR const uint32_t *)data;
+
+  while (len >= 32)
+    {
+      acc += (uint64_t)wptr[0] + wptr[1] + wptr[2] + wptr[3];
+      acc += (uint64_t)wptr[4] + wptr[5] + wptr[6] + wptr[7];
+      wptr += 8;
+      len  -= 32;
+    }
+
+  while (len >= 4)
+    {
+      acc += *wptr++;
+      len -= 4;
+    }
+
+  data = (FAR const uint8_t *)wptr;
+  if (len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  /* A trailing odd byte is the high byte of a big-endian word padded with
+   * zero.  Place it where it would be in memory.
+   */
+
+  if (len > 0)
+    {
+      last = 0;
+      *(FAR uint8_t *)&last = *data;
+      acc += last;
+    }
+
+  /* Fold the accumulator to 16 bits with end-around carries */
+
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+
   /* Return sum in host byte order. */
 
+  t    = ntohs((uint16_t)acc);
+  sum += t;
+  if (sum < t)
+    {
+      sum++; /* carry */
+    }
+
   return sum;
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
@@ -123,4 +219,62 @@ uint16_t net_chksum(FAR uint16_t *data, uint16_t len)
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
 
+/****************************************************************************
+ * Name: net_chksum_adjust
+ *
+ * Description:
+ *   Update an Internet checksum for the change of one 16-bit word of the
+ *   covered data, without summing the data again (RFC 1624, eqn. 3).
+ *
+ * Input Parameters:
+ *   csum   - The checksum before the change.
+ *   oldval - The previous value of the word.
+ *   newval - The new value of the word.
+ *
+ *   All three values must be in the same byte order; that is typically
+ *   network order as they are found in the packet.
+ *
+ * Returned Value:
+ *   The checksum after the change, in the same byte order.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t csum, uint16_t oldval,
+                           uint16_t newval)
+{
+  uint32_t sum;
+
+  sum = (uint32_t)(uint16_t)~csum + (uint16_t)~oldval + newval;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+
+  return (uint16_t)~sum;
+}
+
+/****************************************************************************
+ * Name: net_chksum_replace
+ *
+ * Description:
+ *   Update an Internet checksum for the replacement of len bytes of the
+ *   covered data, for example the rewrite of an address by NAT.  The
+ *   replaced field must start at an even offset of the covered data.
+ *
+ * Input Parameters:
+ *   csum   - The checksum before the change, in network order.
+ *   optr   - The previous content of the field.
+ *   nptr   - The new content of the field.
+ *   len    - The length of the field in bytes.
+ *
+ * Returned Value:
+ *   The checksum after the change, in network order.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_replace(uint16_t csum, FAR const uint8_t *optr,
+                            FAR const uint8_t *nptr, uint16_t len)
+{
+  return net_chksum_adjust(csum, htons(chksum(0, optr, len)),
+                           htons(chksum(0, nptr, len)));
+}
+
 #endif /* CONFIG_NET */
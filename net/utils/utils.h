@@ -248,6 +248,50 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
 
 uint16_t net_chksum(FAR uint16_t *data, uint16_t len);
 
+/****************************************************************************
+ * Name: net_chksum_adjust
+ *
+ * Description:
+ *   Update an Internet checksum for the change of one 16-bit word of the
+ *   covered data, without summing the data again (RFC 1624).
+ *
+ * Input Parameters:
+ *   csum   - The checksum before the change.
+ *   oldval - The previous value of the word.
+ *   newval - The new value of the word.
+ *
+ *   All three values must be in the same byte order.
+ *
+ * Returned Value:
+ *   The checksum after the change, in the same byte order.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t csum, uint16_t oldval,
+                           uint16_t newval);
+
+/****************************************************************************
+ * Name: net_chksum_replace
+ *
+ * Description:
+ *   Update an Internet checksum for the replacement of len bytes of the
+ *   covered data, such as an address rewritten by NAT.  The field must
+ *   start at an even offset of the covered data.
+ *
+ * Input Parameters:
+ *   csum - The checksum before the change, in network order.
+ *   optr - The previous content of the field.
+ *   nptr - The new content of the field.
+ *   len  - The length of the field in bytes.
+ *
+ * Returned Value:
+ *   The checksum after the change, in network order.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_replace(uint16_t csum, FAR const uint8_t *optr,
+                            FAR const uint8_t *nptr, uint16_t len);
+
 /****************************************************************************
  * Name: ipv4_upperlayer_chksum
  *
@@ -32,6 +32,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/module.h>
 #include <nuttx/lib/modlib.h>
+#include <nuttx/syslog/syslog.h>
 
 #ifdef CONFIG_MODULE
 
@@ -112,6 +113,14 @@ int rmmod(FAR void *handle)
 #endif
     }
 
+#ifdef CONFIG_SYSLOG_DEFERRED
+  /* Format any deferred syslog records that may still reference format
+   * strings in the module text.
+   */
+
+  syslog_flush();
+#endif
+
   /* Release resources held by the module */
 
   if (modp->textalloc != NULL || modp->dataalloc != NULL)
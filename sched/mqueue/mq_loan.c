@@ -0,0 +1,196 @@
+/****************************************************************************
+ * sched/mqueue/mq_loan.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/mqueue.h>
+
+#include "mqueue/mqueue.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: file_mq_receive_loan
+ *
+ * Description:
+ *   Receive the oldest of the highest priority messages from the message
+ *   queue "mq" like file_mq_receive(), but without copying it:  the
+ *   message buffer itself is loaned to the caller, who must hand it back
+ *   with file_mq_return_loan() when done.  Until then the buffer is not
+ *   reused, but the message no longer counts against mq_maxmsg.
+ *
+ * Input Parameters:
+ *   mq     - Message Queue Descriptor
+ *   msg    - The location to return the address of the message
+ *   prio   - If not NULL, the location to store message priority.
+ *
+ * Returned Value:
+ *   The length of the message on success.  A negated errno value is
+ *   returned on failure (see mq_receive() for the list of values).
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_receive_loan(FAR struct file *mq, FAR char **msg,
+                             FAR unsigned int *prio)
+{
+  FAR struct inode *inode = mq->f_inode;
+  FAR struct mqueue_inode_s *msgq;
+  FAR struct mqueue_msg_s *mqmsg;
+  irqstate_t flags;
+  ssize_t ret;
+
+  if (!inode)
+    {
+      return -EBADF;
+    }
+
+  msgq = inode->i_private;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  if (msg == NULL || msgq == NULL)
+    {
+      return -EINVAL;
+    }
+
+  if ((mq->f_oflags & O_RDOK) == 0)
+    {
+      return -EPERM;
+    }
+
+  /* Get the next message as file_mq_receive() does */
+
+  sched_lock();
+
+  flags = enter_critical_section();
+  ret = nxmq_wait_receive(msgq, mq->f_oflags, &mqmsg);
+  leave_critical_section(flags);
+
+  if (ret >= 0)
+    {
+      DEBUGASSERT(mqmsg != NULL);
+
+      *msg = mqmsg->mail;
+      ret  = nxmq_do_receive(msgq, mqmsg, NULL, prio);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_mq_return_loan
+ *
+ * Description:
+ *   Hand back a message buffer obtained with file_mq_receive_loan().  All
+ *   loans must be returned before the message queue is closed.
+ *
+ * Input Parameters:
+ *   mq     - Message Queue Descriptor
+ *   msg    - The message address returned by file_mq_receive_loan()
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+int file_mq_return_loan(FAR struct file *mq, FAR char *msg)
+{
+  FAR struct inode *inode = mq->f_inode;
+  FAR struct mqueue_msg_s *mqmsg;
+
+  if (!inode)
+    {
+      return -EBADF;
+    }
+
+  if (msg == NULL)
+    {
+      return -EINVAL;
+    }
+
+  mqmsg = (FAR struct mqueue_msg_s *)
+    (msg - offsetof(struct mqueue_msg_s, mail));
+
+  nxmq_free_msg(inode->i_private, mqmsg);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxmq_receive_loan
+ *
+ * Description:
+ *   Equivalent to file_mq_receive_loan(), but takes a message queue
+ *   descriptor.
+ *
+ ****************************************************************************/
+
+ssize_t nxmq_receive_loan(mqd_t mqdes, FAR char **msg,
+                          FAR unsigned int *prio)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return file_mq_receive_loan(filep, msg, prio);
+}
+
+/****************************************************************************
+ * Name: nxmq_return_loan
+ *
+ * Description:
+ *   Equivalent to file_mq_return_loan(), but takes a message queue
+ *   descriptor.
+ *
+ ****************************************************************************/
+
+int nxmq_return_loan(mqd_t mqdes, FAR char *msg)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return file_mq_return_loan(filep, msg);
+}
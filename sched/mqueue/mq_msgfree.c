@@ -46,6 +46,7 @@
  *   allocated dynamically it will be deallocated.
  *
  * Input Parameters:
+ *   msgq  - The message queue that the message was allocated for
  *   mqmsg - message to free
  *
  * Returned Value:
@@ -53,7 +54,8 @@
  *
  ****************************************************************************/
 
-void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg)
+void nxmq_free_msg(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg)
 {
   irqstate_t flags;
 
@@ -87,6 +89,19 @@ void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg)
       leave_critical_section(flags);
     }
 
+#ifdef CONFIG_MQ_QUEUE_POOL
+  /* If this message came from the pool of the message queue, then put it
+   * back there.
+   */
+
+  else if (mqmsg->type == MQ_ALLOC_QUEUE)
+    {
+      flags = enter_critical_section();
+      sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+      leave_critical_section(flags);
+    }
+#endif
+
   /* Otherwise, deallocate it.  Note:  interrupt handlers
    * will never deallocate messages because they will not
    * received them.
@@ -44,6 +44,9 @@
  * Description:
  *   This function implements a part of the POSIX message queue open logic.
  *   It allocates and initializes a struct mqueue_inode_s structure.
+ *   With CONFIG_MQ_QUEUE_POOL, room for mq_maxmsg messages of mq_msgsize
+ *   bytes is allocated along with it, so that sends need no further
+ *   allocation.
  *
  * Input Parameters:
  *   attr   - The mq_maxmsg attribute is used at the time that the message
@@ -59,6 +62,15 @@
 FAR struct mqueue_inode_s *nxmq_alloc_msgq(FAR struct mq_attr *attr)
 {
   FAR struct mqueue_inode_s *msgq;
+  size_t allocsize = sizeof(struct mqueue_inode_s);
+  int16_t maxmsgs = MQ_MAX_MSGS;
+  int16_t maxmsgsize = MQ_MAX_BYTES;
+#ifdef CONFIG_MQ_QUEUE_POOL
+  FAR struct mqueue_msg_s *mqmsg;
+  FAR uint8_t *pool;
+  size_t msgsize;
+  int i;
+#endif
 
   /* Check if the caller is attempting to allocate a message for messages
    * larger than the configured maximum message size.
@@ -70,28 +82,50 @@ FAR struct mqueue_inode_s *nxmq_alloc_msgq(FAR struct mq_attr *attr)
       return NULL;
     }
 
-  /* Allocate memory for the new message queue. */
+  if (attr)
+    {
+      maxmsgs    = (int16_t)attr->mq_maxmsg;
+      maxmsgsize = (int16_t)attr->mq_msgsize;
+    }
+
+#ifdef CONFIG_MQ_QUEUE_POOL
+  /* The messages of the queue follow it in the same allocation, each with
+   * room for mq_msgsize bytes.
+   */
+
+  msgsize = MQ_MSG_SIZE(maxmsgsize);
+  msgsize = (msgsize + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
 
-  msgq = (FAR struct mqueue_inode_s *)
-    kmm_zalloc(sizeof(struct mqueue_inode_s));
+  if (maxmsgs > 0)
+    {
+      allocsize += maxmsgs * msgsize;
+    }
+#endif
 
+  /* Allocate memory for the new message queue. */
+
+  msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(allocsize);
   if (msgq)
     {
       /* Initialize the new named message queue */
 
       sq_init(&msgq->msglist);
-      if (attr)
-        {
-          msgq->maxmsgs    = (int16_t)attr->mq_maxmsg;
-          msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
-        }
-      else
+      msgq->maxmsgs    = maxmsgs;
+      msgq->maxmsgsize = maxmsgsize;
+      msgq->ntpid      = INVALID_PROCESS_ID;
+
+#ifdef CONFIG_MQ_QUEUE_POOL
+      sq_init(&msgq->msgfree);
+
+      pool = (FAR uint8_t *)(msgq + 1);
+      for (i = 0; i < maxmsgs; i++)
         {
-          msgq->maxmsgs    = MQ_MAX_MSGS;
-          msgq->maxmsgsize = MQ_MAX_BYTES;
+          mqmsg       = (FAR struct mqueue_msg_s *)pool;
+          mqmsg->type = MQ_ALLOC_QUEUE;
+          sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+          pool       += msgsize;
         }
-
-      msgq->ntpid = INVALID_PROCESS_ID;
+#endif
     }
 
   return msgq;
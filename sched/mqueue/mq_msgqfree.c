@@ -63,7 +63,7 @@ void nxmq_free_msgq(FAR struct mqueue_inode_s *msgq)
       /* Deallocate the message structure. */
 
       next = curr->next;
-      nxmq_free_msg(curr);
+      nxmq_free_msg(msgq, curr);
       curr = next;
     }
 
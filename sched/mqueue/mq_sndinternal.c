@@ -101,13 +101,15 @@ int nxmq_verify_send(FAR struct mqueue_inode_s *msgq, int oflags,
  *
  * Description:
  *   The nxmq_alloc_msg function will get a free message for use by the
- *   operating system.  The message will be allocated from the g_msgfree
- *   list.
+ *   operating system.  With CONFIG_MQ_QUEUE_POOL, the message is taken
+ *   from the pool of the message queue itself, which holds mq_maxmsg
+ *   messages of mq_msgsize bytes.  Otherwise (or if a send from an
+ *   interrupt handler has overfilled the queue) it will be allocated from
+ *   the g_msgfree list.
  *
  *   If the list is empty AND the message is NOT being allocated from the
- *   interrupt level, then the message will be allocated.  If a message
- *   cannot be obtained, the operating system is dead and therefore cannot
- *   continue.
+ *   interrupt level, then a message with just enough space for 'msglen'
+ *   bytes will be allocated.
  *
  *   If the list is empty AND the message IS being allocated from the
  *   interrupt level.  This function will attempt to get a message from
@@ -115,7 +117,8 @@ int nxmq_verify_send(FAR struct mqueue_inode_s *msgq, int oflags,
  *   handler will be notified.
  *
  * Input Parameters:
- *   None
+ *   msgq   - The message queue that the message will be sent to
+ *   msglen - The length of the message in bytes
  *
  * Returned Value:
  *   A reference to the allocated msg structure.  On a failure to allocate,
@@ -123,11 +126,25 @@ int nxmq_verify_send(FAR struct mqueue_inode_s *msgq, int oflags,
  *
  ****************************************************************************/
 
-FAR struct mqueue_msg_s *nxmq_alloc_msg(void)
+FAR struct mqueue_msg_s *nxmq_alloc_msg(FAR struct mqueue_inode_s *msgq,
+                                        size_t msglen)
 {
   FAR struct mqueue_msg_s *mqmsg;
   irqstate_t flags;
 
+#ifdef CONFIG_MQ_QUEUE_POOL
+  /* Use the pool of the message queue, if it has a message left */
+
+  flags = enter_critical_section();
+  mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msgfree);
+  leave_critical_section(flags);
+
+  if (mqmsg != NULL)
+    {
+      return mqmsg;
+    }
+#endif
+
   /* If we were called from an interrupt handler, then try to get the message
    * from generally available list of messages. If this fails, then try the
    * list of messages reserved for interrupt handlers
@@ -164,8 +181,7 @@ FAR struct mqueue_msg_s *nxmq_alloc_msg(void)
 
       if (mqmsg == NULL)
         {
-          mqmsg = (FAR struct mqueue_msg_s *)
-            kmm_malloc((sizeof (struct mqueue_msg_s)));
+          mqmsg = (FAR struct mqueue_msg_s *)kmm_malloc(MQ_MSG_SIZE(msglen));
 
           /* Check if we allocated the message */
 
@@ -344,13 +360,28 @@ int nxmq_do_send(FAR struct mqueue_inode_s *msgq,
 
   flags = enter_critical_section();
 
-  /* Search the message list to find the location to insert the new
-   * message. Each is list is maintained in ascending priority order.
+  /* Find the location to insert the new message.  The list is kept in
+   * descending priority order, FIFO among messages of equal priority.  The
+   * usual cases, a message no more urgent than the last one queued or
+   * more urgent than the first, need no search.
    */
 
-  for (prev = NULL, next = (FAR struct mqueue_msg_s *)msgq->msglist.head;
-       next && prio <= next->priority;
-       prev = next, next = next->next);
+  prev = (FAR struct mqueue_msg_s *)msgq->msglist.tail;
+  next = (FAR struct mqueue_msg_s *)msgq->msglist.head;
+
+  if (prev != NULL && prio > prev->priority)
+    {
+      if (prio > next->priority)
+        {
+          prev = NULL;
+        }
+      else
+        {
+          for (prev = NULL;
+               next && prio <= next->priority;
+               prev = next, next = next->next);
+        }
+    }
 
   /* Add the message at the right place */
 
@@ -173,18 +173,6 @@ int file_mq_timedsend(FAR struct file *mq, FAR const char *msg,
       return ret;
     }
 
-  /* Pre-allocate a message structure */
-
-  mqmsg = nxmq_alloc_msg();
-  if (mqmsg == NULL)
-    {
-      /* Failed to allocate the message. nxmq_alloc_msg() does not set the
-       * errno value.
-       */
-
-      return -ENOMEM;
-    }
-
   /* Get a pointer to the message queue */
 
   sched_lock();
@@ -209,7 +197,9 @@ int file_mq_timedsend(FAR struct file *mq, FAR const char *msg,
        * Currently nxmq_do_send() always returns OK.
        */
 
-      ret = nxmq_do_send(msgq, mqmsg, msg, msglen, prio);
+      mqmsg = nxmq_alloc_msg(msgq, msglen);
+      ret   = mqmsg != NULL ? nxmq_do_send(msgq, mqmsg, msg, msglen, prio) :
+                              -ENOMEM;
       sched_unlock();
       return ret;
     }
@@ -221,7 +211,7 @@ int file_mq_timedsend(FAR struct file *mq, FAR const char *msg,
   if (!abstime || abstime->tv_nsec < 0 || abstime->tv_nsec >= 1000000000)
     {
       ret = -EINVAL;
-      goto errout_with_mqmsg;
+      goto errout_with_lock;
     }
 
   /* We are not in an interrupt handler and the message queue is full.
@@ -280,30 +270,30 @@ int file_mq_timedsend(FAR struct file *mq, FAR const char *msg,
 
   /* If any of the above failed, set the errno.  Otherwise, there should
    * be space for another message in the message queue.  NOW we can allocate
-   * the message structure.
+   * the message structure (which, with a per-queue pool, could not be had
+   * while the queue was full).
    *
    * Currently nxmq_do_send() always returns OK.
    */
 
-  ret = nxmq_do_send(msgq, mqmsg, msg, msglen, prio);
+  mqmsg = nxmq_alloc_msg(msgq, msglen);
+  ret   = mqmsg != NULL ? nxmq_do_send(msgq, mqmsg, msg, msglen, prio) :
+                          -ENOMEM;
 
   sched_unlock();
   leave_cancellation_point();
   return ret;
 
-  /* Exit here with (1) the scheduler locked, (2) a message allocated, (3) a
-   * wdog allocated, and (4) interrupts disabled.
+  /* Exit here with (1) the scheduler locked, (2) a wdog allocated, and (3)
+   * interrupts disabled.
    */
 
 errout_in_critical_section:
   leave_critical_section(flags);
 
-  /* Exit here with (1) the scheduler locked and 2) a message allocated.  The
-   * error code is in 'result'
-   */
+  /* Exit here with the scheduler locked.  The error code is in 'ret' */
 
-errout_with_mqmsg:
-  nxmq_free_msg(mqmsg);
+errout_with_lock:
   sched_unlock();
   return ret;
 }
@@ -29,6 +29,7 @@
 #include <nuttx/compiler.h>
 
 #include <sys/types.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
@@ -47,6 +48,13 @@
 #define MQ_MAX_MSGS    16
 #define MQ_PRIO_MAX    _POSIX_MQ_PRIO_MAX
 
+/* The size of a message structure with an 'n' byte payload.  Only the
+ * preallocated messages carry the full MQ_MAX_BYTES payload;  others are
+ * allocated with just the space that they need.
+ */
+
+#define MQ_MSG_SIZE(n) (offsetof(struct mqueue_msg_s, mail) + (n))
+
 /********************************************************************************
  * Public Type Definitions
  ********************************************************************************/
@@ -55,7 +63,8 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* Pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* Dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_QUEUE       /* From the message queue's own pool */
 };
 
 /* This structure describes one buffered POSIX message. */
@@ -107,7 +116,8 @@ struct task_group_s; /* Forward reference */
 /* Functions defined in mq_initialize.c *****************************************/
 
 void weak_function nxmq_initialize(void);
-void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg);
+void nxmq_free_msg(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg);
 
 /* mq_waitirq.c *****************************************************************/
 
@@ -127,7 +137,8 @@ ssize_t nxmq_do_receive(FAR struct mqueue_inode_s *msgq,
 
 int nxmq_verify_send(FAR struct mqueue_inode_s *msgq, int oflags,
                      FAR const char *msg, size_t msglen, unsigned int prio);
-FAR struct mqueue_msg_s *nxmq_alloc_msg(void);
+FAR struct mqueue_msg_s *nxmq_alloc_msg(FAR struct mqueue_inode_s *msgq,
+                                        size_t msglen);
 int nxmq_wait_send(FAR struct mqueue_inode_s *msgq, int oflags);
 int nxmq_do_send(FAR struct mqueue_inode_s *msgq,
                  FAR struct mqueue_msg_s *mqmsg,
@@ -44,6 +44,14 @@
 #  define CONFIG_SEM_PREALLOCHOLDERS 0
 #endif
 
+#ifndef CONFIG_SEM_PICHAIN
+#  define CONFIG_SEM_PICHAIN 0
+#endif
+
+#if defined(CONFIG_PRIORITY_PROTECT) && CONFIG_SEM_NNESTPRIO > 0
+#  error CONFIG_PRIORITY_PROTECT requires CONFIG_SEM_NNESTPRIO == 0
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -51,6 +59,14 @@
 typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
                                FAR sem_t *sem, FAR void *arg);
 
+/* Argument of nxsem_boostholderprio() */
+
+struct semboost_s
+{
+  FAR struct tcb_s *wtcb;        /* The thread waiting for a count */
+  int depth;                     /* Links followed from the first waiter */
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -128,15 +144,29 @@ static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
   FAR struct semholder_s *pholder;
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+  FAR struct semholder_s *prev;
+
   /* Try to find the holder in the list of holders associated with this
    * semaphore
    */
 
-  for (pholder = sem->hhead; pholder != NULL; pholder = pholder->flink)
+  for (prev = NULL, pholder = sem->hhead;
+       pholder != NULL;
+       prev = pholder, pholder = pholder->flink)
     {
       if (pholder->htcb == htcb)
         {
-          /* Got it! */
+          /* Got it!  Move it to the head of the list:  the same holder is
+           * normally looked up again on release and freed right after, so
+           * both then find it at once, however many holders there are.
+           */
+
+          if (prev != NULL)
+            {
+              prev->flink    = pholder->flink;
+              pholder->flink = sem->hhead;
+              sem->hhead     = pholder;
+            }
 
           return pholder;
         }
@@ -180,6 +210,138 @@ nxsem_findorallocateholder(sem_t *sem, FAR struct tcb_s *htcb)
   return pholder;
 }
 
+/****************************************************************************
+ * Name: nxsem_inheritedprio
+ *
+ * Description:
+ *   Return the priority that htcb is entitled to:  its base priority,
+ *   raised to the ceiling of any priority protected semaphore that it holds
+ *   and to the priority of the highest priority thread waiting for a
+ *   semaphore that it holds.  The waiter xtcb, if not NULL, is no longer
+ *   waiting and is not counted.
+ *
+ *   The list of waiters is in priority order, so the search stops at the
+ *   first waiter that is blocked by htcb or that could not raise it.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SEM_NNESTPRIO == 0
+static int nxsem_inheritedprio(FAR struct tcb_s *htcb,
+                               FAR struct tcb_s *xtcb)
+{
+  FAR struct semholder_s *pholder;
+  FAR struct tcb_s *wtcb;
+  int priority = htcb->base_priority;
+#ifdef CONFIG_PRIORITY_PROTECT
+  int i;
+
+  for (i = 0; i < htcb->nceilings; i++)
+    {
+      if (htcb->ceilings[i] > priority)
+        {
+          priority = htcb->ceilings[i];
+        }
+    }
+#endif
+
+  for (wtcb = (FAR struct tcb_s *)g_waitingforsemaphore.head;
+       wtcb != NULL && wtcb->sched_priority > priority;
+       wtcb = wtcb->flink)
+    {
+      if (wtcb != xtcb && wtcb->waitsem != NULL)
+        {
+          pholder = nxsem_findholder(wtcb->waitsem, htcb);
+          if (pholder != NULL && pholder->counts > 0)
+            {
+              priority = wtcb->sched_priority;
+              break;
+            }
+        }
+    }
+
+  return priority;
+}
+
+/****************************************************************************
+ * Name: nxsem_resetprio
+ *
+ * Description:
+ *   Drop the priority of htcb to nxsem_inheritedprio().
+ *
+ ****************************************************************************/
+
+static void nxsem_resetprio(FAR struct tcb_s *htcb, FAR struct tcb_s *xtcb)
+{
+  int priority = nxsem_inheritedprio(htcb, xtcb);
+
+  if (priority > htcb->base_priority)
+    {
+      if (priority != htcb->sched_priority)
+        {
+          nxsched_set_priority(htcb, priority);
+        }
+    }
+  else if (htcb->sched_priority != htcb->base_priority)
+    {
+      nxsched_reprioritize(htcb, htcb->base_priority);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: nxsem_raiseceiling
+ *
+ * Description:
+ *   htcb has just become a holder of the priority protected semaphore sem:
+ *   record the ceiling and run htcb at it.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_PROTECT
+static void nxsem_raiseceiling(FAR struct tcb_s *htcb, FAR sem_t *sem)
+{
+  if (htcb->nceilings < CONFIG_SEM_NPROTECT)
+    {
+      htcb->ceilings[htcb->nceilings++] = sem->ceiling;
+    }
+  else
+    {
+      serr("ERROR: CONFIG_SEM_NPROTECT exceeded\n");
+      DEBUGASSERT(htcb->nceilings < CONFIG_SEM_NPROTECT);
+    }
+
+  if (sem->ceiling > htcb->sched_priority)
+    {
+      nxsched_set_priority(htcb, sem->ceiling);
+    }
+}
+
+/****************************************************************************
+ * Name: nxsem_dropceiling
+ *
+ * Description:
+ *   htcb has given up its last count on the priority protected semaphore
+ *   sem:  forget the ceiling and drop to the priority still owed to it.
+ *
+ ****************************************************************************/
+
+static void nxsem_dropceiling(FAR struct tcb_s *htcb, FAR sem_t *sem)
+{
+  int i;
+
+  for (i = 0; i < htcb->nceilings; i++)
+    {
+      if (htcb->ceilings[i] == sem->ceiling)
+        {
+          htcb->ceilings[i] = htcb->ceilings[--htcb->nceilings];
+          break;
+        }
+    }
+
+  nxsem_resetprio(htcb, NULL);
+}
+#endif
+
 /****************************************************************************
  * Name: nxsem_freeholder
  ****************************************************************************/
@@ -241,6 +403,13 @@ static inline void nxsem_findandfreeholder(sem_t *sem,
   if (pholder != NULL && pholder->counts <= 0)
     {
       nxsem_freeholder(sem, pholder);
+
+#ifdef CONFIG_PRIORITY_PROTECT
+      if ((sem->flags & PRIOINHERIT_FLAGS_PROTECT) != 0)
+        {
+          nxsem_dropceiling(htcb, sem);
+        }
+#endif
     }
 }
 
@@ -301,11 +470,26 @@ static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
  * Name: nxsem_recoverholders
  ****************************************************************************/
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 || defined(CONFIG_PRIORITY_PROTECT)
 static int nxsem_recoverholders(FAR struct semholder_s *pholder,
                                 FAR sem_t *sem, FAR void *arg)
 {
+#ifdef CONFIG_PRIORITY_PROTECT
+  FAR struct tcb_s *htcb = pholder->htcb;
+#endif
+
   nxsem_freeholder(sem, pholder);
+
+#ifdef CONFIG_PRIORITY_PROTECT
+  /* A live holder must not keep the ceiling of a destroyed semaphore */
+
+  if ((sem->flags & PRIOINHERIT_FLAGS_PROTECT) != 0 &&
+      nxsched_verify_tcb(htcb))
+    {
+      nxsem_dropceiling(htcb, sem);
+    }
+#endif
+
   return 0;
 }
 #endif
@@ -317,8 +501,12 @@ static int nxsem_recoverholders(FAR struct semholder_s *pholder,
 static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
                                  FAR sem_t *sem, FAR void *arg)
 {
+  FAR struct semboost_s *boost = (FAR struct semboost_s *)arg;
   FAR struct tcb_s *htcb = (FAR struct tcb_s *)pholder->htcb;
-  FAR struct tcb_s *rtcb = (FAR struct tcb_s *)arg;
+  FAR struct tcb_s *rtcb = boost->wtcb;
+#if CONFIG_SEM_PICHAIN > 0
+  int priority;
+#endif
 
   /* Make sure that the holder thread is still active.  If it exited without
    * releasing its counts, then that would be a bad thing.  But we can take
@@ -329,16 +517,30 @@ static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
   if (!nxsched_verify_tcb(htcb))
     {
       swarn("WARNING: TCB %p is a stale handle, counts lost\n", htcb);
-      nxsem_freeholder(sem, pholder);
+
+      /* Further down a chain, this semaphore may also be the one being
+       * walked by a caller, so leave the clean-up to the first level.
+       */
+
+      if (boost->depth == 0)
+        {
+          nxsem_freeholder(sem, pholder);
+        }
+
+      return 0;
     }
 
+#if CONFIG_SEM_PICHAIN > 0
+  priority = htcb->sched_priority;
+#endif
+
 #if CONFIG_SEM_NNESTPRIO > 0
   /* If the priority of the thread that is waiting for a count is greater
    * than the base priority of the thread holding a count, then we may need
    * to adjust the holder's priority now or later to that priority.
    */
 
-  else if (rtcb->sched_priority > htcb->base_priority)
+  if (rtcb->sched_priority > htcb->base_priority)
     {
       /* If the new priority is greater than the current, possibly already
        * boosted priority of the holder thread, then we will have to raise
@@ -407,7 +609,7 @@ static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
    * because the thread is already running at a sufficient priority.
    */
 
-  else if (rtcb->sched_priority > htcb->sched_priority)
+  if (rtcb->sched_priority > htcb->sched_priority)
     {
       /* Raise the priority of the holder of the semaphore.  This
        * cannot cause a context switch because we have preemption
@@ -419,6 +621,27 @@ static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
     }
 #endif
 
+#if CONFIG_SEM_PICHAIN > 0
+  /* If the holder was raised while it is itself waiting for a semaphore,
+   * then the holders of that semaphore are now blocking the waiter too and
+   * must be raised in turn.  The chain is followed only so far, which
+   * bounds the time spent here and ends any walk around a deadlock cycle.
+   */
+
+  if (htcb->sched_priority > priority &&
+      htcb->task_state == TSTATE_WAIT_SEM &&
+      htcb->waitsem != NULL && htcb->waitsem != sem &&
+      boost->depth < CONFIG_SEM_PICHAIN)
+    {
+      struct semboost_s chain;
+
+      chain.wtcb  = htcb;
+      chain.depth = boost->depth + 1;
+
+      nxsem_foreachholder(htcb->waitsem, nxsem_boostholderprio, &chain);
+    }
+#endif
+
   return 0;
 }
 
@@ -605,12 +828,12 @@ static int nxsem_restoreholderprio(FAR struct tcb_s *htcb,
             }
         }
 #else
-      /* There is no alternative restore priorities, drop the priority
-       * of the holder thread all the way back to the threads "base"
-       * priority.
+      /* There is no list of restore priorities:  work out again what the
+       * holder is still owed by the other threads that it blocks, which is
+       * right however long a chain of semaphores it is part of.
        */
 
-      nxsched_reprioritize(htcb, htcb->base_priority);
+      nxsem_resetprio(htcb, (FAR struct tcb_s *)arg);
 #endif
     }
 
@@ -914,6 +1137,10 @@ void nxsem_destroyholder(FAR sem_t *sem)
 
   DEBUGASSERT(sem->holder[0].htcb == NULL || sem->holder[1].htcb == NULL);
 
+#ifdef CONFIG_PRIORITY_PROTECT
+  nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
+#endif
+
   sem->holder[0].htcb = NULL;
   sem->holder[1].htcb = NULL;
 #endif
@@ -960,6 +1187,18 @@ void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
 
           pholder->htcb = htcb;
           pholder->counts++;
+
+#ifdef CONFIG_PRIORITY_PROTECT
+          /* The first count on a priority protected semaphore raises the
+           * holder to the ceiling of the semaphore.
+           */
+
+          if (pholder->counts == 1 &&
+              (sem->flags & PRIOINHERIT_FLAGS_PROTECT) != 0)
+            {
+              nxsem_raiseceiling(htcb, sem);
+            }
+#endif
         }
     }
 }
@@ -1004,14 +1243,17 @@ void nxsem_add_holder(FAR sem_t *sem)
 
 void nxsem_boost_priority(FAR sem_t *sem)
 {
-  FAR struct tcb_s *rtcb = this_task();
+  struct semboost_s boost;
+
+  boost.wtcb  = this_task();
+  boost.depth = 0;
 
   /* Boost the priority of every thread holding counts on this semaphore
    * that are lower in priority than the new thread that is waiting for a
    * count.
    */
 
-  nxsem_foreachholder(sem, nxsem_boostholderprio, rtcb);
+  nxsem_foreachholder(sem, nxsem_boostholderprio, &boost);
 }
 
 /****************************************************************************
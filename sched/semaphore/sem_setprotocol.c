@@ -24,6 +24,7 @@
 
 #include <nuttx/config.h>
 
+#include <sched.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -83,6 +84,7 @@ int nxsem_set_protocol(FAR sem_t *sem, int protocol)
         /* Disable priority inheritance */
 
         sem->flags |= PRIOINHERIT_FLAGS_DISABLE;
+        sem->flags &= ~PRIOINHERIT_FLAGS_PROTECT;
 
         /* Remove any current holders */
 
@@ -94,13 +96,29 @@ int nxsem_set_protocol(FAR sem_t *sem, int protocol)
         /* Enable priority inheritance (dangerous) */
 
         sem->flags &= ~PRIOINHERIT_FLAGS_DISABLE;
+        sem->flags &= ~PRIOINHERIT_FLAGS_PROTECT;
         return OK;
 
       case SEM_PRIO_PROTECT:
+#ifdef CONFIG_PRIORITY_PROTECT
+        /* Enable the priority ceiling protocol.  Priority inheritance
+         * still applies above the ceiling.  Without a ceiling set by
+         * nxsem_set_prioceiling(), holders run at the highest priority.
+         */
 
-        /* Not yet supported */
+        if (sem->ceiling == 0)
+          {
+            sem->ceiling = SCHED_PRIORITY_MAX;
+          }
+
+        sem->flags &= ~PRIOINHERIT_FLAGS_DISABLE;
+        sem->flags |= PRIOINHERIT_FLAGS_PROTECT;
+        return OK;
+#else
+        /* Not supported in this configuration */
 
         return -ENOSYS;
+#endif
 
       default:
         break;
@@ -109,6 +127,47 @@ int nxsem_set_protocol(FAR sem_t *sem, int protocol)
   return -EINVAL;
 }
 
+/****************************************************************************
+ * Name: nxsem_set_prioceiling
+ *
+ * Description:
+ *    Set the priority ceiling of a semaphore that uses, or will use, the
+ *    SEM_PRIO_PROTECT protocol.  The new ceiling applies to counts taken
+ *    after the change; it must not be changed while the semaphore is held.
+ *
+ * Input Parameters:
+ *    sem         - A pointer to the semaphore whose ceiling is to be set
+ *    prioceiling - The new priority ceiling
+ *    oldceiling  - If not NULL, the location to return the old ceiling
+ *
+ * Returned Value:
+ *   This is an internal OS interface and should not be used by applications.
+ *   It follows the NuttX internal error return policy:  Zero (OK) is
+ *   returned on success.  A negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_PROTECT
+int nxsem_set_prioceiling(FAR sem_t *sem, int prioceiling,
+                          FAR int *oldceiling)
+{
+  DEBUGASSERT(sem != NULL);
+
+  if (prioceiling < SCHED_PRIORITY_MIN || prioceiling > SCHED_PRIORITY_MAX)
+    {
+      return -EINVAL;
+    }
+
+  if (oldceiling != NULL)
+    {
+      *oldceiling = sem->ceiling;
+    }
+
+  sem->ceiling = (uint8_t)prioceiling;
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: sem_setprotocol
  *
@@ -169,6 +169,9 @@ int task_restart(pid_t pid)
 #  if CONFIG_SEM_NNESTPRIO > 0
   tcb->cmn.npend_reprio = 0;
 #  endif
+#  ifdef CONFIG_PRIORITY_PROTECT
+  tcb->cmn.nceilings = 0;
+#  endif
 #endif
 
   /* Re-initialize the processor-specific portion of the TCB.  This will
@@ -91,9 +91,13 @@
 #define FILE_MODEFLAGS     (NUTTX_IFREG | NUTTX_IRUSR | NUTTX_IRGRP | NUTTX_IROTH)
 
 #define CROMFS_MAGIC       0x4d4f5243
-#define CROMFS_BLOCKSIZE   512
+#define CROMFS_BLOCKSIZE   512        /* Default block size */
+#define CROMFS_MINBLOCK    64         /* Smallest block size */
+#define CROMFS_MAXBLOCK    32768      /* Largest block size */
 
-#define LZF_BUFSIZE        512
+#define CROMFS_FLAG_BLKTAB (1 << 0)   /* Must match fs/cromfs/cromfs.h */
+
+#define LZF_BUFSIZE        CROMFS_MAXBLOCK
 #define LZF_HLOG           13
 #define LZF_HSIZE          (1 << LZF_HLOG)
 
@@ -112,6 +116,8 @@
 
 #define HEX_PER_LINE       8
 
+#define DEDUP_HSIZE        1024       /* Must be a power of two */
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -140,7 +146,7 @@ struct cromfs_volume_s
 struct cromfs_node_s
 {
   uint16_t cn_mode;       /* File type, attributes, and access mode bits */
-  uint16_t cn_pad;        /* Not used */
+  uint16_t cn_flags;      /* See CROMFS_FLAG_* definitions */
   uint32_t cn_name;       /* Offset from the beginning of the volume header to the
                            * node name string.  NUL-terminated. */
   uint32_t cn_size;       /* Size of the uncompressed data (in bytes) */
@@ -206,6 +212,19 @@ union lzf_result_u
 
 static uint8_t *g_lzf_hashtab[LZF_HSIZE];
 
+/* Describes one block of file data that has already been generated.  These
+ * are kept in a hash table when blocks are deduplicated.
+ */
+
+struct dedup_block_s
+{
+  struct dedup_block_s *flink; /* Next block with the same hash bucket */
+  uint32_t hash;               /* Hash of the uncompressed data */
+  uint32_t offset;             /* Image offset of the block header */
+  size_t len;                  /* Length of the uncompressed data */
+  uint8_t data[1];             /* Uncompressed data (actual size is len) */
+};
+
 /* Type of the callback from traverse_directory() */
 
 typedef int (*traversal_callback_t)(const char *dirpath, const char *name,
@@ -255,6 +274,15 @@ static unsigned int g_nhex;    /* Number of hex characters on output line */
 static unsigned int g_ntmps;   /* Number temporary files */
 #endif
 
+static unsigned int g_blocksize = CROMFS_BLOCKSIZE;
+
+static bool g_blktab;           /* Generate a block table for each file */
+static bool g_dedup;            /* Share identical blocks */
+static unsigned int g_ndups;    /* Number of shared duplicate blocks */
+static unsigned long g_dupsize; /* Uncompressed size of the duplicates */
+
+static struct dedup_block_s *g_dedup_hash[DEDUP_HSIZE];
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -273,6 +301,11 @@ static void dump_hexbuffer(FILE *stream, const void *buffer,
 static void dump_nextline(FILE *stream);
 static size_t lzf_compress(const uint8_t *inbuffer, unsigned int inlen,
                            union lzf_result_u *result);
+static uint32_t dedup_hash(const uint8_t *data, size_t len);
+static struct dedup_block_s *dedup_find(const uint8_t *data, size_t len,
+                                        uint32_t hash);
+static void dedup_add(const uint8_t *data, size_t len, uint32_t hash,
+                      uint32_t offset);
 static uint16_t get_mode(mode_t mode);
 #ifdef HOST_TGTSWAP
 static inline uint16_t tgt_uint16(uint16_t a);
@@ -301,7 +334,18 @@ static int  traverse_directory(const char *dirpath,
 
 static void show_usage(void)
 {
-  fprintf(stderr, "USAGE: %s <dir-path> <out-file>\n", g_progname);
+  fprintf(stderr, "USAGE: %s [-b <block-size>] [-i] [-d] "
+          "<dir-path> <out-file>\n", g_progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  -b <block-size>: Uncompressed size of each block of "
+          "file data (%u-%u,\n", CROMFS_MINBLOCK, CROMFS_MAXBLOCK);
+  fprintf(stderr, "     default %u).  The target caches decompressed "
+          "blocks of this size.\n", CROMFS_BLOCKSIZE);
+  fprintf(stderr, "  -i: Generate a block table for each file so that the "
+          "target can locate\n");
+  fprintf(stderr, "     any block directly.  Requires a target with block "
+          "table support.\n");
+  fprintf(stderr, "  -d: Store identical blocks only once.  Implies -i.\n");
   exit(1);
 }
 
@@ -528,7 +572,7 @@ static size_t lzf_compress(const uint8_t *inbuffer, unsigned int inlen,
   const uint8_t *inptr  = inbuffer;
         uint8_t *outptr = result->compressed.lzf_buffer;
   const uint8_t *inend  = inptr + inlen;
-        uint8_t *outend = outptr + LZF_BUFSIZE;
+        uint8_t *outend = outptr + g_blocksize;
   const uint8_t *ref;
   uintptr_t off;
   ssize_t cs;
@@ -808,6 +852,63 @@ genhdr:
   return retlen;
 }
 
+static uint32_t dedup_hash(const uint8_t *data, size_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  /* 32-bit FNV-1a */
+
+  while (len-- > 0)
+    {
+      hash ^= *data++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+static struct dedup_block_s *dedup_find(const uint8_t *data, size_t len,
+                                        uint32_t hash)
+{
+  struct dedup_block_s *block;
+
+  for (block = g_dedup_hash[hash & (DEDUP_HSIZE - 1)];
+       block != NULL;
+       block = block->flink)
+    {
+      if (block->hash == hash && block->len == len &&
+          memcmp(block->data, data, len) == 0)
+        {
+          return block;
+        }
+    }
+
+  return NULL;
+}
+
+static void dedup_add(const uint8_t *data, size_t len, uint32_t hash,
+                      uint32_t offset)
+{
+  struct dedup_block_s *block;
+  unsigned int ndx;
+
+  block = malloc(sizeof(struct dedup_block_s) + len);
+  if (block == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate a dedup block\n");
+      exit(1);
+    }
+
+  block->hash         = hash;
+  block->offset       = offset;
+  block->len          = len;
+  memcpy(block->data, data, len);
+
+  ndx                 = hash & (DEDUP_HSIZE - 1);
+  block->flink        = g_dedup_hash[ndx];
+  g_dedup_hash[ndx]   = block;
+}
+
 static uint16_t get_mode(mode_t mode)
 {
   uint16_t ret = 0;
@@ -877,7 +978,7 @@ static void gen_dirlink(const char *name, uint32_t tgtoffs, bool dirempty)
           (unsigned long)g_offset, name);
 
   node.cn_mode    = TGT_UINT16(DIRLINK_MODEFLAGS);
-  node.cn_pad     = 0;
+  node.cn_flags   = 0;
 
   g_offset       += sizeof(struct cromfs_node_s);
   node.cn_name    = TGT_UINT32(g_offset);
@@ -960,7 +1061,7 @@ static void gen_directory(const char *path, const char *name, mode_t mode,
           (unsigned long)save_offset, path);
 
   node.cn_mode    = TGT_UINT16(NUTTX_IFDIR | get_mode(mode));
-  node.cn_pad     = 0;
+  node.cn_flags   = 0;
 
   save_offset    += sizeof(struct cromfs_node_s);
   node.cn_name    = TGT_UINT32(save_offset);
@@ -987,27 +1088,27 @@ static void gen_file(const char *path, const char *name, mode_t mode,
                      bool lastentry)
 {
   struct cromfs_node_s node;
-  union lzf_result_u result;
+  static union lzf_result_u result;
+  static uint8_t iobuffer[LZF_BUFSIZE];
+  struct dedup_block_s *dup;
   uint32_t nodeoffs = g_offset;
+  uint32_t *blktab = NULL;
+  uint32_t tabsize = 0;
+  uint32_t hash = 0;
   FILE *save_tmpstream = g_tmpstream;
   FILE *outstream;
   FILE *instream;
-  uint8_t iobuffer[LZF_BUFSIZE];
+  struct stat buf;
   size_t nread;
   size_t ntotal;
   size_t blklen;
   size_t blktotal;
+  unsigned int nblocks = 0;
   unsigned int blkno;
   int namlen;
 
   namlen      = strlen(name) + 1;
 
-  /* Open a new temporary file */
-
-  outstream   = open_tmpfile();
-  g_tmpstream = outstream;
-  g_offset    = nodeoffs + sizeof(struct cromfs_node_s) + namlen;
-
   /* Open the source data file */
 
   instream    = fopen(path, "r");
@@ -1018,6 +1119,33 @@ static void gen_file(const char *path, const char *name, mode_t mode,
       exit(1);
     }
 
+  /* The block table follows the file name and precedes the data */
+
+  if (g_blktab)
+    {
+      if (fstat(fileno(instream), &buf) < 0)
+        {
+          fprintf(stderr, "fstat for source file %s failed: %s\n",
+                  path, strerror(errno));
+          exit(1);
+        }
+
+      nblocks = (buf.st_size + g_blocksize - 1) / g_blocksize;
+      tabsize = nblocks * sizeof(uint32_t);
+      blktab  = malloc(tabsize + 1);
+      if (blktab == NULL)
+        {
+          fprintf(stderr, "Failed to allocate block table for %s\n", path);
+          exit(1);
+        }
+    }
+
+  /* Open a new temporary file */
+
+  outstream   = open_tmpfile();
+  g_tmpstream = outstream;
+  g_offset    = nodeoffs + sizeof(struct cromfs_node_s) + namlen + tabsize;
+
   /* Then read data from the file, compress it, and write it to the new
    * temporary file
    */
@@ -1030,11 +1158,42 @@ static void gen_file(const char *path, const char *name, mode_t mode,
     {
       /* Read the next chunk from the file */
 
-      nread = fread(iobuffer, 1, LZF_BUFSIZE, instream);
+      nread = fread(iobuffer, 1, g_blocksize, instream);
       if (nread > 0)
         {
           uint16_t clen;
 
+          if (g_blktab && blkno >= nblocks)
+            {
+              fprintf(stderr, "ERROR: %s changed size\n", path);
+              exit(1);
+            }
+
+          /* Check if an identical block has already been generated */
+
+          dup = NULL;
+          if (g_dedup)
+            {
+              hash = dedup_hash(iobuffer, nread);
+              dup  = dedup_find(iobuffer, nread, hash);
+            }
+
+          if (dup != NULL)
+            {
+              fprintf(g_tmpstream,
+                      "\n  /* Block %u Uncompressed=%lu:  "
+                      "Same as offset %lu */\n",
+                      blkno, (long)nread, (unsigned long)dup->offset);
+
+              blktab[blkno] = TGT_UINT32(dup->offset);
+              ntotal       += nread;
+
+              g_ndups++;
+              g_dupsize    += dup->len;
+              blkno++;
+              continue;
+            }
+
           /* Compress the chunk */
 
           blklen = lzf_compress(iobuffer, nread, &result);
@@ -1056,6 +1215,16 @@ static void gen_file(const char *path, const char *name, mode_t mode,
           dump_hexbuffer(g_tmpstream, &result, blklen);
           dump_nextline(g_tmpstream);
 
+          if (g_blktab)
+            {
+              blktab[blkno] = TGT_UINT32(g_offset);
+            }
+
+          if (g_dedup)
+            {
+              dedup_add(iobuffer, nread, hash, g_offset);
+            }
+
           ntotal   += nread;
           blktotal += blklen;
           g_offset += blklen;
@@ -1066,6 +1235,14 @@ static void gen_file(const char *path, const char *name, mode_t mode,
     }
   while (nread > 0);
 
+  fclose(instream);
+
+  if (g_blktab && blkno != nblocks)
+    {
+      fprintf(stderr, "ERROR: %s changed size\n", path);
+      exit(1);
+    }
+
   /* Restore the old tmpfile context */
 
   g_tmpstream        = save_tmpstream;
@@ -1078,7 +1255,7 @@ static void gen_file(const char *path, const char *name, mode_t mode,
           (unsigned long)blktotal);
 
   node.cn_mode       = TGT_UINT16(NUTTX_IFREG | get_mode(mode));
-  node.cn_pad        = 0;
+  node.cn_flags      = TGT_UINT16(g_blktab ? CROMFS_FLAG_BLKTAB : 0);
 
   nodeoffs          += sizeof(struct cromfs_node_s);
   node.cn_name       = TGT_UINT32(nodeoffs);
@@ -1088,13 +1265,22 @@ static void gen_file(const char *path, const char *name, mode_t mode,
   nodeoffs          += namlen;
   node.u.cn_blocks   = TGT_UINT32(nodeoffs);
 
-  nodeoffs          += blktotal;
+  nodeoffs          += tabsize + blktotal;
   node.cn_peer       = TGT_UINT32(lastentry ? 0 : nodeoffs);
 
   dump_hexbuffer(g_tmpstream, &node, sizeof(struct cromfs_node_s));
   dump_hexbuffer(g_tmpstream, name, namlen);
   dump_nextline(g_tmpstream);
 
+  if (g_blktab)
+    {
+      fprintf(g_tmpstream, "\n  /* Offset %6lu:  Block table */\n\n",
+              (unsigned long)nodeoffs - tabsize - blktotal);
+      dump_hexbuffer(g_tmpstream, blktab, tabsize);
+      dump_nextline(g_tmpstream);
+      free(blktab);
+    }
+
   g_nnodes++;
 
   /* Now append the sub-tree nodes in the new tmpfile to the previous
@@ -1242,22 +1428,53 @@ static int traverse_directory(const char *dirpath,
 int main(int argc, char **argv, char **envp)
 {
   struct cromfs_volume_s vol;
+  char *endptr;
   char *ptr;
   int result;
+  int ch;
 
   /* Verify arguments */
 
   ptr = strrchr(argv[0], '/');
   g_progname = ptr == NULL ? argv[0] : ptr + 1;
 
-  if (argc != 3)
+  while ((ch = getopt(argc, argv, "b:di")) != -1)
+    {
+      switch (ch)
+        {
+          case 'b':
+            g_blocksize = strtoul(optarg, &endptr, 0);
+            if (*endptr != '\0' || g_blocksize < CROMFS_MINBLOCK ||
+                g_blocksize > CROMFS_MAXBLOCK)
+              {
+                fprintf(stderr, "Invalid block size: %s\n", optarg);
+                show_usage();
+              }
+            break;
+
+          case 'd':
+            g_dedup  = true;
+            g_blktab = true;
+            break;
+
+          case 'i':
+            g_blktab = true;
+            break;
+
+          default:
+            show_usage();
+            break;
+        }
+    }
+
+  if (argc - optind != 2)
     {
       fprintf(stderr, "Unexpected number of arguments\n");
       show_usage();
     }
 
-  g_dirname  = argv[1];
-  g_outname  = argv[2];
+  g_dirname  = argv[optind];
+  g_outname  = argv[optind + 1];
 
   verify_directory();
   verify_outfile();
@@ -1311,7 +1528,7 @@ int main(int argc, char **argv, char **envp)
   vol.cv_nblocks  = TGT_UINT16(g_nblocks);
   vol.cv_root     = TGT_UINT32(sizeof(struct cromfs_volume_s));
   vol.cv_fsize    = TGT_UINT32(g_offset);
-  vol.cv_bsize    = TGT_UINT32(CROMFS_BLOCKSIZE);
+  vol.cv_bsize    = TGT_UINT32(g_blocksize);
 
   dump_hexbuffer(g_outstream, &vol, sizeof(struct cromfs_volume_s));
   dump_nextline(g_outstream);
@@ -1324,6 +1541,13 @@ int main(int argc, char **argv, char **envp)
   fprintf(g_outstream, "};\n");
 
   fclose(g_outstream);
+
+  if (g_dedup)
+    {
+      printf("%u duplicate blocks (%lu bytes uncompressed) were shared\n",
+             g_ndups, g_dupsize);
+    }
+
 #ifndef USE_MKSTEMP
   unlink_tmpfiles();
 #endif